@@ -24,15 +24,25 @@ void Geo_Builder::build_constraints_from_input_files()
 {
 	try
 	{
+		// csv files are read concurrently by surfe_lib, each one in parallel
+		std::string csv_files[4];
+		const std::string *files[4] = { &input_.interface_file, &input_.planar_file, &input_.tangent_file, &input_.inequality_file };
+		for (int j = 0; j < 4; j++)
+			if (!files[j]->empty() && get_file_extension(files[j]->c_str()) == "csv")
+				csv_files[j] = *files[j];
+		surfe->LoadConstraintFiles(csv_files[0].c_str(), csv_files[1].c_str(), csv_files[2].c_str(), csv_files[3].c_str());
+		// binary constraint files (Surfe_API::SaveConstraints) hold every type
+		std::vector<std::string> constraint_files;
+		for (int j = 0; j < 4; j++)
+			if (!files[j]->empty() && get_file_extension(files[j]->c_str()) == "scf" &&
+				std::find(constraint_files.begin(), constraint_files.end(), *files[j]) == constraint_files.end())
+				constraint_files.push_back(*files[j]);
+		for (const auto &constraint_file : constraint_files)
+			surfe->LoadConstraints(constraint_file.c_str());
+
 		if (!input_.interface_file.empty()) {
 			std::string extension = get_file_extension(input_.interface_file.c_str());
-			if (extension == "csv")
-			{
-				CSVInterfaceConstraintFileReader reader =
-					CSVInterfaceConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.interface_file.c_str());
-				reader.GetConstraints();
-			}
-			else if (extension == "vtp" || extension == "vtk")
+			if (extension == "vtp" || extension == "vtk")
 			{
 				VTKInterfaceConstraintFileReader reader =
 					VTKInterfaceConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.interface_file.c_str());
@@ -40,15 +50,8 @@ void Geo_Builder::build_constraints_from_input_files()
 			}
 		}
 		if (!input_.inequality_file.empty()) {
-			std::vector<Inequality> inequality_constraints;
 			std::string extension = get_file_extension(input_.inequality_file.c_str());
-			if (extension == "csv")
-			{
-				CSVInequalityConstraintFileReader reader =
-					CSVInequalityConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.inequality_file.c_str());
-				reader.GetConstraints();
-			}
-			else if (extension == "vtp" || extension == "vtk")
+			if (extension == "vtp" || extension == "vtk")
 			{
 				VTKInequalityConstraintFileReader reader =
 					VTKInequalityConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.inequality_file.c_str());
@@ -57,15 +60,8 @@ void Geo_Builder::build_constraints_from_input_files()
 		}
 
 		if (!input_.planar_file.empty()) {
-			std::vector<Planar> planar_constraints;
 			std::string extension = get_file_extension(input_.planar_file.c_str());
-			if (extension == "csv")
-			{
-				CSVPlanarConstraintFileReader reader =
-					CSVPlanarConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.planar_file.c_str());
-				reader.GetConstraints();
-			}
-			else if (extension == "vtp" || extension == "vtk")
+			if (extension == "vtp" || extension == "vtk")
 			{
 				VTKPlanarConstraintFileReader reader =
 					VTKPlanarConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.planar_file.c_str());
@@ -73,15 +69,8 @@ void Geo_Builder::build_constraints_from_input_files()
 			}
 		}
 		if (!input_.tangent_file.empty()) {
-			std::vector<Tangent> tangent_constraints;
-			std::string extension = get_file_extension(input_.planar_file.c_str());
-			if (extension == "csv")
-			{
-				CSVTangentConstraintFileReader reader =
-					CSVTangentConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.tangent_file.c_str());
-				reader.GetConstraints();
-			}
-			else if (extension == "vtp" || extension == "vtk")
+			std::string extension = get_file_extension(input_.tangent_file.c_str());
+			if (extension == "vtp" || extension == "vtk")
 			{
 				VTKTangentConstraintFileReader reader =
 					VTKTangentConstraintFileReader::CreateUsingDefaultPropertyNames(surfe, input_.tangent_file.c_str());
@@ -303,6 +292,16 @@ void Geo_Builder::BuildRegularGrid(const double &resolution, const double &xy_pe
 	}
 }
 
+void Geo_Builder::get_grid_geometry(Vector3d &origin, Vector3d &spacing, Vector3i &dims)
+{
+	double first_point[3];
+	grid_->GetPoint(0, first_point);
+	int *dimensions = grid_->GetDimensions();
+	origin = Vector3d(first_point[0], first_point[1], first_point[2]);
+	spacing = Vector3d(grid_->GetSpacing()[0], grid_->GetSpacing()[1], grid_->GetSpacing()[2]);
+	dims = Vector3i(dimensions[0], dimensions[1], dimensions[2]);
+}
+
 vtkSmartPointer<vtkImageData> Geo_Builder::GetEvaluatedGrid()
 {
 	if (!grid_)
@@ -334,40 +333,21 @@ vtkSmartPointer<vtkImageData> Geo_Builder::GetEvaluatedGrid()
 	// 	normfield->SetNumberOfComponents(1);
 	// 	normfield->SetNumberOfTuples(grid_->GetNumberOfPoints());
 
-	clock_t this_time = clock();
-	clock_t last_time = this_time;
-	double time_counter = 0.0;
-
 	int N = grid_->GetNumberOfPoints();
-	int evaluations_completed = 0;
+	// the grid is evaluated from its geometry, no point coordinates are formed
+	Vector3d origin, spacing;
+	Vector3i dims;
+	get_grid_geometry(origin, spacing, dims);
+
 	std::cout << "Evaluating interpolant in grid: " << std::endl;
-#pragma omp parallel for
-	for (int j = 0; j < N; j++) {
-		double point[3];
-		grid_->GetPoint(j, point);
-		// evaluate scalar field at point
-		double scalar_field = surfe->EvaluateInterpolantAtPoint(point[0], point[1], point[2]);
-
-		sfield->SetTuple1(j, scalar_field);
-		// 		method_->eval_vector_interpolant_at_point(pt);
-		// 		double nx = pt.nx_interp();
-		// 		double ny = pt.ny_interp();
-		// 		double nz = pt.nz_interp();
-		// 		double norm = sqrt(nx*nx + ny * ny + nz * nz);
-		// 		normfield->SetTuple1(j, norm);
-
-				// Print progress every 1s
-		evaluations_completed++;
-		this_time = clock();
-		time_counter += (double)(this_time - last_time);
-		last_time = this_time;
-		if (time_counter > (double)(1 * CLOCKS_PER_SEC))
-		{
-			time_counter -= (double)(1 * CLOCKS_PER_SEC);
-			float percent_completed = ((float)evaluations_completed / (float)N);
-			progress(percent_completed);
-		}
-	}
+	// evaluated on surfe's task scheduler, progress is reported per chunk of points
+	surfe->SetProgressCallback([this](const std::string &stage, const double &fraction) {
+		progress((float)fraction);
+	});
+	VectorXd scalar_field = surfe->EvaluateOnRegularGrid(origin, spacing, dims);
+	surfe->SetProgressCallback(ProgressCallback());
+	for (int j = 0; j < N; j++)
+		sfield->SetTuple1(j, scalar_field(j));
 	progress(1);
 	std::cout << std::endl;
 	grid_->GetPointData()->SetScalars(sfield);
@@ -551,50 +531,34 @@ vtkSmartPointer<vtkPolyData> Geo_Builder::GetInequalityConstraints()
 
 void Geo_Builder::WriteVTKInterfaceConstraints(const char *filename)
 {
-	vtkSmartPointer<vtkPolyData> poly = GetInterfaceConstraints();
+	MatrixXd interface = surfe->GetInterfaceConstraints();
 
-	if (poly) {
-		vtkNew<vtkXMLPolyDataWriter> writer;
-		writer->SetInputData(poly);
-		writer->SetFileName(filename);
-		writer->Write();
-	}
+	if (interface.rows() != 0)
+		write_vtp_points(filename, interface.leftCols(3), { Vtk_Array{ "level", interface.col(3) } }, vtk_compression_available());
 }
 
 void Geo_Builder::WriteVTKPlanarConstraints(const char *filename)
 {
-	vtkSmartPointer<vtkPolyData> poly = GetPlanarConstraints();
+	MatrixXd planar = surfe->GetPlanarConstraints();
 
-	if (poly) {
-		vtkNew<vtkXMLPolyDataWriter> writer;
-		writer->SetInputData(poly);
-		writer->SetFileName(filename);
-		writer->Write();
-	}
+	if (planar.rows() != 0)
+		write_vtp_points(filename, planar.leftCols(3), { Vtk_Array{ "normal", planar.rightCols(3) } }, vtk_compression_available());
 }
 
 void Geo_Builder::WriteVTKTangentConstraints(const char *filename)
 {
-	vtkSmartPointer<vtkPolyData> poly = GetTangentConstraints();
+	MatrixXd tangent = surfe->GetTangentConstraints();
 
-	if (poly) {
-		vtkNew<vtkXMLPolyDataWriter> writer;
-		writer->SetInputData(poly);
-		writer->SetFileName(filename);
-		writer->Write();
-	}
+	if (tangent.rows() != 0)
+		write_vtp_points(filename, tangent.leftCols(3), { Vtk_Array{ "tangent", tangent.rightCols(3) } }, vtk_compression_available());
 }
 
 void Geo_Builder::WriteVTKInequalityConstraints(const char *filename)
 {
-	vtkSmartPointer<vtkPolyData> poly = GetInequalityConstraints();
+	MatrixXd inequality = surfe->GetInequalityConstraints();
 
-	if (poly) {
-		vtkNew<vtkXMLPolyDataWriter> writer;
-		writer->SetInputData(poly);
-		writer->SetFileName(filename);
-		writer->Write();
-	}
+	if (inequality.rows() != 0)
+		write_vtp_points(filename, inequality.leftCols(3), { Vtk_Array{ "level", inequality.col(3) } }, vtk_compression_available());
 }
 
 void Geo_Builder::WriteVTKEvaluationGrid(const char *filename)
@@ -614,24 +578,64 @@ void Geo_Builder::WriteVTKEvaluationGrid(const char *filename)
 		}
 	}
 
-	vtkNew<vtkXMLImageDataWriter> writer;
-	writer->SetInputData(grid_);
-	writer->SetFileName(filename);
-	writer->SetDataModeToBinary();
-	writer->Write();
+	// written straight from the evaluated scalars
+	Vector3d origin, spacing;
+	Vector3i dims;
+	get_grid_geometry(origin, spacing, dims);
+	vtkDoubleArray *scalars = vtkDoubleArray::SafeDownCast(grid_->GetPointData()->GetScalars());
+	Grid_File_Writer writer(filename, origin, spacing, dims, "Scalar Field", false, vtk_compression_available());
+	writer.WriteSlices(scalars->GetPointer(0), dims(2));
+	writer.Close();
 }
 
-void Geo_Builder::WriteVTKIsoSurfaces(const char *filename)
+void Geo_Builder::WriteStreamedEvaluationGrid(const char *filename, const bool &single_precision /*= false*/, const bool &compress /*= false*/)
 {
-	vtkSmartPointer<vtkPolyData> isosurfaces = GetIsoSurfaces();
+	if (!grid_)
+		throw "No vtkImageData grid exists";
+
+	if (!surfe->InterpolantComputed())
+		surfe->ComputeInterpolant();
+
+	Vector3d origin, spacing;
+	Vector3i dims;
+	get_grid_geometry(origin, spacing, dims);
 
-	if (isosurfaces) {
-		vtkNew<vtkXMLPolyDataWriter> writer;
-		writer->SetInputData(isosurfaces);
-		writer->SetFileName(filename);
-		writer->SetDataModeToBinary();
-		writer->Write();
+	std::cout << "Evaluating interpolant in grid and writing " << filename << ": " << std::endl;
+	surfe->SetProgressCallback([this](const std::string &stage, const double &fraction) {
+		progress((float)fraction);
+	});
+	try
+	{
+		surfe->WriteRegularGrid(filename, origin, spacing, dims, single_precision, compress);
 	}
+	catch (const std::exception&)
+	{
+		surfe->SetProgressCallback(ProgressCallback());
+		throw;
+	}
+	surfe->SetProgressCallback(ProgressCallback());
+	progress(1);
+	std::cout << std::endl;
+}
+
+void Geo_Builder::WriteVTKIsoSurfaces(const char *filename)
+{
+	if (!grid_)
+		throw "No vtkImageData grid exists";
+
+	GetEvaluatedGrid();
+
+	// contoured by surfe_lib from the evaluated scalars at the interfaces
+	std::vector<double> iso_values;
+	MatrixXd interface_ref_points = surfe->GetInterfaceReferencePoints();
+	for (int j = 0; j < interface_ref_points.rows(); j++)
+		iso_values.push_back(surfe->EvaluateInterpolantAtPoint(interface_ref_points(j, 0), interface_ref_points(j, 1), interface_ref_points(j, 2)));
+	Vector3d origin, spacing;
+	Vector3i dims;
+	get_grid_geometry(origin, spacing, dims);
+	vtkDoubleArray *scalars = vtkDoubleArray::SafeDownCast(grid_->GetPointData()->GetScalars());
+	std::vector<Iso_Surface> surfaces = extract_iso_surfaces(scalars->GetPointer(0), origin, spacing, dims, iso_values);
+	write_vtp_surfaces(filename, surfaces, vtk_compression_available());
 }
 
 void Geo_Builder::VisualizeVTKData()
@@ -2,6 +2,8 @@
 #define GEO_BUILDER_H
 
 #include <surfe_api.h>
+#include <grid_writer.h>
+#include <vtk_writer.h>
 #include <read_input_files.h>
 #include <modelling_parameters.h>
 
@@ -47,6 +49,8 @@ private:
 	vtkSmartPointer<vtkImageData> grid_;
 	InputParameters getGUIParameters();
 	void progress(const float &progress_value);
+	// origin, spacing and dimensions of grid_
+	void get_grid_geometry(Vector3d &origin, Vector3d &spacing, Vector3i &dims);
 	bool evaluation_completed_;
 	void build_constraints_from_input_files();
 public:
@@ -79,11 +83,16 @@ public:
 	vtkSmartPointer<vtkPolyData> GetPlanarConstraints();
 	vtkSmartPointer<vtkPolyData> GetTangentConstraints();
 	vtkSmartPointer<vtkPolyData> GetInequalityConstraints();
+	// .vtp/.vti files written by surfe_lib's writers, compressed if surfe_lib
+	// was built with zlib
 	void WriteVTKInterfaceConstraints(const char *filename);
 	void WriteVTKPlanarConstraints(const char *filename);
 	void WriteVTKTangentConstraints(const char *filename);
 	void WriteVTKInequalityConstraints(const char *filename);
 	void WriteVTKEvaluationGrid(const char *filename);
+	// evaluates the grid by slabs written to a .vti or .mhd file as they are
+	// done, without filling the vtkImageData: for grids larger than memory
+	void WriteStreamedEvaluationGrid(const char *filename, const bool &single_precision = false, const bool &compress = false);
 	void WriteVTKIsoSurfaces(const char *filename);
 	void VisualizeVTKData();
 };
@@ -94,7 +94,8 @@ double Math_methods::RandomDouble(const double &min, const double &max)
 bool Math_methods::quadratic_solver_loqo(
 	const MatrixXd &H, const MatrixXd &A,
 	const VectorXd &b, const VectorXd &r,
-	VectorXd &fvalues)
+	VectorXd &fvalues,
+	const Iteration_Callback &iteration_callback /*= Iteration_Callback()*/)
 {
 	// minimize f = 1/2 xT H x
 	// s.t. b <= Ax <= b + r
@@ -210,6 +211,8 @@ bool Math_methods::quadratic_solver_loqo(
 	int iter = 0;
 	while (!converged) {
 		iter++;
+		if (iteration_callback)
+			iteration_callback(iter);
 		// 		MatrixXd DebugV(n,10);
 		// 		DebugV.col(0) = x;
 		// 		DebugV.col(1) = y;
@@ -467,6 +470,23 @@ bool Math_methods::angle_btw_2_vectors(
 	return true;
 }
 
+bool Math_methods::angle_btw_2_vectors(
+	const double v1[3], const double v2[3], double &angle)
+{
+	double dotp = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+	double v1norm = v1[0] * v1[0] + v1[1] * v1[1] + v1[2] * v1[2];
+	double v2norm = v2[0] * v2[0] + v2[1] * v2[1] + v2[2] * v2[2];
+	if (v1norm == 0.0 || v2norm == 0.0)
+		return false;
+
+	// clamp to guard against round-off pushing the cosine just outside [-1,1]
+	double cos_angle = dotp / (sqrt(v1norm) * sqrt(v2norm));
+	if (cos_angle > 1.0) cos_angle = 1.0;
+	if (cos_angle < -1.0) cos_angle = -1.0;
+	angle = acos(cos_angle);
+	return true;
+}
+
 double Math_methods::max_element_wrt_zero(const double &a, const double &b) {
 	double max_value = a;
 	double c = 0.0;
@@ -542,7 +562,8 @@ bool Math_methods::quadratic_solver(
 	const MatrixXd &C,
 	const VectorXd &b,
 	const VectorXd &d,
-	VectorXd &fvalues)
+	VectorXd &fvalues,
+	const Iteration_Callback &iteration_callback /*= Iteration_Callback()*/)
 {
 	// Describe the Quadratic Optimization problem
 	// min (w.r.t. x) f(x) = 1/2 * xT * H * x => our objective function
@@ -840,6 +861,8 @@ bool Math_methods::quadratic_solver(
 	bool found_soln = false;
 	int iter = 0;
 	while (!found_soln) {
+		if (iteration_callback)
+			iteration_callback(iter + 1);
 		// Update KKT matrix blocks: [4][3], [4][4]
 		for (int j = 0; j < nc; j++) {
 			// [4][3] Block
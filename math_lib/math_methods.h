@@ -48,11 +48,15 @@
 #include <Eigen/LU>
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <vector>
 using namespace Eigen;
 
+// called at the start of every iteration of the iterative solvers, may throw to abort
+typedef std::function<void(const int &iteration)> Iteration_Callback;
+
 class MATH_LIB_EXPORT Math_methods {
 private:
 	static double _find_step_length(
@@ -81,6 +85,9 @@ public:
 	}
 	static bool angle_btw_2_vectors(
 		const std::vector<double> &v1, const std::vector<double> &v2, double &angle);
+	// 3D specialization - no heap allocations, safe to call in tight parallel loops
+	static bool angle_btw_2_vectors(
+		const double v1[3], const double v2[3], double &angle);
 	static double RandomDouble(const double &min, const double &max);
 	static bool quadratic_solver(
 		const MatrixXd &H,
@@ -88,13 +95,15 @@ public:
 		const MatrixXd &C,
 		const VectorXd &b,
 		const VectorXd &d,
-		VectorXd &fvalues);
+		VectorXd &fvalues,
+		const Iteration_Callback &iteration_callback = Iteration_Callback());
 	static bool quadratic_solver_loqo(
 		const MatrixXd &H,
 		const MatrixXd &A,
 		const VectorXd &b,
 		const VectorXd &r,
-		VectorXd &fvalues);
+		VectorXd &fvalues,
+		const Iteration_Callback &iteration_callback = Iteration_Callback());
 };
 
 
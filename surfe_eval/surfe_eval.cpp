@@ -0,0 +1,251 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <surfe_eval.h>
+#include <grbf_exceptions.h>
+
+#include <algorithm>
+
+namespace {
+
+// Everything an evaluation pass reads, lives on the caller's stack
+struct Evaluation_Data {
+	const Radial_Geometry *geometry;
+	const double *terms;
+	int n_terms;
+	int stride;
+	const double *coefficients;
+
+	double delta(const double *x, const double *p, double *a) const {
+		return geometry->delta(x, p, a);
+	}
+	void apply_metric(const double *v, double *m_v) const {
+		geometry->apply_metric(v, m_v);
+	}
+	double polynomial(const double *x) const {
+		const double *c = coefficients;
+		return c[0] * x[0] * x[0] + c[1] * x[1] * x[1] + c[2] * x[2] * x[2] +
+			c[3] * x[0] * x[1] + c[4] * x[0] * x[2] + c[5] * x[1] * x[2] +
+			c[6] * x[0] + c[7] * x[1] + c[8] * x[2] + c[9];
+	}
+	void polynomial_gradient(const double *x, double *g) const {
+		const double *c = coefficients;
+		g[0] = 2.0 * c[0] * x[0] + c[3] * x[1] + c[4] * x[2] + c[6];
+		g[1] = 2.0 * c[1] * x[1] + c[3] * x[0] + c[5] * x[2] + c[7];
+		g[2] = 2.0 * c[2] * x[2] + c[4] * x[0] + c[5] * x[1] + c[8];
+	}
+};
+
+// term layout: type, weight, p (x, y, z, c), q (x, y, z, c)
+template <class Profile>
+double scalar_at(const Profile &k, const Evaluation_Data &data, const double *x)
+{
+	double sum = data.polynomial(x);
+	double a[3];
+	double phi, f1;
+	for (int j = 0; j < data.n_terms; j++) {
+		const double *term = data.terms + (long long)j * data.stride;
+		const double r = data.delta(x, term + 2, a);
+		k.value(r, phi, f1);
+		switch ((int)term[0]) {
+		case Snapshot_Format::Value_Term:
+			sum += term[1] * phi;
+			break;
+		case Snapshot_Format::Derivative_Term:
+			sum -= term[1] * f1 * (a[0] * term[6] + a[1] * term[7] + a[2] * term[8]);
+			break;
+		default: {
+			double phi_q;
+			k.value(data.delta(x, term + 6, a), phi_q, f1);
+			sum += term[1] * (phi - phi_q);
+		}
+		}
+	}
+	return sum;
+}
+
+template <class Profile>
+void gradient_at(const Profile &k, const Evaluation_Data &data, const double *x, double *g)
+{
+	data.polynomial_gradient(x, g);
+	double a[3];
+	double m_v[3];
+	double f1, f2;
+	for (int j = 0; j < data.n_terms; j++) {
+		const double *term = data.terms + (long long)j * data.stride;
+		const double w = term[1];
+		const double r = data.delta(x, term + 2, a);
+		k.derivatives(r, f1, f2);
+		switch ((int)term[0]) {
+		case Snapshot_Format::Value_Term:
+			for (int i = 0; i < 3; i++)
+				g[i] += w * f1 * a[i];
+			break;
+		case Snapshot_Format::Derivative_Term: {
+			const double a_v = a[0] * term[6] + a[1] * term[7] + a[2] * term[8];
+			data.apply_metric(term + 6, m_v);
+			for (int i = 0; i < 3; i++)
+				g[i] -= w * (f2 * a[i] * a_v + f1 * m_v[i]);
+			break;
+		}
+		default:
+			for (int i = 0; i < 3; i++)
+				g[i] += w * f1 * a[i];
+			k.derivatives(data.delta(x, term + 6, a), f1, f2);
+			for (int i = 0; i < 3; i++)
+				g[i] -= w * f1 * a[i];
+		}
+	}
+}
+
+template <class Profile>
+void evaluate_points(const Profile &k, const Evaluation_Data &data, const double *points, const int &n_points, double *values, double *gradients)
+{
+	for (int j = 0; j < n_points; j++) {
+		const double *x = points + 3 * (long long)j;
+		if (values)
+			values[j] = scalar_at(k, data, x);
+		if (gradients)
+			gradient_at(k, data, x, gradients + 3 * (long long)j);
+	}
+}
+
+struct Points_Evaluation {
+	const Evaluation_Data &data;
+	const double *points;
+	int n_points;
+	double *values;
+	double *gradients;
+	template <class Profile>
+	void operator()(const Profile &k) const {
+		evaluate_points(k, data, points, n_points, values, gradients);
+	}
+};
+
+// values and/or gradients, nullptr skips
+void evaluate(const int &rbf_type, const double &shape_parameter, const Evaluation_Data &data,
+	const double *points, const int &n_points, double *values, double *gradients)
+{
+	const Points_Evaluation evaluation = { data, points, n_points, values, gradients };
+	if (!visit_radial_profile(rbf_type, shape_parameter, evaluation))
+		throw GRBF_Exceptions::unknown_rbf;
+}
+
+}
+
+Surfe_Evaluator::Surfe_Evaluator()
+	: _rbf_type(Parameter_Types::Cubic), _shape_parameter(0),
+	_terms(nullptr), _n_terms(0), _term_stride(0), _monomial_coefficients(nullptr), _loaded(false)
+{
+}
+
+Surfe_Evaluator::Surfe_Evaluator(const char *filename) : Surfe_Evaluator()
+{
+	Load(filename);
+}
+
+void Surfe_Evaluator::Load(const char *filename)
+{
+	_loaded = false;
+	_iso_values.clear();
+	_sorted_iso_values.clear();
+	_reader.open(filename);
+
+	int rows = 0;
+	const double *kernel_values = _reader.get_doubles(Snapshot_Format::Evaluation_Kernel_Section, 12, rows);
+	_terms = _reader.get_doubles(Snapshot_Format::Evaluation_Terms_Section, Snapshot_Format::n_evaluation_term_cols, _n_terms);
+	if (!kernel_values || !_terms)
+		throw GRBF_Exceptions::snapshot_without_evaluation_terms;
+	_term_stride = (int)_reader.find_section(Snapshot_Format::Evaluation_Terms_Section)->cols;
+	if (rows != 1)
+		throw GRBF_Exceptions::invalid_snapshot;
+	_monomial_coefficients = _reader.get_doubles(Snapshot_Format::Evaluation_Polynomial_Section, Snapshot_Format::n_monomials, rows);
+	if (!_monomial_coefficients || rows != 1)
+		throw GRBF_Exceptions::invalid_snapshot;
+
+	_rbf_type = (int)kernel_values[0];
+	if (_rbf_type < Parameter_Types::Cubic || _rbf_type > Parameter_Types::MaternC4)
+		throw GRBF_Exceptions::invalid_snapshot;
+	_shape_parameter = kernel_values[1];
+	_geometry.set(kernel_values[2] != 0, kernel_values + 3);
+	for (int j = 0; j < _n_terms; j++) {
+		const double type = _terms[(long long)j * _term_stride];
+		if (type != Snapshot_Format::Value_Term && type != Snapshot_Format::Derivative_Term && type != Snapshot_Format::Increment_Term)
+			throw GRBF_Exceptions::invalid_snapshot;
+	}
+
+	const double *iso_values = _reader.get_doubles(Snapshot_Format::Iso_Values_Section, 1, rows);
+	if (iso_values)
+		_iso_values.assign(iso_values, iso_values + rows);
+	_sorted_iso_values = _iso_values;
+	std::sort(_sorted_iso_values.begin(), _sorted_iso_values.end());
+	_loaded = true;
+}
+
+void Surfe_Evaluator::_check_loaded() const
+{
+	if (!_loaded)
+		throw GRBF_Exceptions::missing_interpolant;
+}
+
+void Surfe_Evaluator::EvaluateScalar(const double *points, const int &n_points, double *values) const
+{
+	EvaluateScalarAndGradient(points, n_points, values, nullptr);
+}
+
+void Surfe_Evaluator::EvaluateGradient(const double *points, const int &n_points, double *gradients) const
+{
+	EvaluateScalarAndGradient(points, n_points, nullptr, gradients);
+}
+
+void Surfe_Evaluator::EvaluateScalarAndGradient(const double *points, const int &n_points, double *values, double *gradients) const
+{
+	_check_loaded();
+	Evaluation_Data data = { &_geometry, _terms, _n_terms, _term_stride, _monomial_coefficients };
+	evaluate(_rbf_type, _shape_parameter, data, points, n_points, values, gradients);
+}
+
+void Surfe_Evaluator::Classify(const double *points, const int &n_points, int *units) const
+{
+	_check_loaded();
+	Evaluation_Data data = { &_geometry, _terms, _n_terms, _term_stride, _monomial_coefficients };
+	for (int j = 0; j < n_points; j++) {
+		double value;
+		evaluate(_rbf_type, _shape_parameter, data, points + 3 * (long long)j, 1, &value, nullptr);
+		units[j] = (int)(std::upper_bound(_sorted_iso_values.begin(), _sorted_iso_values.end(), value) - _sorted_iso_values.begin());
+	}
+}
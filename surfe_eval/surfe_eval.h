@@ -0,0 +1,95 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef surfe_eval_h
+#define surfe_eval_h
+
+#include <surfe_eval_module.h>
+#include <snapshot_reader.h>
+#include <radial_profiles.h>
+
+#include <vector>
+
+// Lightweight evaluator of a saved interpolant (see Surfe_API::SaveInterpolant).
+// Only reads the Evaluation_* sections of the snapshot: no modelling methods,
+// no solver and no Eigen. The snapshot stays memory mapped, the centers are
+// used in place and the evaluation methods do not allocate, so loading is
+// cheap and the memory footprint is about the size of the file.
+// Evaluation methods are const and can be called from several threads at once.
+// points: n_points x 3 row major array of x, y, z
+class SURFE_EVAL_EXPORT Surfe_Evaluator {
+private:
+	Snapshot_Reader _reader;
+	int _rbf_type;            // Parameter_Types::RBF
+	double _shape_parameter;
+	Radial_Geometry _geometry;
+	const double *_terms;     // see Snapshot_Format::Evaluation_Term_Type
+	int _n_terms;
+	int _term_stride;
+	const double *_monomial_coefficients;
+	std::vector<double> _iso_values;         // as saved, 1 per interface
+	std::vector<double> _sorted_iso_values;  // ascending, for Classify()
+	bool _loaded;
+	void _check_loaded() const;
+	// not copyable, owns the mapping
+	Surfe_Evaluator(const Surfe_Evaluator &);
+	Surfe_Evaluator &operator=(const Surfe_Evaluator &);
+
+public:
+	Surfe_Evaluator();
+	Surfe_Evaluator(const char *filename);
+	// replaces any previously loaded snapshot. Throws error_reading_snapshot,
+	// invalid_snapshot, unsupported_snapshot_version or
+	// snapshot_without_evaluation_terms
+	void Load(const char *filename);
+	bool IsLoaded() const { return _loaded; }
+	int GetNumberOfCenters() const { return _n_terms; }
+	// values: n_points
+	void EvaluateScalar(const double *points, const int &n_points, double *values) const;
+	// gradients: n_points x 3 row major
+	void EvaluateGradient(const double *points, const int &n_points, double *gradients) const;
+	// values: n_points, gradients: n_points x 3 row major
+	void EvaluateScalarAndGradient(const double *points, const int &n_points, double *values, double *gradients) const;
+	// units: # of interfaces whose scalar field value is <= the scalar field at
+	// the point, 0 .. GetNumberOfInterfaces()
+	void Classify(const double *points, const int &n_points, int *units) const;
+	int GetNumberOfInterfaces() const { return (int)_iso_values.size(); }
+	// scalar field value of each interface, in the order of Surfe_API
+	const std::vector<double> &GetInterfaceIsoValues() const { return _iso_values; }
+};
+
+#endif
@@ -0,0 +1,143 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <surfe_eval_c.h>
+#include <surfe_eval.h>
+#include <grbf_exceptions.h>
+
+#include <algorithm>
+#include <string>
+
+struct surfe_evaluator {
+	Surfe_Evaluator evaluator;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+int fail(const std::exception &e)
+{
+	SurfeExceptions exceptions(e);
+	last_error = exceptions.what();
+	return -1;
+}
+
+}
+
+surfe_evaluator *surfe_eval_open(const char *filename)
+{
+	last_error.clear();
+	surfe_evaluator *handle = nullptr;
+	try {
+		handle = new surfe_evaluator;
+		handle->evaluator.Load(filename);
+		return handle;
+	}
+	catch (const std::exception &e) {
+		delete handle;
+		fail(e);
+		return nullptr;
+	}
+}
+
+void surfe_eval_close(surfe_evaluator *evaluator)
+{
+	delete evaluator;
+}
+
+int surfe_eval_scalar(const surfe_evaluator *evaluator, const double *points, int n_points, double *values)
+{
+	last_error.clear();
+	try {
+		if (!evaluator)
+			throw GRBF_Exceptions::missing_interpolant;
+		evaluator->evaluator.EvaluateScalar(points, n_points, values);
+		return 0;
+	}
+	catch (const std::exception &e) {
+		return fail(e);
+	}
+}
+
+int surfe_eval_gradient(const surfe_evaluator *evaluator, const double *points, int n_points, double *gradients)
+{
+	last_error.clear();
+	try {
+		if (!evaluator)
+			throw GRBF_Exceptions::missing_interpolant;
+		evaluator->evaluator.EvaluateGradient(points, n_points, gradients);
+		return 0;
+	}
+	catch (const std::exception &e) {
+		return fail(e);
+	}
+}
+
+int surfe_eval_classify(const surfe_evaluator *evaluator, const double *points, int n_points, int *units)
+{
+	last_error.clear();
+	try {
+		if (!evaluator)
+			throw GRBF_Exceptions::missing_interpolant;
+		evaluator->evaluator.Classify(points, n_points, units);
+		return 0;
+	}
+	catch (const std::exception &e) {
+		return fail(e);
+	}
+}
+
+int surfe_eval_n_interfaces(const surfe_evaluator *evaluator)
+{
+	return evaluator ? evaluator->evaluator.GetNumberOfInterfaces() : 0;
+}
+
+int surfe_eval_iso_values(const surfe_evaluator *evaluator, double *iso_values)
+{
+	last_error.clear();
+	if (!evaluator)
+		return fail(GRBF_Exceptions::missing_interpolant);
+	const std::vector<double> &values = evaluator->evaluator.GetInterfaceIsoValues();
+	std::copy(values.begin(), values.end(), iso_values);
+	return 0;
+}
+
+const char *surfe_eval_last_error(void)
+{
+	return last_error.c_str();
+}
@@ -0,0 +1,76 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef surfe_eval_c_h
+#define surfe_eval_c_h
+
+#include <surfe_eval_module.h>
+
+/* C interface of Surfe_Evaluator (surfe_eval.h).
+   points: n_points x 3 row major array of x, y, z
+   Functions returning int return 0 on success and -1 on failure, the reason
+   is then given by surfe_eval_last_error() on the calling thread */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct surfe_evaluator surfe_evaluator;
+
+/* nullptr on failure */
+SURFE_EVAL_EXPORT surfe_evaluator *surfe_eval_open(const char *filename);
+SURFE_EVAL_EXPORT void surfe_eval_close(surfe_evaluator *evaluator);
+
+/* values: n_points */
+SURFE_EVAL_EXPORT int surfe_eval_scalar(const surfe_evaluator *evaluator, const double *points, int n_points, double *values);
+/* gradients: n_points x 3 row major */
+SURFE_EVAL_EXPORT int surfe_eval_gradient(const surfe_evaluator *evaluator, const double *points, int n_points, double *gradients);
+/* units: # of interfaces whose scalar field value is <= the scalar field at the point */
+SURFE_EVAL_EXPORT int surfe_eval_classify(const surfe_evaluator *evaluator, const double *points, int n_points, int *units);
+
+/* scalar field value of each interface, iso_values: surfe_eval_n_interfaces() */
+SURFE_EVAL_EXPORT int surfe_eval_n_interfaces(const surfe_evaluator *evaluator);
+SURFE_EVAL_EXPORT int surfe_eval_iso_values(const surfe_evaluator *evaluator, double *iso_values);
+
+/* message of the last failure on this thread, empty if none */
+SURFE_EVAL_EXPORT const char *surfe_eval_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
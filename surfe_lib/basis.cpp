@@ -60,6 +60,8 @@ inline void RBFKernel::scaled_radius() {
 	double dx = _p1->x() - _p2->x();
 	double dy = _p1->y() - _p2->y();
 	double dz = _p1->z() - _p2->z();
+	// the c component is not scaled
+	_c_delta = _p1->c() - _p2->c();
 	// compute scaled component differences
 	_x_delta =
 		_Transform(0, 0) * dx + _Transform(0, 1) * dy + _Transform(0, 2) * dz;
@@ -69,13 +71,14 @@ inline void RBFKernel::scaled_radius() {
 		_Transform(2, 0) * dx + _Transform(2, 1) * dy + _Transform(2, 2) * dz;
 
 	_radius =
-		sqrt(_x_delta * _x_delta + _y_delta * _y_delta + _z_delta * _z_delta);
+		sqrt(_x_delta * _x_delta + _y_delta * _y_delta + _z_delta * _z_delta +
+			_c_delta * _c_delta);
 }
 
 bool RBFKernel::get_global_anisotropy(const std::vector<Planar> &planar)
 {
 	if ((int)planar.size() < 2)
-		std::throw_with_nested(GRBF_Exceptions::failure_computing_global_anisotropy);
+		throw GRBF_Exceptions::failure_computing_global_anisotropy;
 
 	double SumXX = 0; // Sum(x_i *  x_i)
 	double SumXY = 0; // Sum(x_i *  y_i)
@@ -1886,6 +1889,10 @@ void Lagrangian_Polynomial_Basis::_initialize_basis() {
 		// 	for (int j = 0; j< 16;j++)
 		// poly_const_double.push_back(_polynomial_constants[j].get_d());
 
+	_initialize_derivative_constants();
+}
+
+void Lagrangian_Polynomial_Basis::_initialize_derivative_constants() {
 	_derivative_polynomial_constants.resize(3, 4);
 
 	_derivative_polynomial_constants(0, 0) = _polynomial_constants[1];  // basis 1
@@ -2852,6 +2859,15 @@ double Modified_Kernel::basis_tangent_planar(const Parameter_Types::FirstDerivat
 	}
 }
 
+void Polynomial_Basis::get_monomial_coefficients(const VectorXd &weights, VectorXd &coefficients) const {
+	// the terms of Poly_Zero, Poly_First and Poly_Second are the tail of
+	// xx, yy, zz, xy, xz, yz, x, y, z, 1 - without the 1 if truncated
+	coefficients = VectorXd::Zero(10);
+	int offset = (_truncated ? 9 : 10) - (int)weights.size();
+	for (int k = 0; k < (int)weights.size(); k++)
+		coefficients(offset + k) = weights(k);
+}
+
 VectorXd Poly_Zero::basis() {
 	if (!_truncated) {
 		VectorXd v(1);
@@ -135,6 +135,15 @@ public:
 	double basis_planar_tangent(const Parameter_Types::FirstDerivatives &fd) override;
 	double basis_tangent_planar(const Parameter_Types::FirstDerivatives &fd) override;
 	RBFKernel *clone() override = 0;
+	// global anisotropy state - used to store/restore solved interpolants
+	void get_anisotropy_transform(double(&plunge)[3], Matrix3f &transform) const {
+		for (int j = 0; j < 3; j++) plunge[j] = _Global_Plunge[j];
+		transform = _Transform;
+	}
+	void set_anisotropy_transform(const double(&plunge)[3], const Matrix3f &transform) {
+		for (int j = 0; j < 3; j++) _Global_Plunge[j] = plunge[j];
+		_Transform = transform;
+	}
 };
 
 class Cubic : public RBFKernel {
@@ -553,7 +562,12 @@ public:
 		_p = nullptr;
 		_truncated = false;
 	}
+	virtual ~Polynomial_Basis() {}
 	void set_point(Point &point) { _p = &point; }
+	bool truncated() const { return _truncated; }
+	// weights of the basis terms as coefficients of the monomials
+	// xx, yy, zz, xy, xz, yz, x, y, z, 1
+	void get_monomial_coefficients(const VectorXd &weights, VectorXd &coefficients) const;
 	virtual VectorXd basis() = 0;
 	virtual VectorXd dx() = 0;
 	virtual VectorXd dy() = 0;
@@ -598,6 +612,7 @@ private:
 	bool _get_unisolvent_subset(
 		const std::vector<std::vector<Interface> > &interface_point_lists);
 	void _initialize_basis();
+	void _initialize_derivative_constants();
 
 public:
 	Lagrangian_Polynomial_Basis(
@@ -605,10 +620,22 @@ public:
 	{
 		if (_get_unisolvent_subset(interface_point_lists))
 			_initialize_basis();
-		else {
-			std::throw_with_nested(GRBF_Exceptions::failure_creating_lagrangian_polynomial_basis);
-		}
+		else
+			// plain throw: nothing to nest outside a handler, and a nested
+			// exception with no inner one terminates SurfeExceptions
+			throw GRBF_Exceptions::failure_creating_lagrangian_polynomial_basis;
+	}
+	// previously computed basis e.g. from an interpolant snapshot
+	Lagrangian_Polynomial_Basis(
+		const std::vector<Interface> &unisolvent_points,
+		const VectorXd &polynomial_constants)
+		: _polynomial_constants(polynomial_constants), unisolvent_subset_points(unisolvent_points)
+	{
+		if ((int)_polynomial_constants.size() != 16 || (int)unisolvent_subset_points.size() != 4)
+			throw GRBF_Exceptions::failure_creating_lagrangian_polynomial_basis;
+		_initialize_derivative_constants();
 	}
+	const VectorXd &polynomial_constants() const { return _polynomial_constants; }
 	VectorXd poly(const Point *p);
 	VectorXd poly_dx(const Point *p);
 	VectorXd poly_dy(const Point *p);
@@ -633,6 +660,8 @@ public:
 			std::throw_with_nested(GRBF_Exceptions::failure_creating_lagrangian_polynomial_basis);
 		}
 	}
+	Modified_Kernel(RBFKernel *arbfkernel, Lagrangian_Polynomial_Basis *alpb)
+		: _aRBFKernel(arbfkernel), _aLPB(alpb) {}
 	// copy constructor
 	Modified_Kernel(const Modified_Kernel &source)
 		: _aRBFKernel(source._aRBFKernel->clone()), _aLPB(source._aLPB) {}
@@ -651,6 +680,8 @@ public:
 	double basis_planar_tangent(const Parameter_Types::FirstDerivatives &fd) override;
 	double basis_tangent_planar(const Parameter_Types::FirstDerivatives &fd) override;
 	Modified_Kernel *clone() override { return new Modified_Kernel(*this); }
+	RBFKernel *rbf_kernel() const { return _aRBFKernel; }
+	Lagrangian_Polynomial_Basis *lagrangian_basis() const { return _aLPB; }
 
 private:
 	RBFKernel *_aRBFKernel;
@@ -0,0 +1,445 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#include <center_selection.h>
+#include <kd_tree.h>
+#include <task_scheduler.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+Center_Selection::Center_Selection(const Constraints &constraints, RBFKernel *kernel, const int &polynomial_order,
+	const Parameter_Types::CenterSelectionMethod &method)
+{
+	_itrface = constraints.itrface;
+	_planar = constraints.planar;
+	_tangent = constraints.tangent;
+
+	_kernel = kernel;
+	if (polynomial_order == 0)
+		_p_basis = new Poly_Zero;
+	else if (polynomial_order == 1)
+		_p_basis = new Poly_First;
+	else
+		_p_basis = new Poly_Second;
+	_method = method;
+
+	_kernel_sign = 1.0;
+	_n_basis = 0;
+	_pivot_tolerance = 1e-10;
+}
+
+Center_Selection::~Center_Selection()
+{
+	delete _p_basis;
+}
+
+Point &Center_Selection::_point(const int &functional)
+{
+	int block = _functionals[functional].block;
+	int n_i = (int)_itrface.size();
+	int n_p = (int)_planar.size();
+	if (block < n_i)
+		return _itrface[block];
+	else if (block < n_i + n_p)
+		return _planar[block - n_i];
+	else
+		return _tangent[block - n_i - n_p];
+}
+
+double Center_Selection::_kernel_value(RBFKernel *kernel, const int &f1, const int &f2)
+{
+	kernel->set_points(_point(f1), _point(f2));
+	FunctionalType t1 = _functionals[f1].type;
+	FunctionalType t2 = _functionals[f2].type;
+
+	if (t1 == Value) {
+		if (t2 == Value) return kernel->basis_pt_pt();
+		else if (t2 == GradientX) return kernel->basis_pt_planar_x();
+		else if (t2 == GradientY) return kernel->basis_pt_planar_y();
+		else if (t2 == GradientZ) return kernel->basis_pt_planar_z();
+		else return kernel->basis_pt_tangent();
+	}
+	else if (t1 == Directional) {
+		if (t2 == Value) return kernel->basis_tangent_pt();
+		else if (t2 == Directional) return kernel->basis_tangent_tangent();
+		else return kernel->basis_tangent_planar((Parameter_Types::FirstDerivatives)(t2 - GradientX));
+	}
+	else {
+		int c1 = t1 - GradientX;
+		if (t2 == Value) {
+			if (t1 == GradientX) return kernel->basis_planar_x_pt();
+			else if (t1 == GradientY) return kernel->basis_planar_y_pt();
+			else return kernel->basis_planar_z_pt();
+		}
+		else if (t2 == Directional)
+			return kernel->basis_planar_tangent((Parameter_Types::FirstDerivatives)c1);
+		else
+			return kernel->basis_planar_planar((Parameter_Types::SecondDerivatives)(3 * c1 + t2 - GradientX));
+	}
+}
+
+VectorXd Center_Selection::_polynomial_value(const int &functional)
+{
+	_p_basis->set_point(_point(functional));
+	FunctionalType type = _functionals[functional].type;
+	if (type == Value)
+		return _p_basis->basis();
+	else if (type == GradientX)
+		return _p_basis->dx();
+	else if (type == GradientY)
+		return _p_basis->dy();
+	else if (type == GradientZ)
+		return _p_basis->dz();
+	else {
+		Tangent &t = static_cast<Tangent &>(_point(functional));
+		return t.tx() * _p_basis->dx() + t.ty() * _p_basis->dy() + t.tz() * _p_basis->dz();
+	}
+}
+
+double Center_Selection::_target_value(const int &functional) const
+{
+	int block = _functionals[functional].block;
+	int n_i = (int)_itrface.size();
+	switch (_functionals[functional].type) {
+	case Value:
+		return _itrface[block].level();
+	case GradientX:
+		return _planar[block - n_i].nx();
+	case GradientY:
+		return _planar[block - n_i].ny();
+	case GradientZ:
+		return _planar[block - n_i].nz();
+	default:
+		return 0.0;
+	}
+}
+
+void Center_Selection::_setup_functionals()
+{
+	_functionals.clear();
+	_block_functionals.clear();
+
+	int n_blocks = (int)(_itrface.size() + _planar.size() + _tangent.size());
+	int n_i = (int)_itrface.size();
+	int n_p = (int)_planar.size();
+	_block_functionals.resize(n_blocks);
+	for (int b = 0; b < n_blocks; b++) {
+		std::vector<FunctionalType> types;
+		if (b < n_i)
+			types.push_back(Value);
+		else if (b < n_i + n_p) {
+			types.push_back(GradientX);
+			types.push_back(GradientY);
+			types.push_back(GradientZ);
+		}
+		else
+			types.push_back(Directional);
+		for (const auto &type : types) {
+			Functional f;
+			f.type = type;
+			f.block = b;
+			_block_functionals[b].push_back((int)_functionals.size());
+			_functionals.push_back(f);
+		}
+	}
+}
+
+void Center_Selection::_setup_polynomial_projection()
+{
+	int n = (int)_functionals.size();
+	int n_poly = (int)_polynomial_value(0).rows();
+
+	MatrixXd poly_matrix(n_poly, n);
+	for (int j = 0; j < n; j++)
+		poly_matrix.col(j) = _polynomial_value(j);
+
+	// column pivoting picks a unisolvent subset, Q^T P spans the polynomial
+	// space that is actually resolved by the input (coplanar data, gradients only ...)
+	ColPivHouseholderQR<MatrixXd> qr(poly_matrix);
+	int rank = (int)qr.rank();
+	_unisolvent.clear();
+	if (rank == 0) {
+		_lagrange.resize(0, n);
+		_kernel_unisolvent.resize(n, 0);
+		return;
+	}
+	MatrixXd reduced_poly = (qr.householderQ().transpose() * poly_matrix).topRows(rank);
+	MatrixXd unisolvent_poly(rank, rank);
+	for (int a = 0; a < rank; a++) {
+		_unisolvent.push_back(qr.colsPermutation().indices()(a));
+		unisolvent_poly.col(a) = reduced_poly.col(_unisolvent[a]);
+	}
+	_lagrange = unisolvent_poly.partialPivLu().solve(reduced_poly);
+
+	_kernel_unisolvent.resize(n, rank);
+	parallel_for(n, 64, [&](const int &begin, const int &end) {
+		RBFKernel *kernel_j = _kernel->clone();
+		for (int j = begin; j < end; j++)
+			for (int a = 0; a < rank; a++)
+				_kernel_unisolvent(j, a) = _kernel_value(kernel_j, j, _unisolvent[a]);
+		delete kernel_j;
+	});
+}
+
+// the projected kernel
+// K_u(i,j) = K(i,j) - L_i.K(u,j) - L_j.K(i,u) + L_i^T K(u,u) L_j + L_i.L_j
+// with L the Lagrange basis of the unisolvent set u, is positive definite
+// for conditionally positive definite kernels of order <= polynomial order + 1
+void Center_Selection::_reduced_kernel_column(const int &functional, VectorXd &column)
+{
+	int n = (int)_functionals.size();
+	column.resize(n);
+	// need a clone per chunk, kernel is stateful (set_points)
+	parallel_for(n, 256, [&](const int &begin, const int &end) {
+		RBFKernel *kernel_j = _kernel->clone();
+		for (int j = begin; j < end; j++)
+			column(j) = _kernel_value(kernel_j, j, functional);
+		delete kernel_j;
+	});
+	if (_unisolvent.empty()) {
+		column *= _kernel_sign;
+		return;
+	}
+
+	int rank = (int)_unisolvent.size();
+	MatrixXd kernel_uu(rank, rank);
+	for (int a = 0; a < rank; a++)
+		kernel_uu.row(a) = _kernel_unisolvent.row(_unisolvent[a]);
+	VectorXd l_j = _lagrange.col(functional);
+	VectorXd k_uj = _kernel_unisolvent.row(functional).transpose();
+
+	column -= _lagrange.transpose() * (k_uj - kernel_uu * l_j);
+	column -= _kernel_unisolvent * l_j;
+	column *= _kernel_sign;
+	column += _lagrange.transpose() * l_j;
+}
+
+void Center_Selection::_reduced_kernel_diagonal(VectorXd &diagonal)
+{
+	int n = (int)_functionals.size();
+	int rank = (int)_unisolvent.size();
+	MatrixXd kernel_uu(rank, rank);
+	for (int a = 0; a < rank; a++)
+		kernel_uu.row(a) = _kernel_unisolvent.row(_unisolvent[a]);
+
+	VectorXd kernel_part(n);
+	VectorXd poly_part(n);
+	parallel_for(n, 256, [&](const int &begin, const int &end) {
+		RBFKernel *kernel_j = _kernel->clone();
+		for (int j = begin; j < end; j++) {
+			kernel_part(j) = _kernel_value(kernel_j, j, j);
+			poly_part(j) = 0;
+			if (rank != 0) {
+				VectorXd l_j = _lagrange.col(j);
+				kernel_part(j) += -2.0 * _kernel_unisolvent.row(j).dot(l_j) + l_j.dot(kernel_uu * l_j);
+				poly_part(j) = l_j.squaredNorm();
+			}
+		}
+		delete kernel_j;
+	});
+	// e.g. MQ is conditionally positive definite with a negative sign
+	_kernel_sign = kernel_part.sum() < 0 ? -1.0 : 1.0;
+	diagonal = _kernel_sign * kernel_part + poly_part;
+}
+
+bool Center_Selection::_add_functional(const int &functional)
+{
+	double min_pivot = _pivot_tolerance * _diagonal(functional);
+	if (_functional_in_basis[functional] || _diagonal(functional) <= 0 || _power2(functional) <= min_pivot)
+		return false;
+
+	VectorXd column;
+	_reduced_kernel_column(functional, column);
+	if (_n_basis != 0)
+		column -= _newton_basis.leftCols(_n_basis) * _newton_basis.row(functional).head(_n_basis).transpose();
+	double pivot = column(functional);
+	if (pivot <= min_pivot)
+		return false;
+	column /= std::sqrt(pivot);
+
+	if (_n_basis == (int)_newton_basis.cols())
+		_newton_basis.conservativeResize(NoChange, std::max(2 * _n_basis, 16));
+	_newton_basis.col(_n_basis) = column;
+	_n_basis++;
+
+	_power2 -= column.cwiseAbs2();
+	_power2(functional) = 0;
+	double coefficient = _residual(functional) / column(functional);
+	_residual -= coefficient * column;
+	_residual(functional) = 0;
+	_functional_in_basis[functional] = 1;
+
+	return true;
+}
+
+void Center_Selection::_add_block(const int &block)
+{
+	if (_block_selected[block]) return;
+	for (const auto &functional : _block_functionals[block])
+		_add_functional(functional);
+	_block_selected[block] = 1;
+	_selected_blocks.push_back(block);
+}
+
+double Center_Selection::_block_criterion(const int &block) const
+{
+	double criterion = 0;
+	for (const auto &functional : _block_functionals[block]) {
+		if (_functional_in_basis[functional] || _diagonal(functional) <= 0) continue;
+		double value = _method == Parameter_Types::FGreedy ? _residual(functional) * _residual(functional) :
+			_power2(functional) / _diagonal(functional);
+		if (value > criterion) criterion = value;
+	}
+	return criterion;
+}
+
+std::vector<int> Center_Selection::_get_seed_blocks()
+{
+	// two furthest points of each interface, so iso-value increments are defined for every level
+	std::map<double, std::vector<int> > levels;
+	for (int j = 0; j < (int)_itrface.size(); j++)
+		levels[_itrface[j].level()].push_back(j);
+
+	std::vector<int> seeds;
+	for (const auto &level : levels) {
+		if (level.second.size() < 2) {
+			seeds.push_back(level.second[0]);
+			continue;
+		}
+		std::vector<Point> pts;
+		for (const auto &index : level.second)
+			pts.push_back(_itrface[index]);
+		KD_Tree tree(pts);
+		int two_indexes[2] = { -1, -1 };
+		if (!Find_STL_Vector_Indices_FurtherestTwoPoints(pts, tree, two_indexes)) continue;
+		seeds.push_back(level.second[two_indexes[0]]);
+		seeds.push_back(level.second[two_indexes[1]]);
+	}
+
+	return seeds;
+}
+
+int Center_Selection::select(const int &max_centers, const double &tolerance)
+{
+	_setup_functionals();
+	int n = (int)_functionals.size();
+	int n_blocks = (int)_block_functionals.size();
+	_selected_blocks.clear();
+	_n_basis = 0;
+	if (n == 0) return 0;
+
+	_setup_polynomial_projection();
+	_reduced_kernel_diagonal(_diagonal);
+	_power2 = _diagonal;
+	_residual.resize(n);
+	for (int j = 0; j < n; j++)
+		_residual(j) = _target_value(j);
+	_functional_in_basis.assign(n, 0);
+	_block_selected.assign(n_blocks, 0);
+	_newton_basis.resize(n, std::min(n, 3 * std::max(max_centers, 1) + (int)_unisolvent.size()));
+
+	// unisolvent set first (polynomial part), then the seeds
+	for (const auto &functional : _unisolvent)
+		_add_functional(functional);
+	for (const auto &functional : _unisolvent)
+		_add_block(_functionals[functional].block);
+	for (const auto &block : _get_seed_blocks())
+		_add_block(block);
+
+	while ((int)_selected_blocks.size() < max_centers) {
+		int best_block = -1;
+		double best_criterion = 0;
+		for (int b = 0; b < n_blocks; b++) {
+			if (_block_selected[b]) continue;
+			double criterion = _block_criterion(b);
+			if (criterion > best_criterion) {
+				best_criterion = criterion;
+				best_block = b;
+			}
+		}
+		if (best_block == -1) break;
+
+		if (std::sqrt(best_criterion) <= tolerance)
+			break;
+
+		_add_block(best_block);
+	}
+
+	return (int)_selected_blocks.size();
+}
+
+void Center_Selection::get_selected_constraints(const Constraints &input, Constraints &selected) const
+{
+	std::vector<int> blocks(_selected_blocks);
+	std::sort(blocks.begin(), blocks.end());
+
+	int n_i = (int)input.itrface.size();
+	int n_p = (int)input.planar.size();
+	selected.inequality = input.inequality;
+	selected.itrface.clear();
+	selected.planar.clear();
+	selected.tangent.clear();
+	for (const auto &block : blocks) {
+		if (block < n_i)
+			selected.itrface.push_back(input.itrface[block]);
+		else if (block < n_i + n_p)
+			selected.planar.push_back(input.planar[block - n_i]);
+		else
+			selected.tangent.push_back(input.tangent[block - n_i - n_p]);
+	}
+}
+
+double Center_Selection::max_power_function() const
+{
+	double max_power2 = 0;
+	for (int j = 0; j < (int)_power2.rows(); j++)
+		if (!_functional_in_basis[j] && _diagonal(j) > 0 && _power2(j) / _diagonal(j) > max_power2)
+			max_power2 = _power2(j) / _diagonal(j);
+	return std::sqrt(max_power2);
+}
+
+double Center_Selection::max_residual() const
+{
+	double max_residual = 0;
+	for (int j = 0; j < (int)_residual.rows(); j++)
+		if (!_functional_in_basis[j] && std::fabs(_residual(j)) > max_residual) max_residual = std::fabs(_residual(j));
+	return max_residual;
+}
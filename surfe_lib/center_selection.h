@@ -0,0 +1,136 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#ifndef center_selection_h
+#define center_selection_h
+
+#include <basis.h>
+#include <modelling_input.h>
+#include <modelling_parameters.h>
+
+#include <Eigen/Core>
+#include <vector>
+
+using namespace Eigen;
+
+// Greedy selection of a compact subset of constraints (centers) using the
+// Newton basis of the kernel, i.e. a pivoted Cholesky factorization of the
+// interpolation matrix that is only ever formed one column at a time.
+// Each constraint is a block of functionals (interface: value, planar: gradient
+// x/y/z, tangent: directional derivative); selecting a constraint adds all its
+// functionals to the basis. Selecting m centers out of N functionals costs
+// O(N*m^2) operations and O(N*m) memory instead of m full solves.
+//   P-greedy: picks the constraint where the power function is largest. Values and
+//             derivatives scale differently, so the power function is taken relative
+//             to the kernel diagonal (1 far from any center, 0 at a center)
+//   f-greedy: picks the constraint where the interpolation residual is largest
+// Polynomial reproduction is handled by projecting the kernel with the Lagrange
+// basis of a unisolvent subset, which is always selected first.
+class Center_Selection {
+private:
+	enum FunctionalType {
+		Value,
+		GradientX,
+		GradientY,
+		GradientZ,
+		Directional
+	};
+	struct Functional {
+		FunctionalType type;
+		int block;  // constraint index: interface -> planar -> tangent
+	};
+	// local copies, the kernel holds non-const pointers to the points
+	std::vector<Interface> _itrface;
+	std::vector<Planar> _planar;
+	std::vector<Tangent> _tangent;
+
+	std::vector<Functional> _functionals;
+	std::vector<std::vector<int> > _block_functionals;
+	RBFKernel *_kernel;
+	Polynomial_Basis *_p_basis;
+	Parameter_Types::CenterSelectionMethod _method;
+
+	// polynomial projection
+	std::vector<int> _unisolvent;  // functional indices
+	MatrixXd _lagrange;            // (n unisolvent) x (n functionals)
+	MatrixXd _kernel_unisolvent;   // (n functionals) x (n unisolvent)
+	double _kernel_sign;           // conditionally positive definite kernels can be of negative type (e.g. MQ)
+
+	// Newton basis
+	MatrixXd _newton_basis;  // (n functionals) x (n basis)
+	int _n_basis;
+	VectorXd _diagonal;  // projected kernel diagonal
+	VectorXd _power2;    // squared power function
+	VectorXd _residual;  // f-greedy residual
+	std::vector<char> _functional_in_basis;
+	std::vector<char> _block_selected;
+	std::vector<int> _selected_blocks;  // in selection order
+	double _pivot_tolerance;  // relative to the diagonal
+
+	Point &_point(const int &functional);
+	double _kernel_value(RBFKernel *kernel, const int &f1, const int &f2);
+	VectorXd _polynomial_value(const int &functional);
+	double _target_value(const int &functional) const;
+	void _setup_functionals();
+	void _setup_polynomial_projection();
+	void _reduced_kernel_column(const int &functional, VectorXd &column);
+	void _reduced_kernel_diagonal(VectorXd &diagonal);
+	bool _add_functional(const int &functional);
+	void _add_block(const int &block);
+	double _block_criterion(const int &block) const;
+	std::vector<int> _get_seed_blocks();
+
+public:
+	Center_Selection(const Constraints &constraints, RBFKernel *kernel, const int &polynomial_order,
+		const Parameter_Types::CenterSelectionMethod &method);
+	~Center_Selection();
+
+	// max_centers: maximum # of selected constraints (blocks). The unisolvent set
+	//              and the seeds of every interface are needed for a solvable
+	//              system and are always selected, even beyond max_centers
+	// tolerance: P-greedy - relative power function
+	//            f-greedy - absolute residual (constraint units: level, normal component)
+	// returns the # of selected constraints
+	int select(const int &max_centers, const double &tolerance);
+	// selected interface/planar/tangent constraints, in input order. Inequalities are copied as is.
+	void get_selected_constraints(const Constraints &input, Constraints &selected) const;
+	double max_power_function() const;  // relative
+	double max_residual() const;
+};
+
+#endif
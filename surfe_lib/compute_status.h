@@ -0,0 +1,131 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#ifndef compute_status_h
+#define compute_status_h
+
+#include <grbf_exceptions.h>
+#include <modelling_parameters.h>
+
+#include <algorithm>
+#include <atomic>
+
+// snapshot of a running interpolant computation
+struct Compute_Progress {
+	Parameter_Types::ComputePhase phase;
+	double assembly_fraction;  // rows of the interpolation matrix assembled [0,1]
+	int solver_iteration;      // iterative (quadratic) solvers only
+	int greedy_iteration;
+	int n_greedy_residuals;    // constraints still left out of the greedy input
+};
+
+// Progress and cancellation state shared between the thread computing an
+// interpolant and the threads observing it. Cancellation is cooperative: the
+// computation polls it while assembling the interpolation matrix, at every
+// solver iteration and every greedy iteration, and throws computation_cancelled.
+class Compute_Status {
+private:
+	std::atomic<int> _phase;
+	std::atomic<long long> _assembly_done;
+	std::atomic<long long> _assembly_total;
+	std::atomic<int> _solver_iteration;
+	std::atomic<int> _greedy_iteration;
+	std::atomic<int> _n_greedy_residuals;
+	std::atomic<bool> _cancel_requested;
+
+public:
+	Compute_Status() { reset(); }
+	void reset() {
+		_phase = Parameter_Types::Idle;
+		_assembly_done = 0;
+		_assembly_total = 0;
+		_solver_iteration = 0;
+		_greedy_iteration = 0;
+		_n_greedy_residuals = 0;
+		_cancel_requested = false;
+	}
+
+	void set_phase(const Parameter_Types::ComputePhase &phase) { _phase = phase; }
+	Parameter_Types::ComputePhase phase() const { return (Parameter_Types::ComputePhase)_phase.load(); }
+
+	void request_cancel() { _cancel_requested = true; }
+	bool cancel_requested() const { return _cancel_requested; }
+	void check_cancelled() const {
+		if (_cancel_requested)
+			throw GRBF_Exceptions::computation_cancelled;
+	}
+
+	// assembly of the interpolation matrix, n_rows = # of row blocks visited
+	void begin_assembly(const long long &n_rows) {
+		check_cancelled();
+		_assembly_done = 0;
+		_assembly_total = n_rows;
+		_solver_iteration = 0;
+		_phase = Parameter_Types::Assembly;
+	}
+	void advance_assembly() {
+		check_cancelled();
+		// the system is solved right after it is assembled
+		if (++_assembly_done >= _assembly_total)
+			_phase = Parameter_Types::Solving;
+	}
+	void set_solver_iteration(const int &iteration) {
+		check_cancelled();
+		_phase = Parameter_Types::Solving;
+		_solver_iteration = iteration;
+	}
+	void set_greedy_iteration(const int &iteration, const int &n_residuals) {
+		check_cancelled();
+		_phase = Parameter_Types::Greedy;
+		_greedy_iteration = iteration;
+		_n_greedy_residuals = n_residuals;
+	}
+
+	Compute_Progress progress() const {
+		Compute_Progress p;
+		p.phase = phase();
+		long long total = _assembly_total;
+		p.assembly_fraction = total == 0 ? 0.0 : std::min(1.0, (double)_assembly_done / total);
+		p.solver_iteration = _solver_iteration;
+		p.greedy_iteration = _greedy_iteration;
+		p.n_greedy_residuals = _n_greedy_residuals;
+		return p;
+	}
+};
+
+#endif
@@ -0,0 +1,275 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <constraint_file.h>
+#include <grbf_exceptions.h>
+#include <task_scheduler.h>
+#include <vtk_writer.h>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Column_Payload {
+	Constraint_File_Format::Column column;
+	std::string bytes;
+};
+
+std::uint64_t aligned(const std::uint64_t &offset)
+{
+	return (offset + 7) / 8 * 8;
+}
+
+// one field of rows constraints as stored: doubles or floats, kept compressed
+// if that saves at least 10%
+Column_Payload encode_column(const Constraint_File_Format::Constraint_Type &type, const int &field,
+	const double *values, const Index &rows, const bool &single_precision, const bool &compress)
+{
+	Column_Payload payload;
+	payload.column.constraint_type = type;
+	payload.column.field = field;
+	payload.column.value_type = single_precision ? Constraint_File_Format::Float32_Values : Constraint_File_Format::Float64_Values;
+	payload.column.encoding = Constraint_File_Format::Raw_Encoding;
+	payload.column.offset = 0;
+	payload.column.rows = rows;
+	if (single_precision) {
+		std::vector<float> single_values(values, values + rows);
+		payload.bytes.assign(reinterpret_cast<const char *>(single_values.data()), single_values.size() * sizeof(float));
+	}
+	else
+		payload.bytes.assign(reinterpret_cast<const char *>(values), rows * sizeof(double));
+
+	if (compress) {
+		std::vector<std::string> blocks = compress_vtk_blocks(payload.bytes.data(), payload.bytes.size());
+		std::vector<std::uint64_t> block_table(1, blocks.size());
+		size_t compressed_size = 0;
+		for (const auto &block : blocks) {
+			block_table.push_back(block.size());
+			compressed_size += block.size();
+		}
+		compressed_size += block_table.size() * sizeof(std::uint64_t);
+		if (compressed_size * 10 <= payload.bytes.size() * 9) {
+			std::string compressed(reinterpret_cast<const char *>(block_table.data()), block_table.size() * sizeof(std::uint64_t));
+			compressed.reserve(compressed_size);
+			for (const auto &block : blocks)
+				compressed.append(block);
+			payload.bytes.swap(compressed);
+			payload.column.encoding = Constraint_File_Format::Zlib_Encoding;
+		}
+	}
+	payload.column.stored_bytes = payload.bytes.size();
+	return payload;
+}
+
+// the rows values of a column, false if the payload is not valid
+bool decode_column(const unsigned char *file_data, const Constraint_File_Format::Column &column, double *values)
+{
+	const char *payload = reinterpret_cast<const char *>(file_data + column.offset);
+	const bool single_precision = column.value_type == Constraint_File_Format::Float32_Values;
+	const size_t n_bytes = (size_t)column.rows * (single_precision ? sizeof(float) : sizeof(double));
+
+	std::vector<float> single_values(single_precision ? column.rows : 0);
+	char *bytes = single_precision ? reinterpret_cast<char *>(single_values.data()) : reinterpret_cast<char *>(values);
+	if (column.encoding == Constraint_File_Format::Zlib_Encoding) {
+		std::uint64_t n_blocks = 0;
+		if (column.stored_bytes < sizeof(n_blocks))
+			return false;
+		std::memcpy(&n_blocks, payload, sizeof(n_blocks));
+		if (n_blocks > column.stored_bytes / sizeof(std::uint64_t) - 1)
+			return false;
+		std::vector<std::uint64_t> block_sizes(n_blocks);
+		if (n_blocks != 0)
+			std::memcpy(block_sizes.data(), payload + sizeof(n_blocks), n_blocks * sizeof(std::uint64_t));
+		std::uint64_t available = column.stored_bytes - (n_blocks + 1) * sizeof(std::uint64_t);
+		for (const auto &size : block_sizes) {
+			if (size > available)
+				return false;
+			available -= size;
+		}
+		if (!uncompress_vtk_blocks(payload + (n_blocks + 1) * sizeof(std::uint64_t), block_sizes, bytes, n_bytes))
+			return false;
+	}
+	else
+		std::memcpy(bytes, payload, n_bytes);
+
+	if (single_precision)
+		for (std::uint64_t j = 0; j < column.rows; j++)
+			values[j] = single_values[j];
+	return true;
+}
+
+}
+
+void write_constraint_file(const char *filename, const MatrixXd &interface, const MatrixXd &planar,
+	const MatrixXd &tangent, const MatrixXd &inequality, const bool &single_precision /*= false*/, const bool &compress /*= false*/)
+{
+	if (compress && !vtk_compression_available())
+		throw GRBF_Exceptions::compression_not_available;
+
+	const MatrixXd *matrices[] = { &interface, &planar, &tangent, &inequality };
+	std::vector<Column_Payload> payloads;
+	for (int t = 0; t < 4; t++) {
+		const Constraint_File_Format::Constraint_Type type = (Constraint_File_Format::Constraint_Type)(t + 1);
+		const MatrixXd &constraints = *matrices[t];
+		if (constraints.rows() == 0)
+			continue;
+		if (constraints.cols() != Constraint_File_Format::n_fields(type))
+			throw GRBF_Exceptions::array_has_incorrect_dimensions;
+		for (int field = 0; field < constraints.cols(); field++)
+			payloads.push_back(encode_column(type, field, constraints.col(field).data(), constraints.rows(), single_precision, compress));
+	}
+
+	// lay out the payloads behind the column table
+	Constraint_File_Format::Header header;
+	std::memcpy(header.magic, Constraint_File_Format::magic, sizeof(header.magic));
+	header.version = Constraint_File_Format::version;
+	header.byte_order = Constraint_File_Format::byte_order;
+	header.n_columns = (std::uint32_t)payloads.size();
+	header.reserved = 0;
+	std::uint64_t offset = sizeof(Constraint_File_Format::Header) + payloads.size() * sizeof(Constraint_File_Format::Column);
+	for (auto &payload : payloads) {
+		offset = aligned(offset);
+		payload.column.offset = offset;
+		offset += payload.bytes.size();
+	}
+	header.file_size = aligned(offset);
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw GRBF_Exceptions::error_writing_constraint_file;
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	for (const auto &payload : payloads)
+		file.write(reinterpret_cast<const char *>(&payload.column), sizeof(payload.column));
+	const char padding[8] = { 0 };
+	std::uint64_t position = sizeof(Constraint_File_Format::Header) + payloads.size() * sizeof(Constraint_File_Format::Column);
+	for (const auto &payload : payloads) {
+		file.write(padding, payload.column.offset - position);
+		file.write(payload.bytes.data(), payload.bytes.size());
+		position = payload.column.offset + payload.bytes.size();
+	}
+	file.write(padding, header.file_size - position);
+	if (!file)
+		throw GRBF_Exceptions::error_writing_constraint_file;
+}
+
+void Constraint_File_Reader::open(const char *filename)
+{
+	if (!file_.open(filename))
+		throw GRBF_Exceptions::error_reading_constraint_file;
+
+	const std::size_t size = file_.size();
+	if (size < sizeof(Constraint_File_Format::Header))
+		throw GRBF_Exceptions::invalid_constraint_file;
+	header_ = reinterpret_cast<const Constraint_File_Format::Header *>(file_.data());
+	if (std::memcmp(header_->magic, Constraint_File_Format::magic, sizeof(Constraint_File_Format::magic)) != 0 ||
+		header_->byte_order != Constraint_File_Format::byte_order || header_->version > Constraint_File_Format::version ||
+		header_->file_size != size)
+		throw GRBF_Exceptions::invalid_constraint_file;
+	const std::uint64_t table_end = sizeof(Constraint_File_Format::Header) + (std::uint64_t)header_->n_columns * sizeof(Constraint_File_Format::Column);
+	if (table_end > size)
+		throw GRBF_Exceptions::invalid_constraint_file;
+	columns_ = reinterpret_cast<const Constraint_File_Format::Column *>(file_.data() + sizeof(Constraint_File_Format::Header));
+	for (std::uint32_t j = 0; j < header_->n_columns; j++) {
+		const Constraint_File_Format::Column &column = columns_[j];
+		const Constraint_File_Format::Constraint_Type type = (Constraint_File_Format::Constraint_Type)column.constraint_type;
+		if (type < Constraint_File_Format::Interface_Constraints || type > Constraint_File_Format::Inequality_Constraints ||
+			column.field >= (std::uint32_t)Constraint_File_Format::n_fields(type) ||
+			(column.value_type != Constraint_File_Format::Float64_Values && column.value_type != Constraint_File_Format::Float32_Values) ||
+			(column.encoding != Constraint_File_Format::Raw_Encoding && column.encoding != Constraint_File_Format::Zlib_Encoding))
+			throw GRBF_Exceptions::invalid_constraint_file;
+		if (column.offset % 8 != 0 || column.offset < table_end || column.offset > size || column.stored_bytes > size - column.offset)
+			throw GRBF_Exceptions::invalid_constraint_file;
+		const std::uint64_t element_size = column.value_type == Constraint_File_Format::Float64_Values ? sizeof(double) : sizeof(float);
+		if (column.rows > size / element_size * 1024)
+			throw GRBF_Exceptions::invalid_constraint_file;  // more than zlib can inflate
+		if (column.encoding == Constraint_File_Format::Raw_Encoding && column.stored_bytes != column.rows * element_size)
+			throw GRBF_Exceptions::invalid_constraint_file;
+	}
+}
+
+const Constraint_File_Format::Column *Constraint_File_Reader::find_column(const Constraint_File_Format::Constraint_Type &type, const int &field) const
+{
+	for (std::uint32_t j = 0; j < header_->n_columns; j++)
+		if (columns_[j].constraint_type == (std::uint32_t)type && columns_[j].field == (std::uint32_t)field)
+			return &columns_[j];
+	return nullptr;
+}
+
+Index Constraint_File_Reader::GetNumberOfConstraints(const Constraint_File_Format::Constraint_Type &type) const
+{
+	const Constraint_File_Format::Column *column = find_column(type, 0);
+	return column ? (Index)column->rows : 0;
+}
+
+Map<const MatrixXd> Constraint_File_Reader::GetConstraints(const Constraint_File_Format::Constraint_Type &type, MatrixXd &storage) const
+{
+	const Index rows = GetNumberOfConstraints(type);
+	const int n_fields = Constraint_File_Format::n_fields(type);
+	if (rows == 0) {
+		storage.resize(0, n_fields);
+		return Map<const MatrixXd>(storage.data(), 0, n_fields);
+	}
+
+	std::vector<const Constraint_File_Format::Column *> columns(n_fields);
+	bool adjacent_doubles = true;
+	for (int field = 0; field < n_fields; field++) {
+		columns[field] = find_column(type, field);
+		if (!columns[field] || (Index)columns[field]->rows != rows)
+			throw GRBF_Exceptions::invalid_constraint_file;
+		adjacent_doubles = adjacent_doubles &&
+			columns[field]->value_type == Constraint_File_Format::Float64_Values &&
+			columns[field]->encoding == Constraint_File_Format::Raw_Encoding &&
+			columns[field]->offset == columns[0]->offset + field * rows * sizeof(double);
+	}
+	if (adjacent_doubles)
+		return Map<const MatrixXd>(reinterpret_cast<const double *>(file_.data() + columns[0]->offset), rows, n_fields);
+
+	storage.resize(rows, n_fields);
+	std::atomic<bool> valid(true);
+	parallel_for(n_fields, 1, [&](const int &first, const int &last) {
+		for (int field = first; field < last; field++)
+			if (!decode_column(file_.data(), *columns[field], storage.col(field).data()))
+				valid = false;
+	});
+	if (!valid)
+		throw GRBF_Exceptions::invalid_constraint_file;
+	return Map<const MatrixXd>(storage.data(), rows, n_fields);
+}
@@ -0,0 +1,138 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef constraint_file_h
+#define constraint_file_h
+
+#include <surfe_lib_module.h>
+#include <mapped_file.h>
+
+#include <Eigen/Core>
+#include <cstdint>
+
+using namespace Eigen;
+
+// Binary columnar constraint file (native byte order), loaded without parsing:
+//   Constraint_File_Format::Header
+//   Constraint_File_Format::Column[n_columns]
+//   column payloads, each starting at an 8 byte aligned offset
+// A column holds one field of one constraint type for all its constraints.
+// The fields of a type follow the columns of the Surfe_API matrices:
+//   interface, inequality  x, y, z, level
+//   planar                 x, y, z, nx, ny, nz
+//   tangent                x, y, z, tx, ty, tz
+// Payloads are 8 or 4 byte floats, stored as is or zlib compressed in the
+// blocks of compress_vtk_blocks:
+//   uint64 n_blocks, uint64 compressed block sizes[n_blocks], blocks
+// The raw double columns of a type are written one after the other, so that
+// type is read as a matrix straight from the mapped file.
+namespace Constraint_File_Format {
+	const char magic[8] = { 'S', 'U', 'R', 'F', 'E', 'C', 'O', 'N' };
+	const std::uint32_t version = 1;
+	const std::uint32_t byte_order = 0x01020304;
+
+	enum Constraint_Type {
+		Interface_Constraints = 1,
+		Planar_Constraints,
+		Tangent_Constraints,
+		Inequality_Constraints
+	};
+	enum Value_Type {
+		Float64_Values = 1,
+		Float32_Values
+	};
+	enum Encoding {
+		Raw_Encoding = 0,
+		Zlib_Encoding
+	};
+	// # of fields of a constraint type
+	inline int n_fields(const Constraint_Type &type)
+	{
+		return type == Interface_Constraints || type == Inequality_Constraints ? 4 : 6;
+	}
+
+	struct Header {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t byte_order;
+		std::uint32_t n_columns;
+		std::uint32_t reserved;
+		std::uint64_t file_size;
+	};
+
+	struct Column {
+		std::uint32_t constraint_type;
+		std::uint32_t field;         // column of the Surfe_API matrix
+		std::uint32_t value_type;
+		std::uint32_t encoding;
+		std::uint64_t offset;        // from the beginning of the file
+		std::uint64_t rows;
+		std::uint64_t stored_bytes;  // payload size, compressed or not
+	};
+}
+
+// Writes the constraint matrices, in the column order of Surfe_API's getters.
+// Empty matrices are left out. single_precision stores 4 byte floats, enough
+// for directions and levels but not for coordinates far from the origin.
+// compress stores the columns zlib compressed when that makes them at least 10%
+// smaller. Throws error_writing_constraint_file or compression_not_available
+SURFE_LIB_EXPORT void write_constraint_file(const char *filename, const MatrixXd &interface, const MatrixXd &planar,
+	const MatrixXd &tangent, const MatrixXd &inequality, const bool &single_precision = false, const bool &compress = false);
+
+// Mapped constraint file. Throws error_reading_constraint_file or
+// invalid_constraint_file
+class SURFE_LIB_EXPORT Constraint_File_Reader {
+private:
+	Mapped_File file_;
+	const Constraint_File_Format::Header *header_;
+	const Constraint_File_Format::Column *columns_;
+
+	const Constraint_File_Format::Column *find_column(const Constraint_File_Format::Constraint_Type &type, const int &field) const;
+
+public:
+	Constraint_File_Reader() : header_(nullptr), columns_(nullptr) {}
+	void open(const char *filename);
+	// # of constraints of a type in the file, 0 if there are none
+	Index GetNumberOfConstraints(const Constraint_File_Format::Constraint_Type &type) const;
+	// n x n_fields(type) matrix of the constraints of a type. It points into the
+	// mapped file if the type is stored as adjacent raw doubles, otherwise the
+	// columns are decoded in parallel into storage. Valid while the reader is
+	// open and storage is not changed
+	Map<const MatrixXd> GetConstraints(const Constraint_File_Format::Constraint_Type &type, MatrixXd &storage) const;
+};
+
+#endif
@@ -229,65 +229,6 @@ void Continuous_Property::setup_system_solver() {
 // 	return true;
 // }
 
-bool Continuous_Property::measure_residuals(Constraints &input)
-{
-	if (solver == nullptr) return false;
-
-	// inequalities points
-	for (auto &inequality_pt : input.inequality) {
-		eval_scalar_interpolant_at_point(inequality_pt);
-		if (inequality_pt.level() >= 0) {
-			if (inequality_pt.scalar_field() >= 0)
-				inequality_pt.setResidual(true);
-			else
-				inequality_pt.setResidual(false);
-		}
-		else {
-			if (inequality_pt.scalar_field() < 0)
-				inequality_pt.setResidual(true);
-			else
-				inequality_pt.setResidual(false);
-		}
-	}
-	// interface points
-	for (auto &interface_pt : input.itrface) {
-		eval_scalar_interpolant_at_point(interface_pt);
-		interface_pt.setResidual(abs(interface_pt.scalar_field() - interface_pt.level())); // THIS DOES NOT WORK FOR INCREMENT POINTS
-	}
-	// planar points
-	for (auto &planar_pt : input.planar) {
-		eval_vector_interpolant_at_point(planar_pt);
-		double angle = 0.0;
-		std::vector<double> v1;
-		std::vector<double> v2;
-		v1.push_back(planar_pt.nx());
-		v1.push_back(planar_pt.ny());
-		v1.push_back(planar_pt.nz());
-		v2.push_back(planar_pt.nx_interp());
-		v2.push_back(planar_pt.ny_interp());
-		v2.push_back(planar_pt.nz_interp());
-		Math_methods::angle_btw_2_vectors(v1, v2, angle);
-		planar_pt.setResidual(angle);
-	}
-	// tangent points
-	for (auto &tangent_pt : input.tangent) {
-		eval_vector_interpolant_at_point(tangent_pt);
-		double angle = 0.0;
-		std::vector<double> v1;
-		std::vector<double> v2;
-		v1.push_back(tangent_pt.tx());
-		v1.push_back(tangent_pt.ty());
-		v1.push_back(tangent_pt.tz());
-		v2.push_back(tangent_pt.nx_interp());
-		v2.push_back(tangent_pt.ny_interp());
-		v2.push_back(tangent_pt.nz_interp());
-		Math_methods::angle_btw_2_vectors(v1, v2, angle);
-		tangent_pt.setResidual(angle);
-	}
-
-	return true;
-}
-
 bool Continuous_Property::append_greedy_input(Constraints &input) {
 	// planar > tangent > interface > inequalities
 
@@ -401,30 +342,30 @@ void Continuous_Property::eval_vector_interpolant_at_point(Point &p) {
 	double poly_z = 0.0;
 	// interface constraints
 	for (int k = 0; k < n_i; k++) {
-		kernel->set_points(p, constraints.itrface[k]);
-		elemsum_1_x += solver->weights[k] * kernel->basis_planar_x_pt();
-		elemsum_1_y += solver->weights[k] * kernel->basis_planar_y_pt();
-		elemsum_1_z += solver->weights[k] * kernel->basis_planar_z_pt();
+		kernel_j->set_points(p, constraints.itrface[k]);
+		elemsum_1_x += solver->weights[k] * kernel_j->basis_planar_x_pt();
+		elemsum_1_y += solver->weights[k] * kernel_j->basis_planar_y_pt();
+		elemsum_1_z += solver->weights[k] * kernel_j->basis_planar_z_pt();
 	}
 	// normal constraints
 	for (int k = 0; k < n_p; k++) {
-		kernel->set_points(p, constraints.planar[k]);
-		elemsum_2_x += solver->weights[n_i + 0 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DXDX);
-		elemsum_2_x += solver->weights[n_i + 1 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DXDY);
-		elemsum_2_x += solver->weights[n_i + 2 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DXDZ);
-		elemsum_2_y += solver->weights[n_i + 0 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DYDX);
-		elemsum_2_y += solver->weights[n_i + 1 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DYDY);
-		elemsum_2_y += solver->weights[n_i + 2 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DYDZ);
-		elemsum_2_z += solver->weights[n_i + 0 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DZDX);
-		elemsum_2_z += solver->weights[n_i + 1 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DZDY);
-		elemsum_2_z += solver->weights[n_i + 2 + 3 * k] * kernel->basis_planar_planar(Parameter_Types::DZDZ);
+		kernel_j->set_points(p, constraints.planar[k]);
+		elemsum_2_x += solver->weights[n_i + 0 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DXDX);
+		elemsum_2_x += solver->weights[n_i + 1 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DXDY);
+		elemsum_2_x += solver->weights[n_i + 2 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DXDZ);
+		elemsum_2_y += solver->weights[n_i + 0 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DYDX);
+		elemsum_2_y += solver->weights[n_i + 1 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DYDY);
+		elemsum_2_y += solver->weights[n_i + 2 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DYDZ);
+		elemsum_2_z += solver->weights[n_i + 0 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DZDX);
+		elemsum_2_z += solver->weights[n_i + 1 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DZDY);
+		elemsum_2_z += solver->weights[n_i + 2 + 3 * k] * kernel_j->basis_planar_planar(Parameter_Types::DZDZ);
 	}
 	// tangent constraints
 	for (int k = 0; k < n_t; k++) {
-		kernel->set_points(p, constraints.tangent[k]);
-		elemsum_3_x += solver->weights[n_i + 3 * n_p + k] * kernel->basis_planar_tangent(Parameter_Types::DX);
-		elemsum_3_y += solver->weights[n_i + 3 * n_p + k] * kernel->basis_planar_tangent(Parameter_Types::DY);
-		elemsum_3_z += solver->weights[n_i + 3 * n_p + k] * kernel->basis_planar_tangent(Parameter_Types::DZ);
+		kernel_j->set_points(p, constraints.tangent[k]);
+		elemsum_3_x += solver->weights[n_i + 3 * n_p + k] * kernel_j->basis_planar_tangent(Parameter_Types::DX);
+		elemsum_3_y += solver->weights[n_i + 3 * n_p + k] * kernel_j->basis_planar_tangent(Parameter_Types::DY);
+		elemsum_3_z += solver->weights[n_i + 3 * n_p + k] * kernel_j->basis_planar_tangent(Parameter_Types::DZ);
 	}
 	if (intern_params.poly_term) {
 		Polynomial_Basis *p_basis_j = p_basis->clone();
@@ -446,6 +387,28 @@ void Continuous_Property::eval_vector_interpolant_at_point(Point &p) {
 	delete kernel_j;
 }
 
+void Continuous_Property::get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) {
+	int n_i = intern_params.n_interface;
+	int n_p = intern_params.n_planar;
+	int n_t = intern_params.n_tangent;
+
+	for (int k = 0; k < n_i; k++)
+		terms.push_back(Evaluation_Term(Evaluation_Term::Value, solver->weights[k], constraints.itrface[k], constraints.itrface[k]));
+	for (int k = 0; k < n_p; k++) {
+		Point weights(solver->weights[n_i + 3 * k], solver->weights[n_i + 3 * k + 1], solver->weights[n_i + 3 * k + 2]);
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, 1.0, constraints.planar[k], weights));
+	}
+	for (int k = 0; k < n_t; k++) {
+		Point direction(constraints.tangent[k].tx(), constraints.tangent[k].ty(), constraints.tangent[k].tz());
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, solver->weights[n_i + 3 * n_p + k], constraints.tangent[k], direction));
+	}
+	monomial_coefficients = VectorXd::Zero(10);
+	if (intern_params.poly_term) {
+		prepare_polynomial_basis();
+		p_basis->get_monomial_coefficients(solver->weights.segment(n_i + 3 * n_p + n_t, intern_params.n_poly_terms), monomial_coefficients);
+	}
+}
+
 bool Continuous_Property::get_equality_values(VectorXd &equality_values) {
 	int j = 0;
 	int k = 0;
@@ -478,6 +441,8 @@ bool Continuous_Property::get_interpolation_matrix(
 	int n_p = intern_params.n_planar;
 	int n_t = intern_params.n_tangent;
 
+	_begin_assembly(n_i + n_p + n_t);
+
 	// Row and Column constraint order : interface (itr) -> planar (p_x,p_y,p_z)
 	// -> tangent (t)
 
@@ -489,75 +454,75 @@ bool Continuous_Property::get_interpolation_matrix(
 	// |   t/itr   t/p_x   t/p_y   t/p_z   t/t |
 
 	// Interface Constraints:
-	for (int j = 0; j < n_i; j++) {
+	_assemble_rows(n_i, [&](const int &j, Kernel *lane_kernel) {
 		// Row:interface/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.itrface[k]);
-			interpolation_matrix(j, k) = kernel->basis_pt_pt();
+			lane_kernel->set_points(constraints.itrface[j], constraints.itrface[k]);
+			interpolation_matrix(j, k) = lane_kernel->basis_pt_pt();
 		}
 		// Row:interface/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.planar[k]);
-			interpolation_matrix(j, 3 * k + n_i) = kernel->basis_pt_planar_x();
-			interpolation_matrix(j, 3 * k + n_i + 1) = kernel->basis_pt_planar_y();
-			interpolation_matrix(j, 3 * k + n_i + 2) = kernel->basis_pt_planar_z();
+			lane_kernel->set_points(constraints.itrface[j], constraints.planar[k]);
+			interpolation_matrix(j, 3 * k + n_i) = lane_kernel->basis_pt_planar_x();
+			interpolation_matrix(j, 3 * k + n_i + 1) = lane_kernel->basis_pt_planar_y();
+			interpolation_matrix(j, 3 * k + n_i + 2) = lane_kernel->basis_pt_planar_z();
 		}
 		// Row:interface/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.tangent[k]);
-			interpolation_matrix(j, n_i + 3 * n_p + k) = kernel->basis_pt_tangent();
+			lane_kernel->set_points(constraints.itrface[j], constraints.tangent[k]);
+			interpolation_matrix(j, n_i + 3 * n_p + k) = lane_kernel->basis_pt_tangent();
 		}
-	}
+	});
 	// Planar Constraints
-	for (int j = 0; j < n_p; j++) {
+	_assemble_rows(n_p, [&](const int &j, Kernel *lane_kernel) {
 		// Row:planar/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.planar[j], constraints.itrface[k]);
-			interpolation_matrix(3 * j + n_i, k) = kernel->basis_planar_x_pt();
-			interpolation_matrix(3 * j + n_i + 1, k) = kernel->basis_planar_y_pt();
-			interpolation_matrix(3 * j + n_i + 2, k) = kernel->basis_planar_z_pt();
+			lane_kernel->set_points(constraints.planar[j], constraints.itrface[k]);
+			interpolation_matrix(3 * j + n_i, k) = lane_kernel->basis_planar_x_pt();
+			interpolation_matrix(3 * j + n_i + 1, k) = lane_kernel->basis_planar_y_pt();
+			interpolation_matrix(3 * j + n_i + 2, k) = lane_kernel->basis_planar_z_pt();
 		}
 		// Row:planar/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.planar[j], constraints.planar[k]);
-			interpolation_matrix(3 * j + n_i, 3 * k + n_i) = kernel->basis_planar_planar(Parameter_Types::DXDX);
-			interpolation_matrix(3 * j + n_i, 3 * k + n_i + 1) = kernel->basis_planar_planar(Parameter_Types::DXDY);
-			interpolation_matrix(3 * j + n_i, 3 * k + n_i + 2) = kernel->basis_planar_planar(Parameter_Types::DXDZ);
-			interpolation_matrix(3 * j + n_i + 1, 3 * k + n_i) = kernel->basis_planar_planar(Parameter_Types::DYDX);
-			interpolation_matrix(3 * j + n_i + 1, 3 * k + n_i + 1) = kernel->basis_planar_planar(Parameter_Types::DYDY);
-			interpolation_matrix(3 * j + n_i + 1, 3 * k + n_i + 2) = kernel->basis_planar_planar(Parameter_Types::DYDZ);
-			interpolation_matrix(3 * j + n_i + 2, 3 * k + n_i) = kernel->basis_planar_planar(Parameter_Types::DZDX);
-			interpolation_matrix(3 * j + n_i + 2, 3 * k + n_i + 1) = kernel->basis_planar_planar(Parameter_Types::DZDY);
-			interpolation_matrix(3 * j + n_i + 2, 3 * k + n_i + 2) = kernel->basis_planar_planar(Parameter_Types::DZDZ);
+			lane_kernel->set_points(constraints.planar[j], constraints.planar[k]);
+			interpolation_matrix(3 * j + n_i, 3 * k + n_i) = lane_kernel->basis_planar_planar(Parameter_Types::DXDX);
+			interpolation_matrix(3 * j + n_i, 3 * k + n_i + 1) = lane_kernel->basis_planar_planar(Parameter_Types::DXDY);
+			interpolation_matrix(3 * j + n_i, 3 * k + n_i + 2) = lane_kernel->basis_planar_planar(Parameter_Types::DXDZ);
+			interpolation_matrix(3 * j + n_i + 1, 3 * k + n_i) = lane_kernel->basis_planar_planar(Parameter_Types::DYDX);
+			interpolation_matrix(3 * j + n_i + 1, 3 * k + n_i + 1) = lane_kernel->basis_planar_planar(Parameter_Types::DYDY);
+			interpolation_matrix(3 * j + n_i + 1, 3 * k + n_i + 2) = lane_kernel->basis_planar_planar(Parameter_Types::DYDZ);
+			interpolation_matrix(3 * j + n_i + 2, 3 * k + n_i) = lane_kernel->basis_planar_planar(Parameter_Types::DZDX);
+			interpolation_matrix(3 * j + n_i + 2, 3 * k + n_i + 1) = lane_kernel->basis_planar_planar(Parameter_Types::DZDY);
+			interpolation_matrix(3 * j + n_i + 2, 3 * k + n_i + 2) = lane_kernel->basis_planar_planar(Parameter_Types::DZDZ);
 		}
 		// Row:planar/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.planar[j], constraints.tangent[k]);
-			interpolation_matrix(3 * j + n_i, n_i + 3 * n_p + k) = kernel->basis_planar_tangent(Parameter_Types::DX);
-			interpolation_matrix(3 * j + n_i + 1, n_i + 3 * n_p + k) = kernel->basis_planar_tangent(Parameter_Types::DY);
-			interpolation_matrix(3 * j + n_i + 2, n_i + 3 * n_p + k) = kernel->basis_planar_tangent(Parameter_Types::DZ);
+			lane_kernel->set_points(constraints.planar[j], constraints.tangent[k]);
+			interpolation_matrix(3 * j + n_i, n_i + 3 * n_p + k) = lane_kernel->basis_planar_tangent(Parameter_Types::DX);
+			interpolation_matrix(3 * j + n_i + 1, n_i + 3 * n_p + k) = lane_kernel->basis_planar_tangent(Parameter_Types::DY);
+			interpolation_matrix(3 * j + n_i + 2, n_i + 3 * n_p + k) = lane_kernel->basis_planar_tangent(Parameter_Types::DZ);
 		}
-	}
+	});
 	// Tangent Constraints
-	for (int j = 0; j < n_t; j++) {
+	_assemble_rows(n_t, [&](const int &j, Kernel *lane_kernel) {
 		// Row:tangent/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.itrface[k]);
-			interpolation_matrix(j + n_i + 3 * n_p, k) = kernel->basis_tangent_pt();
+			lane_kernel->set_points(constraints.tangent[j], constraints.itrface[k]);
+			interpolation_matrix(j + n_i + 3 * n_p, k) = lane_kernel->basis_tangent_pt();
 		}
 		// Row:tangent/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.planar[k]);
-			interpolation_matrix(j + n_i + 3 * n_p, 3 * k + n_i) = kernel->basis_tangent_planar(Parameter_Types::DX);
-			interpolation_matrix(j + n_i + 3 * n_p, 3 * k + n_i + 1) = kernel->basis_tangent_planar(Parameter_Types::DY);
-			interpolation_matrix(j + n_i + 3 * n_p, 3 * k + n_i + 2) = kernel->basis_tangent_planar(Parameter_Types::DZ);
+			lane_kernel->set_points(constraints.tangent[j], constraints.planar[k]);
+			interpolation_matrix(j + n_i + 3 * n_p, 3 * k + n_i) = lane_kernel->basis_tangent_planar(Parameter_Types::DX);
+			interpolation_matrix(j + n_i + 3 * n_p, 3 * k + n_i + 1) = lane_kernel->basis_tangent_planar(Parameter_Types::DY);
+			interpolation_matrix(j + n_i + 3 * n_p, 3 * k + n_i + 2) = lane_kernel->basis_tangent_planar(Parameter_Types::DZ);
 		}
 		// Row:tangent/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.tangent[k]);
-			interpolation_matrix(j + n_i + 3 * n_p, n_i + 3 * n_p + k) = kernel->basis_tangent_tangent();
+			lane_kernel->set_points(constraints.tangent[j], constraints.tangent[k]);
+			interpolation_matrix(j + n_i + 3 * n_p, n_i + 3 * n_p + k) = lane_kernel->basis_tangent_tangent();
 		}
-	}
+	});
 
 	// build polynomial blocks if required
 	// | A PT |
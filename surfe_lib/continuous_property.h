@@ -58,14 +58,17 @@ public:
 	bool get_equality_values(VectorXd &equality_values) override;
 	void eval_scalar_interpolant_at_point(Point &p) override;
 	void eval_vector_interpolant_at_point(Point &p) override;
+	void get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) override;
 	void get_method_parameters() override;
 	void process_input_data() override;
 	void setup_system_solver() override;
 	bool get_minimial_and_excluded_input(Constraints &greedy_input, Constraints &excluded_input) override { return true; }
-	bool measure_residuals(Constraints &input) override;
 	bool append_greedy_input(Constraints &input) override;
 	bool convert_modified_kernel_to_rbf_kernel() override { return true; }  // To IMPLEMENT
 	GRBF_Modelling_Methods *clone() override { return new Continuous_Property(*this); }
+	void prepare_polynomial_basis() override {
+		if (intern_params.poly_term && !p_basis) p_basis = create_polynomial_basis(parameters.polynomial_order);
+	}
 	// Attributes
 	Polynomial_Basis *p_basis;
 };
@@ -0,0 +1,289 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <csv_reader.h>
+#include <mapped_file.h>
+#include <grbf_exceptions.h>
+#include <task_scheduler.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// text parsed by one task, cut at the first line break after it
+const size_t chunk_bytes = 1 << 22;
+
+// powers of ten exactly representable by a double
+const double exact_powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+struct Csv_Text {
+	std::vector<std::string> names;
+	const char *begin;  // first line after the header
+	const char *end;
+};
+
+bool is_blank(const char &c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool is_digit(const char &c)
+{
+	return (unsigned)(c - '0') < 10;
+}
+
+const char *find_line_end(const char *line, const char *end)
+{
+	const void *newline = std::memchr(line, '\n', end - line);
+	return newline ? static_cast<const char *>(newline) : end;
+}
+
+bool is_blank_line(const char *line, const char *end)
+{
+	for (; line < end; line++)
+		if (!is_blank(*line))
+			return false;
+	return true;
+}
+
+Csv_Text parse_header(const Mapped_File &file)
+{
+	const char *begin = reinterpret_cast<const char *>(file.data());
+	const char *end = begin + file.size();
+	if (end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0)
+		begin += 3;
+	const char *header_end = find_line_end(begin, end);
+
+	Csv_Text text;
+	for (const char *field = begin;;) {
+		const char *comma = static_cast<const char *>(std::memchr(field, ',', header_end - field));
+		const char *first = field;
+		const char *last = comma ? comma : header_end;
+		while (first < last && (is_blank(*first) || *first == '"'))
+			first++;
+		while (last > first && (is_blank(last[-1]) || last[-1] == '"'))
+			last--;
+		text.names.emplace_back(first, last);
+		if (!comma)
+			break;
+		field = comma + 1;
+	}
+	text.begin = header_end < end ? header_end + 1 : end;
+	text.end = end;
+	return text;
+}
+
+// Parses the field starting at field, which ends at the next comma or at
+// line_end, and returns where it ends. Decimal values of up to 19 digits and a
+// small exponent are read in one pass, exact as one product or quotient of
+// exact doubles. Anything else (long mantissas, nan, inf, ...)
+// goes through strtod. nullptr if the field is not a number
+const char *parse_field(const char *field, const char *line_end, double &value)
+{
+	const char *p = field;
+	while (p < line_end && is_blank(*p))
+		p++;
+	bool negative = false;
+	if (p < line_end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+	// at most 19 digits, leading zeros included, fit the mantissa
+	std::uint64_t mantissa = 0;
+	const char *digits = p;
+	for (; p < line_end && is_digit(*p); p++)
+		mantissa = mantissa * 10 + (*p - '0');
+	int n_digits = (int)(p - digits);
+	int exponent = 0;
+	if (p < line_end && *p == '.') {
+		const char *decimals = ++p;
+		for (; p < line_end && is_digit(*p); p++)
+			mantissa = mantissa * 10 + (*p - '0');
+		exponent = -(int)(p - decimals);
+		n_digits -= exponent;
+	}
+	const bool have_digits = n_digits != 0;
+	bool valid_exponent = true;
+	if (have_digits && p < line_end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool negative_exponent = false;
+		if (p < line_end && (*p == '-' || *p == '+')) {
+			negative_exponent = *p == '-';
+			p++;
+		}
+		valid_exponent = p < line_end && is_digit(*p);
+		int e = 0;
+		for (; p < line_end && is_digit(*p); p++)
+			if (e < 100000)
+				e = e * 10 + (*p - '0');
+		exponent += negative_exponent ? -e : e;
+	}
+	while (p < line_end && is_blank(*p))
+		p++;
+
+	if (have_digits && valid_exponent && (p == line_end || *p == ',') &&
+		n_digits <= 19 && mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+		double v = (double)mantissa;
+		v = exponent < 0 ? v / exact_powers_of_ten[-exponent] : v * exact_powers_of_ten[exponent];
+		value = negative ? -v : v;
+		return p;
+	}
+
+	const char *comma = static_cast<const char *>(std::memchr(field, ',', line_end - field));
+	const char *field_end = comma ? comma : line_end;
+	const char *first = field;
+	const char *last = field_end;
+	while (first < last && is_blank(*first))
+		first++;
+	while (last > first && is_blank(last[-1]))
+		last--;
+	if (first == last)
+		return nullptr;
+	std::string number(first, last);
+	char *parsed_end;
+	value = std::strtod(number.c_str(), &parsed_end);
+	return parsed_end == number.c_str() + number.size() ? field_end : nullptr;
+}
+
+}
+
+std::vector<std::string> read_csv_header(const char *filename)
+{
+	Mapped_File file;
+	if (!file.open(filename))
+		throw GRBF_Exceptions::error_reading_csv;
+	return parse_header(file).names;
+}
+
+MatrixXd read_csv_columns(const char *filename, const std::vector<std::string> &columns)
+{
+	Mapped_File file;
+	if (!file.open(filename))
+		throw GRBF_Exceptions::error_reading_csv;
+	const Csv_Text text = parse_header(file);
+
+	// matrix column of each field, -1 if it is not read
+	std::vector<int> field_column(text.names.size(), -1);
+	// columns asked for twice, copied from the first once parsed
+	std::vector<std::pair<int, int> > repeated_columns;
+	int last_field = -1;
+	for (int c = 0; c < (int)columns.size(); c++) {
+		std::vector<std::string>::const_iterator name = std::find(text.names.begin(), text.names.end(), columns[c]);
+		if (name == text.names.end())
+			throw GRBF_Exceptions::missing_csv_column;
+		int field = (int)(name - text.names.begin());
+		if (field_column[field] >= 0)
+			repeated_columns.emplace_back(c, field_column[field]);
+		else
+			field_column[field] = c;
+		last_field = std::max(last_field, field);
+	}
+
+	// chunk c is [chunk_starts[c], chunk_starts[c + 1]), whole lines
+	std::vector<const char *> chunk_starts(1, text.begin);
+	while ((size_t)(text.end - chunk_starts.back()) > chunk_bytes) {
+		const char *line_end = find_line_end(chunk_starts.back() + chunk_bytes, text.end);
+		if (line_end == text.end)
+			break;
+		chunk_starts.push_back(line_end + 1);
+	}
+	chunk_starts.push_back(text.end);
+	const int n_chunks = (int)chunk_starts.size() - 1;
+
+	// rows are counted first so every chunk knows where its rows go
+	std::vector<Index> chunk_first_row(n_chunks + 1, 0);
+	parallel_for(n_chunks, 1, [&](const int &first, const int &last) {
+		for (int c = first; c < last; c++) {
+			Index n_rows = 0;
+			for (const char *line = chunk_starts[c]; line < chunk_starts[c + 1];) {
+				const char *line_end = find_line_end(line, chunk_starts[c + 1]);
+				if (!is_blank_line(line, line_end))
+					n_rows++;
+				line = line_end + 1;
+			}
+			chunk_first_row[c + 1] = n_rows;
+		}
+	});
+	for (int c = 0; c < n_chunks; c++)
+		chunk_first_row[c + 1] += chunk_first_row[c];
+
+	MatrixXd values(chunk_first_row[n_chunks], columns.size());
+	parallel_for(n_chunks, 1, [&](const int &first, const int &last) {
+		for (int c = first; c < last; c++) {
+			Index row = chunk_first_row[c];
+			for (const char *line = chunk_starts[c]; line < chunk_starts[c + 1];) {
+				const char *line_end = find_line_end(line, chunk_starts[c + 1]);
+				if (!is_blank_line(line, line_end)) {
+					const char *field_begin = line;
+					int field = 0;
+					for (; field <= last_field; field++) {
+						const char *field_end;
+						if (field_column[field] >= 0) {
+							field_end = parse_field(field_begin, line_end, values(row, field_column[field]));
+							if (!field_end)
+								throw GRBF_Exceptions::error_reading_csv;
+						}
+						else {
+							// fields are short, a call to memchr costs more
+							field_end = field_begin;
+							while (field_end < line_end && *field_end != ',')
+								field_end++;
+						}
+						if (field_end == line_end)
+							break;
+						field_begin = field_end + 1;
+					}
+					// line too short for the last column read
+					if (field < last_field)
+						throw GRBF_Exceptions::error_reading_csv;
+					row++;
+				}
+				line = line_end + 1;
+			}
+		}
+	});
+	for (const auto &repeated : repeated_columns)
+		values.col(repeated.first) = values.col(repeated.second);
+
+	return values;
+}
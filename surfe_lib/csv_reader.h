@@ -0,0 +1,61 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef csv_reader_h
+#define csv_reader_h
+
+#include <surfe_lib_module.h>
+
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+using namespace Eigen;
+
+// Comma separated files with a header line, e.g. constraint exports. The file
+// is memory mapped (see Mapped_File) and cut in chunks at line boundaries that
+// are parsed in parallel on the task scheduler. Fields are not quoted, blank
+// lines are skipped and numbers are parsed exactly, without strtod for
+// ordinary decimal values.
+
+// names of the header fields
+SURFE_LIB_EXPORT std::vector<std::string> read_csv_header(const char *filename);
+// n x columns.size() matrix of the named columns, n = # of rows. Throws
+// missing_csv_column or error_reading_csv
+SURFE_LIB_EXPORT MatrixXd read_csv_columns(const char *filename, const std::vector<std::string> &columns);
+
+#endif
@@ -0,0 +1,535 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <fused_evaluator.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+
+namespace {
+
+// points per block: the block's results of all models stay in cache while
+// the centers are swept
+const int block_size = 256;
+const int n_entry_cols = 7;
+// hessian components xx, yy, zz, xy, xz, yz
+const int hessian_rows[6] = { 0, 1, 2, 0, 0, 1 };
+const int hessian_cols[6] = { 0, 1, 2, 1, 2, 2 };
+
+struct Model_Entry {
+	int model;
+	double value_weight;
+	double direction[3];
+};
+
+// centers of one kernel while the models are added
+struct Group_Builder {
+	double kernel_values[12];
+	std::map<std::array<double, 4>, int> center_index;
+	std::vector<std::array<double, 4> > centers;
+	std::vector<std::vector<Model_Entry> > entries;
+
+	Model_Entry &entry(const Point &p, const int &model) {
+		std::array<double, 4> key = { { p.x(), p.y(), p.z(), p.c() } };
+		auto found = center_index.find(key);
+		int index;
+		if (found == center_index.end()) {
+			index = (int)centers.size();
+			center_index[key] = index;
+			centers.push_back(key);
+			entries.push_back(std::vector<Model_Entry>());
+		}
+		else
+			index = found->second;
+		std::vector<Model_Entry> &center_entries = entries[index];
+		for (auto &existing : center_entries)
+			if (existing.model == model)
+				return existing;
+		Model_Entry added = { model, 0.0, { 0.0, 0.0, 0.0 } };
+		center_entries.push_back(added);
+		return center_entries.back();
+	}
+};
+
+struct Group_View {
+	const Radial_Geometry *geometry;
+	const double *centers;
+	int n_centers;
+	const int *entry_offsets;
+	const int *entry_models;
+	const double *entry_weights;
+	int n_models;
+};
+
+// adds the rbf part of every model at points (n_points x 3 row major) to
+// values (n_points x n_models), gradients (n_points x n_models x 3) and
+// hessians (n_points x n_models x 6), nullptr skips
+template <class Profile>
+void accumulate_block(const Profile &k, const Group_View &group, const double *points, const int &n_points,
+	double *values, double *gradients, double *hessians)
+{
+	const Radial_Geometry &geometry = *group.geometry;
+	const double *metric = geometry.metric;
+	double a[3];
+	// f3 is only set with hessians, f2 with gradients or hessians
+	double phi = 0.0, f1 = 0.0, f2 = 0.0, f3 = 0.0;
+	for (int c = 0; c < group.n_centers; c++) {
+		const double *p = group.centers + 4 * c;
+		const int first = group.entry_offsets[c];
+		const int last = group.entry_offsets[c + 1];
+		for (int j = 0; j < n_points; j++) {
+			const double r = geometry.delta(points + 3 * j, p, a);
+			if (values) {
+				k.value(r, phi, f1);
+				double *v = values + (long long)j * group.n_models;
+				for (int e = first; e < last; e++) {
+					const double *w = group.entry_weights + n_entry_cols * e;
+					v[group.entry_models[e]] += w[0] * phi - f1 * (a[0] * w[1] + a[1] * w[2] + a[2] * w[3]);
+				}
+			}
+			if (!gradients && !hessians)
+				continue;
+			if (hessians)
+				k.derivatives(r, f1, f2, f3);
+			else
+				k.derivatives(r, f1, f2);
+			for (int e = first; e < last; e++) {
+				const double *w = group.entry_weights + n_entry_cols * e;
+				const double a_d = a[0] * w[1] + a[1] * w[2] + a[2] * w[3];
+				const long long index = (long long)j * group.n_models + group.entry_models[e];
+				if (gradients) {
+					double *g = gradients + 3 * index;
+					for (int i = 0; i < 3; i++)
+						g[i] += w[0] * f1 * a[i] - f2 * a[i] * a_d - f1 * w[4 + i];
+				}
+				if (hessians) {
+					// W (f2 a a^t + f1 M) - (f3 a_d a a^t + f2 a_d M + f2 (a (M D)^t + (M D) a^t))
+					const double c_aa = w[0] * f2 - f3 * a_d;
+					const double c_m = w[0] * f1 - f2 * a_d;
+					double *h = hessians + 6 * index;
+					for (int i = 0; i < 6; i++) {
+						const int u = hessian_rows[i];
+						const int v = hessian_cols[i];
+						h[i] += c_aa * a[u] * a[v] + c_m * metric[3 * u + v] - f2 * (a[u] * w[4 + v] + a[v] * w[4 + u]);
+					}
+				}
+			}
+		}
+	}
+}
+
+struct Block_Accumulation {
+	const Group_View &group;
+	const double *points;
+	int n_points;
+	double *values;
+	double *gradients;
+	double *hessians;
+	template <class Profile>
+	void operator()(const Profile &k) const {
+		accumulate_block(k, group, points, n_points, values, gradients, hessians);
+	}
+};
+
+// adds the rbf part of every model along a grid row at x[i], y, z to values
+// (nx x n_models). The y and z parts of the distances are formed once per
+// center and row, the sweep along x only adds the x part
+template <class Profile>
+void accumulate_row(const Profile &k, const Group_View &group, const double *x, const int &nx, const double &y, const double &z, double *values, std::vector<double> &yz_d)
+{
+	const Radial_Geometry &geometry = *group.geometry;
+	const double *t = geometry.transform;
+	// yz_d per entry: a(x = p) . D, or T D when anisotropic
+	double phi, f1;
+	for (int c = 0; c < group.n_centers; c++) {
+		const double *p = group.centers + 4 * c;
+		const int first = group.entry_offsets[c];
+		const int n_entries = group.entry_offsets[c + 1] - first;
+		const int *models = group.entry_models + first;
+		const double *weights = group.entry_weights + n_entry_cols * first;
+		const double dy = y - p[1];
+		const double dz = z - p[2];
+		if (!geometry.anisotropic) {
+			const double s = dy * dy + dz * dz + p[3] * p[3];
+			yz_d.resize(n_entries);
+			for (int e = 0; e < n_entries; e++)
+				yz_d[e] = dy * weights[n_entry_cols * e + 2] + dz * weights[n_entry_cols * e + 3];
+			for (int i = 0; i < nx; i++) {
+				const double dx = x[i] - p[0];
+				k.value(std::sqrt(dx * dx + s), phi, f1);
+				double *v = values + (long long)i * group.n_models;
+				for (int e = 0; e < n_entries; e++) {
+					const double *w = weights + n_entry_cols * e;
+					v[models[e]] += w[0] * phi - f1 * (dx * w[1] + yz_d[e]);
+				}
+			}
+		}
+		else {
+			// u = T (x - p) = T_0 dx + u_yz, a . D = u . (T D)
+			const double c2 = p[3] * p[3];
+			double u_yz[3];
+			for (int j = 0; j < 3; j++)
+				u_yz[j] = t[3 * j + 1] * dy + t[3 * j + 2] * dz;
+			yz_d.resize(3 * n_entries);
+			for (int e = 0; e < n_entries; e++)
+				for (int j = 0; j < 3; j++) {
+					const double *d = weights + n_entry_cols * e + 1;
+					yz_d[3 * e + j] = t[3 * j] * d[0] + t[3 * j + 1] * d[1] + t[3 * j + 2] * d[2];
+				}
+			for (int i = 0; i < nx; i++) {
+				const double dx = x[i] - p[0];
+				const double u[3] = { t[0] * dx + u_yz[0], t[3] * dx + u_yz[1], t[6] * dx + u_yz[2] };
+				k.value(std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2] + c2), phi, f1);
+				double *v = values + (long long)i * group.n_models;
+				for (int e = 0; e < n_entries; e++) {
+					const double *t_d = &yz_d[3 * e];
+					v[models[e]] += weights[n_entry_cols * e] * phi - f1 * (u[0] * t_d[0] + u[1] * t_d[1] + u[2] * t_d[2]);
+				}
+			}
+		}
+	}
+}
+
+struct Row_Accumulation {
+	const Group_View &group;
+	const double *x;
+	int nx;
+	double y;
+	double z;
+	double *values;
+	std::vector<double> &yz_d;
+	template <class Profile>
+	void operator()(const Profile &k) const {
+		accumulate_row(k, group, x, nx, y, z, values, yz_d);
+	}
+};
+
+}
+
+Fused_Evaluator::Fused_Evaluator(const std::vector<Surfe_API *> &models)
+	: n_models_((int)models.size()), n_centers_(0), task_scheduler_(nullptr), max_concurrency_(0)
+{
+	std::vector<GRBF_Modelling_Methods *> methods;
+	for (const auto &model : models) {
+		if (!model)
+			throw GRBF_Exceptions::missing_interpolant;
+		model->check_interpolant_current();
+		methods.push_back(model->method_);
+	}
+	build(methods);
+}
+
+Fused_Evaluator::Fused_Evaluator(GRBF_Modelling_Methods *method)
+	: n_models_(1), n_centers_(0), task_scheduler_(nullptr), max_concurrency_(0)
+{
+	build(std::vector<GRBF_Modelling_Methods *>(1, method));
+}
+
+void Fused_Evaluator::build(const std::vector<GRBF_Modelling_Methods *> &methods)
+{
+	std::vector<Group_Builder> builders;
+	monomial_coefficients_.assign(10 * (size_t)n_models_, 0.0);
+	for (int m = 0; m < n_models_; m++) {
+		GRBF_Modelling_Methods *method = methods[m];
+		std::vector<Evaluation_Term> terms;
+		VectorXd coefficients;
+		method->get_rbf_evaluation_terms(terms, coefficients);
+		for (int j = 0; j < coefficients.size() && j < 10; j++)
+			monomial_coefficients_[10 * m + j] = coefficients(j);
+
+		double kernel_values[12];
+		method->get_rbf_evaluation_kernel(kernel_values);
+		Group_Builder *builder = nullptr;
+		for (auto &existing : builders)
+			if (std::equal(kernel_values, kernel_values + 12, existing.kernel_values))
+				builder = &existing;
+		if (!builder) {
+			builders.push_back(Group_Builder());
+			builder = &builders.back();
+			std::copy(kernel_values, kernel_values + 12, builder->kernel_values);
+		}
+
+		for (const auto &term : terms) {
+			switch (term.type) {
+			case Evaluation_Term::Value:
+				builder->entry(term.p, m).value_weight += term.weight;
+				break;
+			case Evaluation_Term::Derivative: {
+				Model_Entry &entry = builder->entry(term.p, m);
+				entry.direction[0] += term.weight * term.q.x();
+				entry.direction[1] += term.weight * term.q.y();
+				entry.direction[2] += term.weight * term.q.z();
+				break;
+			}
+			case Evaluation_Term::Increment:
+				builder->entry(term.p, m).value_weight += term.weight;
+				builder->entry(term.q, m).value_weight -= term.weight;
+				break;
+			}
+		}
+	}
+
+	groups_.resize(builders.size());
+	for (size_t g = 0; g < builders.size(); g++) {
+		const Group_Builder &builder = builders[g];
+		Kernel_Group &group = groups_[g];
+		group.rbf_type = (int)builder.kernel_values[0];
+		group.shape_parameter = builder.kernel_values[1];
+		group.geometry.set(builder.kernel_values[2] != 0, builder.kernel_values + 3);
+		group.entry_offsets.push_back(0);
+		for (size_t c = 0; c < builder.centers.size(); c++) {
+			group.centers.insert(group.centers.end(), builder.centers[c].begin(), builder.centers[c].end());
+			for (const auto &entry : builder.entries[c]) {
+				group.entry_models.push_back(entry.model);
+				group.entry_weights.push_back(entry.value_weight);
+				group.entry_weights.insert(group.entry_weights.end(), entry.direction, entry.direction + 3);
+				double m_d[3];
+				group.geometry.apply_metric(entry.direction, m_d);
+				group.entry_weights.insert(group.entry_weights.end(), m_d, m_d + 3);
+			}
+			group.entry_offsets.push_back((int)group.entry_models.size());
+		}
+		n_centers_ += (int)builder.centers.size();
+	}
+}
+
+void Fused_Evaluator::evaluate_block(const double *points, const int &n_points, double *values, double *gradients, double *hessians) const
+{
+	for (const auto &group : groups_) {
+		const Group_View view = { &group.geometry, group.centers.data(), (int)group.entry_offsets.size() - 1,
+			group.entry_offsets.data(), group.entry_models.data(), group.entry_weights.data(), n_models_ };
+		const Block_Accumulation accumulation = { view, points, n_points, values, gradients, hessians };
+		if (!visit_radial_profile(group.rbf_type, group.shape_parameter, accumulation))
+			throw GRBF_Exceptions::unknown_rbf;
+	}
+
+	// polynomial part, monomials xx, yy, zz, xy, xz, yz, x, y, z, 1 once per point
+	for (int j = 0; j < n_points; j++) {
+		const double *x = points + 3 * j;
+		const double monomials[10] = { x[0] * x[0], x[1] * x[1], x[2] * x[2],
+			x[0] * x[1], x[0] * x[2], x[1] * x[2], x[0], x[1], x[2], 1.0 };
+		for (int m = 0; m < n_models_; m++) {
+			const double *c = &monomial_coefficients_[10 * m];
+			if (values) {
+				double sum = 0;
+				for (int i = 0; i < 10; i++)
+					sum += c[i] * monomials[i];
+				values[(long long)j * n_models_ + m] += sum;
+			}
+			if (gradients) {
+				double *g = gradients + 3 * ((long long)j * n_models_ + m);
+				g[0] += 2.0 * c[0] * x[0] + c[3] * x[1] + c[4] * x[2] + c[6];
+				g[1] += 2.0 * c[1] * x[1] + c[3] * x[0] + c[5] * x[2] + c[7];
+				g[2] += 2.0 * c[2] * x[2] + c[4] * x[0] + c[5] * x[1] + c[8];
+			}
+			if (hessians) {
+				double *h = hessians + 6 * ((long long)j * n_models_ + m);
+				h[0] += 2.0 * c[0];
+				h[1] += 2.0 * c[1];
+				h[2] += 2.0 * c[2];
+				h[3] += c[3];
+				h[4] += c[4];
+				h[5] += c[5];
+			}
+		}
+	}
+}
+
+void Fused_Evaluator::evaluate(const ConstMatrixView &locations, MatrixXd *values, MatrixXd *gradients, MatrixXd *hessians) const
+{
+	if (locations.cols() != 3)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	const int n = (int)locations.rows();
+	if (values)
+		values->resize(n, n_models_);
+	if (gradients)
+		gradients->resize(n, 3 * n_models_);
+	if (hessians)
+		hessians->resize(n, 6 * n_models_);
+	const int n_blocks = (n + block_size - 1) / block_size;
+
+	// without a scheduler or a limit of its own the loops follow the scope of
+	// the caller
+	std::unique_ptr<Scheduler_Scope> scope;
+	if (task_scheduler_ || max_concurrency_ > 0)
+		scope.reset(new Scheduler_Scope(task_scheduler_, max_concurrency_));
+	parallel_for(n_blocks, 1, [&](const int &first, const int &last) {
+		std::vector<double> points(3 * block_size);
+		std::vector<double> block_values(values ? (size_t)block_size * n_models_ : 0);
+		std::vector<double> block_gradients(gradients ? (size_t)block_size * 3 * n_models_ : 0);
+		std::vector<double> block_hessians(hessians ? (size_t)block_size * 6 * n_models_ : 0);
+		for (int b = first; b < last; b++) {
+			const int begin = b * block_size;
+			const int count = std::min(block_size, n - begin);
+			for (int j = 0; j < count; j++)
+				for (int i = 0; i < 3; i++)
+					points[3 * j + i] = locations(begin + j, i);
+			std::fill(block_values.begin(), block_values.end(), 0.0);
+			std::fill(block_gradients.begin(), block_gradients.end(), 0.0);
+			std::fill(block_hessians.begin(), block_hessians.end(), 0.0);
+			evaluate_block(points.data(), count, values ? block_values.data() : nullptr,
+				gradients ? block_gradients.data() : nullptr, hessians ? block_hessians.data() : nullptr);
+			for (int j = 0; j < count; j++)
+				for (int m = 0; m < n_models_; m++) {
+					if (values)
+						(*values)(begin + j, m) = block_values[(size_t)j * n_models_ + m];
+					if (gradients)
+						for (int i = 0; i < 3; i++)
+							(*gradients)(begin + j, 3 * m + i) = block_gradients[3 * ((size_t)j * n_models_ + m) + i];
+					if (hessians)
+						for (int i = 0; i < 6; i++)
+							(*hessians)(begin + j, 6 * m + i) = block_hessians[6 * ((size_t)j * n_models_ + m) + i];
+				}
+		}
+	});
+}
+
+void Fused_Evaluator::evaluate_grid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const int &first_slice, const int &last_slice, MatrixXd &values, const bool &skip_coarse_points /*= false*/) const
+{
+	const int nx = dims(0);
+	const int ny = dims(1);
+	// x of every point of a row, then of the odd points only
+	const int n_odd = nx / 2;
+	std::vector<double> x(nx + n_odd);
+	for (int i = 0; i < nx; i++)
+		x[i] = origin(0) + i * spacing(0);
+	for (int i = 0; i < n_odd; i++)
+		x[nx + i] = x[2 * i + 1];
+	const int first_row = first_slice * ny;
+	const int n_rows = (last_slice - first_slice) * ny;
+	// rows are tiled over the threads, a tile holds about a block of points
+	const int grain = std::max(1, block_size / std::max(nx, 1));
+
+	// without a scheduler or a limit of its own the loops follow the scope of
+	// the caller
+	std::unique_ptr<Scheduler_Scope> scope;
+	if (task_scheduler_ || max_concurrency_ > 0)
+		scope.reset(new Scheduler_Scope(task_scheduler_, max_concurrency_));
+	parallel_for(n_rows, grain, [&](const int &first, const int &last) {
+		std::vector<double> row_values((size_t)nx * n_models_);
+		std::vector<double> yz_d;
+		for (int row = first_row + first; row < first_row + last; row++) {
+			const double y = origin(1) + (row % ny) * spacing(1);
+			const double z = origin(2) + (row / ny) * spacing(2);
+			// the even points of rows with even y and z indices are on the
+			// grid of twice the spacing
+			const bool odd_only = skip_coarse_points && (row % ny) % 2 == 0 && (row / ny) % 2 == 0;
+			const double *row_x = odd_only ? &x[nx] : x.data();
+			const int n_points = odd_only ? n_odd : nx;
+			std::fill(row_values.begin(), row_values.end(), 0.0);
+			for (const auto &group : groups_) {
+				const Group_View view = { &group.geometry, group.centers.data(), (int)group.entry_offsets.size() - 1,
+					group.entry_offsets.data(), group.entry_models.data(), group.entry_weights.data(), n_models_ };
+				const Row_Accumulation accumulation = { view, row_x, n_points, y, z, row_values.data(), yz_d };
+				if (!visit_radial_profile(group.rbf_type, group.shape_parameter, accumulation))
+					throw GRBF_Exceptions::unknown_rbf;
+			}
+			const long long offset = (long long)row * nx;
+			for (int m = 0; m < n_models_; m++) {
+				const double *c = &monomial_coefficients_[10 * m];
+				// polynomial in x with the y and z terms of the row folded in
+				const double c_x = c[3] * y + c[4] * z + c[6];
+				const double c_0 = c[1] * y * y + c[2] * z * z + c[5] * y * z + c[7] * y + c[8] * z + c[9];
+				for (int i = 0; i < n_points; i++)
+					values(offset + (odd_only ? 2 * i + 1 : i), m) = row_values[(size_t)i * n_models_ + m] + (c[0] * row_x[i] + c_x) * row_x[i] + c_0;
+			}
+		}
+	});
+}
+
+MatrixXd Fused_Evaluator::EvaluateOnRefinedGrid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const MatrixXd &coarse_values) const
+{
+	if (dims.minCoeff() < 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	const Vector3i coarse_dims = (dims.array() - 1) / 2 + 1;
+	if (coarse_values.rows() != (long long)coarse_dims(0) * coarse_dims(1) * coarse_dims(2) || coarse_values.cols() != n_models_)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	MatrixXd values((long long)dims(0) * dims(1) * dims(2), n_models_);
+	copy_coarse_points(coarse_values, dims, values);
+	evaluate_grid(origin, spacing, dims, 0, dims(2), values, true);
+	return values;
+}
+
+void Fused_Evaluator::copy_coarse_points(const MatrixXd &coarse_values, const Vector3i &dims, MatrixXd &values)
+{
+	const Vector3i coarse_dims = (dims.array() - 1) / 2 + 1;
+	for (int k = 0; k < coarse_dims(2); k++)
+		for (int j = 0; j < coarse_dims(1); j++) {
+			const long long coarse_row = ((long long)k * coarse_dims(1) + j) * coarse_dims(0);
+			const long long row = ((long long)2 * k * dims(1) + 2 * j) * dims(0);
+			for (int i = 0; i < coarse_dims(0); i++)
+				values.row(row + 2 * i) = coarse_values.row(coarse_row + i);
+		}
+}
+
+MatrixXd Fused_Evaluator::EvaluateOnRegularGrid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims) const
+{
+	if (dims.minCoeff() < 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	MatrixXd values((long long)dims(0) * dims(1) * dims(2), n_models_);
+	evaluate_grid(origin, spacing, dims, 0, dims(2), values);
+	return values;
+}
+
+MatrixXd Fused_Evaluator::EvaluateInterpolantsAtPoints(const ConstMatrixView &locations) const
+{
+	MatrixXd values;
+	evaluate(locations, &values, nullptr, nullptr);
+	return values;
+}
+
+MatrixXd Fused_Evaluator::EvaluateVectorInterpolantsAtPoints(const ConstMatrixView &locations) const
+{
+	MatrixXd gradients;
+	evaluate(locations, nullptr, &gradients, nullptr);
+	return gradients;
+}
+
+void Fused_Evaluator::EvaluateInterpolantsAndGradientsAtPoints(const ConstMatrixView &locations, MatrixXd &values, MatrixXd &gradients) const
+{
+	evaluate(locations, &values, &gradients, nullptr);
+}
+
+void Fused_Evaluator::EvaluateInterpolantsAndDerivativesAtPoints(const ConstMatrixView &locations, MatrixXd &values, MatrixXd &gradients, MatrixXd &hessians) const
+{
+	evaluate(locations, &values, &gradients, &hessians);
+}
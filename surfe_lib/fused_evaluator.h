@@ -0,0 +1,124 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef fused_evaluator_h
+#define fused_evaluator_h
+
+#include <surfe_lib_module.h>
+#include <surfe_api.h>
+#include <radial_profiles.h>
+
+#include <vector>
+
+// Evaluates several solved interpolants at the same points, or on the same
+// regular grid, in one pass.
+// The interpolants are flattened into their rbf terms (see Evaluation_Term)
+// at construction; models sharing a kernel are grouped and their centers
+// merged, so a center shared by several models (the same constraints, or
+// a restricted range kernel's unisolvent points) costs one distance and one
+// kernel evaluation per point for all of them. Points are streamed once, in
+// blocks small enough that the per block results stay in cache.
+// Later changes to the models are not seen, construct a new evaluator.
+// Evaluation methods are const and can be called from several threads at once.
+class SURFE_LIB_EXPORT Fused_Evaluator {
+private:
+	// merged terms of the models using one kernel
+	struct Kernel_Group {
+		int rbf_type;  // Parameter_Types::RBF
+		double shape_parameter;
+		Radial_Geometry geometry;
+		std::vector<double> centers;        // n_centers x 4: x, y, z, c
+		std::vector<int> entry_offsets;     // n_centers + 1
+		std::vector<int> entry_models;      // model of each entry
+		// n_entries x 7: value weight W, derivative direction D = sum w v,
+		// and M D with M the anisotropy metric
+		std::vector<double> entry_weights;
+	};
+	std::vector<Kernel_Group> groups_;
+	std::vector<double> monomial_coefficients_;  // n_models x 10
+	int n_models_;
+	int n_centers_;
+	Task_Scheduler *task_scheduler_;  // nullptr: process wide default
+	int max_concurrency_;  // max # of threads, 0 = no limit
+
+	void evaluate_block(const double *points, const int &n_points, double *values, double *gradients, double *hessians) const;
+	void evaluate(const ConstMatrixView &locations, MatrixXd *values, MatrixXd *gradients, MatrixXd *hessians) const;
+	// grid slices [first_slice, last_slice) into their rows of values.
+	// skip_coarse_points leaves the points with even i, j and k untouched
+	void evaluate_grid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+		const int &first_slice, const int &last_slice, MatrixXd &values, const bool &skip_coarse_points = false) const;
+	// values of the grid of twice the spacing to the points with even i, j, k
+	static void copy_coarse_points(const MatrixXd &coarse_values, const Vector3i &dims, MatrixXd &values);
+	void build(const std::vector<GRBF_Modelling_Methods *> &methods);
+	friend class Surfe_API;  // EvaluateOnRegularGrid() and the grid pyramids by slabs
+
+public:
+	// throws missing_interpolant if a model has no interpolant, and
+	// interpolant_needs_update if its constraints or parameters changed after
+	// it was computed
+	Fused_Evaluator(const std::vector<Surfe_API *> &models);
+	// a solved modelling method on its own, e.g. for its constraint residuals
+	explicit Fused_Evaluator(GRBF_Modelling_Methods *method);
+	int GetNumberOfModels() const { return n_models_; }
+	// # of distinct centers over all kernel groups
+	int GetNumberOfCenters() const { return n_centers_; }
+	// thread pool of the evaluations, nullptr selects the process wide
+	// default. Not owned. With neither set the evaluations follow the
+	// Scheduler_Scope of the calling thread
+	void SetTaskScheduler(Task_Scheduler *scheduler) { task_scheduler_ = scheduler; }
+	void SetMaxConcurrency(const int &max_threads) { max_concurrency_ = max_threads; }
+
+	// locations: n x 3, returns n x n_models scalar field values
+	MatrixXd EvaluateInterpolantsAtPoints(const ConstMatrixView &locations) const;
+	// n x 3 * n_models: gx, gy, gz of model 0, then model 1 ...
+	MatrixXd EvaluateVectorInterpolantsAtPoints(const ConstMatrixView &locations) const;
+	void EvaluateInterpolantsAndGradientsAtPoints(const ConstMatrixView &locations, MatrixXd &values, MatrixXd &gradients) const;
+	// same with the hessians, n x 6 * n_models: xx, yy, zz, xy, xz, yz of
+	// model 0, then model 1 ...
+	void EvaluateInterpolantsAndDerivativesAtPoints(const ConstMatrixView &locations, MatrixXd &values, MatrixXd &gradients, MatrixXd &hessians) const;
+	// values on the grid origin + (i, j, k) * spacing, 0 <= i < dims(0) ...
+	// without forming the grid points. nx ny nz x n_models, x varies fastest,
+	// then y, then z (the point order of vtkImageData)
+	MatrixXd EvaluateOnRegularGrid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims) const;
+	// same grid given its values on the grid of twice the spacing (the points
+	// with even i, j and k, (dims - 1) / 2 + 1 along each axis), which are
+	// copied instead of evaluated again: 7/8 of the work
+	MatrixXd EvaluateOnRefinedGrid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+		const MatrixXd &coarse_values) const;
+};
+
+#endif
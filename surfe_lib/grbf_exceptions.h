@@ -143,6 +143,144 @@ class arrayhasincorrectdimensions : public exception {
 	}
 };
 
+class errormeasuringresiduals : public exception {
+	const char* what() const throw() override {
+		return "Error measuring constraint residuals";
+	}
+};
+
+class unknowndeclustermethod : public exception {
+	const char* what() const throw() override {
+		return "Entered declustering method name is unknown";
+	}
+};
+
+class invaliddeclusterspacing : public exception {
+	const char* what() const throw() override {
+		return "Declustering spacing must be greater than zero";
+	}
+};
+
+class unknowncenterselectionmethod : public exception {
+	const char* what() const throw() override {
+		return "Entered center selection method name is unknown";
+	}
+};
+
+class invalidmaxcenters : public exception {
+	const char* what() const throw() override {
+		return "Maximum number of centers must be greater than zero";
+	}
+};
+
+class computationcancelled : public exception {
+	const char* what() const throw() override {
+		return "Computation of the interpolant was cancelled";
+	}
+};
+
+class computationinprogress : public exception {
+	const char* what() const throw() override {
+		return "An interpolant is already being computed for this instance";
+	}
+};
+
+class errorreadingsnapshot : public exception {
+	const char* what() const throw() override {
+		return "Error reading interpolant snapshot file";
+	}
+};
+
+class errorwritingsnapshot : public exception {
+	const char* what() const throw() override {
+		return "Error writing interpolant snapshot file";
+	}
+};
+
+class invalidsnapshot : public exception {
+	const char* what() const throw() override {
+		return "File is not a valid interpolant snapshot";
+	}
+};
+
+class unsupportedsnapshotversion : public exception {
+	const char* what() const throw() override {
+		return "Interpolant snapshot version or byte order is not supported";
+	}
+};
+
+class snapshotwithoutevaluationterms : public exception {
+	const char* what() const throw() override {
+		return "Interpolant snapshot has no evaluation terms. Save it again with this version of surfe";
+	}
+};
+
+class evaluationcancelled : public exception {
+	const char* what() const throw() override {
+		return "Evaluation was cancelled";
+	}
+};
+
+class levelnotevaluated : public exception {
+	const char* what() const throw() override {
+		return "Grid level has not been evaluated";
+	}
+};
+
+class errorwritinggrid : public exception {
+	const char* what() const throw() override {
+		return "Error writing grid file";
+	}
+};
+
+class unsupportedgridfileformat : public exception {
+	const char* what() const throw() override {
+		return "Grid file name must end in .vti or .mhd";
+	}
+};
+
+class errorwritingvtkfile : public exception {
+	const char* what() const throw() override {
+		return "Error writing VTK file";
+	}
+};
+
+class compressionnotavailable : public exception {
+	const char* what() const throw() override {
+		return "Compression needs surfe built with zlib and a .vti or .vtp file";
+	}
+};
+
+class errorreadingcsv : public exception {
+	const char* what() const throw() override {
+		return "Error reading csv file: can not be opened or has a malformed value";
+	}
+};
+
+class missingcsvcolumn : public exception {
+	const char* what() const throw() override {
+		return "Missing column in csv file";
+	}
+};
+
+class errorreadingconstraintfile : public exception {
+	const char* what() const throw() override {
+		return "Error reading constraint file";
+	}
+};
+
+class errorwritingconstraintfile : public exception {
+	const char* what() const throw() override {
+		return "Error writing constraint file";
+	}
+};
+
+class invalidconstraintfile : public exception {
+	const char* what() const throw() override {
+		return "Invalid constraint file: truncated, corrupt or written by a newer version of surfe";
+	}
+};
+
 class SurfeExceptions : public exception {
 private:
 	std::string errors;
@@ -199,6 +337,29 @@ namespace GRBF_Exceptions {
 	const unknownmodellingmode unknown_modelling_mode;
 	const problemcomputingspatialparameters problem_computing_spatial_parameters;
 	const arrayhasincorrectdimensions array_has_incorrect_dimensions;
+	const errormeasuringresiduals error_measuring_residuals;
+	const unknowndeclustermethod unknown_decluster_method;
+	const invaliddeclusterspacing invalid_decluster_spacing;
+	const unknowncenterselectionmethod unknown_center_selection_method;
+	const invalidmaxcenters invalid_max_centers;
+	const computationcancelled computation_cancelled;
+	const computationinprogress computation_in_progress;
+	const errorreadingsnapshot error_reading_snapshot;
+	const errorwritingsnapshot error_writing_snapshot;
+	const invalidsnapshot invalid_snapshot;
+	const unsupportedsnapshotversion unsupported_snapshot_version;
+	const snapshotwithoutevaluationterms snapshot_without_evaluation_terms;
+	const evaluationcancelled evaluation_cancelled;
+	const levelnotevaluated level_not_evaluated;
+	const errorwritinggrid error_writing_grid;
+	const unsupportedgridfileformat unsupported_grid_file_format;
+	const errorwritingvtkfile error_writing_vtk_file;
+	const compressionnotavailable compression_not_available;
+	const errorreadingcsv error_reading_csv;
+	const missingcsvcolumn missing_csv_column;
+	const errorreadingconstraintfile error_reading_constraint_file;
+	const errorwritingconstraintfile error_writing_constraint_file;
+	const invalidconstraintfile invalid_constraint_file;
 }
 
 #endif //
@@ -0,0 +1,129 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <grid_pyramid.h>
+#include <grbf_exceptions.h>
+
+#include <chrono>
+
+int automatic_pyramid_levels(const Vector3i &dims)
+{
+	const int max_points = 32;
+	int n_levels = 1;
+	for (int stride = 1; (dims.maxCoeff() - 1) / stride + 1 > max_points; stride *= 2)
+		n_levels++;
+	return n_levels;
+}
+
+Grid_Pyramid_Handle::~Grid_Pyramid_Handle()
+{
+	if (thread_.joinable()) {
+		// the last reference can be released by the worker thread itself
+		if (thread_.get_id() == std::this_thread::get_id())
+			thread_.detach();
+		else
+			thread_.join();
+	}
+}
+
+void Grid_Pyramid_Handle::publish(const Grid_Level &level)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	levels_.push_back(level);
+	level_condition_.notify_all();
+}
+
+void Grid_Pyramid_Handle::set_fraction(const double &fraction)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	fraction_ = fraction;
+}
+
+void Grid_Pyramid_Handle::finish(const std::string &error_message)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	error_message_ = error_message;
+	done_ = true;
+	level_condition_.notify_all();
+}
+
+int Grid_Pyramid_Handle::GetNumberOfCompletedLevels() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return (int)levels_.size();
+}
+
+double Grid_Pyramid_Handle::GetProgress() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return fraction_;
+}
+
+bool Grid_Pyramid_Handle::WaitForLevel(const int &level, const double &seconds)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	level_condition_.wait_for(lock, std::chrono::duration<double>(seconds), [this, level]() {
+		return done_ || level < (int)levels_.size();
+	});
+	return level < (int)levels_.size();
+}
+
+Grid_Level Grid_Pyramid_Handle::GetLevel(const int &level) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (level < 0 || level >= (int)levels_.size())
+		throw GRBF_Exceptions::level_not_evaluated;
+	return levels_[level];
+}
+
+void Grid_Pyramid_Handle::Wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	level_condition_.wait(lock, [this]() { return done_; });
+}
+
+bool Grid_Pyramid_Handle::IsDone() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return done_;
+}
+
+std::string Grid_Pyramid_Handle::GetErrorMessage() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return error_message_;
+}
@@ -0,0 +1,117 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef grid_pyramid_h
+#define grid_pyramid_h
+
+#include <surfe_lib_module.h>
+
+#include <Eigen/Core>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Eigen;
+
+// One level of a progressively evaluated regular grid. Level n_levels - 1 is
+// the grid itself, every coarser level keeps every other point of the next
+// one along each axis, so level l samples the grid points whose indices are
+// multiples of stride = 2^(n_levels - 1 - l)
+struct Grid_Level {
+	int level;         // 0 is the coarsest
+	int stride;        // in grid points of the finest level
+	Vector3d origin;   // the same for every level
+	Vector3d spacing;  // grid spacing * stride
+	Vector3i dims;     // (grid dims - 1) / stride + 1
+	VectorXd values;   // scalar field, x varies fastest, then y, then z
+};
+
+// called with every level as soon as it is complete, coarsest first
+typedef std::function<void(const Grid_Level &level)> LevelCallback;
+
+// # of levels such that the coarsest one has at most 32 points along every
+// axis
+SURFE_LIB_EXPORT int automatic_pyramid_levels(const Vector3i &dims);
+
+// Handle on a grid pyramid evaluated in the background by
+// Surfe_API::EvaluateGridPyramidAsync(). The levels are published as they are
+// completed and can be polled from any thread. The evaluation works on a copy
+// of the interpolant, the Surfe_API instance can be used meanwhile.
+class SURFE_LIB_EXPORT Grid_Pyramid_Handle {
+private:
+	friend class Surfe_API;
+	std::thread thread_;
+	mutable std::mutex mutex_;
+	std::condition_variable level_condition_;
+	std::vector<Grid_Level> levels_;  // completed levels, coarsest first
+	int n_levels_;
+	double fraction_;  // of all the points evaluated
+	bool done_;
+	std::atomic<bool> cancel_requested_;
+	std::string error_message_;
+
+	void publish(const Grid_Level &level);
+	void set_fraction(const double &fraction);
+	void finish(const std::string &error_message);
+
+public:
+	Grid_Pyramid_Handle(const int &n_levels) : n_levels_(n_levels), fraction_(0), done_(false), cancel_requested_(false) {}
+	~Grid_Pyramid_Handle();
+
+	int GetNumberOfLevels() const { return n_levels_; }
+	int GetNumberOfCompletedLevels() const;
+	// fraction [0,1] of the points of all levels evaluated
+	double GetProgress() const;
+	// false if level is still not complete after seconds (or never will be:
+	// the evaluation failed or was cancelled)
+	bool WaitForLevel(const int &level, const double &seconds);
+	// copy of a completed level, throws level_not_evaluated otherwise
+	Grid_Level GetLevel(const int &level) const;
+	// block until the evaluation ended and the last callback has run
+	void Wait();
+	bool IsDone() const;
+	// request cancellation. Honoured at the next slab of grid slices
+	void Cancel() { cancel_requested_ = true; }
+	// what() of the exception that ended the evaluation early
+	std::string GetErrorMessage() const;
+};
+
+#endif
@@ -0,0 +1,223 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <grid_writer.h>
+#include <grbf_exceptions.h>
+#include <vtk_writer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+static bool has_extension(const std::string &filename, const std::string &extension)
+{
+	if (filename.size() < extension.size())
+		return false;
+	std::string end = filename.substr(filename.size() - extension.size());
+	std::transform(end.begin(), end.end(), end.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return end == extension;
+}
+
+Grid_File_Writer::Grid_File_Writer(const char *filename, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const std::string &array_name /*= "Scalar Field"*/, const bool &single_precision /*= false*/, const bool &compress /*= false*/)
+	: dims_(dims), single_precision_(single_precision), n_slices_written_(0), compress_(compress), block_table_position_(0)
+{
+	if (dims.minCoeff() <= 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	const std::string name(filename);
+	if (has_extension(name, ".vti")) {
+		vti_ = true;
+		if (compress_ && !vtk_compression_available())
+			throw GRBF_Exceptions::compression_not_available;
+		file_.open(filename, std::ios::binary | std::ios::trunc);
+		if (!file_)
+			throw GRBF_Exceptions::error_writing_grid;
+		write_vti_header(origin, spacing, array_name);
+	}
+	else if (has_extension(name, ".mhd")) {
+		vti_ = false;
+		if (compress_)
+			throw GRBF_Exceptions::compression_not_available;
+		const std::string raw_filename = name.substr(0, name.size() - 4) + ".raw";
+		write_mhd_header(filename, raw_filename, origin, spacing);
+		file_.open(raw_filename.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file_)
+			throw GRBF_Exceptions::error_writing_grid;
+	}
+	else
+		throw GRBF_Exceptions::unsupported_grid_file_format;
+}
+
+Grid_File_Writer::~Grid_File_Writer()
+{
+	if (file_.is_open())
+		file_.close();
+}
+
+void Grid_File_Writer::write_vti_header(const Vector3d &origin, const Vector3d &spacing, const std::string &array_name)
+{
+	std::ostringstream header;
+	header << std::setprecision(17);
+	header << "<?xml version=\"1.0\"?>\n"
+		<< "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"" << (little_endian_machine() ? "LittleEndian" : "BigEndian")
+		<< "\" header_type=\"UInt64\"" << (compress_ ? " compressor=\"vtkZLibDataCompressor\"" : "") << ">\n";
+	std::ostringstream extent;
+	extent << "0 " << dims_(0) - 1 << " 0 " << dims_(1) - 1 << " 0 " << dims_(2) - 1;
+	header << "  <ImageData WholeExtent=\"" << extent.str() << "\" Origin=\"" << origin(0) << " " << origin(1) << " " << origin(2)
+		<< "\" Spacing=\"" << spacing(0) << " " << spacing(1) << " " << spacing(2) << "\">\n"
+		<< "    <Piece Extent=\"" << extent.str() << "\">\n"
+		<< "      <PointData Scalars=\"" << array_name << "\">\n"
+		<< "        <DataArray type=\"" << (single_precision_ ? "Float32" : "Float64") << "\" Name=\"" << array_name
+		<< "\" format=\"appended\" offset=\"0\"/>\n"
+		<< "      </PointData>\n"
+		<< "      <CellData>\n"
+		<< "      </CellData>\n"
+		<< "    </Piece>\n"
+		<< "  </ImageData>\n"
+		<< "  <AppendedData encoding=\"raw\">\n"
+		<< "   _";
+	const std::string text = header.str();
+	file_.write(text.data(), text.size());
+	const std::uint64_t n_bytes = (std::uint64_t)dims_(0) * dims_(1) * dims_(2) * (single_precision_ ? sizeof(float) : sizeof(double));
+	if (compress_) {
+		// # of blocks, block size, partial last block size and the compressed
+		// sizes, which are only known at the end: zeros for now
+		const std::uint64_t n_blocks = (n_bytes + vtk_block_bytes - 1) / vtk_block_bytes;
+		block_table_position_ = file_.tellp();
+		const std::vector<std::uint64_t> table(3 + n_blocks, 0);
+		file_.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(std::uint64_t));
+	}
+	else
+		// raw appended data: byte count of the array, then its values
+		file_.write(reinterpret_cast<const char *>(&n_bytes), sizeof(n_bytes));
+	if (!file_)
+		throw GRBF_Exceptions::error_writing_grid;
+}
+
+void Grid_File_Writer::write_mhd_header(const char *filename, const std::string &raw_filename, const Vector3d &origin, const Vector3d &spacing)
+{
+	std::ofstream header(filename, std::ios::trunc);
+	if (!header)
+		throw GRBF_Exceptions::error_writing_grid;
+	// the data file is named relative to the header
+	const size_t separator = raw_filename.find_last_of("/\\");
+	header << std::setprecision(17)
+		<< "ObjectType = Image\n"
+		<< "NDims = 3\n"
+		<< "BinaryData = True\n"
+		<< "BinaryDataByteOrderMSB = " << (little_endian_machine() ? "False" : "True") << "\n"
+		<< "CompressedData = False\n"
+		<< "TransformMatrix = 1 0 0 0 1 0 0 0 1\n"
+		<< "Offset = " << origin(0) << " " << origin(1) << " " << origin(2) << "\n"
+		<< "ElementSpacing = " << spacing(0) << " " << spacing(1) << " " << spacing(2) << "\n"
+		<< "DimSize = " << dims_(0) << " " << dims_(1) << " " << dims_(2) << "\n"
+		<< "ElementType = " << (single_precision_ ? "MET_FLOAT" : "MET_DOUBLE") << "\n"
+		<< "ElementDataFile = " << (separator == std::string::npos ? raw_filename : raw_filename.substr(separator + 1)) << "\n";
+	if (!header)
+		throw GRBF_Exceptions::error_writing_grid;
+}
+
+void Grid_File_Writer::WriteSlices(const double *values, const int &n_slices)
+{
+	if (n_slices < 0 || n_slices_written_ + n_slices > dims_(2))
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	const size_t n = (size_t)dims_(0) * dims_(1) * n_slices;
+	if (single_precision_) {
+		single_values_.resize(n);
+		for (size_t i = 0; i < n; i++)
+			single_values_[i] = (float)values[i];
+		write_blocks(reinterpret_cast<const char *>(single_values_.data()), n * sizeof(float));
+	}
+	else
+		write_blocks(reinterpret_cast<const char *>(values), n * sizeof(double));
+	if (!file_)
+		throw GRBF_Exceptions::error_writing_grid;
+	n_slices_written_ += n_slices;
+}
+
+void Grid_File_Writer::write_blocks(const char *bytes, const size_t &n_bytes)
+{
+	if (!compress_) {
+		file_.write(bytes, n_bytes);
+		return;
+	}
+	// whole blocks are compressed now, the rest waits for the next slices
+	pending_bytes_.append(bytes, n_bytes);
+	const size_t n_whole = pending_bytes_.size() / vtk_block_bytes * vtk_block_bytes;
+	if (n_whole == 0)
+		return;
+	for (const auto &block : compress_vtk_blocks(pending_bytes_.data(), n_whole)) {
+		file_.write(block.data(), block.size());
+		block_sizes_.push_back(block.size());
+	}
+	pending_bytes_.erase(0, n_whole);
+}
+
+void Grid_File_Writer::Close()
+{
+	if (!file_.is_open())
+		return;
+	if (n_slices_written_ != dims_(2)) {
+		file_.close();
+		throw GRBF_Exceptions::error_writing_grid;
+	}
+	if (compress_) {
+		// the partial last block, then the block table
+		for (const auto &block : compress_vtk_blocks(pending_bytes_.data(), pending_bytes_.size())) {
+			file_.write(block.data(), block.size());
+			block_sizes_.push_back(block.size());
+		}
+		const std::uint64_t n_bytes = (std::uint64_t)dims_(0) * dims_(1) * dims_(2) * (single_precision_ ? sizeof(float) : sizeof(double));
+		std::vector<std::uint64_t> table;
+		table.push_back(block_sizes_.size());
+		table.push_back(vtk_block_bytes);
+		table.push_back(n_bytes % vtk_block_bytes);
+		table.insert(table.end(), block_sizes_.begin(), block_sizes_.end());
+		const std::streamoff end = file_.tellp();
+		file_.seekp(block_table_position_);
+		file_.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(std::uint64_t));
+		file_.seekp(end);
+	}
+	if (vti_) {
+		const std::string footer = "\n  </AppendedData>\n</VTKFile>\n";
+		file_.write(footer.data(), footer.size());
+	}
+	file_.close();
+	if (!file_)
+		throw GRBF_Exceptions::error_writing_grid;
+}
@@ -0,0 +1,94 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef grid_writer_h
+#define grid_writer_h
+
+#include <surfe_lib_module.h>
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Eigen;
+
+// Writes a scalar field on the grid origin + (i, j, k) * spacing to disk z
+// slice by z slice, so a grid far larger than memory can be written as it is
+// evaluated (see Surfe_API::WriteRegularGrid). The file format follows the
+// file name:
+//   .vti  VTK XML image data, values in raw binary appended data
+//   .mhd  MetaImage header, values in a .raw file of the same name
+// Both open in ParaView. Values are in the byte order of this machine.
+// A .vti file can be compressed: the values are cut in blocks compressed in
+// parallel as the slices come (see vtk_writer.h), the table of compressed
+// block sizes in front of them is filled in by Close().
+class SURFE_LIB_EXPORT Grid_File_Writer {
+private:
+	std::ofstream file_;
+	bool vti_;
+	Vector3i dims_;
+	bool single_precision_;
+	int n_slices_written_;
+	std::vector<float> single_values_;
+	bool compress_;
+	std::streamoff block_table_position_;
+	std::vector<std::uint64_t> block_sizes_;  // compressed
+	std::string pending_bytes_;  // less than a block, not compressed yet
+
+	void write_blocks(const char *bytes, const size_t &n_bytes);
+
+	void write_vti_header(const Vector3d &origin, const Vector3d &spacing, const std::string &array_name);
+	void write_mhd_header(const char *filename, const std::string &raw_filename, const Vector3d &origin, const Vector3d &spacing);
+
+public:
+	// single_precision stores 4 byte floats, half the size of the file.
+	// compress: zlib blocks, .vti only. Throws unsupported_grid_file_format,
+	// compression_not_available or error_writing_grid
+	Grid_File_Writer(const char *filename, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+		const std::string &array_name = "Scalar Field", const bool &single_precision = false, const bool &compress = false);
+	// closes the file, incomplete if not every slice was written
+	~Grid_File_Writer();
+	// the next n_slices z slices: nx * ny * n_slices values, x varies fastest
+	void WriteSlices(const double *values, const int &n_slices);
+	int GetNumberOfSlicesWritten() const { return n_slices_written_; }
+	// completes the file. Throws error_writing_grid if slices are missing
+	void Close();
+};
+
+#endif
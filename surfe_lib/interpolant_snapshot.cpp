@@ -0,0 +1,422 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <interpolant_snapshot.h>
+#include <modeling_methods.h>
+#include <single_surface.h>
+#include <lajaunie.h>
+#include <vector_field.h>
+#include <stratigraphic_surfaces.h>
+#include <continuous_property.h>
+#include <grbf_exceptions.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+// Parameters_Section layout. New fields are appended, older files keep the
+// defaults of the fields they do not have
+std::vector<double> pack_parameters(const Parameters &p)
+{
+	double values[] = {
+		(double)p.model_type, p.min_stratigraphic_thickness,
+		(double)p.use_interface, (double)p.use_planar, (double)p.use_tangent, (double)p.use_inequality,
+		(double)p.basis_type, p.shape_parameter, (double)p.polynomial_order,
+		(double)p.advanced_parameters, (double)p.model_global_anisotropy, (double)p.use_greedy,
+		(double)p.use_restricted_range, p.smoothing_amount, (double)p.use_regression_smoothing,
+		p.interface_uncertainty, p.angular_uncertainty,
+		(double)p.use_declustering, (double)p.decluster_method, p.decluster_spacing,
+		(double)p.use_center_selection, (double)p.center_selection_method, (double)p.max_centers,
+		p.center_selection_tolerance
+	};
+	return std::vector<double>(values, values + sizeof(values) / sizeof(double));
+}
+
+void unpack_parameters(const double *values, const int &n, Parameters &p)
+{
+	int j = 0;
+	if (j < n) p.model_type = (Parameter_Types::ModelType)(int)values[j++];
+	if (j < n) p.min_stratigraphic_thickness = values[j++];
+	if (j < n) p.use_interface = values[j++] != 0;
+	if (j < n) p.use_planar = values[j++] != 0;
+	if (j < n) p.use_tangent = values[j++] != 0;
+	if (j < n) p.use_inequality = values[j++] != 0;
+	if (j < n) p.basis_type = (Parameter_Types::RBF)(int)values[j++];
+	if (j < n) p.shape_parameter = values[j++];
+	if (j < n) p.polynomial_order = (int)values[j++];
+	if (j < n) p.advanced_parameters = values[j++] != 0;
+	if (j < n) p.model_global_anisotropy = values[j++] != 0;
+	if (j < n) p.use_greedy = values[j++] != 0;
+	if (j < n) p.use_restricted_range = values[j++] != 0;
+	if (j < n) p.smoothing_amount = values[j++];
+	if (j < n) p.use_regression_smoothing = values[j++] != 0;
+	if (j < n) p.interface_uncertainty = values[j++];
+	if (j < n) p.angular_uncertainty = values[j++];
+	if (j < n) p.use_declustering = values[j++] != 0;
+	if (j < n) p.decluster_method = (Parameter_Types::DeclusterMethod)(int)values[j++];
+	if (j < n) p.decluster_spacing = values[j++];
+	if (j < n) p.use_center_selection = values[j++] != 0;
+	if (j < n) p.center_selection_method = (Parameter_Types::CenterSelectionMethod)(int)values[j++];
+	if (j < n) p.max_centers = (int)values[j++];
+	if (j < n) p.center_selection_tolerance = values[j++];
+}
+
+// Method_Section layout: method code followed by the InternalParameters
+std::vector<std::int64_t> pack_internal_parameters(const int &modelling_method, const InternalParameters &ip)
+{
+	std::int64_t values[] = {
+		modelling_method,
+		ip.n_interface, ip.n_planar, ip.n_inequality, ip.n_tangent,
+		ip.n_constraints, ip.n_equality,
+		ip.modified_basis, ip.poly_term, ip.n_poly_terms,
+		ip.problem_type, ip.restricted_range
+	};
+	return std::vector<std::int64_t>(values, values + sizeof(values) / sizeof(std::int64_t));
+}
+
+struct Section_Payload {
+	Snapshot_Format::Section section;
+	std::vector<char> bytes;
+};
+
+template <class T>
+void add_section(std::vector<Section_Payload> &payloads, const Snapshot_Format::Section_ID &id,
+	const int &rows, const int &cols, const std::vector<T> &values)
+{
+	Section_Payload payload;
+	payload.section.id = id;
+	payload.section.element_size = sizeof(T);
+	payload.section.offset = 0;
+	payload.section.rows = rows;
+	payload.section.cols = cols;
+	payload.bytes.resize(values.size() * sizeof(T));
+	if (!values.empty())
+		std::memcpy(payload.bytes.data(), values.data(), payload.bytes.size());
+	payloads.push_back(payload);
+}
+
+void append_point(std::vector<double> &values, const Point &p)
+{
+	values.push_back(p.x());
+	values.push_back(p.y());
+	values.push_back(p.z());
+	values.push_back(p.c());
+}
+
+std::uint64_t aligned(const std::uint64_t &offset)
+{
+	return (offset + 7) & ~(std::uint64_t)7;
+}
+
+// row stride of a section, a file written by a later version may have more
+// columns than this version reads
+int section_stride(const Snapshot_Reader &reader, const Snapshot_Format::Section_ID &id)
+{
+	const Snapshot_Format::Section *section = reader.find_section(id);
+	return section ? (int)section->cols : 0;
+}
+}
+
+int Interpolant_Snapshot::get_modelling_method_code(GRBF_Modelling_Methods *method)
+{
+	if (dynamic_cast<Single_Surface *>(method))
+		return 1;
+	else if (dynamic_cast<Lajaunie_Approach *>(method))
+		return 2;
+	else if (dynamic_cast<Vector_Field *>(method))
+		return 3;
+	else if (dynamic_cast<Stratigraphic_Surfaces *>(method))
+		return 4;
+	else if (dynamic_cast<Continuous_Property *>(method))
+		return 5;
+	else
+		throw GRBF_Exceptions::unknown_modelling_mode;
+}
+
+GRBF_Modelling_Methods *Interpolant_Snapshot::create_method(const int &modelling_method)
+{
+	if (modelling_method == 1)
+		return new Single_Surface();
+	else if (modelling_method == 2)
+		return new Lajaunie_Approach();
+	else if (modelling_method == 3)
+		return new Vector_Field();
+	else if (modelling_method == 4)
+		return new Stratigraphic_Surfaces();
+	else if (modelling_method == 5)
+		return new Continuous_Property();
+	else
+		throw GRBF_Exceptions::unknown_modelling_mode;
+}
+
+void Interpolant_Snapshot::save(const char *filename, const int &modelling_method, GRBF_Modelling_Methods *method)
+{
+	if (!method || !method->solver || !method->kernel)
+		throw GRBF_Exceptions::missing_interpolant;
+
+	std::vector<Section_Payload> payloads;
+	std::vector<double> parameter_values = pack_parameters(method->parameters);
+	add_section(payloads, Snapshot_Format::Parameters_Section, 1, (int)parameter_values.size(), parameter_values);
+	std::vector<std::int64_t> method_values = pack_internal_parameters(modelling_method, method->intern_params);
+	add_section(payloads, Snapshot_Format::Method_Section, 1, (int)method_values.size(), method_values);
+
+	const Constraints &constraints = method->constraints;
+	std::vector<double> values;
+	for (const auto &inequality_pt : constraints.inequality) {
+		append_point(values, inequality_pt);
+		values.push_back(inequality_pt.level());
+	}
+	add_section(payloads, Snapshot_Format::Inequality_Section, (int)constraints.inequality.size(), 5, values);
+	values.clear();
+	for (const auto &interface_pt : constraints.itrface) {
+		append_point(values, interface_pt);
+		values.push_back(interface_pt.level());
+	}
+	add_section(payloads, Snapshot_Format::Interface_Section, (int)constraints.itrface.size(), 5, values);
+	values.clear();
+	for (const auto &planar_pt : constraints.planar) {
+		append_point(values, planar_pt);
+		values.push_back(planar_pt.nx());
+		values.push_back(planar_pt.ny());
+		values.push_back(planar_pt.nz());
+		values.push_back(planar_pt.dip());
+		values.push_back(planar_pt.strike());
+		values.push_back(planar_pt.polarity());
+	}
+	add_section(payloads, Snapshot_Format::Planar_Section, (int)constraints.planar.size(), 10, values);
+	values.clear();
+	for (const auto &tangent_pt : constraints.tangent) {
+		append_point(values, tangent_pt);
+		values.push_back(tangent_pt.tx());
+		values.push_back(tangent_pt.ty());
+		values.push_back(tangent_pt.tz());
+		values.push_back(tangent_pt.inner_product_constraint());
+	}
+	add_section(payloads, Snapshot_Format::Tangent_Section, (int)constraints.tangent.size(), 8, values);
+
+	const VectorXd &weights = method->solver->weights;
+	values.assign(weights.data(), weights.data() + weights.size());
+	add_section(payloads, Snapshot_Format::Weights_Section, (int)weights.size(), 1, values);
+	add_section(payloads, Snapshot_Format::Iso_Values_Section, (int)method->interface_iso_values.size(), 1, method->interface_iso_values);
+
+	if (method->parameters.model_global_anisotropy && method->rbf_kernel) {
+		double plunge[3];
+		Matrix3f transform;
+		method->rbf_kernel->get_anisotropy_transform(plunge, transform);
+		values.assign(plunge, plunge + 3);
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 3; k++)
+				values.push_back(transform(j, k));
+		add_section(payloads, Snapshot_Format::Anisotropy_Section, 1, 12, values);
+	}
+
+	if (method->intern_params.modified_basis) {
+		Modified_Kernel *modified_kernel = dynamic_cast<Modified_Kernel *>(method->kernel);
+		if (!modified_kernel || !modified_kernel->lagrangian_basis())
+			throw GRBF_Exceptions::missing_interpolant;
+		const Lagrangian_Polynomial_Basis *lagrangian_basis = modified_kernel->lagrangian_basis();
+		values.clear();
+		for (const auto &unisolvent_pt : lagrangian_basis->unisolvent_subset_points) {
+			append_point(values, unisolvent_pt);
+			values.push_back(unisolvent_pt.level());
+		}
+		add_section(payloads, Snapshot_Format::Unisolvent_Points_Section, (int)lagrangian_basis->unisolvent_subset_points.size(), 5, values);
+		const VectorXd &constants = lagrangian_basis->polynomial_constants();
+		values.assign(constants.data(), constants.data() + constants.size());
+		add_section(payloads, Snapshot_Format::Lagrange_Constants_Section, 1, (int)constants.size(), values);
+	}
+
+	// flat form of the interpolant for evaluators without the modelling methods
+	std::vector<Evaluation_Term> terms;
+	VectorXd monomial_coefficients;
+	method->get_rbf_evaluation_terms(terms, monomial_coefficients);
+	double kernel_values[12];
+	method->get_rbf_evaluation_kernel(kernel_values);
+	values.assign(kernel_values, kernel_values + 12);
+	add_section(payloads, Snapshot_Format::Evaluation_Kernel_Section, 1, 12, values);
+	values.clear();
+	for (const auto &term : terms) {
+		values.push_back((double)term.type);
+		values.push_back(term.weight);
+		append_point(values, term.p);
+		append_point(values, term.q);
+	}
+	add_section(payloads, Snapshot_Format::Evaluation_Terms_Section, (int)terms.size(), Snapshot_Format::n_evaluation_term_cols, values);
+	values.assign(monomial_coefficients.data(), monomial_coefficients.data() + monomial_coefficients.size());
+	add_section(payloads, Snapshot_Format::Evaluation_Polynomial_Section, 1, Snapshot_Format::n_monomials, values);
+
+	// lay out the payloads behind the section table
+	Snapshot_Format::Header header;
+	std::memcpy(header.magic, Snapshot_Format::magic, sizeof(header.magic));
+	header.version = Snapshot_Format::version;
+	header.byte_order = Snapshot_Format::byte_order;
+	header.n_sections = (std::uint32_t)payloads.size();
+	header.reserved = 0;
+	std::uint64_t offset = sizeof(Snapshot_Format::Header) + payloads.size() * sizeof(Snapshot_Format::Section);
+	for (auto &payload : payloads) {
+		offset = aligned(offset);
+		payload.section.offset = offset;
+		offset += payload.bytes.size();
+	}
+	header.file_size = aligned(offset);
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw GRBF_Exceptions::error_writing_snapshot;
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	for (const auto &payload : payloads)
+		file.write(reinterpret_cast<const char *>(&payload.section), sizeof(payload.section));
+	const char padding[8] = { 0 };
+	std::uint64_t position = sizeof(Snapshot_Format::Header) + payloads.size() * sizeof(Snapshot_Format::Section);
+	for (const auto &payload : payloads) {
+		file.write(padding, payload.section.offset - position);
+		file.write(payload.bytes.data(), payload.bytes.size());
+		position = payload.section.offset + payload.bytes.size();
+	}
+	file.write(padding, header.file_size - position);
+	if (!file)
+		throw GRBF_Exceptions::error_writing_snapshot;
+}
+
+GRBF_Modelling_Methods *Interpolant_Snapshot::load(const char *filename, int &modelling_method)
+{
+	Snapshot_Reader reader;
+	reader.open(filename);
+
+	int rows = 0;
+	const std::int64_t *method_values = reader.get_int64s(Snapshot_Format::Method_Section, 12, rows);
+	const double *parameter_values = reader.get_doubles(Snapshot_Format::Parameters_Section, 0, rows);
+	if (!method_values || !parameter_values || rows != 1)
+		throw GRBF_Exceptions::invalid_snapshot;
+	const int n_parameters = (int)reader.find_section(Snapshot_Format::Parameters_Section)->cols;
+
+	modelling_method = (int)method_values[0];
+	GRBF_Modelling_Methods *method = create_method(modelling_method);
+	try
+	{
+		unpack_parameters(parameter_values, n_parameters, method->parameters);
+
+		// centers, straight from the mapped file
+		Constraints &constraints = method->constraints;
+		const double *v = reader.get_doubles(Snapshot_Format::Inequality_Section, 5, rows);
+		int stride = section_stride(reader, Snapshot_Format::Inequality_Section);
+		for (int j = 0; j < rows; j++, v += stride)
+			constraints.inequality.push_back(Inequality(v[0], v[1], v[2], v[4], v[3]));
+		v = reader.get_doubles(Snapshot_Format::Interface_Section, 5, rows);
+		stride = section_stride(reader, Snapshot_Format::Interface_Section);
+		for (int j = 0; j < rows; j++, v += stride)
+			constraints.itrface.push_back(Interface(v[0], v[1], v[2], v[4], v[3]));
+		v = reader.get_doubles(Snapshot_Format::Planar_Section, 10, rows);
+		stride = section_stride(reader, Snapshot_Format::Planar_Section);
+		for (int j = 0; j < rows; j++, v += stride)
+			constraints.planar.push_back(Planar(v[0], v[1], v[2], v[4], v[5], v[6], v[7], v[8], (int)v[9], v[3]));
+		v = reader.get_doubles(Snapshot_Format::Tangent_Section, 8, rows);
+		stride = section_stride(reader, Snapshot_Format::Tangent_Section);
+		for (int j = 0; j < rows; j++, v += stride) {
+			Tangent tangent_pt(v[0], v[1], v[2], v[4], v[5], v[6], v[3]);
+			tangent_pt.setInnerProductConstraint(v[7]);
+			constraints.tangent.push_back(tangent_pt);
+		}
+
+		// rebuild the bookkeeping (interface lists, increment pairs, ...) and
+		// make sure it matches the solved system
+		method->process_input_data();
+		method->get_method_parameters();
+		const std::vector<std::int64_t> expected = pack_internal_parameters(modelling_method, method->intern_params);
+		for (int j = 0; j < (int)expected.size(); j++)
+			if (expected[j] != method_values[j])
+				throw GRBF_Exceptions::invalid_snapshot;
+
+		// basis functions as they were when the system was solved
+		method->rbf_kernel = method->create_rbf_kernel(method->parameters.basis_type, method->parameters.model_global_anisotropy);
+		if (method->parameters.model_global_anisotropy) {
+			v = reader.get_doubles(Snapshot_Format::Anisotropy_Section, 12, rows);
+			if (!v || rows != 1)
+				throw GRBF_Exceptions::invalid_snapshot;
+			double plunge[3] = { v[0], v[1], v[2] };
+			Matrix3f transform;
+			for (int j = 0; j < 3; j++)
+				for (int k = 0; k < 3; k++)
+					transform(j, k) = (float)v[3 + 3 * j + k];
+			method->rbf_kernel->set_anisotropy_transform(plunge, transform);
+		}
+		if (method->intern_params.modified_basis) {
+			v = reader.get_doubles(Snapshot_Format::Unisolvent_Points_Section, 5, rows);
+			if (!v || rows != 4)
+				throw GRBF_Exceptions::invalid_snapshot;
+			std::vector<Interface> unisolvent_points;
+			const int stride = section_stride(reader, Snapshot_Format::Unisolvent_Points_Section);
+			for (int j = 0; j < rows; j++, v += stride)
+				unisolvent_points.push_back(Interface(v[0], v[1], v[2], v[4], v[3]));
+			v = reader.get_doubles(Snapshot_Format::Lagrange_Constants_Section, 16, rows);
+			if (!v || rows != 1)
+				throw GRBF_Exceptions::invalid_snapshot;
+			VectorXd constants = Map<const VectorXd>(v, 16);
+			method->kernel = new Modified_Kernel(method->rbf_kernel, new Lagrangian_Polynomial_Basis(unisolvent_points, constants));
+		}
+		else
+			method->kernel = method->rbf_kernel;
+		method->prepare_polynomial_basis();
+
+		// solution
+		v = reader.get_doubles(Snapshot_Format::Weights_Section, 1, rows);
+		if (!v || rows == 0)
+			throw GRBF_Exceptions::invalid_snapshot;
+		Linear_LU_decomposition *solution = new Linear_LU_decomposition();
+		solution->weights = Map<const VectorXd>(v, rows);
+		method->solver = solution;
+
+		v = reader.get_doubles(Snapshot_Format::Iso_Values_Section, 1, rows);
+		if (v) {
+			if (rows != (int)method->interface_iso_values.size())
+				throw GRBF_Exceptions::invalid_snapshot;
+			method->interface_iso_values.assign(v, v + rows);
+			if (method->interface_test_points.size() == method->interface_iso_values.size())
+				for (int j = 0; j < rows; j++)
+					method->interface_test_points[j].set_scalar_field(v[j]);
+		}
+	}
+	catch (std::exception& e)
+	{
+		delete method;
+		std::cout << "Exception: " << e.what() << " occurred. " << std::endl;
+		std::throw_with_nested(GRBF_Exceptions::invalid_snapshot);
+	}
+
+	return method;
+}
@@ -0,0 +1,62 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef interpolant_snapshot_h
+#define interpolant_snapshot_h
+
+#include <surfe_lib_module.h>
+#include <snapshot_reader.h>
+
+class GRBF_Modelling_Methods;
+
+// Stores the solved state of a modelling method - parameters, the processed
+// constraints (the centers), the weights, anisotropy and lagrangian basis data
+// and the interface iso values - and restores it without solving the system
+// again. Evaluations of a restored method are bit for bit identical.
+class SURFE_LIB_EXPORT Interpolant_Snapshot {
+public:
+	// modelling_method: Surfe_API(int) code of method
+	static void save(const char *filename, const int &modelling_method, GRBF_Modelling_Methods *method);
+	// returns a ready to evaluate method. Caller owns it
+	static GRBF_Modelling_Methods *load(const char *filename, int &modelling_method);
+	// Surfe_API(int) codes: 1 single surface, 2 lajaunie, 3 vector field,
+	// 4 stratigraphic horizons, 5 continuous property
+	static int get_modelling_method_code(GRBF_Modelling_Methods *method);
+	static GRBF_Modelling_Methods *create_method(const int &modelling_method);
+};
+
+#endif
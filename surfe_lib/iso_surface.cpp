@@ -0,0 +1,376 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <iso_surface.h>
+#include <task_scheduler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+// corners of a cell: c = dx + 2 dy + 4 dz. Each tetrahedron is a path from
+// corner 0 to corner 7 along the cell edges, so every tetrahedron edge joins
+// a corner a to a corner b with the bits of a included in those of b, and
+// neighbouring cells cut their common face along the same diagonal
+const int cell_tetrahedra[6][4] = {
+	{ 0, 1, 3, 7 }, { 0, 1, 5, 7 }, { 0, 2, 3, 7 },
+	{ 0, 2, 6, 7 }, { 0, 4, 5, 7 }, { 0, 4, 6, 7 }
+};
+
+// fraction of a grid edge below which a crossing is put on the grid point
+const double point_tolerance = 1e-9;
+
+// part of a mesh contoured from one slab of cells
+struct Partial_Mesh {
+	std::vector<long long> edges;  // grid edge (or grid point) of each vertex
+	std::vector<double> vertices;  // x, y, z
+	std::vector<int> triangles;
+	std::unordered_map<long long, int> vertex_of_edge;
+};
+
+struct Cell {
+	long long point_index[8];
+	double value[8];
+	double position[8][3];
+};
+
+// vertex where the iso value crosses the edge between corners a and b of
+// the cell, created once per grid edge: point a and the offset b - a
+int edge_vertex(Partial_Mesh &mesh, const Cell &cell, int a, int b, const double &iso_value)
+{
+	if (a > b)
+		std::swap(a, b);
+	double t = (iso_value - cell.value[a]) / (cell.value[b] - cell.value[a]);
+	// a grid point at the iso value (to round off) is a vertex of all the
+	// edges through it, keyed by the point (negative) instead of the edge, so
+	// the slivers around it collapse
+	long long edge = 7 * cell.point_index[a] + (b - a - 1);
+	if (t <= point_tolerance) {
+		t = 0;
+		edge = -1 - cell.point_index[a];
+	}
+	else if (t >= 1 - point_tolerance) {
+		t = 1;
+		edge = -1 - cell.point_index[b];
+	}
+	auto found = mesh.vertex_of_edge.find(edge);
+	if (found != mesh.vertex_of_edge.end())
+		return found->second;
+	const int index = (int)mesh.edges.size();
+	mesh.edges.push_back(edge);
+	for (int i = 0; i < 3; i++)
+		mesh.vertices.push_back(t == 1 ? cell.position[b][i] : cell.position[a][i] + t * (cell.position[b][i] - cell.position[a][i]));
+	mesh.vertex_of_edge[edge] = index;
+	return index;
+}
+
+// appends the triangle with its normal pointing along up, skips triangles
+// collapsed onto a grid point at the iso value
+void add_triangle(Partial_Mesh &mesh, int v0, int v1, int v2, const double *up)
+{
+	if (v0 == v1 || v1 == v2 || v0 == v2)
+		return;
+	const double *p0 = &mesh.vertices[3 * v0];
+	const double *p1 = &mesh.vertices[3 * v1];
+	const double *p2 = &mesh.vertices[3 * v2];
+	const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+	const double normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+	if (normal[0] * up[0] + normal[1] * up[1] + normal[2] * up[2] < 0)
+		std::swap(v1, v2);
+	mesh.triangles.push_back(v0);
+	mesh.triangles.push_back(v1);
+	mesh.triangles.push_back(v2);
+}
+
+void contour_tetrahedron(Partial_Mesh &mesh, const Cell &cell, const int *corners, const double &iso_value)
+{
+	int above[4], below[4];
+	int n_above = 0, n_below = 0;
+	for (int j = 0; j < 4; j++) {
+		if (cell.value[corners[j]] > iso_value)
+			above[n_above++] = corners[j];
+		else
+			below[n_below++] = corners[j];
+	}
+	if (n_above == 0 || n_below == 0)
+		return;
+	// from the corners below to the corners above the iso value
+	double up[3];
+	for (int i = 0; i < 3; i++) {
+		double a = 0, b = 0;
+		for (int j = 0; j < n_above; j++)
+			a += cell.position[above[j]][i];
+		for (int j = 0; j < n_below; j++)
+			b += cell.position[below[j]][i];
+		up[i] = a / n_above - b / n_below;
+	}
+	if (n_above == 1 || n_below == 1) {
+		const int lone = n_above == 1 ? above[0] : below[0];
+		const int *others = n_above == 1 ? below : above;
+		add_triangle(mesh, edge_vertex(mesh, cell, lone, others[0], iso_value),
+			edge_vertex(mesh, cell, lone, others[1], iso_value),
+			edge_vertex(mesh, cell, lone, others[2], iso_value), up);
+		return;
+	}
+	// quadrilateral around the tetrahedron
+	const int q0 = edge_vertex(mesh, cell, above[0], below[0], iso_value);
+	const int q1 = edge_vertex(mesh, cell, above[0], below[1], iso_value);
+	const int q2 = edge_vertex(mesh, cell, above[1], below[1], iso_value);
+	const int q3 = edge_vertex(mesh, cell, above[1], below[0], iso_value);
+	add_triangle(mesh, q0, q1, q2, up);
+	add_triangle(mesh, q0, q2, q3, up);
+}
+
+// corner positions and grid indices of the cell with lower corner (i, j, k)
+void set_cell_corners(Cell &cell, const int &i, const int &j, const int &k, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims)
+{
+	for (int c = 0; c < 8; c++) {
+		const int ci = i + (c & 1);
+		const int cj = j + ((c >> 1) & 1);
+		const int ck = k + ((c >> 2) & 1);
+		cell.point_index[c] = ci + (long long)dims(0) * (cj + (long long)dims(1) * ck);
+		cell.position[c][0] = origin(0) + ci * spacing(0);
+		cell.position[c][1] = origin(1) + cj * spacing(1);
+		cell.position[c][2] = origin(2) + ck * spacing(2);
+	}
+}
+
+// meshes: one per iso value
+void contour_cell(std::vector<Partial_Mesh> &meshes, const Cell &cell, const std::vector<double> &iso_values)
+{
+	const double min_value = *std::min_element(cell.value, cell.value + 8);
+	const double max_value = *std::max_element(cell.value, cell.value + 8);
+	for (size_t s = 0; s < iso_values.size(); s++) {
+		if (iso_values[s] < min_value || iso_values[s] >= max_value)
+			continue;
+		for (int t = 0; t < 6; t++)
+			contour_tetrahedron(meshes[s], cell, cell_tetrahedra[t], iso_values[s]);
+	}
+}
+
+// welds the parts (each one mesh per iso value) in order, vertices on the
+// faces between parts are in both
+std::vector<Iso_Surface> weld_parts(std::vector<std::vector<Partial_Mesh> > &parts, const std::vector<double> &iso_values)
+{
+	const int n_iso = (int)iso_values.size();
+	std::vector<Iso_Surface> surfaces(n_iso);
+	for (int s = 0; s < n_iso; s++) {
+		std::unordered_map<long long, int> vertex_of_edge;
+		std::vector<double> vertices;
+		std::vector<int> triangles;
+		std::vector<int> global_index;
+		for (auto &part : parts) {
+			const Partial_Mesh &mesh = part[s];
+			global_index.resize(mesh.edges.size());
+			for (size_t v = 0; v < mesh.edges.size(); v++) {
+				auto inserted = vertex_of_edge.insert(std::make_pair(mesh.edges[v], (int)(vertices.size() / 3)));
+				if (inserted.second)
+					vertices.insert(vertices.end(), mesh.vertices.begin() + 3 * v, mesh.vertices.begin() + 3 * v + 3);
+				global_index[v] = inserted.first->second;
+			}
+			for (int v : mesh.triangles)
+				triangles.push_back(global_index[v]);
+			part[s] = Partial_Mesh();
+		}
+		Iso_Surface &surface = surfaces[s];
+		surface.iso_value = iso_values[s];
+		surface.vertices = Map<const Matrix<double, Dynamic, 3, RowMajor> >(vertices.data(), vertices.size() / 3, 3);
+		surface.triangles = Map<const Matrix<int, Dynamic, 3, RowMajor> >(triangles.data(), triangles.size() / 3, 3);
+	}
+	return surfaces;
+}
+
+}
+
+std::vector<Iso_Surface> extract_iso_surfaces(const double *volume, const Vector3d &origin, const Vector3d &spacing,
+	const Vector3i &dims, const std::vector<double> &iso_values)
+{
+	const int nx = dims(0);
+	const int ny = dims(1);
+	const int nz = dims(2);
+	const int n_slabs = nx > 1 && ny > 1 ? std::max(nz - 1, 0) : 0;
+
+	// slab k: cells between the z slices k and k + 1
+	std::vector<std::vector<Partial_Mesh> > slabs(n_slabs, std::vector<Partial_Mesh>(iso_values.size()));
+	parallel_for(n_slabs, 1, [&](const int &first, const int &last) {
+		Cell cell;
+		for (int k = first; k < last; k++) {
+			for (int j = 0; j < ny - 1; j++)
+				for (int i = 0; i < nx - 1; i++) {
+					set_cell_corners(cell, i, j, k, origin, spacing, dims);
+					for (int c = 0; c < 8; c++)
+						cell.value[c] = volume[cell.point_index[c]];
+					contour_cell(slabs[k], cell, iso_values);
+				}
+			// the edge lookups are not needed once the slab is done
+			for (auto &mesh : slabs[k])
+				std::unordered_map<long long, int>().swap(mesh.vertex_of_edge);
+		}
+	});
+	return weld_parts(slabs, iso_values);
+}
+
+std::vector<Iso_Surface> extract_iso_surfaces_in_cells(const std::vector<long long> &cells, const std::vector<double> &corner_values,
+	const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const std::vector<double> &iso_values)
+{
+	const long long nx = dims(0);
+	const long long ny = dims(1);
+	// chunks of cells contoured in parallel, welded in order
+	const int chunk_size = 4096;
+	const int n_chunks = (int)((cells.size() + chunk_size - 1) / chunk_size);
+	std::vector<std::vector<Partial_Mesh> > chunks(n_chunks, std::vector<Partial_Mesh>(iso_values.size()));
+	parallel_for(n_chunks, 1, [&](const int &first, const int &last) {
+		Cell cell;
+		for (int chunk = first; chunk < last; chunk++) {
+			const size_t end = std::min(cells.size(), (size_t)(chunk + 1) * chunk_size);
+			for (size_t c = (size_t)chunk * chunk_size; c < end; c++) {
+				const long long index = cells[c];
+				set_cell_corners(cell, (int)(index % nx), (int)(index / nx % ny), (int)(index / (nx * ny)), origin, spacing, dims);
+				std::copy(corner_values.begin() + 8 * c, corner_values.begin() + 8 * c + 8, cell.value);
+				contour_cell(chunks[chunk], cell, iso_values);
+			}
+			for (auto &mesh : chunks[chunk])
+				std::unordered_map<long long, int>().swap(mesh.vertex_of_edge);
+		}
+	});
+	return weld_parts(chunks, iso_values);
+}
+
+std::vector<Iso_Surface> extract_iso_surfaces_adaptive(const Field_Sampler &sample,
+	const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const std::vector<double> &iso_values,
+	const int &coarse_stride, const double &gradient_safety, long long *n_evaluated)
+{
+	const long long nx = dims(0);
+	const long long ny = dims(1);
+	const long long nz = dims(2);
+	if (n_evaluated)
+		*n_evaluated = 0;
+	if (nx < 2 || ny < 2 || nz < 2 || iso_values.empty()) {
+		std::vector<std::vector<Partial_Mesh> > no_cells;
+		return weld_parts(no_cells, iso_values);
+	}
+	int stride = 1;
+	while (2 * stride <= coarse_stride)
+		stride *= 2;
+
+	// cells of the current level by lower corner, a cell spans stride grid
+	// cells along each axis clipped to the grid
+	std::vector<long long> cells;
+	for (long long k = 0; k < nz - 1; k += stride)
+		for (long long j = 0; j < ny - 1; j += stride)
+			for (long long i = 0; i < nx - 1; i += stride)
+				cells.push_back(i + nx * (j + ny * k));
+	std::unordered_map<long long, std::pair<double, double> > samples;  // value, gradient norm
+	auto corner = [&](const long long &cell, const int &c, const int &size) {
+		const long long i = std::min(cell % nx + (c & 1) * size, nx - 1);
+		const long long j = std::min(cell / nx % ny + ((c >> 1) & 1) * size, ny - 1);
+		const long long k = std::min(cell / (nx * ny) + ((c >> 2) & 1) * size, nz - 1);
+		return i + nx * (j + ny * k);
+	};
+
+	while (true) {
+		// sample the corners not seen at a coarser level, gradients are only
+		// needed to prune cells
+		std::vector<long long> missing;
+		for (const auto &cell : cells)
+			for (int c = 0; c < 8; c++) {
+				const long long point = corner(cell, c, stride);
+				if (samples.insert(std::make_pair(point, std::make_pair(0.0, 0.0))).second)
+					missing.push_back(point);
+			}
+		if (!missing.empty()) {
+			MatrixXd points(missing.size(), 3);
+			for (size_t p = 0; p < missing.size(); p++) {
+				points(p, 0) = origin(0) + (missing[p] % nx) * spacing(0);
+				points(p, 1) = origin(1) + (missing[p] / nx % ny) * spacing(1);
+				points(p, 2) = origin(2) + (missing[p] / (nx * ny)) * spacing(2);
+			}
+			VectorXd values, gradient_norms;
+			sample(points, values, stride > 1 ? &gradient_norms : nullptr);
+			for (size_t p = 0; p < missing.size(); p++)
+				samples[missing[p]] = std::make_pair(values(p), stride > 1 ? gradient_norms(p) : 0.0);
+			if (n_evaluated)
+				*n_evaluated += (long long)missing.size();
+		}
+		if (stride == 1)
+			break;
+
+		// split the cells that may hold a surface
+		const int half = stride / 2;
+		std::vector<long long> children;
+		for (const auto &cell : cells) {
+			double min_value = 0, max_value = 0, max_gradient = 0;
+			for (int c = 0; c < 8; c++) {
+				const std::pair<double, double> &s = samples[corner(cell, c, stride)];
+				if (c == 0 || s.first < min_value)
+					min_value = s.first;
+				if (c == 0 || s.first > max_value)
+					max_value = s.first;
+				max_gradient = std::max(max_gradient, s.second);
+			}
+			const long long end[3] = { std::min(cell % nx + stride, nx - 1), std::min(cell / nx % ny + stride, ny - 1),
+				std::min(cell / (nx * ny) + stride, nz - 1) };
+			const long long begin[3] = { cell % nx, cell / nx % ny, cell / (nx * ny) };
+			double diagonal = 0;
+			for (int i = 0; i < 3; i++)
+				diagonal += std::pow((end[i] - begin[i]) * spacing(i), 2);
+			// every point of the cell is within half a diagonal of a corner
+			const double margin = gradient_safety * max_gradient * 0.5 * std::sqrt(diagonal);
+			bool may_cross = false;
+			for (const auto &iso_value : iso_values)
+				may_cross = may_cross || (iso_value >= min_value - margin && iso_value <= max_value + margin);
+			if (!may_cross)
+				continue;
+			for (int c = 0; c < 8; c++) {
+				const long long child[3] = { begin[0] + (c & 1) * half, begin[1] + ((c >> 1) & 1) * half, begin[2] + ((c >> 2) & 1) * half };
+				if (child[0] < end[0] && child[1] < end[1] && child[2] < end[2])
+					children.push_back(child[0] + nx * (child[1] + ny * child[2]));
+			}
+		}
+		cells.swap(children);
+		stride = half;
+	}
+
+	std::vector<double> corner_values(8 * cells.size());
+	for (size_t cell = 0; cell < cells.size(); cell++)
+		for (int c = 0; c < 8; c++)
+			corner_values[8 * cell + c] = samples[corner(cells[cell], c, 1)].first;
+	return extract_iso_surfaces_in_cells(cells, corner_values, origin, spacing, dims, iso_values);
+}
@@ -0,0 +1,89 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef iso_surface_h
+#define iso_surface_h
+
+#include <surfe_lib_module.h>
+
+#include <Eigen/Core>
+#include <functional>
+#include <vector>
+
+using namespace Eigen;
+
+// Indexed triangle mesh of the iso surface of a scalar field at one value
+struct Iso_Surface {
+	double iso_value;
+	MatrixXd vertices;   // n x 3, a vertex is shared by all its triangles
+	MatrixXi triangles;  // m x 3 vertex indices, counter clockwise seen from
+	                     // the side where the scalar field is above iso_value
+};
+
+// Contours a volume sampled on the grid origin + (i, j, k) * spacing,
+// dims(0) * dims(1) * dims(2) values with x varying fastest (see
+// Surfe_API::EvaluateOnRegularGrid), at every iso value in one pass.
+// Marching tetrahedra: each cell is split into 6 tetrahedra around its
+// diagonal, which has no ambiguous cases and no holes between cells.
+// Vertices lie on the grid edges and are welded by edge, the slabs of cells
+// are contoured in parallel on the current task scheduler
+SURFE_LIB_EXPORT std::vector<Iso_Surface> extract_iso_surfaces(const double *volume, const Vector3d &origin, const Vector3d &spacing,
+	const Vector3i &dims, const std::vector<double> &iso_values);
+// same on a subset of the grid cells, given by the grid index of their lower
+// corner, with the 8 corner values of each cell (corner dx + 2 dy + 4 dz)
+SURFE_LIB_EXPORT std::vector<Iso_Surface> extract_iso_surfaces_in_cells(const std::vector<long long> &cells,
+	const std::vector<double> &corner_values, const Vector3d &origin, const Vector3d &spacing,
+	const Vector3i &dims, const std::vector<double> &iso_values);
+
+// values of the scalar field at points (n x 3), and the norms of its gradient
+// unless gradient_norms is nullptr
+typedef std::function<void(const MatrixXd &points, VectorXd &values, VectorXd *gradient_norms)> Field_Sampler;
+
+// Same surfaces as extract_iso_surfaces without evaluating the whole grid.
+// The field and its gradient are sampled on every coarse_stride-th grid
+// point (rounded down to a power of 2). A cell is kept when an iso value is
+// within reach of its corner values given gradient_safety times the largest
+// corner gradient norm; kept cells are split in 8 until they are grid cells,
+// which are contoured. The surfaces only cross grid cells, so there are no
+// cracks between refinement levels. The bound comes from sampled gradients:
+// raise gradient_safety for fields varying faster than those suggest.
+// n_evaluated: # of points sampled, nullptr skips
+SURFE_LIB_EXPORT std::vector<Iso_Surface> extract_iso_surfaces_adaptive(const Field_Sampler &sample,
+	const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const std::vector<double> &iso_values,
+	const int &coarse_stride = 16, const double &gradient_safety = 2.0, long long *n_evaluated = nullptr);
+
+#endif
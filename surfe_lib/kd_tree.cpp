@@ -0,0 +1,332 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#include <kd_tree.h>
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef DBL_MAX
+#define DBL_MAX     __DBL_MAX__
+#endif
+
+static const int Leaf_size = 8;
+
+void KD_Tree::_to_array(const Point &p, double(&q)[4])
+{
+	q[0] = p.x();
+	q[1] = p.y();
+	q[2] = p.z();
+	q[3] = p.c();
+}
+
+int KD_Tree::_build_node(const int &begin, const int &end)
+{
+	Node node;
+	node.begin = begin;
+	node.end = end;
+	node.left = -1;
+	node.right = -1;
+	for (int d = 0; d < 4; d++) {
+		node.bounds[d][0] = DBL_MAX;
+		node.bounds[d][1] = -DBL_MAX;
+	}
+	for (int j = begin; j < end; j++) {
+		const double *c = &_coords[4 * _indices[j]];
+		for (int d = 0; d < 4; d++) {
+			if (c[d] < node.bounds[d][0]) node.bounds[d][0] = c[d];
+			if (c[d] > node.bounds[d][1]) node.bounds[d][1] = c[d];
+		}
+	}
+	int node_id = (int)_nodes.size();
+	_nodes.push_back(node);
+
+	if (end - begin <= Leaf_size) return node_id;
+
+	// split at the median of the axis with the largest extent
+	int split_dim = 0;
+	double largest_extent = -1.0;
+	for (int d = 0; d < 4; d++) {
+		double extent = node.bounds[d][1] - node.bounds[d][0];
+		if (extent > largest_extent) {
+			largest_extent = extent;
+			split_dim = d;
+		}
+	}
+	if (largest_extent <= 0.0) return node_id;  // all points collocated
+
+	int mid = begin + (end - begin) / 2;
+	const std::vector<double> &coords = _coords;
+	std::nth_element(_indices.begin() + begin, _indices.begin() + mid, _indices.begin() + end,
+		[&coords, split_dim](const int &a, const int &b) { return coords[4 * a + split_dim] < coords[4 * b + split_dim]; });
+
+	int left = _build_node(begin, mid);
+	int right = _build_node(mid, end);
+	_nodes[node_id].left = left;
+	_nodes[node_id].right = right;
+
+	return node_id;
+}
+
+double KD_Tree::_squared_distance(const double(&q)[4], const int &index) const
+{
+	const double *c = &_coords[4 * index];
+	double d2 = 0.0;
+	for (int d = 0; d < 4; d++) {
+		double delta = q[d] - c[d];
+		d2 += delta * delta;
+	}
+	return d2;
+}
+
+double KD_Tree::_min_squared_distance(const double(&q)[4], const Node &node) const
+{
+	double d2 = 0.0;
+	for (int d = 0; d < 4; d++) {
+		double delta = 0.0;
+		if (q[d] < node.bounds[d][0]) delta = node.bounds[d][0] - q[d];
+		else if (q[d] > node.bounds[d][1]) delta = q[d] - node.bounds[d][1];
+		d2 += delta * delta;
+	}
+	return d2;
+}
+
+double KD_Tree::_max_squared_distance(const double(&q)[4], const Node &node) const
+{
+	double d2 = 0.0;
+	for (int d = 0; d < 4; d++) {
+		double delta = std::max(fabs(q[d] - node.bounds[d][0]), fabs(q[d] - node.bounds[d][1]));
+		d2 += delta * delta;
+	}
+	return d2;
+}
+
+void KD_Tree::_nearest(const int &node_id, const double(&q)[4], const int &exclude_index, const bool &exclude_zero_distance,
+	double &best_d2, int &best_index) const
+{
+	const Node &node = _nodes[node_id];
+	if (_min_squared_distance(q, node) > best_d2) return;
+
+	if (node.left == -1) {
+		for (int j = node.begin; j < node.end; j++) {
+			int index = _indices[j];
+			if (index == exclude_index) continue;
+			double d2 = _squared_distance(q, index);
+			if (exclude_zero_distance && d2 == 0.0) continue;
+			if (d2 < best_d2 || (d2 == best_d2 && index < best_index)) {
+				best_d2 = d2;
+				best_index = index;
+			}
+		}
+		return;
+	}
+	// visit the closer child first
+	int first = node.left;
+	int second = node.right;
+	if (_min_squared_distance(q, _nodes[second]) < _min_squared_distance(q, _nodes[first]))
+		std::swap(first, second);
+	_nearest(first, q, exclude_index, exclude_zero_distance, best_d2, best_index);
+	_nearest(second, q, exclude_index, exclude_zero_distance, best_d2, best_index);
+}
+
+void KD_Tree::_k_nearest(const int &node_id, const double(&q)[4], const int &k, const bool &exclude_zero_distance,
+	std::vector<std::pair<double, int> > &heap) const
+{
+	const Node &node = _nodes[node_id];
+	if ((int)heap.size() == k && _min_squared_distance(q, node) > heap.front().first) return;
+
+	if (node.left == -1) {
+		for (int j = node.begin; j < node.end; j++) {
+			int index = _indices[j];
+			double d2 = _squared_distance(q, index);
+			if (exclude_zero_distance && d2 == 0.0) continue;
+			std::pair<double, int> candidate(d2, index);
+			if ((int)heap.size() < k) {
+				heap.push_back(candidate);
+				std::push_heap(heap.begin(), heap.end());
+			}
+			else if (candidate < heap.front()) {
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = candidate;
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+		return;
+	}
+	int first = node.left;
+	int second = node.right;
+	if (_min_squared_distance(q, _nodes[second]) < _min_squared_distance(q, _nodes[first]))
+		std::swap(first, second);
+	_k_nearest(first, q, k, exclude_zero_distance, heap);
+	_k_nearest(second, q, k, exclude_zero_distance, heap);
+}
+
+void KD_Tree::_radius(const int &node_id, const double(&q)[4], const double &r2, std::vector<int> &result) const
+{
+	const Node &node = _nodes[node_id];
+	if (_min_squared_distance(q, node) > r2) return;
+
+	if (node.left == -1 || _max_squared_distance(q, node) <= r2) {
+		// leaf, or the whole node is inside the search sphere
+		for (int j = node.begin; j < node.end; j++) {
+			int index = _indices[j];
+			if (_squared_distance(q, index) <= r2)
+				result.push_back(index);
+		}
+		return;
+	}
+	_radius(node.left, q, r2, result);
+	_radius(node.right, q, r2, result);
+}
+
+void KD_Tree::_furthest(const int &node_id, const double(&q)[4], double &best_d2, int &best_index) const
+{
+	const Node &node = _nodes[node_id];
+	if (_max_squared_distance(q, node) < best_d2) return;
+
+	if (node.left == -1) {
+		for (int j = node.begin; j < node.end; j++) {
+			int index = _indices[j];
+			double d2 = _squared_distance(q, index);
+			if (d2 > best_d2 || (d2 == best_d2 && index < best_index)) {
+				best_d2 = d2;
+				best_index = index;
+			}
+		}
+		return;
+	}
+	// visit the further child first
+	int first = node.left;
+	int second = node.right;
+	if (_max_squared_distance(q, _nodes[second]) > _max_squared_distance(q, _nodes[first]))
+		std::swap(first, second);
+	_furthest(first, q, best_d2, best_index);
+	_furthest(second, q, best_d2, best_index);
+}
+
+void KD_Tree::_closest_to_distance(const int &node_id, const double(&q)[4], const double &dist,
+	double &best_residual, int &best_index) const
+{
+	const Node &node = _nodes[node_id];
+	// lower bound of |distance - dist| over the node
+	double lower = sqrt(_min_squared_distance(q, node));
+	double upper = sqrt(_max_squared_distance(q, node));
+	double bound = 0.0;
+	if (dist < lower) bound = lower - dist;
+	else if (dist > upper) bound = dist - upper;
+	if (bound > best_residual) return;
+
+	if (node.left == -1) {
+		for (int j = node.begin; j < node.end; j++) {
+			int index = _indices[j];
+			double residual = fabs(sqrt(_squared_distance(q, index)) - dist);
+			if (residual < best_residual || (residual == best_residual && index < best_index)) {
+				best_residual = residual;
+				best_index = index;
+			}
+		}
+		return;
+	}
+	_closest_to_distance(node.left, q, dist, best_residual, best_index);
+	_closest_to_distance(node.right, q, dist, best_residual, best_index);
+}
+
+int KD_Tree::nearest_neighbour(const Point &p, const int &exclude_index /*= -1*/, const bool &exclude_zero_distance /*= false*/) const
+{
+	if (_nodes.empty()) return -1;
+
+	double q[4];
+	_to_array(p, q);
+	double best_d2 = DBL_MAX;
+	int best_index = -1;
+	_nearest(0, q, exclude_index, exclude_zero_distance, best_d2, best_index);
+	return best_index;
+}
+
+std::vector<int> KD_Tree::k_nearest_neighbours(const Point &p, const int &k, const bool &exclude_zero_distance /*= false*/) const
+{
+	std::vector<int> nn_indices;
+	if (_nodes.empty() || k <= 0) return nn_indices;
+
+	double q[4];
+	_to_array(p, q);
+	std::vector<std::pair<double, int> > heap;
+	heap.reserve(k);
+	_k_nearest(0, q, k, exclude_zero_distance, heap);
+	std::sort_heap(heap.begin(), heap.end());  // closest to furthest
+	for (const auto &entry : heap)
+		nn_indices.push_back(entry.second);
+	return nn_indices;
+}
+
+std::vector<int> KD_Tree::points_within_radius(const Point &p, const double &radius) const
+{
+	std::vector<int> result;
+	if (_nodes.empty() || radius < 0) return result;
+
+	double q[4];
+	_to_array(p, q);
+	_radius(0, q, radius * radius, result);
+	return result;
+}
+
+int KD_Tree::furthest_neighbour(const Point &p, double &distance) const
+{
+	distance = 0.0;
+	if (_nodes.empty()) return -1;
+
+	double q[4];
+	_to_array(p, q);
+	double best_d2 = -1.0;
+	int best_index = -1;
+	_furthest(0, q, best_d2, best_index);
+	distance = sqrt(best_d2);
+	return best_index;
+}
+
+int KD_Tree::closest_to_distance(const Point &p, const double &dist) const
+{
+	if (_nodes.empty()) return -1;
+
+	double q[4];
+	_to_array(p, q);
+	double best_residual = DBL_MAX;
+	int best_index = -1;
+	_closest_to_distance(0, q, dist, best_residual, best_index);
+	return best_index;
+}
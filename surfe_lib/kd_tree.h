@@ -0,0 +1,117 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#ifndef kd_tree_h
+#define kd_tree_h
+
+#include <modelling_input.h>
+
+#include <vector>
+
+// Static k-d tree over the 4D coordinates (x, y, z, c) of a set of points.
+// Distances are consistent with distance_btw_pts(). Queries return indices
+// into the vector the tree was built from. When several points are at the
+// same distance the lowest index wins, same as the brute force scans.
+class KD_Tree {
+private:
+	struct Node {
+		int begin;  // range in _indices
+		int end;
+		int left;   // child nodes, -1 for leaf nodes
+		int right;
+		double bounds[4][2];  // bounding box of the points in the node
+	};
+	std::vector<double> _coords;  // packed x, y, z, c
+	std::vector<int> _indices;
+	std::vector<Node> _nodes;
+
+	int _build_node(const int &begin, const int &end);
+	double _squared_distance(const double(&q)[4], const int &index) const;
+	double _min_squared_distance(const double(&q)[4], const Node &node) const;
+	double _max_squared_distance(const double(&q)[4], const Node &node) const;
+	void _nearest(const int &node_id, const double(&q)[4], const int &exclude_index, const bool &exclude_zero_distance,
+		double &best_d2, int &best_index) const;
+	void _k_nearest(const int &node_id, const double(&q)[4], const int &k, const bool &exclude_zero_distance,
+		std::vector<std::pair<double, int> > &heap) const;
+	void _radius(const int &node_id, const double(&q)[4], const double &r2, std::vector<int> &result) const;
+	void _furthest(const int &node_id, const double(&q)[4], double &best_d2, int &best_index) const;
+	void _closest_to_distance(const int &node_id, const double(&q)[4], const double &dist,
+		double &best_residual, int &best_index) const;
+	static void _to_array(const Point &p, double(&q)[4]);
+
+public:
+	KD_Tree() {}
+	template <class T> KD_Tree(const std::vector<T> &pts) { build(pts); }
+	template <class T> void build(const std::vector<T> &pts);
+	int size() const { return (int)_indices.size(); }
+	bool empty() const { return _indices.empty(); }
+
+	// index of the closest point, -1 if there is none. exclude_index skips a
+	// point of the set itself, exclude_zero_distance skips any point collocated with p
+	int nearest_neighbour(const Point &p, const int &exclude_index = -1, const bool &exclude_zero_distance = false) const;
+	// indices of the k closest points sorted closest to furthest
+	std::vector<int> k_nearest_neighbours(const Point &p, const int &k, const bool &exclude_zero_distance = false) const;
+	// indices (unsorted) of all points within radius of p (inclusive)
+	std::vector<int> points_within_radius(const Point &p, const double &radius) const;
+	// index of the furthest point, -1 if the tree is empty
+	int furthest_neighbour(const Point &p, double &distance) const;
+	// index of the point whose distance to p is closest to dist
+	int closest_to_distance(const Point &p, const double &dist) const;
+};
+
+template <class T>
+void KD_Tree::build(const std::vector<T> &pts)
+{
+	int n = (int)pts.size();
+	_coords.resize(4 * n);
+	_indices.resize(n);
+	_nodes.clear();
+	for (int j = 0; j < n; j++) {
+		_coords[4 * j] = pts[j].x();
+		_coords[4 * j + 1] = pts[j].y();
+		_coords[4 * j + 2] = pts[j].z();
+		_coords[4 * j + 3] = pts[j].c();
+		_indices[j] = j;
+	}
+	if (n != 0) {
+		_nodes.reserve(2 * (n / 8 + 1));
+		_build_node(0, n);
+	}
+}
+
+#endif
@@ -0,0 +1,154 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <mapped_file.h>
+
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Mapped_File::Mapped_File() : _data(nullptr), _size(0), _mapped(false)
+{
+#ifdef _WIN32
+	_file_handle = INVALID_HANDLE_VALUE;
+	_mapping_handle = nullptr;
+#endif
+}
+
+bool Mapped_File::open(const std::string &path)
+{
+	close();
+	if (_map(path))
+		return true;
+	return _read(path);
+}
+
+void Mapped_File::close()
+{
+	if (_mapped) {
+#ifdef _WIN32
+		UnmapViewOfFile(_data);
+		CloseHandle((HANDLE)_mapping_handle);
+		CloseHandle((HANDLE)_file_handle);
+		_mapping_handle = nullptr;
+		_file_handle = INVALID_HANDLE_VALUE;
+#else
+		munmap(const_cast<unsigned char *>(_data), _size);
+#endif
+	}
+	_buffer.clear();
+	_buffer.shrink_to_fit();
+	_data = nullptr;
+	_size = 0;
+	_mapped = false;
+}
+
+bool Mapped_File::_map(const std::string &path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	_file_handle = file;
+	_mapping_handle = mapping;
+	_data = static_cast<const unsigned char *>(view);
+	_size = (std::size_t)file_size.QuadPart;
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat file_status;
+	if (fstat(fd, &file_status) != 0 || file_status.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+	void *view = mmap(nullptr, (std::size_t)file_status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+	if (view == MAP_FAILED)
+		return false;
+	_data = static_cast<const unsigned char *>(view);
+	_size = (std::size_t)file_status.st_size;
+#endif
+	_mapped = true;
+	return true;
+}
+
+bool Mapped_File::_read(const std::string &path)
+{
+	std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	std::streamoff file_size = file.tellg();
+	if (file_size <= 0)
+		return false;
+	_buffer.resize(((std::size_t)file_size + sizeof(unsigned long long) - 1) / sizeof(unsigned long long));
+	file.seekg(0, std::ios::beg);
+	if (!file.read(reinterpret_cast<char *>(_buffer.data()), file_size)) {
+		_buffer.clear();
+		return false;
+	}
+	_data = reinterpret_cast<const unsigned char *>(_buffer.data());
+	_size = (std::size_t)file_size;
+	return true;
+}
@@ -0,0 +1,76 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef mapped_file_h
+#define mapped_file_h
+
+#include <surfe_lib_module.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read only view of a whole file. The file is memory mapped where the platform
+// supports it, otherwise it is read into an 8 byte aligned buffer
+class SURFE_LIB_EXPORT Mapped_File {
+private:
+	const unsigned char *_data;
+	std::size_t _size;
+	bool _mapped;
+	std::vector<unsigned long long> _buffer;  // fallback storage
+#ifdef _WIN32
+	void *_file_handle;
+	void *_mapping_handle;
+#endif
+	bool _map(const std::string &path);
+	bool _read(const std::string &path);
+	// not copyable, owns the mapping
+	Mapped_File(const Mapped_File &);
+	Mapped_File &operator=(const Mapped_File &);
+
+public:
+	Mapped_File();
+	~Mapped_File() { close(); }
+	// returns false if the file can not be opened or is empty
+	bool open(const std::string &path);
+	void close();
+	const unsigned char *data() const { return _data; }
+	std::size_t size() const { return _size; }
+	bool is_mapped() const { return _mapped; }
+};
+
+#endif
@@ -146,7 +146,7 @@ bool Quadratic_Predictor_Corrector::solve()
 
 	if (!Math_methods::quadratic_solver(_hessian_matrixD, _equality_matrixD,
 		_inequality_matrixD, _equality_vectorD,
-		_inequality_vectorD, fvalues))
+		_inequality_vectorD, fvalues, iteration_callback))
 		return false;
 
 	// weights = _convert_mpf_vector_2_double(fvalues);
@@ -169,7 +169,7 @@ bool Quadratic_Predictor_Corrector_LOQO::solve() {
 	int n = (int)_H.rows();
 
 	VectorXd w(n);
-	if (!Math_methods::quadratic_solver_loqo(_H, _A, _b, _r, w)) return false;
+	if (!Math_methods::quadratic_solver_loqo(_H, _A, _b, _r, w, iteration_callback)) return false;
 
 	weights = w;
 
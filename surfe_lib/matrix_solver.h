@@ -40,6 +40,8 @@
 #ifndef matrix_solver_h
 #define matrix_solver_h
 
+#include <math_methods.h>
+
 #include <Eigen/Core>
 #include <fstream>
 #include <iomanip>
@@ -54,6 +56,7 @@ public:
 	System_Solver() {}
 	virtual ~System_Solver() {}
 	VectorXd weights;
+	Iteration_Callback iteration_callback;  // progress/cancellation of iterative solvers
 	virtual bool solve() = 0;
 	virtual bool validate_matrix_systems() = 0;
 	// virtual bool validate_constraint_vectors() = 0;
@@ -38,7 +38,9 @@
 // WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <basis.h>
+#include <center_selection.h>
 #include <continuous_property.h>
+#include <fused_evaluator.h>
 #include <lajaunie.h>
 #include <math_methods.h>
 #include <matrix_solver.h>
@@ -47,9 +49,11 @@
 #include <stratigraphic_surfaces.h>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <time.h>
 #include <vector>
 
@@ -184,23 +188,186 @@ bool GRBF_Modelling_Methods::_update_interface_iso_values() {
 	return true;
 }
 
-void GRBF_Modelling_Methods::remove_collocated_constraints()
+void GRBF_Modelling_Methods::_get_interface_reference_values(const std::vector<Interface> &interface_pts, std::vector<double> &reference_values)
 {
-	std::sort(constraints.inequality.begin(), constraints.inequality.end());
-	auto ie_unique_end = std::unique(constraints.inequality.begin(), constraints.inequality.end(), collocated);
-	constraints.inequality.erase(ie_unique_end, constraints.inequality.end());
+	// default: the interpolant should reproduce the level property
+	reference_values.resize(interface_pts.size());
+	for (int j = 0; j < (int)interface_pts.size(); j++)
+		reference_values[j] = interface_pts[j].level();
+}
+
+void GRBF_Modelling_Methods::_get_interface_reference_values_from_test_points(const std::vector<Interface> &interface_pts, std::vector<double> &reference_values)
+{
+	// interface points are used as increment constraints so the scalar field
+	// value of an interface is not known a priori. Evaluate the interpolant once
+	// at each interface_test_point here, instead of once per residual.
+	std::vector<Interface> test_points(interface_test_points);
+	eval_scalar_interpolant_at_points(test_points);
+
+	reference_values.resize(interface_pts.size());
+	for (int j = 0; j < (int)interface_pts.size(); j++) {
+		reference_values[j] = interface_pts[j].level();
+		for (const auto &test_point : test_points) {
+			if (test_point.level() == interface_pts[j].level()) {
+				reference_values[j] = test_point.scalar_field();  // this is the value it should be
+				break;
+			}
+		}
+	}
+}
+
+void GRBF_Modelling_Methods::_assemble_rows(const int &n_rows, const std::function<void(const int &row, Kernel *lane_kernel)> &assemble_row)
+{
+	parallel_for(n_rows, 8, [&](const int &begin, const int &end) {
+		std::unique_ptr<Kernel> lane_kernel(kernel->clone());
+		for (int j = begin; j < end; j++) {
+			_advance_assembly();
+			assemble_row(j, lane_kernel.get());
+		}
+	});
+}
+
+bool GRBF_Modelling_Methods::measure_residuals(Constraints &input)
+{
+	if (solver == nullptr) return false;
+
+	int n_ie = (int)input.inequality.size();
+	int n_i = (int)input.itrface.size();
+	int n_p = (int)input.planar.size();
+
+	std::vector<double> interface_reference_values;
+	_get_interface_reference_values(input.itrface, interface_reference_values);
+
+	// every constraint location in one fused pass (see Fused_Evaluator)
+	std::vector<Point> pts = convert_constraints_to_points(input);
+	MatrixXd locations((int)pts.size(), 3);
+	for (int j = 0; j < (int)pts.size(); j++)
+		locations.row(j) << pts[j].x(), pts[j].y(), pts[j].z();
+	MatrixXd values, gradients;
+	Fused_Evaluator evaluator(this);
+	evaluator.EvaluateInterpolantsAndGradientsAtPoints(locations, values, gradients);
+
+	// inequality points
+	for (int j = 0; j < n_ie; j++) {
+		Inequality &inequality_pt = input.inequality[j];
+		inequality_pt.set_scalar_field(values(j, 0));
+		if (inequality_pt.level() >= 0)
+			inequality_pt.setResidual(inequality_pt.scalar_field() >= 0);
+		else
+			inequality_pt.setResidual(inequality_pt.scalar_field() < 0);
+	}
+	// interface points
+	for (int k = 0; k < n_i; k++) {
+		Interface &interface_pt = input.itrface[k];
+		interface_pt.set_scalar_field(values(n_ie + k, 0));
+		interface_pt.setResidual(std::abs(interface_pt.scalar_field() - interface_reference_values[k]));
+	}
+	// planar points
+	for (int k = 0; k < n_p; k++) {
+		Planar &planar_pt = input.planar[k];
+		const int row = n_ie + n_i + k;
+		planar_pt.set_vector_field(gradients(row, 0), gradients(row, 1), gradients(row, 2));
+		double v1[3] = { planar_pt.nx(), planar_pt.ny(), planar_pt.nz() };
+		double v2[3] = { planar_pt.nx_interp(), planar_pt.ny_interp(), planar_pt.nz_interp() };
+		double angle = 0.0;
+		Math_methods::angle_btw_2_vectors(v1, v2, angle);
+		planar_pt.setResidual(angle);
+	}
+	// tangent points
+	for (int k = 0; k < (int)input.tangent.size(); k++) {
+		Tangent &tangent_pt = input.tangent[k];
+		const int row = n_ie + n_i + n_p + k;
+		tangent_pt.set_vector_field(gradients(row, 0), gradients(row, 1), gradients(row, 2));
+		double v1[3] = { tangent_pt.tx(), tangent_pt.ty(), tangent_pt.tz() };
+		double v2[3] = { tangent_pt.nx_interp(), tangent_pt.ny_interp(), tangent_pt.nz_interp() };
+		double angle = 0.0;
+		Math_methods::angle_btw_2_vectors(v1, v2, angle);
+		tangent_pt.setResidual(angle);
+	}
+
+	return true;
+}
+
+void GRBF_Modelling_Methods::decluster_constraints()
+{
+	if (!parameters.use_declustering)
+		return;
+	if (parameters.decluster_spacing <= 0)
+		throw GRBF_Exceptions::invalid_decluster_spacing;
+
+	int n_itr = (int)constraints.itrface.size();
+	int n_p = (int)constraints.planar.size();
+	int n_t = (int)constraints.tangent.size();
+
+	double spacing = parameters.decluster_spacing;
+	Parameter_Types::DeclusterMethod method = parameters.decluster_method;
+	int n_itr_kept = decluster_interface_constraints(constraints.itrface, spacing, method);
+	int n_p_kept = decluster_planar_constraints(constraints.planar, spacing, method);
+	int n_t_kept = decluster_tangent_constraints(constraints.tangent, spacing, method);
+
+	std::cout << " Declustered constraints (kept/input): " << std::endl;
+	std::cout << "	interface: " << n_itr_kept << "/" << n_itr << std::endl;
+	std::cout << "	planar: " << n_p_kept << "/" << n_p << std::endl;
+	std::cout << "	tangent: " << n_t_kept << "/" << n_t << std::endl;
+}
+
+int GRBF_Modelling_Methods::select_centers()
+{
+	int n_input = (int)(constraints.itrface.size() + constraints.planar.size() + constraints.tangent.size());
+	if (!parameters.use_center_selection)
+		return n_input;
+	if (parameters.max_centers <= 0)
+		throw GRBF_Exceptions::invalid_max_centers;
+
+	std::unique_ptr<RBFKernel> selection_kernel;
+	try
+	{
+		selection_kernel.reset(create_rbf_kernel(parameters.basis_type, parameters.model_global_anisotropy));
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Exception: " << e.what() << " occurred. " << std::endl;
+		std::throw_with_nested(GRBF_Exceptions::failure_setting_up_basis_functions);
+	}
+
+	Center_Selection selection(constraints, selection_kernel.get(), parameters.polynomial_order, parameters.center_selection_method);
+	int n_selected = selection.select(parameters.max_centers, parameters.center_selection_tolerance);
 
-	std::sort(constraints.itrface.begin(), constraints.itrface.end());
-	auto itr_unique_end = std::unique(constraints.itrface.begin(), constraints.itrface.end(), collocated);
-	constraints.itrface.erase(itr_unique_end, constraints.itrface.end());
+	// constraints is the working copy solved by this method (see Surfe_API),
+	// the selected centers replace it
+	Constraints selected;
+	selection.get_selected_constraints(constraints, selected);
+	constraints = selected;
+
+	if (parameters.center_selection_method == Parameter_Types::PGreedy)
+		std::cout << " P-greedy center selection kept " << n_selected << "/" << n_input
+		<< " constraints. Max power function: " << selection.max_power_function() << std::endl;
+	else
+		std::cout << " f-greedy center selection kept " << n_selected << "/" << n_input
+		<< " constraints. Max residual: " << selection.max_residual() << std::endl;
+	if (n_selected > parameters.max_centers)
+		std::cout << " The unisolvent and interface seed constraints exceed max_centers, all of them are kept" << std::endl;
 
-	std::sort(constraints.planar.begin(), constraints.planar.end());
-	auto p_unique_end = std::unique(constraints.planar.begin(), constraints.planar.end(), collocated);
-	constraints.planar.erase(p_unique_end, constraints.planar.end());
+	return n_selected;
+}
+
+int GRBF_Modelling_Methods::remove_collocated_constraints()
+{
+	int n_ie_removed = remove_collocated_duplicates(constraints.inequality);
+	int n_itr_removed = remove_collocated_duplicates(constraints.itrface);
+	int n_p_removed = remove_collocated_duplicates(constraints.planar);
+	int n_t_removed = remove_collocated_duplicates(constraints.tangent);
+
+	int n_removed = n_ie_removed + n_itr_removed + n_p_removed + n_t_removed;
+	if (n_removed != 0) {
+		std::cout << " Collocated constraints merged: " << std::endl;
+		std::cout << "	inequality: " << n_ie_removed << std::endl;
+		std::cout << "	interface: " << n_itr_removed << std::endl;
+		std::cout << "	planar: " << n_p_removed << std::endl;
+		std::cout << "	tangent: " << n_t_removed << std::endl;
+	}
 
-	std::sort(constraints.tangent.begin(), constraints.tangent.end());
-	auto t_unique_end = std::unique(constraints.tangent.begin(), constraints.tangent.end(), collocated);
-	constraints.tangent.erase(t_unique_end, constraints.tangent.end());
+	return n_removed;
 }
 
 void GRBF_Modelling_Methods::setup_basis_functions() {
@@ -391,6 +558,14 @@ GRBF_Modelling_Methods* GRBF_Modelling_Methods::get_method(const Parameters& m_p
 		return new Continuous_Property(m_parameters);
 }
 
+Iteration_Callback GRBF_Modelling_Methods::_solver_iteration_callback()
+{
+	if (!status)
+		return Iteration_Callback();
+	Compute_Status *s = status;
+	return [s](const int &iteration) { s->set_solver_iteration(iteration); };
+}
+
 bool GRBF_Modelling_Methods::run_greedy_algorithm() {
 	// check if there are non-zero errors permitted on the data
 	if (parameters.interface_uncertainty == 0 && parameters.angular_uncertainty == 0)
@@ -410,10 +585,14 @@ bool GRBF_Modelling_Methods::run_greedy_algorithm() {
 	greedy_input.SetPlanarAvgNNDist(greedy_method->constraints.GetPlanarAvgNNDist());
 	greedy_input.SetTangentAvgNNDist(greedy_method->constraints.GetTangentAvgNNDist());
 	greedy_method->constraints = greedy_input;
+	greedy_method->status = status;
 
 	bool converged = false;
 	int iter = 0;
 	while (!converged) {
+		if (status)
+			status->set_greedy_iteration(iter, (int)(excluded_input.inequality.size() + excluded_input.itrface.size() +
+			                                         excluded_input.planar.size() + excluded_input.tangent.size()));
 		// run normal algorithm
 		try
 		{
@@ -441,6 +620,8 @@ bool GRBF_Modelling_Methods::run_greedy_algorithm() {
 		{
 			std::cout << e.what() << std::endl;
 		}
+		// a cancellation is not a failure of this iteration, it ends the run
+		if (status) status->check_cancelled();
 
 		// measure residuals
 		if (!greedy_method->measure_residuals(excluded_input)) return false;
@@ -466,4 +647,94 @@ bool GRBF_Modelling_Methods::run_greedy_algorithm() {
 	// 		std::vector<double>(greedy_method->constraints.interface_iso_values);
 
 	return true;
+}
+
+// L[K(x, .)] of one evaluation term for a plain rbf kernel
+static double _rbf_term_value(RBFKernel *rbf, Point &x, Evaluation_Term &term)
+{
+	rbf->set_points(x, term.p);
+	if (term.type == Evaluation_Term::Value)
+		return rbf->basis();
+	if (term.type == Evaluation_Term::Derivative)
+		return term.q.x() * rbf->dx_p2() + term.q.y() * rbf->dy_p2() + term.q.z() * rbf->dz_p2();
+	double v = rbf->basis();
+	rbf->set_points(x, term.q);
+	return v - rbf->basis();
+}
+
+// L[p_j] of one evaluation term for the lagrangian basis polynomials
+static VectorXd _lagrangian_term_value(Lagrangian_Polynomial_Basis *lpb, Evaluation_Term &term)
+{
+	if (term.type == Evaluation_Term::Value)
+		return lpb->poly(&term.p);
+	if (term.type == Evaluation_Term::Derivative)
+		return term.q.x() * lpb->poly_dx(&term.p) + term.q.y() * lpb->poly_dy(&term.p) + term.q.z() * lpb->poly_dz(&term.p);
+	return lpb->poly(&term.p) - lpb->poly(&term.q);
+}
+
+void GRBF_Modelling_Methods::_fold_modified_kernel_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients)
+{
+	// Expanding the modified kernel (see Modified_Kernel::basis_pt_pt) the
+	// interpolant becomes
+	//   s(x) = R(x) - sum_j B_j K(x, u_j) + sum_j p_j(x) C_j
+	// with R the plain rbf sum, u_j the unisolvent points, p_j the lagrangian
+	// polynomials, B_j = sum_k w_k L_k[p_j] and
+	//   C_j = -R(u_j) + B_j + sum_{k != j} B_k K(u_j, u_k)
+	Modified_Kernel *m_kernel = dynamic_cast<Modified_Kernel *>(kernel);
+	if (!m_kernel)
+		return;
+	RBFKernel *rbf = m_kernel->rbf_kernel()->clone();
+	Lagrangian_Polynomial_Basis *lpb = m_kernel->lagrangian_basis();
+	std::vector<Interface> &u = lpb->unisolvent_subset_points;
+
+	VectorXd B = VectorXd::Zero(4);
+	VectorXd R = VectorXd::Zero(4);
+	for (int k = 0; k < (int)terms.size(); k++) {
+		B += terms[k].weight * _lagrangian_term_value(lpb, terms[k]);
+		for (int j = 0; j < 4; j++)
+			R(j) += terms[k].weight * _rbf_term_value(rbf, u[j], terms[k]);
+	}
+
+	const VectorXd &constants = lpb->polynomial_constants();
+	for (int j = 0; j < 4; j++) {
+		double c = -R(j) + B(j);
+		for (int k = 0; k < 4; k++) {
+			if (k != j) {
+				rbf->set_points(u[j], u[k]);
+				c += B(k) * rbf->basis();
+			}
+		}
+		// p_j(x) = constants[4j] + constants[4j+1] x + constants[4j+2] y + constants[4j+3] z
+		monomial_coefficients(9) += c * constants(4 * j);
+		monomial_coefficients(6) += c * constants(4 * j + 1);
+		monomial_coefficients(7) += c * constants(4 * j + 2);
+		monomial_coefficients(8) += c * constants(4 * j + 3);
+	}
+	for (int j = 0; j < 4; j++)
+		terms.push_back(Evaluation_Term(Evaluation_Term::Value, -B(j), u[j], u[j]));
+	delete rbf;
+}
+
+void GRBF_Modelling_Methods::get_rbf_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients)
+{
+	terms.clear();
+	get_evaluation_terms(terms, monomial_coefficients);
+	if (intern_params.modified_basis)
+		_fold_modified_kernel_terms(terms, monomial_coefficients);
+}
+
+void GRBF_Modelling_Methods::get_rbf_evaluation_kernel(double kernel_values[12])
+{
+	const bool anisotropic = parameters.model_global_anisotropy && rbf_kernel;
+	kernel_values[0] = (double)parameters.basis_type;
+	kernel_values[1] = parameters.shape_parameter;
+	kernel_values[2] = anisotropic ? 1.0 : 0.0;
+	Matrix3f transform = Matrix3f::Identity();
+	if (anisotropic) {
+		double plunge[3];
+		rbf_kernel->get_anisotropy_transform(plunge, transform);
+	}
+	for (int j = 0; j < 3; j++)
+		for (int k = 0; k < 3; k++)
+			kernel_values[3 + 3 * j + k] = transform(j, k);
 }
\ No newline at end of file
@@ -44,14 +44,35 @@
 #include <grbf_exceptions.h>
 #include <basis.h>
 #include <matrix_solver.h>
+#include <compute_status.h>
+#include <task_scheduler.h>
+
+#include <functional>
 
-#include <omp.h>
 
 using namespace Eigen;
 
+// One term of the interpolant written as a flat sum over centers
+//   s(x) = sum_k weight_k * L_k[K(x, .)] + polynomial(x)
+// Used to export the interpolant to evaluators without the modelling methods
+struct Evaluation_Term {
+	enum Type {
+		Value,       // K(x, p)
+		Derivative,  // q . grad_p K(x, p), q is a direction
+		Increment    // K(x, p) - K(x, q)
+	};
+	Type type;
+	double weight;
+	Point p;
+	Point q;
+	Evaluation_Term(const Type &term_type, const double &w, const Point &pt, const Point &second)
+		: type(term_type), weight(w), p(pt), q(second) {}
+};
+
 // Abstract base class
 class GRBF_Modelling_Methods {
 private:
+	friend class Interpolant_Snapshot;  // stores/restores the solved state
 	void _get_distinct_interface_iso_values();
 	void _get_interface_points();
 	std::vector<double> _get_distinct_inequality_iso_values();
@@ -80,8 +101,25 @@ protected:
 	// for iso surface extraction
 	bool _output_greedy_debug_objects();
 	void _SetIteration(const int &iter) { _iteration = iter; }
+	// scalar field value each interface point residual is measured against.
+	// Called once, before the fused residual pass in measure_residuals()
+	virtual void _get_interface_reference_values(const std::vector<Interface> &interface_pts, std::vector<double> &reference_values);
+	// for increment based methods (Lajaunie, Stratigraphic) - the reference is the interpolant @ the interface_test_point with the same level
+	void _get_interface_reference_values_from_test_points(const std::vector<Interface> &interface_pts, std::vector<double> &reference_values);
+	// progress reporting and cooperative cancellation hooks. No-ops if status is nullptr
+	void _begin_assembly(const long long &n_rows) { if (status) status->begin_assembly(n_rows); }
+	void _advance_assembly() { if (status) status->advance_assembly(); }
+	// calls assemble_row(j, lane_kernel) for the interpolation matrix rows j in
+	// [0, n_rows) of one constraint type, in parallel. set_points() changes the
+	// kernel so every lane works with its own copy of it
+	void _assemble_rows(const int &n_rows, const std::function<void(const int &row, Kernel *lane_kernel)> &assemble_row);
+	Iteration_Callback _solver_iteration_callback();
+	// folds the lagrangian terms of a modified kernel into extra centers and the
+	// linear monomial coefficients
+	void _fold_modified_kernel_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients);
 
 public:
+	GRBF_Modelling_Methods() : status(nullptr) {}
 	// Destructor
 	virtual ~GRBF_Modelling_Methods() {}
 	// Methods
@@ -89,7 +127,9 @@ public:
 	RBFKernel *create_rbf_kernel(const Parameter_Types::RBF &rbf_type, const bool &anisotropy);
 	std::vector<Interface> get_interface_points_ouput() const { return constraints.itrface; }
 	Constraints constraints;// algorithm input
-	void remove_collocated_constraints(); // cleaning method to ensure valid interpolation matrix
+	int remove_collocated_constraints(); // cleaning method to ensure valid interpolation matrix. Returns # of constraints removed
+	void decluster_constraints(); // thins dense interface, planar and tangent constraints if parameters.use_declustering
+	int select_centers(); // replaces constraints by a P/f-greedy subset if parameters.use_center_selection. Returns # of constraints kept
 	std::vector<double> get_interface_iso_values() const { return interface_iso_values; }
 	void setup_basis_functions();
 	bool check_interpolant();
@@ -103,10 +143,24 @@ public:
 	virtual void process_input_data() = 0;
 	virtual void setup_system_solver() = 0;
 	virtual bool get_minimial_and_excluded_input(Constraints &greedy_input, Constraints &excluded_input) = 0;
-	virtual bool measure_residuals(Constraints &input) = 0;
+	virtual bool measure_residuals(Constraints &input);
 	virtual bool append_greedy_input(Constraints &input) = 0;
 	virtual bool convert_modified_kernel_to_rbf_kernel() = 0;
 	virtual GRBF_Modelling_Methods *clone() = 0;
+	// polynomial basis used by the evaluation methods. Normally created while
+	// assembling the interpolation matrix, needed when restoring a snapshot
+	virtual void prepare_polynomial_basis() {}
+	// terms (see Evaluation_Term) of the solved interpolant using the modelling
+	// method's kernel, monomial_coefficients: xx, yy, zz, xy, xz, yz, x, y, z, 1
+	virtual void get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) = 0;
+	// same with the terms of a modified kernel expressed with the plain rbf_kernel
+	void get_rbf_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients);
+	// kernel of those terms: rbf type, shape parameter, anisotropic (0/1) and
+	// the row major anisotropy transform (identity when isotropic)
+	void get_rbf_evaluation_kernel(double kernel_values[12]);
+	// batch evaluation - one parallel pass over many points
+	template <class T> void eval_scalar_interpolant_at_points(std::vector<T> &pts);
+	template <class T> void eval_vector_interpolant_at_points(std::vector<T> &pts);
 	// Attributes
 	Parameters parameters;  // QT GUI parameters
 	System_Solver *solver;
@@ -114,6 +168,27 @@ public:
 	RBFKernel *rbf_kernel;
 	std::string error_msg;
 	std::vector<Interface> interface_test_points;
+	Compute_Status *status;  // set while Surfe_API computes the interpolant
 };
 
+template <class T>
+void GRBF_Modelling_Methods::eval_scalar_interpolant_at_points(std::vector<T> &pts)
+{
+	int n = (int)pts.size();
+	parallel_for(n, 64, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			eval_scalar_interpolant_at_point(pts[j]);
+	});
+}
+
+template <class T>
+void GRBF_Modelling_Methods::eval_vector_interpolant_at_points(std::vector<T> &pts)
+{
+	int n = (int)pts.size();
+	parallel_for(n, 64, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			eval_vector_interpolant_at_point(pts[j]);
+	});
+}
+
 #endif
@@ -42,8 +42,13 @@
 #include <math_methods.h>
 #include <modeling_methods.h>
 #include <modelling_input.h>
+#include <kd_tree.h>
+#include <task_scheduler.h>
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <tuple>
+#include <unordered_map>
 
 // DBL_MAX/DBL_MIN didn't work with gcc 7 on ubuntu so manually defining
 // if it doesnt exist
@@ -80,17 +85,11 @@ double Constraints::compute_tangent_avg_nn_distance()
 
 void Constraints::compute_avg_nn_distances()
 {
-#pragma omp parallel sections
-	{
-#pragma omp section
-		{ _avg_nn_dist_ie = compute_inequality_avg_nn_distance(); }
-#pragma omp section
-		{ _avg_nn_dist_itr = compute_interface_avg_nn_distance(); }
-#pragma omp section
-		{ _avg_nn_dist_p = compute_planar_avg_nn_distance(); }
-#pragma omp section
-		{ _avg_nn_dist_t = compute_tangent_avg_nn_distance(); }
-	}
+	// each of these is a parallel loop over the points of one constraint type
+	_avg_nn_dist_ie = compute_inequality_avg_nn_distance();
+	_avg_nn_dist_itr = compute_interface_avg_nn_distance();
+	_avg_nn_dist_p = compute_planar_avg_nn_distance();
+	_avg_nn_dist_t = compute_tangent_avg_nn_distance();
 }
 
 bool Planar::_compute_strike_dip_polarity_from_normal()
@@ -309,33 +308,22 @@ int nearest_neighbour_index(const Point &p, const std::vector<Point> &pts)
 
 	return index;
 }
-std::vector<int> get_n_nearest_neighbours_to_point(const int &n, const Point &p, const std::vector<Point> &pts) {
-	std::vector<int> nn_indices;
 
-	int n_pts = (int)pts.size();
-
-	// calculate all non-zero distances + create index array
-	std::vector<double> dist_arr;
-	std::vector<int> index_arr;
-	for (int j = 0; j < (int)pts.size(); j++) {
-		double distance = distance_btw_pts(p, pts[j]);
-		if (distance != 0)
-		{
-			dist_arr.push_back(distance);
-			index_arr.push_back(j);
-		}
-	}
-	// sort distances and corresponding indices
-	Math_methods::sort_vector_w_index(dist_arr, index_arr);  // smallest to largest
+int nearest_neighbour_index(const Point &p, const KD_Tree &tree)
+{
+	// skip zero distances in case p is in the set of pts
+	return tree.nearest_neighbour(p, -1, true);
+}
 
-	if (n <= n_pts)
-		for (int j = 0; j < n; j++)
-			nn_indices.push_back(index_arr[j]);
-	else
-		for (int j = 0; j < n_pts; j++)
-			nn_indices.push_back(index_arr[j]);  // will return less than n nn index. best option vs getting seg fault
+std::vector<int> get_n_nearest_neighbours_to_point(const int &n, const Point &p, const std::vector<Point> &pts) {
+	KD_Tree tree(pts);
+	return get_n_nearest_neighbours_to_point(n, p, tree);
+}
 
-	return nn_indices;
+std::vector<int> get_n_nearest_neighbours_to_point(const int &n, const Point &p, const KD_Tree &tree) {
+	// closest to furthest, non-zero distances only. Will return less than n nn
+	// indices if there aren't enough points
+	return tree.k_nearest_neighbours(p, n, true);
 }
 
 int furtherest_neighbour_index(const Point &p, const std::vector<Point> &pts)
@@ -353,18 +341,45 @@ int furtherest_neighbour_index(const Point &p, const std::vector<Point> &pts)
 	return index;
 }
 
+int furtherest_neighbour_index(const Point &p, const KD_Tree &tree)
+{
+	double largest_distance = 0.0;
+	int index = tree.furthest_neighbour(p, largest_distance);
+	return index < 0 ? 0 : index;
+}
+
 int furtherest_neighbour_index(const std::vector<Point> &pts1, const std::vector<Point> &pts2) {
 	// find a point in PTS1 dataset that is furthest away from PTS2 dataset
+	int n = (int)pts1.size();
+	KD_Tree tree(pts2);
+	std::vector<double> furthest_distance(n, 0.0);
+	parallel_for(n, 64, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			tree.furthest_neighbour(pts1[j], furthest_distance[j]);
+	});
 
 	int index = 0;
 	double largest_distance = 0.0;
-	for (int j = 0; j < (int)pts1.size(); j++) {
-		for (int k = 0; k < (int)pts2.size(); k++) {
-			double distance_jk = distance_btw_pts(pts1[j], pts2[k]);
-			if (distance_jk > largest_distance) {
-				largest_distance = distance_jk;
-				index = j;
-			}
+	for (int j = 0; j < n; j++) {
+		if (furthest_distance[j] > largest_distance) {
+			largest_distance = furthest_distance[j];
+			index = j;
+		}
+	}
+	return index;
+}
+
+int furtherest_neighbour_index(const KD_Tree &tree1, const std::vector<Point> &pts2) {
+	// find a point in the TREE1 dataset that is furthest away from PTS2 dataset,
+	// one query per point of PTS2
+	int index = 0;
+	double largest_distance = 0.0;
+	for (const auto &p : pts2) {
+		double distance = 0.0;
+		int index_p = tree1.furthest_neighbour(p, distance);
+		if (index_p >= 0 && distance > largest_distance) {
+			largest_distance = distance;
+			index = index_p;
 		}
 	}
 	return index;
@@ -372,22 +387,22 @@ int furtherest_neighbour_index(const std::vector<Point> &pts1, const std::vector
 
 double avg_nn_distance(const std::vector<Point> &pts)
 {
-	double average_nn_distance = 0.0;
 	int n = (int)pts.size();
-	for (int j = 0; j < n; j++) {
-		double min_dist = DBL_MAX;
-		for (int k = 0; k < n; k++) {
-			if (k != j) {
-				double dist = distance_btw_pts(pts.at(j), pts.at(k));
-				if (dist < min_dist) min_dist = dist;
-			}
+	if (n <= 1) return 0.0;  // trap this edge case
+
+	KD_Tree tree(pts);
+	// summed in index order so the result does not depend on the # of threads
+	std::vector<double> nn_distance(n, 0.0);
+	parallel_for(n, 256, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++) {
+			int nn_index = tree.nearest_neighbour(pts[j], j);
+			nn_distance[j] = distance_btw_pts(pts[j], pts[nn_index]);
 		}
-		if (n == 1)
-			min_dist = 0;  // trap this edge case
-		average_nn_distance += min_dist;
-	}
-	if (n != 0)
-		average_nn_distance /= n;
+	});
+	double average_nn_distance = 0.0;
+	for (const auto &d : nn_distance)
+		average_nn_distance += d;
+	average_nn_distance /= n;
 	return average_nn_distance;
 }
 
@@ -395,11 +410,8 @@ bool spatial_metrics(const std::vector<Point> &pts, double &resolution, double &
 {
 	// remove collocated points if any exist
 	std::vector<Point> points = pts; // copy because we don't want to change original inputted data
-	std::sort(points.begin(), points.end());
-	auto unique_end = std::unique(points.begin(), points.end(), collocated);
-	points.erase(unique_end, points.end());
+	remove_collocated_duplicates(points);
 
-	double average_nearest_neighbor_distance = 0.0;
 	resolution = DBL_MAX;
 	xmin = DBL_MAX;
 	xmax = -DBL_MAX;
@@ -407,27 +419,18 @@ bool spatial_metrics(const std::vector<Point> &pts, double &resolution, double &
 	ymax = -DBL_MAX;
 	zmin = DBL_MAX;
 	zmax = -DBL_MAX;
-	int n = (int)points.size();
-	for (int j = 0; j < n; j++) {
-		double min_dist_j = DBL_MAX;
-		for (int k = 0; k < n; k++) {
-			if (k != j) {
-				double dist = distance_btw_pts(points[j], points[k]);
-				if (dist < min_dist_j) min_dist_j = dist;
-			}
-		}
-		if (n == 1)
-			min_dist_j = 0;  // trap this edge case
-		if (points[j].x() < xmin) xmin = points[j].x();
-		if (points[j].x() > xmax) xmax = points[j].x();
-		if (points[j].y() < ymin) ymin = points[j].y();
-		if (points[j].y() > ymax) ymax = points[j].y();
-		if (points[j].z() < zmin) zmin = points[j].z();
-		if (points[j].z() > zmax) zmax = points[j].z();
-		average_nearest_neighbor_distance += min_dist_j;
-	}
-	if (n != 0)
-		average_nearest_neighbor_distance /= n;
+	if (!points.empty()) {
+		double bounds[6];
+		calculate_bounds(points, bounds);
+		xmin = bounds[0];
+		xmax = bounds[1];
+		ymin = bounds[2];
+		ymax = bounds[3];
+		zmin = bounds[4];
+		zmax = bounds[5];
+	}
+
+	double average_nearest_neighbor_distance = avg_nn_distance(points);
 
 	resolution = average_nearest_neighbor_distance/2.0;
 
@@ -438,15 +441,29 @@ bool Find_STL_Vector_Indices_FurtherestTwoPoints(const std::vector<Point> &pts,
 {
 	if (pts.size() < 2) return false;
 
+	KD_Tree tree(pts);
+	return Find_STL_Vector_Indices_FurtherestTwoPoints(pts, tree, TwoIndexes);
+}
+
+bool Find_STL_Vector_Indices_FurtherestTwoPoints(const std::vector<Point> &pts, const KD_Tree &tree, int(&TwoIndexes)[2])
+{
+	int n = (int)pts.size();
+	if (n < 2) return false;
+
+	// furthest point from each point, then the pair with the largest separation
+	std::vector<int> furthest_index(n, -1);
+	std::vector<double> furthest_distance(n, 0.0);
+	parallel_for(n, 64, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			furthest_index[j] = tree.furthest_neighbour(pts[j], furthest_distance[j]);
+	});
+
 	double largest_distance = -DBL_MAX;
-	for (int j = 0; j < (int)pts.size(); j++) {
-		for (int k = 0; k < (int)pts.size(); k++) {
-			double distance_jk = distance_btw_pts(pts[j], pts[k]);
-			if (distance_jk > largest_distance) {
-				largest_distance = distance_jk;
-				TwoIndexes[0] = j;
-				TwoIndexes[1] = k;
-			}
+	for (int j = 0; j < n; j++) {
+		if (furthest_distance[j] > largest_distance) {
+			largest_distance = furthest_distance[j];
+			TwoIndexes[0] = j;
+			TwoIndexes[1] = furthest_index[j];
 		}
 	}
 
@@ -469,6 +486,11 @@ int Find_STL_Vector_Index_ofPointClosestToOtherPointWithinDistance(const Point &
 	return index;
 }
 
+int Find_STL_Vector_Index_ofPointClosestToOtherPointWithinDistance(const Point &p, const KD_Tree &tree, const double &dist)
+{
+	return tree.closest_to_distance(p, dist);
+}
+
 void calculate_bounds(const std::vector<Point> &pts, double(&bounds)[6])
 {
 	// bounds[6] = { xmin, xmax, ymin, ymax, zmin, zmax }
@@ -635,17 +657,310 @@ bool is_index_in_list(const int &index, const std::vector<int> &list)
 
 double get_largest_distance_between_points(const std::vector<Point> &pts)
 {
+	int n = (int)pts.size();
+	KD_Tree tree(pts);
+	std::vector<double> furthest_distance(n, 0.0);
+	parallel_for(n, 64, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			tree.furthest_neighbour(pts[j], furthest_distance[j]);
+	});
+
 	double largest_distance = 0.0;
-	for (const auto& pt_a : pts) {
-		for (const auto& pt_b : pts) {
-			double d = distance_btw_pts(pt_a, pt_b);
-			if (d > largest_distance)
-				largest_distance = d;
-		}
+	for (const auto &d : furthest_distance) {
+		if (d > largest_distance)
+			largest_distance = d;
 	}
 	return largest_distance;
 }
 
+std::vector<char> find_collocated_duplicates(const std::vector<Point> &pts)
+{
+	int n = (int)pts.size();
+	std::vector<char> duplicate(n, 0);
+	if (n < 2) return duplicate;
+
+	// collocated() is a per axis test with tolerance Epilson so collocated
+	// points always fall in the same or in adjacent cells of an Epilson grid
+	std::vector<long long> cell(3 * n);
+	parallel_for(n, 4096, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++) {
+			cell[3 * j] = (long long)floor(pts[j].x() / Epilson);
+			cell[3 * j + 1] = (long long)floor(pts[j].y() / Epilson);
+			cell[3 * j + 2] = (long long)floor(pts[j].z() / Epilson);
+		}
+	});
+	auto cell_key = [](const long long &i, const long long &j, const long long &k) {
+		return (unsigned long long)(i * 73856093LL) ^ (unsigned long long)(j * 19349663LL) ^ (unsigned long long)(k * 83492791LL);
+	};
+	// hash collisions only add candidates, collocated() makes the decision
+	std::unordered_map<unsigned long long, std::vector<int> > grid;
+	grid.reserve(n);
+	for (int j = 0; j < n; j++)
+		grid[cell_key(cell[3 * j], cell[3 * j + 1], cell[3 * j + 2])].push_back(j);
+
+	parallel_for(n, 256, [&](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++) {
+			for (int di = -1; di <= 1 && !duplicate[j]; di++) {
+				for (int dj = -1; dj <= 1 && !duplicate[j]; dj++) {
+					for (int dk = -1; dk <= 1 && !duplicate[j]; dk++) {
+						auto it = grid.find(cell_key(cell[3 * j] + di, cell[3 * j + 1] + dj, cell[3 * j + 2] + dk));
+						if (it == grid.end()) continue;
+						for (const auto &k : it->second) {
+							if (k >= j) break;  // cell lists are in ascending index order
+							if (collocated(pts[j], pts[k])) {
+								duplicate[j] = 1;
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+	});
+
+	return duplicate;
+}
+
+// Greedy selection of well separated points. The candidates are visited in
+// order and a candidate is accepted if no already accepted point is within
+// separation_distance of it. The first candidate is always accepted.
+// Only the accepted points are indexed, in a grid of separation_distance
+// cells: accepted points are at least that far apart, so each cell holds a
+// bounded # of them and a candidate is tested against the 27 cells around
+// it, however dense the candidates are.
+static std::vector<int> get_well_separated_candidates(const std::vector<Point> &candidate_pts, const double &separation_distance)
+{
+	std::vector<int> accepted;
+	int n = (int)candidate_pts.size();
+	if (n == 0) return accepted;
+	accepted.push_back(0);
+	if (std::isinf(separation_distance))
+		return accepted;
+	if (!(separation_distance >= 0)) {
+		// negative (or NaN) distance: no neighbours, every candidate is accepted
+		for (int j = 1; j < n; j++)
+			accepted.push_back(j);
+		return accepted;
+	}
+
+	// distance_btw_pts() also counts c, never less than the x, y, z distance,
+	// so every accepted point within separation_distance is in a neighbouring cell
+	const double cell_size = separation_distance > 0 ? separation_distance : 1.0;
+	auto cell_of = [&](const Point &p, long long(&cell)[3]) {
+		cell[0] = (long long)floor(p.x() / cell_size);
+		cell[1] = (long long)floor(p.y() / cell_size);
+		cell[2] = (long long)floor(p.z() / cell_size);
+	};
+	auto cell_key = [](const long long &i, const long long &j, const long long &k) {
+		return (unsigned long long)(i * 73856093LL) ^ (unsigned long long)(j * 19349663LL) ^ (unsigned long long)(k * 83492791LL);
+	};
+	// squared, as KD_Tree::points_within_radius compares them
+	auto within_separation = [&](const Point &p, const Point &q) {
+		double dx = p.x() - q.x();
+		double dy = p.y() - q.y();
+		double dz = p.z() - q.z();
+		double dc = p.c() - q.c();
+		return dx * dx + dy * dy + dz * dz + dc * dc <= separation_distance * separation_distance;
+	};
+	// hash collisions only add candidates, the distance makes the decision
+	std::unordered_map<unsigned long long, std::vector<int> > grid;
+	long long cell[3];
+	cell_of(candidate_pts[0], cell);
+	grid[cell_key(cell[0], cell[1], cell[2])].push_back(0);
+	for (int j = 1; j < n; j++) {
+		const Point &candidate = candidate_pts[j];
+		cell_of(candidate, cell);
+		bool well_separated = true;
+		for (int di = -1; di <= 1 && well_separated; di++) {
+			for (int dj = -1; dj <= 1 && well_separated; dj++) {
+				for (int dk = -1; dk <= 1 && well_separated; dk++) {
+					auto it = grid.find(cell_key(cell[0] + di, cell[1] + dj, cell[2] + dk));
+					if (it == grid.end()) continue;
+					for (const auto &k : it->second) {
+						if (within_separation(candidate, candidate_pts[k])) {
+							well_separated = false;
+							break;
+						}
+					}
+				}
+			}
+		}
+		if (well_separated) {
+			accepted.push_back(j);
+			grid[cell_key(cell[0], cell[1], cell[2])].push_back(j);
+		}
+	}
+	return accepted;
+}
+
+// Groups of points merged by declustering. For Poisson disk sampling the
+// first index of each group is the retained sample point
+static std::vector<std::vector<int> > get_decluster_groups(const std::vector<Point> &pts, const double &spacing, const Parameter_Types::DeclusterMethod &method)
+{
+	std::vector<std::vector<int> > groups;
+	int n = (int)pts.size();
+	if (n == 0) return groups;
+
+	if (method == Parameter_Types::PoissonDisk) {
+		std::vector<int> samples = get_well_separated_candidates(pts, spacing);
+		std::vector<Point> sample_pts;
+		groups.resize(samples.size());
+		std::vector<bool> is_sample(n, false);
+		for (int k = 0; k < (int)samples.size(); k++) {
+			sample_pts.push_back(pts[samples[k]]);
+			groups[k].push_back(samples[k]);
+			is_sample[samples[k]] = true;
+		}
+		// every other point is merged with its closest sample
+		KD_Tree sample_tree(sample_pts);
+		std::vector<int> closest_sample(n, -1);
+		parallel_for(n, 256, [&](const int &begin, const int &end) {
+			for (int j = begin; j < end; j++) {
+				if (!is_sample[j])
+					closest_sample[j] = sample_tree.nearest_neighbour(pts[j]);
+			}
+		});
+		for (int j = 0; j < n; j++) {
+			if (!is_sample[j])
+				groups[closest_sample[j]].push_back(j);
+		}
+	}
+	else {
+		// voxel grid
+		std::map<std::tuple<long long, long long, long long>, int> cell_group;
+		for (int j = 0; j < n; j++) {
+			std::tuple<long long, long long, long long> cell(
+				(long long)floor(pts[j].x() / spacing),
+				(long long)floor(pts[j].y() / spacing),
+				(long long)floor(pts[j].z() / spacing));
+			auto it = cell_group.find(cell);
+			if (it == cell_group.end()) {
+				cell_group[cell] = (int)groups.size();
+				groups.push_back(std::vector<int>(1, j));
+			}
+			else
+				groups[it->second].push_back(j);
+		}
+	}
+
+	return groups;
+}
+
+// position of the declustered constraint representing a group of points
+static Point get_decluster_group_location(const std::vector<Point> &pts, const std::vector<int> &group, const Parameter_Types::DeclusterMethod &method)
+{
+	if (method == Parameter_Types::PoissonDisk)
+		return pts[group[0]];
+
+	double centroid[4] = { 0.0, 0.0, 0.0, 0.0 };
+	for (const auto &index : group) {
+		centroid[0] += pts[index].x();
+		centroid[1] += pts[index].y();
+		centroid[2] += pts[index].z();
+		centroid[3] += pts[index].c();
+	}
+	for (int d = 0; d < 4; d++)
+		centroid[d] /= (double)group.size();
+	return Point(centroid[0], centroid[1], centroid[2], centroid[3]);
+}
+
+// average of the vectors in a group: direction of the vector sum, length of the mean length.
+// Tangents have no sense of direction so they are aligned to the first vector before summing
+static void get_decluster_group_vector(const std::vector<std::vector<double> > &vectors, const std::vector<int> &group, const bool &align_sense, double(&average)[3])
+{
+	double sum[3] = { 0.0, 0.0, 0.0 };
+	double mean_length = 0.0;
+	const std::vector<double> &ref = vectors[group[0]];
+	for (const auto &index : group) {
+		const std::vector<double> &v = vectors[index];
+		double sense = 1.0;
+		if (align_sense && v[0] * ref[0] + v[1] * ref[1] + v[2] * ref[2] < 0) sense = -1.0;
+		for (int d = 0; d < 3; d++)
+			sum[d] += sense * v[d];
+		mean_length += sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	}
+	mean_length /= (double)group.size();
+	double sum_length = sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+	for (int d = 0; d < 3; d++) {
+		if (sum_length > 0.0)
+			average[d] = sum[d] / sum_length * mean_length;
+		else
+			average[d] = ref[d];  // vectors cancel out, keep the first one
+	}
+}
+
+int decluster_interface_constraints(std::vector<Interface> &itrface, const double &spacing, const Parameter_Types::DeclusterMethod &method)
+{
+	if (spacing <= 0 || itrface.empty()) return (int)itrface.size();
+
+	// each level is thinned independently
+	std::map<double, std::vector<Point> > level_pts;
+	for (const auto &interface_pt : itrface)
+		level_pts[interface_pt.level()].push_back(interface_pt);
+
+	std::vector<Interface> declustered;
+	for (const auto &level : level_pts) {
+		const std::vector<Point> &pts = level.second;
+		for (const auto &group : get_decluster_groups(pts, spacing, method)) {
+			Point location = get_decluster_group_location(pts, group, method);
+			declustered.push_back(Interface(location.x(), location.y(), location.z(), level.first, location.c()));
+		}
+	}
+	itrface = declustered;
+
+	return (int)itrface.size();
+}
+
+int decluster_planar_constraints(std::vector<Planar> &planar, const double &spacing, const Parameter_Types::DeclusterMethod &method)
+{
+	if (spacing <= 0 || planar.empty()) return (int)planar.size();
+
+	std::vector<Point> pts(planar.begin(), planar.end());
+	std::vector<std::vector<double> > normals;
+	for (const auto &planar_pt : planar)
+		normals.push_back({ planar_pt.nx(), planar_pt.ny(), planar_pt.nz() });
+
+	std::vector<Planar> declustered;
+	for (const auto &group : get_decluster_groups(pts, spacing, method)) {
+		if (group.size() == 1) {
+			declustered.push_back(planar[group[0]]);
+			continue;
+		}
+		Point location = get_decluster_group_location(pts, group, method);
+		double normal[3];
+		get_decluster_group_vector(normals, group, false, normal);
+		declustered.push_back(Planar(location.x(), location.y(), location.z(), normal[0], normal[1], normal[2], location.c()));
+	}
+	planar = declustered;
+
+	return (int)planar.size();
+}
+
+int decluster_tangent_constraints(std::vector<Tangent> &tangent, const double &spacing, const Parameter_Types::DeclusterMethod &method)
+{
+	if (spacing <= 0 || tangent.empty()) return (int)tangent.size();
+
+	std::vector<Point> pts(tangent.begin(), tangent.end());
+	std::vector<std::vector<double> > vectors;
+	for (const auto &tangent_pt : tangent)
+		vectors.push_back({ tangent_pt.tx(), tangent_pt.ty(), tangent_pt.tz() });
+
+	std::vector<Tangent> declustered;
+	for (const auto &group : get_decluster_groups(pts, spacing, method)) {
+		if (group.size() == 1) {
+			declustered.push_back(tangent[group[0]]);
+			continue;
+		}
+		Point location = get_decluster_group_location(pts, group, method);
+		double vector[3];
+		get_decluster_group_vector(vectors, group, true, vector);
+		declustered.push_back(Tangent(location.x(), location.y(), location.z(), vector[0], vector[1], vector[2], location.c()));
+	}
+	tangent = declustered;
+
+	return (int)tangent.size();
+}
+
 std::vector<int> Get_Inequality_STL_Vector_Indices_With_Large_Residuals(
 	const std::vector<Inequality> &inequality, const double &avg_nn_distance)
 {
@@ -657,37 +972,18 @@ std::vector<int> Get_Inequality_STL_Vector_Indices_With_Large_Residuals(
 	std::vector<int> inequality_indices_to_include;  // what we are going to
 	// function on function exit
 
-	double Large_distance = DBL_MAX;
-
 	std::vector<int> inequality_residuals_indices;
+	std::vector<Point> inequality_residuals_pts;
 	for (int j = 0; j < (int)inequality.size(); j++) {
-		if (!inequality.at(j).residual())
+		if (!inequality.at(j).residual()) {
 			inequality_residuals_indices.push_back(j);
-	}
-	if (!inequality_residuals_indices.empty()) {
-		// Will always accept the first residual over the threshold
-		inequality_indices_to_include.push_back(inequality_residuals_indices[0]);
-		inequality_residuals_indices.pop_back();
-
-		for (const auto &index : inequality_residuals_indices) {
-			// find closest point currently in inequality_indices_to_include[]
-			// to
-			// index
-			double nn_dist = Large_distance;
-			int nn_index = -1;  // should always be overwritten. Will get a seg fault if this isn't the case
-			for (const auto &ineql_index_to_include : inequality_indices_to_include) {
-				double dist = distance_btw_pts(inequality[index], inequality[ineql_index_to_include]);
-				if (dist < nn_dist)
-				{
-					nn_dist = dist;
-					nn_index = ineql_index_to_include;
-				}
-			}
-			// Distance to other Large Residual Points Condition
-			if (nn_dist > avg_nn_distance)
-				inequality_indices_to_include.push_back(index);
+			inequality_residuals_pts.push_back(inequality[j]);
 		}
 	}
+	// Will always accept the first residual over the threshold
+	// Distance to other Large Residual Points Condition
+	for (const auto &k : get_well_separated_candidates(inequality_residuals_pts, avg_nn_distance))
+		inequality_indices_to_include.push_back(inequality_residuals_indices[k]);
 
 	std::sort(inequality_indices_to_include.begin(), inequality_indices_to_include.end());
 
@@ -710,27 +1006,15 @@ std::vector<int> Get_Interface_STL_Vector_Indices_With_Large_Residuals(
 												  // function
 												  // on function exit
 
-	double Large_distance = DBL_MAX;
-
-	double largest_residual = 0;
-	int ref_index = -1;
 	std::vector<double> large_itrface_residuals;
 	std::vector<int> large_itrface_residuals_indices;
 	for (int j = 0; j < (int)itrface.size(); j++) {
 		double error = itrface.at(j).residual();
 		if (error > itrface_uncertainty) {
-			if (error > largest_residual) {
-				largest_residual = error;
-				ref_index = j;
-			}
 			large_itrface_residuals.push_back(error);
 			large_itrface_residuals_indices.push_back(j);
 		}
 	}
-	// 	if (ref_index != -1 )
-	// 	{
-	// 		itrface_indices_to_include.push_back(ref_index);
-	// 	}
 	if (!large_itrface_residuals.empty())
 	{
 		// Residual Magnitude Condition
@@ -738,29 +1022,14 @@ std::vector<int> Get_Interface_STL_Vector_Indices_With_Large_Residuals(
 		// smallest to
 		// largest - along with linked indices
 		Math_methods::sort_vector_w_index(large_itrface_residuals, large_itrface_residuals_indices);
-		// Will always accept largest residual over the threshold
-		itrface_indices_to_include.push_back(large_itrface_residuals_indices[(int)large_itrface_residuals_indices.size() - 1]);
-		large_itrface_residuals.pop_back();  // probably don't need to do this since we never use it again
-		large_itrface_residuals_indices.pop_back();
-
-		for (int j = 0; j < (int)large_itrface_residuals_indices.size(); j++) {
-			// current index being analyzed (next largest residual in list):
-			int index = large_itrface_residuals_indices[(int)large_itrface_residuals_indices.size() - j - 1];
-			// find closest point currently in itrface_indices_to_include[] to
-			// index
-			double nn_dist = Large_distance;
-			int nn_index = -1;  // should always be overwritten. Will get a seg fault if this isn't the case
-			for (const auto &itr_index_to_include : itrface_indices_to_include) {
-				double dist = distance_btw_pts(itrface[index], itrface[itr_index_to_include]);
-				if (dist < nn_dist) {
-					nn_dist = dist;
-					nn_index = itr_index_to_include;
-				}
-			}
-			// Distance to other Large Residual Points Condition
-			if (nn_dist > avg_nn_distance)
-				itrface_indices_to_include.push_back(index);
-		}
+		// visit largest to smallest residual - will always accept largest residual over the threshold
+		std::reverse(large_itrface_residuals_indices.begin(), large_itrface_residuals_indices.end());
+		std::vector<Point> candidate_pts;
+		for (const auto &index : large_itrface_residuals_indices)
+			candidate_pts.push_back(itrface[index]);
+		// Distance to other Large Residual Points Condition
+		for (const auto &k : get_well_separated_candidates(candidate_pts, avg_nn_distance))
+			itrface_indices_to_include.push_back(large_itrface_residuals_indices[k]);
 	}
 
 	std::sort(itrface_indices_to_include.begin(), itrface_indices_to_include.end());
@@ -781,27 +1050,15 @@ std::vector<int> Get_Planar_STL_Vector_Indices_With_Large_Residuals(
 
 	std::vector<int> planar_indices_to_include;  // what we are going to function on function exit
 
-	double Large_distance = DBL_MAX;
-
-	double largest_residual = 0;
-	int ref_index = -1;
 	std::vector<double> large_planar_residuals;
 	std::vector<int> large_planar_residuals_indices;
 	for (int j = 0; j < (int)planar.size(); j++) {
 		double grad_err = planar.at(j).residual() * R2D;
 		if (grad_err > angular_uncertainty) {
-			if (grad_err > largest_residual) {
-				largest_residual = grad_err;
-				ref_index = j;
-			}
 			large_planar_residuals.push_back(grad_err);
 			large_planar_residuals_indices.push_back(j);
 		}
 	}
-	// 	if (ref_index != -1 )
-	// 	{
-	// 		planar_indices_to_include.push_back(ref_index);
-	// 	}
 	if (!large_planar_residuals.empty())
 	{
 		// Residual Magnitude Condition
@@ -809,30 +1066,14 @@ std::vector<int> Get_Planar_STL_Vector_Indices_With_Large_Residuals(
 		// smallest to
 		// largest - along with linked indices
 		Math_methods::sort_vector_w_index(large_planar_residuals, large_planar_residuals_indices);
-		// Will always accept largest residual over the threshold
-		planar_indices_to_include.push_back(large_planar_residuals_indices[(int)large_planar_residuals_indices.size() - 1]);
-		large_planar_residuals.pop_back();  // probably don't need to do this since we never use it again
-		large_planar_residuals_indices.pop_back();
-
-		for (int j = 0; j < (int)large_planar_residuals_indices.size(); j++) {
-			// current index being analyzed (next largest residual in list):
-			int index = large_planar_residuals_indices[(int)large_planar_residuals_indices.size() - j - 1];
-			// find closest point currently in planar_indices_to_include[] to
-			// index
-			double nn_dist = Large_distance;
-			int nn_index = -1;  // should always be overwritten. Will get a seg fault if this isn't the case
-			for (const auto &planar_index_to_include : planar_indices_to_include) {
-				double dist = distance_btw_pts(planar[index], planar[planar_index_to_include]);
-				if (dist < nn_dist)
-				{
-					nn_dist = dist;
-					nn_index = planar_index_to_include;
-				}
-			}
-			// Distance to other Large Residual Points Condition
-			if (nn_dist > avg_nn_distance)
-				planar_indices_to_include.push_back(index);
-		}
+		// visit largest to smallest residual - will always accept largest residual over the threshold
+		std::reverse(large_planar_residuals_indices.begin(), large_planar_residuals_indices.end());
+		std::vector<Point> candidate_pts;
+		for (const auto &index : large_planar_residuals_indices)
+			candidate_pts.push_back(planar[index]);
+		// Distance to other Large Residual Points Condition
+		for (const auto &k : get_well_separated_candidates(candidate_pts, avg_nn_distance))
+			planar_indices_to_include.push_back(large_planar_residuals_indices[k]);
 	}
 
 	std::sort(planar_indices_to_include.begin(), planar_indices_to_include.end());
@@ -853,8 +1094,6 @@ std::vector<int> Get_Tangent_STL_Vector_Indices_With_Large_Residuals(
 
 	std::vector<int> tangent_indices_to_include;  // what we are going to function on function exit
 
-	double Large_distance = DBL_MAX;
-
 	std::vector<double> large_tangent_residuals;
 	std::vector<int> large_tangent_residuals_indices;
 	for (int j = 0; j < (int)tangent.size(); j++) {
@@ -871,35 +1110,17 @@ std::vector<int> Get_Tangent_STL_Vector_Indices_With_Large_Residuals(
 		// smallest to
 		// largest - along with linked indices
 		Math_methods::sort_vector_w_index(large_tangent_residuals, large_tangent_residuals_indices);
-		// Will always accept largest residual over the threshold
-		tangent_indices_to_include.push_back(large_tangent_residuals_indices[(int)large_tangent_residuals_indices.size() - 1]);
-		large_tangent_residuals.pop_back();  // probably don't need to do this since we never use it again
-		large_tangent_residuals_indices.pop_back();
-
-		for (int j = 0; j < (int)large_tangent_residuals_indices.size(); j++) {
-			// current index being analyzed (next largest residual in list):
-			int index = large_tangent_residuals_indices[(int)large_tangent_residuals_indices.size() - j - 1];
-			// find closest point currently in tangent_indices_to_include[] to
-			// index
-			double nn_dist = Large_distance;
-			int nn_index = -1;  // should always be overwritten. Will get a seg fault if this isn't the case
-			for (const auto &tangent_index_to_include : tangent_indices_to_include) {
-				for (int k = 0; k < (int)tangent_indices_to_include.size(); k++) {
-					double dist = distance_btw_pts(tangent[index], tangent[tangent_index_to_include]);
-					if (dist < nn_dist)
-					{
-						nn_dist = dist;
-						nn_index = tangent_index_to_include;
-					}
-				}
-				// Distance to other Large Residual Points Condition
-				if (nn_dist > avg_nn_distance)
-					tangent_indices_to_include.push_back(index);
-			}
-		}
+		// visit largest to smallest residual - will always accept largest residual over the threshold
+		std::reverse(large_tangent_residuals_indices.begin(), large_tangent_residuals_indices.end());
+		std::vector<Point> candidate_pts;
+		for (const auto &index : large_tangent_residuals_indices)
+			candidate_pts.push_back(tangent[index]);
+		// Distance to other Large Residual Points Condition
+		for (const auto &k : get_well_separated_candidates(candidate_pts, avg_nn_distance))
+			tangent_indices_to_include.push_back(large_tangent_residuals_indices[k]);
+	}
 
-		std::sort(tangent_indices_to_include.begin(), tangent_indices_to_include.end());
+	std::sort(tangent_indices_to_include.begin(), tangent_indices_to_include.end());
 
-		return tangent_indices_to_include;
-	}
-}
\ No newline at end of file
+	return tangent_indices_to_include;
+}
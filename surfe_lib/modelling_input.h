@@ -186,6 +186,20 @@ public:
 		// residual default
 		_residual = 0.0;
 	}
+	// normal already computed from dip, strike and polarity (e.g. bulk conversion)
+	Planar(const double &x_coord, const double &y_coord, const double &z_coord,
+		const double &nx, const double &ny, const double &nz,
+		const double &dip, const double &strike, const int &polarity,
+		const double &c_coord = 0)
+		: Point(x_coord, y_coord, z_coord, c_coord),
+		_dip(dip),
+		_strike(strike),
+		_polarity(polarity) {
+		_normal[0] = nx;
+		_normal[1] = ny;
+		_normal[2] = nz;
+		_residual = 0.0;
+	}
 	bool getDipVector(double(&vector)[3]);
 	bool getStrikeVector(double(&vector)[3]);
 	double dip() const { return _dip; }
@@ -313,20 +327,59 @@ struct SpatialParameters {
 	double zmax;
 };
 
+class KD_Tree;
+
 std::vector<Point> convert_constraints_to_points(const Constraints& constraints);
 double distance_btw_pts(const Point &p1, const Point &p2);
+// Neighbour queries. The std::vector versions are linear scans, fine for a single
+// query. When querying the same set of points repeatedly build a KD_Tree once and
+// use the KD_Tree versions.
 int nearest_neighbour_index(const Point &p, const std::vector<Point> &pts);
+int nearest_neighbour_index(const Point &p, const KD_Tree &tree);
 std::vector<int> get_n_nearest_neighbours_to_point(const int &n, const Point &p, const std::vector<Point> &pts);
+std::vector<int> get_n_nearest_neighbours_to_point(const int &n, const Point &p, const KD_Tree &tree);
 int furtherest_neighbour_index(const Point &p, const std::vector<Point> &pts);
+int furtherest_neighbour_index(const Point &p, const KD_Tree &tree);
 int furtherest_neighbour_index(const std::vector<Point> &pts1, const std::vector<Point> &pts2);
+int furtherest_neighbour_index(const KD_Tree &tree1, const std::vector<Point> &pts2);
 double avg_nn_distance(const std::vector<Point> &pts);
 bool spatial_metrics(const std::vector<Point> &pts, double &resolution, double &xmin, double &xmax, double &ymin, double &ymax, double &zmin, double &zmax);
 bool Find_STL_Vector_Indices_FurtherestTwoPoints(const std::vector<Point> &pts, int(&TwoIndexes)[2]);
+bool Find_STL_Vector_Indices_FurtherestTwoPoints(const std::vector<Point> &pts, const KD_Tree &tree, int(&TwoIndexes)[2]);
 int Find_STL_Vector_Index_ofPointClosestToOtherPointWithinDistance(const Point &p, const std::vector<Point> &pts, const double &dist);
+int Find_STL_Vector_Index_ofPointClosestToOtherPointWithinDistance(const Point &p, const KD_Tree &tree, const double &dist);
 void calculate_bounds(const std::vector<Point> &pts, double(&bounds)[6]);
 std::vector<int> get_extremal_point_data_indices_from_points(const std::vector<Point> &pts);
 bool is_index_in_list(const int &index, const std::vector<int> &list);
 double get_largest_distance_between_points(const std::vector<Point> &pts);
+// Linear time search for collocated points using a spatial hash with Epilson
+// sized cells. duplicate[j] != 0 if pts[j] is collocated with a lower index point
+std::vector<char> find_collocated_duplicates(const std::vector<Point> &pts);
+// Declustering (thinning) of dense constraints to a target spacing. Interface
+// points are thinned per level. Voxel grid: one constraint per cell at the cell
+// centroid. Poisson disk: well separated subset of the input points. Planar and
+// tangent vectors are averaged over the merged points. Returns # of constraints kept
+int decluster_interface_constraints(std::vector<Interface> &itrface, const double &spacing, const Parameter_Types::DeclusterMethod &method);
+int decluster_planar_constraints(std::vector<Planar> &planar, const double &spacing, const Parameter_Types::DeclusterMethod &method);
+int decluster_tangent_constraints(std::vector<Tangent> &tangent, const double &spacing, const Parameter_Types::DeclusterMethod &method);
+// Removes collocated points keeping the first occurrence, the order of the
+// remaining points is preserved. Returns the number of points removed
+template <class T>
+int remove_collocated_duplicates(std::vector<T> &pts)
+{
+	std::vector<Point> points(pts.begin(), pts.end());
+	std::vector<char> duplicate = find_collocated_duplicates(points);
+	int n_kept = 0;
+	for (int j = 0; j < (int)pts.size(); j++) {
+		if (!duplicate[j]) {
+			if (n_kept != j) pts[n_kept] = pts[j];
+			n_kept++;
+		}
+	}
+	int n_removed = (int)pts.size() - n_kept;
+	pts.erase(pts.begin() + n_kept, pts.end());
+	return n_removed;
+}
 // The below functions will intelligently* get the indices within the STL vector
 // of points that have large residuals Intelligently* : Doesn't blindly capture
 // all points with large residuals
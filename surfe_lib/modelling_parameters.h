@@ -93,6 +93,30 @@ struct Parameter_Types {
 		Yaxis,
 		Zaxis
 	};
+	enum DeclusterMethod {
+		VoxelGrid,
+		PoissonDisk
+	};
+	enum CenterSelectionMethod {
+		PGreedy,
+		FGreedy
+	};
+	enum ComputePhase {
+		Idle,
+		Preprocessing,
+		Assembly,
+		Solving,
+		Greedy,
+		Complete,
+		Cancelled,
+		Failed
+	};
+	enum ConstraintType {
+		InequalityConstraint,
+		InterfaceConstraint,
+		PlanarConstraint,
+		TangentConstraint
+	};
 };
 
 struct Parameters {
@@ -121,6 +145,15 @@ struct Parameters {
 	bool use_regression_smoothing;
 	double interface_uncertainty;
 	double angular_uncertainty;
+	// declustering of dense input constraints
+	bool use_declustering;
+	Parameter_Types::DeclusterMethod decluster_method;
+	double decluster_spacing;
+	// greedy center selection (Newton basis)
+	bool use_center_selection;
+	Parameter_Types::CenterSelectionMethod center_selection_method;
+	int max_centers;
+	double center_selection_tolerance;
 
 	// initialization ...
 	Parameters() :
@@ -140,7 +173,14 @@ struct Parameters {
 		smoothing_amount(0),
 		use_regression_smoothing(false),
 		interface_uncertainty(0),
-		angular_uncertainty(0)
+		angular_uncertainty(0),
+		use_declustering(false),
+		decluster_method(Parameter_Types::VoxelGrid),
+		decluster_spacing(0),
+		use_center_selection(false),
+		center_selection_method(Parameter_Types::PGreedy),
+		max_centers(0),
+		center_selection_tolerance(0)
 	{}
 };
 
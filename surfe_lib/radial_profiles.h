@@ -0,0 +1,347 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef radial_profiles_h
+#define radial_profiles_h
+
+#include <modelling_parameters.h>
+
+#include <cmath>
+
+// Header only, no Eigen: shared by the flat evaluators of surfe_lib
+// (Fused_Evaluator) and the standalone surfe_eval library.
+
+// Radial profile phi(r) of each kernel with f1 = phi'(r) / r and
+// f2 = (phi''(r) - phi'(r) / r) / r^2, same conventions as basis.cpp.
+// f3 = f2'(r) / r, so grad f1 = f2 a and grad f2 = f3 a with a = grad(r^2) / 2
+struct Cubic_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		phi = r * r * r;
+		f1 = 3.0 * r;
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		f1 = 3.0 * r;
+		f2 = r == 0 ? 0.0 : 3.0 / r;
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		f1 = 3.0 * r;
+		f2 = r == 0 ? 0.0 : 3.0 / r;
+		f3 = r == 0 ? 0.0 : -3.0 / (r * r * r);
+	}
+};
+
+struct Gaussian_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		phi = std::exp(-(s * s * r * r));
+		f1 = -2.0 * s * s * phi;
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		double e = std::exp(-(s * s * r * r));
+		f1 = -2.0 * s * s * e;
+		f2 = 4.0 * s * s * s * s * e;
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		double e = std::exp(-(s * s * r * r));
+		f1 = -2.0 * s * s * e;
+		f2 = 4.0 * s * s * s * s * e;
+		f3 = -2.0 * s * s * f2;
+	}
+};
+
+struct MQ_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		phi = std::sqrt(s + r * r);
+		f1 = 1.0 / phi;
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		double q = std::sqrt(s + r * r);
+		f1 = 1.0 / q;
+		f2 = -f1 / (q * q);
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		double q = std::sqrt(s + r * r);
+		f1 = 1.0 / q;
+		f2 = -f1 / (q * q);
+		f3 = -3.0 * f2 / (q * q);
+	}
+};
+
+struct IMQ_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		double q2 = s + r * r;
+		phi = 1.0 / std::sqrt(q2);
+		f1 = -phi / q2;
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		double q2 = s + r * r;
+		f1 = -1.0 / (q2 * std::sqrt(q2));
+		f2 = -3.0 * f1 / q2;
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		double q2 = s + r * r;
+		f1 = -1.0 / (q2 * std::sqrt(q2));
+		f2 = -3.0 * f1 / q2;
+		f3 = -5.0 * f2 / q2;
+	}
+};
+
+struct TPS_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		if (r == 0) {
+			phi = 0.0;
+			f1 = 0.0;
+			return;
+		}
+		double l = std::log(r);
+		phi = r * r * r * r * l;
+		f1 = r * r * (4.0 * l + 1.0);
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		if (r == 0) {
+			f1 = 0.0;
+			f2 = 0.0;
+			return;
+		}
+		double l = std::log(r);
+		f1 = r * r * (4.0 * l + 1.0);
+		f2 = 8.0 * l + 6.0;
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		if (r == 0) {
+			f1 = 0.0;
+			f2 = 0.0;
+			f3 = 0.0;
+			return;
+		}
+		double l = std::log(r);
+		f1 = r * r * (4.0 * l + 1.0);
+		f2 = 8.0 * l + 6.0;
+		f3 = 8.0 / (r * r);
+	}
+};
+
+struct R_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		phi = r;
+		f1 = r == 0 ? 0.0 : 1.0 / r;
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		f1 = r == 0 ? 0.0 : 1.0 / r;
+		f2 = -f1 * f1 * f1;
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		f1 = r == 0 ? 0.0 : 1.0 / r;
+		f2 = -f1 * f1 * f1;
+		f3 = -3.0 * f2 * f1 * f1;
+	}
+};
+
+// s is the cut off radius
+struct WendlandC2_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		if (r > s) {
+			phi = 0.0;
+			f1 = 0.0;
+			return;
+		}
+		double t = 1.0 - r / s;
+		phi = t * t * t * t * (1.0 + 4.0 * r / s);
+		f1 = -20.0 * t * t * t / (s * s);
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		if (r > s) {
+			f1 = 0.0;
+			f2 = 0.0;
+			return;
+		}
+		double s5 = s * s * s * s * s;
+		f1 = 20.0 * (r - s) * (r - s) * (r - s) / s5;
+		f2 = r == 0 ? 0.0 : 60.0 * (r - s) * (r - s) / (s5 * r);
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		if (r > s) {
+			f1 = 0.0;
+			f2 = 0.0;
+			f3 = 0.0;
+			return;
+		}
+		double s5 = s * s * s * s * s;
+		f1 = 20.0 * (r - s) * (r - s) * (r - s) / s5;
+		f2 = r == 0 ? 0.0 : 60.0 * (r - s) * (r - s) / (s5 * r);
+		f3 = r == 0 ? 0.0 : 60.0 * (r - s) * (r + s) / (s5 * r * r * r);
+	}
+};
+
+struct MaternC4_Profile {
+	double s;
+	void value(const double &r, double &phi, double &f1) const {
+		double a = s * r;
+		double e = std::exp(-a);
+		phi = e * (3.0 + 3.0 * a + a * a);
+		f1 = -s * s * e * (1.0 + a);
+	}
+	void derivatives(const double &r, double &f1, double &f2) const {
+		double a = s * r;
+		double e = std::exp(-a);
+		f1 = -s * s * e * (1.0 + a);
+		f2 = s * s * s * s * e;
+	}
+	void derivatives(const double &r, double &f1, double &f2, double &f3) const {
+		double a = s * r;
+		double e = std::exp(-a);
+		f1 = -s * s * e * (1.0 + a);
+		f2 = s * s * s * s * e;
+		f3 = r == 0 ? 0.0 : -s * f2 / r;
+	}
+};
+
+// Distance from an evaluation point (c = 0) to a center p (x, y, z, c) for
+// the isotropic kernels or the global anisotropy transform u = T (x - p)
+struct Radial_Geometry {
+	bool anisotropic;
+	double transform[9];  // row major
+	double metric[9];     // T^t T = grad_x(a), identity when isotropic
+
+	Radial_Geometry() : anisotropic(false) {
+		for (int j = 0; j < 9; j++) {
+			transform[j] = j % 4 == 0 ? 1.0 : 0.0;
+			metric[j] = transform[j];
+		}
+	}
+	void set(const bool &is_anisotropic, const double *row_major_transform) {
+		anisotropic = is_anisotropic;
+		// the anisotropic kernels hold the transform as a Matrix3f and form
+		// T^t T in single precision, so does the geometry to reproduce their
+		// gradients
+		float t[9];
+		for (int j = 0; j < 9; j++) {
+			transform[j] = row_major_transform[j];
+			t[j] = (float)transform[j];
+		}
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 3; k++)
+				metric[3 * j + k] = anisotropic ? t[j] * t[k] + t[3 + j] * t[3 + k] + t[6 + j] * t[6 + k] : (j == k ? 1.0 : 0.0);
+	}
+	// returns r, a = grad_x(r^2) / 2
+	double delta(const double *x, const double *p, double *a) const {
+		double d[3] = { x[0] - p[0], x[1] - p[1], x[2] - p[2] };
+		if (!anisotropic) {
+			a[0] = d[0];
+			a[1] = d[1];
+			a[2] = d[2];
+			return std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + p[3] * p[3]);
+		}
+		const double *t = transform;
+		double u[3];
+		for (int j = 0; j < 3; j++)
+			u[j] = t[3 * j] * d[0] + t[3 * j + 1] * d[1] + t[3 * j + 2] * d[2];
+		for (int j = 0; j < 3; j++)
+			a[j] = t[j] * u[0] + t[3 + j] * u[1] + t[6 + j] * u[2];
+		return std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2] + p[3] * p[3]);
+	}
+	// m_v = grad_x(a . v)
+	void apply_metric(const double *v, double *m_v) const {
+		if (!anisotropic) {
+			m_v[0] = v[0];
+			m_v[1] = v[1];
+			m_v[2] = v[2];
+			return;
+		}
+		for (int j = 0; j < 3; j++)
+			m_v[j] = metric[3 * j] * v[0] + metric[3 * j + 1] * v[1] + metric[3 * j + 2] * v[2];
+	}
+};
+
+// Calls visitor(profile) with the radial profile of a Parameter_Types::RBF.
+// Returns false for an unknown kernel
+template <class Visitor>
+bool visit_radial_profile(const int &rbf_type, const double &shape_parameter, Visitor &visitor)
+{
+	switch (rbf_type) {
+	case Parameter_Types::Cubic: {
+		Cubic_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::Gaussian: {
+		Gaussian_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::MQ: {
+		MQ_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::IMQ: {
+		IMQ_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::TPS: {
+		TPS_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::R: {
+		R_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::WendlandC2: {
+		WendlandC2_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	case Parameter_Types::MaternC4: {
+		MaternC4_Profile k = { shape_parameter };
+		visitor(k);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+#endif
@@ -219,6 +219,7 @@ void Single_Surface::setup_system_solver() {
 
 			Quadratic_Predictor_Corrector_LOQO *qpc =
 				new Quadratic_Predictor_Corrector_LOQO(interpolation_matrix, inequality_matrix, b, r);
+			qpc->iteration_callback = _solver_iteration_callback();
 			if (!qpc->solve())
 				throw GRBF_Exceptions::loqo_quadratic_solver_failure;
 			solver = qpc;
@@ -246,6 +247,7 @@ void Single_Surface::setup_system_solver() {
 				new Quadratic_Predictor_Corrector(
 					interpolation_matrix, equality_matrix, inequality_matrix,
 					equality_values, inequality_values);
+			qpc->iteration_callback = _solver_iteration_callback();
 			if (!qpc->solve())
 				throw GRBF_Exceptions::pc_quadratic_solver_failure;
 			solver = qpc;
@@ -307,77 +309,10 @@ bool Single_Surface::get_minimial_and_excluded_input(Constraints &greedy_input,
 	return true;
 }
 
-bool Single_Surface::measure_residuals(Constraints &input) {
-	if (solver == nullptr) return false;
-
-#pragma omp parallel sections
-	{
-#pragma omp section
-		{
-			// inequalities points
-			for (auto &inequality_pt : input.inequality) {
-				eval_scalar_interpolant_at_point(inequality_pt);
-				if (inequality_pt.level() >= 0) {
-					if (inequality_pt.scalar_field() >= 0)
-						inequality_pt.setResidual(true);
-					else
-						inequality_pt.setResidual(false);
-				}
-				else {
-					if (inequality_pt.scalar_field() < 0)
-						inequality_pt.setResidual(true);
-					else
-						inequality_pt.setResidual(false);
-				}
-			}
-		}
-#pragma omp section
-		{
-			// interface points
-			for (auto &interface_pt : input.itrface) {
-				eval_scalar_interpolant_at_point(interface_pt);
-				interface_pt.setResidual(abs(interface_pt.scalar_field()));
-			}
-		}
-#pragma omp section
-		{
-			// planar points
-			for (auto &planar_pt : input.planar) {
-				eval_vector_interpolant_at_point(planar_pt);
-				double angle = 0.0;
-				std::vector<double> v1;
-				std::vector<double> v2;
-				v1.push_back(planar_pt.nx());
-				v1.push_back(planar_pt.ny());
-				v1.push_back(planar_pt.nz());
-				v2.push_back(planar_pt.nx_interp());
-				v2.push_back(planar_pt.ny_interp());
-				v2.push_back(planar_pt.nz_interp());
-				Math_methods::angle_btw_2_vectors(v1, v2, angle);
-				planar_pt.setResidual(angle);
-			}
-		}
-#pragma omp section
-		{
-			// tangent points
-			for (auto &tangent_pt : input.tangent) {
-				eval_vector_interpolant_at_point(tangent_pt);
-				double angle = 0.0;
-				std::vector<double> v1;
-				std::vector<double> v2;
-				v1.push_back(tangent_pt.tx());
-				v1.push_back(tangent_pt.ty());
-				v1.push_back(tangent_pt.tz());
-				v2.push_back(tangent_pt.nx_interp());
-				v2.push_back(tangent_pt.ny_interp());
-				v2.push_back(tangent_pt.nz_interp());
-				Math_methods::angle_btw_2_vectors(v1, v2, angle);
-				tangent_pt.setResidual(angle);
-			}
-		}
-	}
-
-	return true;
+void Single_Surface::_get_interface_reference_values(const std::vector<Interface> &interface_pts, std::vector<double> &reference_values)
+{
+	// all interface points lie on the same surface: the zero level set
+	reference_values.assign(interface_pts.size(), 0.0);
 }
 
 bool Single_Surface::append_greedy_input(Constraints &input) {
@@ -400,40 +335,35 @@ bool Single_Surface::append_greedy_input(Constraints &input) {
 			input.planar, parameters.angular_uncertainty,
 			constraints.GetPlanarAvgNNDist());
 	else {
-#pragma omp parallel sections
-		{
-#pragma omp section
-			{
+		parallel_invoke({
+			[&]() {
 				// PLANAR Observations
 				planar_indices_to_include =
 					Get_Planar_STL_Vector_Indices_With_Large_Residuals(
 						input.planar, parameters.angular_uncertainty,
 						constraints.GetPlanarAvgNNDist());
-			}
-#pragma omp section
-			{
+			},
+			[&]() {
 				// TANGENT Observations
 				tangent_indices_to_include =
 					Get_Tangent_STL_Vector_Indices_With_Large_Residuals(
 						input.tangent, parameters.angular_uncertainty,
 						constraints.GetPlanarAvgNNDist());
-			}
-#pragma omp section
-			{
+			},
+			[&]() {
 				// INTERFACE Observations
 				interface_indices_to_include =
 					Get_Interface_STL_Vector_Indices_With_Large_Residuals(
 						input.itrface, parameters.interface_uncertainty,
 						constraints.GetInterfaceAvgNNDist());
-			}
-#pragma omp section
-			{
+			},
+			[&]() {
 				// INEQUALITIES Observations
 				inequality_indices_to_include =
 					Get_Inequality_STL_Vector_Indices_With_Large_Residuals(
 						input.inequality, constraints.GetInequalityAvgNNDist());
 			}
-		}
+		});
 	}
 
 	int pI2i = (int)planar_indices_to_include.size();
@@ -637,49 +567,49 @@ void Single_Surface::eval_vector_interpolant_at_point(Point &p) {
 	double poly_z = 0.0;
 	// inequality constraints
 	for (int k = 0; k < n_ie; k++) {
-		kernel->set_points(p, constraints.inequality[k]);
-		elemsum_1_x += solver->weights[k] * kernel->basis_planar_x_pt();
-		elemsum_1_y += solver->weights[k] * kernel->basis_planar_y_pt();
-		elemsum_1_z += solver->weights[k] * kernel->basis_planar_z_pt();
+		kernel_j->set_points(p, constraints.inequality[k]);
+		elemsum_1_x += solver->weights[k] * kernel_j->basis_planar_x_pt();
+		elemsum_1_y += solver->weights[k] * kernel_j->basis_planar_y_pt();
+		elemsum_1_z += solver->weights[k] * kernel_j->basis_planar_z_pt();
 	}
 	// interface constraints
 	for (int k = 0; k < n_i; k++) {
-		kernel->set_points(p, constraints.itrface[k]);
-		elemsum_1_x += solver->weights[n_ie + k] * kernel->basis_planar_x_pt();
-		elemsum_1_y += solver->weights[n_ie + k] * kernel->basis_planar_y_pt();
-		elemsum_1_z += solver->weights[n_ie + k] * kernel->basis_planar_z_pt();
+		kernel_j->set_points(p, constraints.itrface[k]);
+		elemsum_1_x += solver->weights[n_ie + k] * kernel_j->basis_planar_x_pt();
+		elemsum_1_y += solver->weights[n_ie + k] * kernel_j->basis_planar_y_pt();
+		elemsum_1_z += solver->weights[n_ie + k] * kernel_j->basis_planar_z_pt();
 	}
 	// normal constraints
 	for (int k = 0; k < n_p; k++) {
-		kernel->set_points(p, constraints.planar[k]);
+		kernel_j->set_points(p, constraints.planar[k]);
 		elemsum_2_x += solver->weights[n_ie + n_i + 0 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DXDX);
+			kernel_j->basis_planar_planar(Parameter_Types::DXDX);
 		elemsum_2_x += solver->weights[n_ie + n_i + 1 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DXDY);
+			kernel_j->basis_planar_planar(Parameter_Types::DXDY);
 		elemsum_2_x += solver->weights[n_ie + n_i + 2 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DXDZ);
+			kernel_j->basis_planar_planar(Parameter_Types::DXDZ);
 		elemsum_2_y += solver->weights[n_ie + n_i + 0 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DYDX);
+			kernel_j->basis_planar_planar(Parameter_Types::DYDX);
 		elemsum_2_y += solver->weights[n_ie + n_i + 1 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DYDY);
+			kernel_j->basis_planar_planar(Parameter_Types::DYDY);
 		elemsum_2_y += solver->weights[n_ie + n_i + 2 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DYDZ);
+			kernel_j->basis_planar_planar(Parameter_Types::DYDZ);
 		elemsum_2_z += solver->weights[n_ie + n_i + 0 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DZDX);
+			kernel_j->basis_planar_planar(Parameter_Types::DZDX);
 		elemsum_2_z += solver->weights[n_ie + n_i + 1 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DZDY);
+			kernel_j->basis_planar_planar(Parameter_Types::DZDY);
 		elemsum_2_z += solver->weights[n_ie + n_i + 2 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DZDZ);
+			kernel_j->basis_planar_planar(Parameter_Types::DZDZ);
 	}
 	// tangent constraints
 	for (int k = 0; k < n_t; k++) {
-		kernel->set_points(p, constraints.tangent[k]);
+		kernel_j->set_points(p, constraints.tangent[k]);
 		elemsum_3_x += solver->weights[n_ie + n_i + 3 * n_p + k] *
-			kernel->basis_planar_tangent(Parameter_Types::DX);
+			kernel_j->basis_planar_tangent(Parameter_Types::DX);
 		elemsum_3_y += solver->weights[n_ie + n_i + 3 * n_p + k] *
-			kernel->basis_planar_tangent(Parameter_Types::DY);
+			kernel_j->basis_planar_tangent(Parameter_Types::DY);
 		elemsum_3_z += solver->weights[n_ie + n_i + 3 * n_p + k] *
-			kernel->basis_planar_tangent(Parameter_Types::DZ);
+			kernel_j->basis_planar_tangent(Parameter_Types::DZ);
 	}
 	if (intern_params.poly_term) {
 		Polynomial_Basis *p_basis_j = p_basis->clone();
@@ -701,6 +631,31 @@ void Single_Surface::eval_vector_interpolant_at_point(Point &p) {
 	delete kernel_j;
 }
 
+void Single_Surface::get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) {
+	int n_ie = intern_params.n_inequality;
+	int n_i = intern_params.n_interface;
+	int n_p = intern_params.n_planar;
+	int n_t = intern_params.n_tangent;
+
+	for (int k = 0; k < n_ie; k++)
+		terms.push_back(Evaluation_Term(Evaluation_Term::Value, solver->weights[k], constraints.inequality[k], constraints.inequality[k]));
+	for (int k = 0; k < n_i; k++)
+		terms.push_back(Evaluation_Term(Evaluation_Term::Value, solver->weights[n_ie + k], constraints.itrface[k], constraints.itrface[k]));
+	for (int k = 0; k < n_p; k++) {
+		Point weights(solver->weights[n_ie + n_i + 3 * k], solver->weights[n_ie + n_i + 3 * k + 1], solver->weights[n_ie + n_i + 3 * k + 2]);
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, 1.0, constraints.planar[k], weights));
+	}
+	for (int k = 0; k < n_t; k++) {
+		Point direction(constraints.tangent[k].tx(), constraints.tangent[k].ty(), constraints.tangent[k].tz());
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, solver->weights[n_ie + n_i + 3 * n_p + k], constraints.tangent[k], direction));
+	}
+	monomial_coefficients = VectorXd::Zero(10);
+	if (intern_params.poly_term) {
+		prepare_polynomial_basis();
+		p_basis->get_monomial_coefficients(solver->weights.segment(n_ie + n_i + 3 * n_p + n_t, intern_params.n_poly_terms), monomial_coefficients);
+	}
+}
+
 bool Single_Surface::get_equality_values(VectorXd &equality_values) {
 	int j = 0;
 	int k = 0;
@@ -927,6 +882,8 @@ bool Single_Surface::get_interpolation_matrix(MatrixXd &interpolation_matrix) {
 	int n_p = intern_params.n_planar;
 	int n_t = intern_params.n_tangent;
 
+	_begin_assembly(n_ie + n_i + n_p + n_t);
+
 	// Row and Column constraint order : inequality (ine) -> interface (itr) ->
 	// planar (p_x,p_y,p_z) -> tangent (t)
 
@@ -939,133 +896,133 @@ bool Single_Surface::get_interpolation_matrix(MatrixXd &interpolation_matrix) {
 	// |   t/ine   t/itr   t/p_x   t/p_y   t/p_z   t/t |
 
 	// Inequality Constraints:
-	for (int j = 0; j < n_ie; j++) {
+	_assemble_rows(n_ie, [&](const int &j, Kernel *lane_kernel) {
 		// Row:inequality/Column:inequality block
 		for (int k = 0; k < n_ie; k++) {
-			kernel->set_points(constraints.inequality[j], constraints.inequality[k]);
-			interpolation_matrix(j, k) = kernel->basis_pt_pt();
+			lane_kernel->set_points(constraints.inequality[j], constraints.inequality[k]);
+			interpolation_matrix(j, k) = lane_kernel->basis_pt_pt();
 		}
 		// Row:inequality/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.inequality[j], constraints.itrface[k]);
-			interpolation_matrix(j, k + n_ie) = kernel->basis_pt_pt();
+			lane_kernel->set_points(constraints.inequality[j], constraints.itrface[k]);
+			interpolation_matrix(j, k + n_ie) = lane_kernel->basis_pt_pt();
 		}
 		// Row:inequality/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.inequality[j], constraints.planar[k]);
-			interpolation_matrix(j, 3 * k + n_ie + n_i) = kernel->basis_pt_planar_x();
-			interpolation_matrix(j, 3 * k + n_ie + n_i + 1) = kernel->basis_pt_planar_y();
-			interpolation_matrix(j, 3 * k + n_ie + n_i + 2) = kernel->basis_pt_planar_z();
+			lane_kernel->set_points(constraints.inequality[j], constraints.planar[k]);
+			interpolation_matrix(j, 3 * k + n_ie + n_i) = lane_kernel->basis_pt_planar_x();
+			interpolation_matrix(j, 3 * k + n_ie + n_i + 1) = lane_kernel->basis_pt_planar_y();
+			interpolation_matrix(j, 3 * k + n_ie + n_i + 2) = lane_kernel->basis_pt_planar_z();
 		}
 		// Row:inequality/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.inequality[j], constraints.tangent[k]);
-			interpolation_matrix(j, n_ie + n_i + 3 * n_p + k) = kernel->basis_pt_tangent();
+			lane_kernel->set_points(constraints.inequality[j], constraints.tangent[k]);
+			interpolation_matrix(j, n_ie + n_i + 3 * n_p + k) = lane_kernel->basis_pt_tangent();
 		}
-	}
+	});
 	// Interface Constraints:
-	for (int j = 0; j < n_i; j++) {
+	_assemble_rows(n_i, [&](const int &j, Kernel *lane_kernel) {
 		// Row:interface/Column:inequality block
 		for (int k = 0; k < n_ie; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.inequality[k]);
-			interpolation_matrix(j + n_ie, k) = kernel->basis_pt_pt();
+			lane_kernel->set_points(constraints.itrface[j], constraints.inequality[k]);
+			interpolation_matrix(j + n_ie, k) = lane_kernel->basis_pt_pt();
 		}
 		// Row:interface/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.itrface[k]);
-			interpolation_matrix(j + n_ie, k + n_ie) = kernel->basis_pt_pt();
+			lane_kernel->set_points(constraints.itrface[j], constraints.itrface[k]);
+			interpolation_matrix(j + n_ie, k + n_ie) = lane_kernel->basis_pt_pt();
 		}
 		// Row:interface/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.planar[k]);
-			interpolation_matrix(j + n_ie, 3 * k + n_ie + n_i) = kernel->basis_pt_planar_x();
-			interpolation_matrix(j + n_ie, 3 * k + n_ie + n_i + 1) = kernel->basis_pt_planar_y();
-			interpolation_matrix(j + n_ie, 3 * k + n_ie + n_i + 2) = kernel->basis_pt_planar_z();
+			lane_kernel->set_points(constraints.itrface[j], constraints.planar[k]);
+			interpolation_matrix(j + n_ie, 3 * k + n_ie + n_i) = lane_kernel->basis_pt_planar_x();
+			interpolation_matrix(j + n_ie, 3 * k + n_ie + n_i + 1) = lane_kernel->basis_pt_planar_y();
+			interpolation_matrix(j + n_ie, 3 * k + n_ie + n_i + 2) = lane_kernel->basis_pt_planar_z();
 		}
 		// Row:interface/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.itrface[j], constraints.tangent[k]);
-			interpolation_matrix(j + n_ie, n_ie + n_i + 3 * n_p + k) = kernel->basis_pt_tangent();
+			lane_kernel->set_points(constraints.itrface[j], constraints.tangent[k]);
+			interpolation_matrix(j + n_ie, n_ie + n_i + 3 * n_p + k) = lane_kernel->basis_pt_tangent();
 		}
-	}
+	});
 	// Planar Constraints
-	for (int j = 0; j < n_p; j++) {
+	_assemble_rows(n_p, [&](const int &j, Kernel *lane_kernel) {
 		// Row:planar/Column:inequality block
 		for (int k = 0; k < n_ie; k++) {
-			kernel->set_points(constraints.planar[j], constraints.inequality[k]);
-			interpolation_matrix(3 * j + n_ie + n_i, k) = kernel->basis_planar_x_pt();
-			interpolation_matrix(3 * j + n_ie + n_i + 1, k) = kernel->basis_planar_y_pt();
-			interpolation_matrix(3 * j + n_ie + n_i + 2, k) = kernel->basis_planar_z_pt();
+			lane_kernel->set_points(constraints.planar[j], constraints.inequality[k]);
+			interpolation_matrix(3 * j + n_ie + n_i, k) = lane_kernel->basis_planar_x_pt();
+			interpolation_matrix(3 * j + n_ie + n_i + 1, k) = lane_kernel->basis_planar_y_pt();
+			interpolation_matrix(3 * j + n_ie + n_i + 2, k) = lane_kernel->basis_planar_z_pt();
 		}
 		// Row:planar/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.planar[j], constraints.itrface[k]);
-			interpolation_matrix(3 * j + n_ie + n_i, k + n_ie) = kernel->basis_planar_x_pt();
-			interpolation_matrix(3 * j + n_ie + n_i + 1, k + n_ie) = kernel->basis_planar_y_pt();
-			interpolation_matrix(3 * j + n_ie + n_i + 2, k + n_ie) = kernel->basis_planar_z_pt();
+			lane_kernel->set_points(constraints.planar[j], constraints.itrface[k]);
+			interpolation_matrix(3 * j + n_ie + n_i, k + n_ie) = lane_kernel->basis_planar_x_pt();
+			interpolation_matrix(3 * j + n_ie + n_i + 1, k + n_ie) = lane_kernel->basis_planar_y_pt();
+			interpolation_matrix(3 * j + n_ie + n_i + 2, k + n_ie) = lane_kernel->basis_planar_z_pt();
 		}
 		// Row:planar/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.planar[j], constraints.planar[k]);
+			lane_kernel->set_points(constraints.planar[j], constraints.planar[k]);
 			interpolation_matrix(3 * j + n_ie + n_i, 3 * k + n_ie + n_i) =
-				kernel->basis_planar_planar(Parameter_Types::DXDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDX);
 			interpolation_matrix(3 * j + n_ie + n_i, 3 * k + n_ie + n_i + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DXDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDY);
 			interpolation_matrix(3 * j + n_ie + n_i, 3 * k + n_ie + n_i + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DXDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDZ);
 			interpolation_matrix(3 * j + n_ie + n_i + 1, 3 * k + n_ie + n_i) =
-				kernel->basis_planar_planar(Parameter_Types::DYDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDX);
 			interpolation_matrix(3 * j + n_ie + n_i + 1, 3 * k + n_ie + n_i + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DYDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDY);
 			interpolation_matrix(3 * j + n_ie + n_i + 1, 3 * k + n_ie + n_i + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DYDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDZ);
 			interpolation_matrix(3 * j + n_ie + n_i + 2, 3 * k + n_ie + n_i) =
-				kernel->basis_planar_planar(Parameter_Types::DZDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDX);
 			interpolation_matrix(3 * j + n_ie + n_i + 2, 3 * k + n_ie + n_i + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DZDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDY);
 			interpolation_matrix(3 * j + n_ie + n_i + 2, 3 * k + n_ie + n_i + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DZDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDZ);
 		}
 		// Row:planar/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.planar[j], constraints.tangent[k]);
+			lane_kernel->set_points(constraints.planar[j], constraints.tangent[k]);
 			interpolation_matrix(3 * j + n_ie + n_i, n_ie + n_i + 3 * n_p + k) =
-				kernel->basis_planar_tangent(Parameter_Types::DX);
+				lane_kernel->basis_planar_tangent(Parameter_Types::DX);
 			interpolation_matrix(3 * j + n_ie + n_i + 1, n_ie + n_i + 3 * n_p + k) =
-				kernel->basis_planar_tangent(Parameter_Types::DY);
+				lane_kernel->basis_planar_tangent(Parameter_Types::DY);
 			interpolation_matrix(3 * j + n_ie + n_i + 2, n_ie + n_i + 3 * n_p + k) =
-				kernel->basis_planar_tangent(Parameter_Types::DZ);
+				lane_kernel->basis_planar_tangent(Parameter_Types::DZ);
 		}
-	}
+	});
 	// Tangent Constraints
-	for (int j = 0; j < n_t; j++) {
+	_assemble_rows(n_t, [&](const int &j, Kernel *lane_kernel) {
 		// Row:tangent/Column:inequality block
 		for (int k = 0; k < n_ie; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.inequality[k]);
-			interpolation_matrix(j + n_ie + n_i + 3 * n_p, k) = kernel->basis_tangent_pt();
+			lane_kernel->set_points(constraints.tangent[j], constraints.inequality[k]);
+			interpolation_matrix(j + n_ie + n_i + 3 * n_p, k) = lane_kernel->basis_tangent_pt();
 		}
 		// Row:tangent/Column:interface block
 		for (int k = 0; k < n_i; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.itrface[k]);
-			interpolation_matrix(j + n_ie + n_i + 3 * n_p, k + n_ie) = kernel->basis_tangent_pt();
+			lane_kernel->set_points(constraints.tangent[j], constraints.itrface[k]);
+			interpolation_matrix(j + n_ie + n_i + 3 * n_p, k + n_ie) = lane_kernel->basis_tangent_pt();
 		}
 		// Row:tangent/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.planar[k]);
+			lane_kernel->set_points(constraints.tangent[j], constraints.planar[k]);
 			interpolation_matrix(j + n_ie + n_i + 3 * n_p, 3 * k + n_ie + n_i) =
-				kernel->basis_tangent_planar(Parameter_Types::DX);
+				lane_kernel->basis_tangent_planar(Parameter_Types::DX);
 			interpolation_matrix(j + n_ie + n_i + 3 * n_p, 3 * k + n_ie + n_i + 1) =
-				kernel->basis_tangent_planar(Parameter_Types::DY);
+				lane_kernel->basis_tangent_planar(Parameter_Types::DY);
 			interpolation_matrix(j + n_ie + n_i + 3 * n_p, 3 * k + n_ie + n_i + 2) =
-				kernel->basis_tangent_planar(Parameter_Types::DZ);
+				lane_kernel->basis_tangent_planar(Parameter_Types::DZ);
 		}
 		// Row:tangent/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.tangent[k]);
+			lane_kernel->set_points(constraints.tangent[j], constraints.tangent[k]);
 			interpolation_matrix(j + n_ie + n_i + 3 * n_p, n_ie + n_i + 3 * n_p + k) =
-				kernel->basis_tangent_tangent();
+				lane_kernel->basis_tangent_tangent();
 		}
-	}
+	});
 
 	// build polynomial blocks if required
 	// | A PT |
@@ -45,6 +45,7 @@ class Single_Surface : public GRBF_Modelling_Methods {
 private:
 	bool _get_polynomial_matrix_block(MatrixXd &poly_matrix);
 	bool _insert_polynomial_matrix_blocks_in_interpolation_matrix(const MatrixXd &poly_matrix, MatrixXd &interpolation_matrix);
+	void _get_interface_reference_values(const std::vector<Interface> &interface_pts, std::vector<double> &reference_values) override;
 public:
 	// Constructor/Destructor
 	Single_Surface();
@@ -59,14 +60,17 @@ public:
 	bool get_inequality_values(VectorXd &b, VectorXd &r);
 	void eval_scalar_interpolant_at_point(Point &p) override;
 	void eval_vector_interpolant_at_point(Point &p) override;
+	void get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) override;
 	void get_method_parameters() override;
 	void process_input_data() override;
 	void setup_system_solver() override;
 	bool get_minimial_and_excluded_input(Constraints &greedy_input, Constraints &excluded_input) override;
-	bool measure_residuals(Constraints &input) override;
 	bool append_greedy_input(Constraints &input) override;
 	bool convert_modified_kernel_to_rbf_kernel() override;
 	GRBF_Modelling_Methods *clone() override { return new Single_Surface(*this); }
+	void prepare_polynomial_basis() override {
+		if (intern_params.poly_term && !p_basis) p_basis = create_polynomial_basis(parameters.polynomial_order);
+	}
 	// Attributes
 	Polynomial_Basis *p_basis;
 };
@@ -0,0 +1,101 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <snapshot_reader.h>
+#include <grbf_exceptions.h>
+
+#include <cstring>
+
+void Snapshot_Reader::open(const char *filename)
+{
+	if (!_file.open(filename))
+		throw GRBF_Exceptions::error_reading_snapshot;
+
+	const std::size_t size = _file.size();
+	if (size < sizeof(Snapshot_Format::Header))
+		throw GRBF_Exceptions::invalid_snapshot;
+	_header = reinterpret_cast<const Snapshot_Format::Header *>(_file.data());
+	if (std::memcmp(_header->magic, Snapshot_Format::magic, sizeof(Snapshot_Format::magic)) != 0)
+		throw GRBF_Exceptions::invalid_snapshot;
+	if (_header->byte_order != Snapshot_Format::byte_order || _header->version > Snapshot_Format::version)
+		throw GRBF_Exceptions::unsupported_snapshot_version;
+	if (_header->file_size != size)
+		throw GRBF_Exceptions::invalid_snapshot;  // truncated
+	const std::uint64_t table_end = sizeof(Snapshot_Format::Header) + (std::uint64_t)_header->n_sections * sizeof(Snapshot_Format::Section);
+	if (table_end > size)
+		throw GRBF_Exceptions::invalid_snapshot;
+	_sections = reinterpret_cast<const Snapshot_Format::Section *>(_file.data() + sizeof(Snapshot_Format::Header));
+	for (std::uint32_t j = 0; j < _header->n_sections; j++) {
+		const Snapshot_Format::Section &section = _sections[j];
+		if (section.element_size == 0 || section.offset % 8 != 0 || section.offset < table_end || section.offset > size)
+			throw GRBF_Exceptions::invalid_snapshot;
+		if (section.cols != 0 && section.rows > (size - section.offset) / section.element_size / section.cols)
+			throw GRBF_Exceptions::invalid_snapshot;
+	}
+}
+
+const Snapshot_Format::Section *Snapshot_Reader::find_section(const Snapshot_Format::Section_ID &id) const
+{
+	for (std::uint32_t j = 0; j < _header->n_sections; j++)
+		if (_sections[j].id == (std::uint32_t)id)
+			return &_sections[j];
+	return nullptr;
+}
+
+const double *Snapshot_Reader::get_doubles(const Snapshot_Format::Section_ID &id, const int &min_cols, int &rows) const
+{
+	rows = 0;
+	const Snapshot_Format::Section *section = find_section(id);
+	if (!section)
+		return nullptr;
+	if (section->element_size != sizeof(double) || section->cols < (std::uint64_t)min_cols)
+		throw GRBF_Exceptions::invalid_snapshot;
+	rows = (int)section->rows;
+	return reinterpret_cast<const double *>(_file.data() + section->offset);
+}
+
+const std::int64_t *Snapshot_Reader::get_int64s(const Snapshot_Format::Section_ID &id, const int &min_cols, int &rows) const
+{
+	rows = 0;
+	const Snapshot_Format::Section *section = find_section(id);
+	if (!section)
+		return nullptr;
+	if (section->element_size != sizeof(std::int64_t) || section->cols < (std::uint64_t)min_cols)
+		throw GRBF_Exceptions::invalid_snapshot;
+	rows = (int)section->rows;
+	return reinterpret_cast<const std::int64_t *>(_file.data() + section->offset);
+}
@@ -0,0 +1,122 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef snapshot_reader_h
+#define snapshot_reader_h
+
+#include <surfe_lib_module.h>
+#include <mapped_file.h>
+
+#include <cstdint>
+
+// Binary layout of an interpolant snapshot (native byte order):
+//   Snapshot_Format::Header
+//   Snapshot_Format::Section[n_sections]
+//   section payloads, row major, each starting at an 8 byte aligned offset
+// Readers skip sections with an unknown id, so sections can be added without
+// breaking older files. The whole file is memory mapped when it is loaded.
+namespace Snapshot_Format {
+	const char magic[8] = { 'S', 'U', 'R', 'F', 'E', 'S', 'N', 'P' };
+	const std::uint32_t version = 1;
+	const std::uint32_t byte_order = 0x01020304;
+
+	enum Section_ID {
+		Parameters_Section = 1,        // 1 x n doubles, see interpolant_snapshot.cpp
+		Method_Section,                // 1 x n int64: method code, InternalParameters
+		Inequality_Section,            // n x 5 doubles: x, y, z, c, level
+		Interface_Section,             // n x 5 doubles: x, y, z, c, level
+		Planar_Section,                // n x 10 doubles: x, y, z, c, nx, ny, nz, dip, strike, polarity
+		Tangent_Section,               // n x 8 doubles: x, y, z, c, tx, ty, tz, inner product constraint
+		Weights_Section,               // n x 1 doubles: solved interpolant weights
+		Iso_Values_Section,            // n x 1 doubles: scalar field value of each interface
+		Anisotropy_Section,            // 1 x 12 doubles: global plunge, row major transform
+		Unisolvent_Points_Section,     // 4 x 5 doubles: x, y, z, c, level
+		Lagrange_Constants_Section,    // 1 x 16 doubles: lagrangian polynomial constants
+		Evaluation_Kernel_Section,     // 1 x 12 doubles: rbf type, shape parameter, anisotropic, row major transform
+		Evaluation_Terms_Section,      // n x 10 doubles: Evaluation_Term_Type, weight, p (x, y, z, c), q (x, y, z, c)
+		Evaluation_Polynomial_Section  // 1 x 10 doubles: coefficients of xx, yy, zz, xy, xz, yz, x, y, z, 1
+	};
+
+	// The Evaluation_* sections hold the interpolant as a flat sum that can be
+	// evaluated without the modelling methods (see surfe_eval)
+	//   s(x) = sum_k weight_k * L_k[K(x, .)] + polynomial(x)
+	enum Evaluation_Term_Type {
+		Value_Term = 0,       // K(x, p)
+		Derivative_Term = 1,  // q . grad_p K(x, p), q is a direction
+		Increment_Term = 2    // K(x, p) - K(x, q)
+	};
+	const int n_evaluation_term_cols = 10;
+	const int n_monomials = 10;
+
+	struct Header {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t byte_order;
+		std::uint32_t n_sections;
+		std::uint32_t reserved;
+		std::uint64_t file_size;
+	};
+
+	struct Section {
+		std::uint32_t id;
+		std::uint32_t element_size;  // bytes, 8 for double and int64
+		std::uint64_t offset;        // from the beginning of the file
+		std::uint64_t rows;
+		std::uint64_t cols;
+	};
+}
+
+// Read only access to the sections of a mapped snapshot. Throws
+// error_reading_snapshot, invalid_snapshot or unsupported_snapshot_version
+class SURFE_LIB_EXPORT Snapshot_Reader {
+private:
+	Mapped_File _file;
+	const Snapshot_Format::Header *_header;
+	const Snapshot_Format::Section *_sections;
+
+public:
+	Snapshot_Reader() : _header(nullptr), _sections(nullptr) {}
+	void open(const char *filename);
+	std::uint32_t version() const { return _header->version; }
+	// nullptr if the snapshot has no section with this id
+	const Snapshot_Format::Section *find_section(const Snapshot_Format::Section_ID &id) const;
+	// payload of a section with at least min_cols columns, nullptr if missing
+	const double *get_doubles(const Snapshot_Format::Section_ID &id, const int &min_cols, int &rows) const;
+	const std::int64_t *get_int64s(const Snapshot_Format::Section_ID &id, const int &min_cols, int &rows) const;
+};
+
+#endif
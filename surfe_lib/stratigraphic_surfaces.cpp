@@ -484,6 +484,8 @@ bool Stratigraphic_Surfaces::get_interpolation_matrix(MatrixXd &interpolation_ma
 	int n_p = intern_params.n_planar;
 	int n_t = intern_params.n_tangent;
 
+	_begin_assembly((int)_increment_pairs.size() + n_p + n_t);
+
 	// Row and Column constraint order : increment pair (ip) -> planar
 	// (p_x,p_y,p_z) -> tangent (t) Note ip encapsulates 3 types of increment
 	// constraints : 1) sequenced stratigraphic reference increments 2)
@@ -500,118 +502,118 @@ bool Stratigraphic_Surfaces::get_interpolation_matrix(MatrixXd &interpolation_ma
 	// |   t/ip   t/p_x   t/p_y   t/p_z   t/t |
 
 	// Interface Increment Pair Constraints:
-	for (int j = 0; j < (int)_increment_pairs.size(); j++) {
+	_assemble_rows((int)_increment_pairs.size(), [&](const int &j, Kernel *lane_kernel) {
 		// Row:interface increment pair/Column:interface increment pair block
-		for (int k = 0; k < (int)_increment_pairs.size(); k++) {
-			kernel->set_points(_increment_pairs[j][0], _increment_pairs[k][0]);
-			double v1 = kernel->basis_pt_pt();
-			kernel->set_points(_increment_pairs[j][0], _increment_pairs[k][1]);
-			double v2 = kernel->basis_pt_pt();
-			kernel->set_points(_increment_pairs[j][1], _increment_pairs[k][0]);
-			double v3 = kernel->basis_pt_pt();
-			kernel->set_points(_increment_pairs[j][1], _increment_pairs[k][1]);
-			double v4 = kernel->basis_pt_pt();
+		for (int k = 0; k < n_ip; k++) {
+			lane_kernel->set_points(_increment_pairs[j][0], _increment_pairs[k][0]);
+			double v1 = lane_kernel->basis_pt_pt();
+			lane_kernel->set_points(_increment_pairs[j][0], _increment_pairs[k][1]);
+			double v2 = lane_kernel->basis_pt_pt();
+			lane_kernel->set_points(_increment_pairs[j][1], _increment_pairs[k][0]);
+			double v3 = lane_kernel->basis_pt_pt();
+			lane_kernel->set_points(_increment_pairs[j][1], _increment_pairs[k][1]);
+			double v4 = lane_kernel->basis_pt_pt();
 			interpolation_matrix(j, k) = (v1 - v2) - (v3 - v4);
 		}
 		// Row:interface increment pair/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(_increment_pairs[j][0], constraints.planar[k]);
-			double v1x = kernel->basis_pt_planar_x();
-			double v1y = kernel->basis_pt_planar_y();
-			double v1z = kernel->basis_pt_planar_z();
-			kernel->set_points(_increment_pairs[j][1], constraints.planar[k]);
-			double v2x = kernel->basis_pt_planar_x();
-			double v2y = kernel->basis_pt_planar_y();
-			double v2z = kernel->basis_pt_planar_z();
+			lane_kernel->set_points(_increment_pairs[j][0], constraints.planar[k]);
+			double v1x = lane_kernel->basis_pt_planar_x();
+			double v1y = lane_kernel->basis_pt_planar_y();
+			double v1z = lane_kernel->basis_pt_planar_z();
+			lane_kernel->set_points(_increment_pairs[j][1], constraints.planar[k]);
+			double v2x = lane_kernel->basis_pt_planar_x();
+			double v2y = lane_kernel->basis_pt_planar_y();
+			double v2z = lane_kernel->basis_pt_planar_z();
 			interpolation_matrix(j, 3 * k + n_ip) = v1x - v2x;
 			interpolation_matrix(j, 3 * k + n_ip + 1) = v1y - v2y;
 			interpolation_matrix(j, 3 * k + n_ip + 2) = v1z - v2z;
 		}
 		// Row:interface increment pair/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(_increment_pairs[j][0], constraints.tangent[k]);
-			double v1 = kernel->basis_pt_tangent();
-			kernel->set_points(_increment_pairs[j][1], constraints.tangent[k]);
-			double v2 = kernel->basis_pt_tangent();
+			lane_kernel->set_points(_increment_pairs[j][0], constraints.tangent[k]);
+			double v1 = lane_kernel->basis_pt_tangent();
+			lane_kernel->set_points(_increment_pairs[j][1], constraints.tangent[k]);
+			double v2 = lane_kernel->basis_pt_tangent();
 			interpolation_matrix(j, n_ip + 3 * n_p + k) = v1 - v2;
 		}
-	}
+	});
 	// Planar Constraints
-	for (int j = 0; j < n_p; j++) {
+	_assemble_rows(n_p, [&](const int &j, Kernel *lane_kernel) {
 		// Row:planar/Column:interface increment pair
-		for (int k = 0; k < (int)_increment_pairs.size(); k++) {
-			kernel->set_points(constraints.planar[j], _increment_pairs[k][0]);
-			double v1x = kernel->basis_planar_x_pt();
-			double v1y = kernel->basis_planar_y_pt();
-			double v1z = kernel->basis_planar_z_pt();
-			kernel->set_points(constraints.planar[j], _increment_pairs[k][1]);
-			double v2x = kernel->basis_planar_x_pt();
-			double v2y = kernel->basis_planar_y_pt();
-			double v2z = kernel->basis_planar_z_pt();
+		for (int k = 0; k < n_ip; k++) {
+			lane_kernel->set_points(constraints.planar[j], _increment_pairs[k][0]);
+			double v1x = lane_kernel->basis_planar_x_pt();
+			double v1y = lane_kernel->basis_planar_y_pt();
+			double v1z = lane_kernel->basis_planar_z_pt();
+			lane_kernel->set_points(constraints.planar[j], _increment_pairs[k][1]);
+			double v2x = lane_kernel->basis_planar_x_pt();
+			double v2y = lane_kernel->basis_planar_y_pt();
+			double v2z = lane_kernel->basis_planar_z_pt();
 			interpolation_matrix(3 * j + n_ip, k) = v1x - v2x;
 			interpolation_matrix(3 * j + n_ip + 1, k) = v1y - v2y;
 			interpolation_matrix(3 * j + n_ip + 2, k) = v1z - v2z;
 		}
 		// Row:planar/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.planar[j], constraints.planar[k]);
+			lane_kernel->set_points(constraints.planar[j], constraints.planar[k]);
 			interpolation_matrix(3 * j + n_ip, 3 * k + n_ip) =
-				kernel->basis_planar_planar(Parameter_Types::DXDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDX);
 			interpolation_matrix(3 * j + n_ip, 3 * k + n_ip + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DXDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDY);
 			interpolation_matrix(3 * j + n_ip, 3 * k + n_ip + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DXDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDZ);
 			interpolation_matrix(3 * j + n_ip + 1, 3 * k + n_ip) =
-				kernel->basis_planar_planar(Parameter_Types::DYDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDX);
 			interpolation_matrix(3 * j + n_ip + 1, 3 * k + n_ip + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DYDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDY);
 			interpolation_matrix(3 * j + n_ip + 1, 3 * k + n_ip + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DYDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDZ);
 			interpolation_matrix(3 * j + n_ip + 2, 3 * k + n_ip) =
-				kernel->basis_planar_planar(Parameter_Types::DZDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDX);
 			interpolation_matrix(3 * j + n_ip + 2, 3 * k + n_ip + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DZDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDY);
 			interpolation_matrix(3 * j + n_ip + 2, 3 * k + n_ip + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DZDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDZ);
 		}
 		// Row:planar/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.planar[j], constraints.tangent[k]);
+			lane_kernel->set_points(constraints.planar[j], constraints.tangent[k]);
 			interpolation_matrix(3 * j + n_ip, n_ip + 3 * n_p + k) =
-				kernel->basis_planar_tangent(Parameter_Types::DX);
+				lane_kernel->basis_planar_tangent(Parameter_Types::DX);
 			interpolation_matrix(3 * j + n_ip + 1, n_ip + 3 * n_p + k) =
-				kernel->basis_planar_tangent(Parameter_Types::DY);
+				lane_kernel->basis_planar_tangent(Parameter_Types::DY);
 			interpolation_matrix(3 * j + n_ip + 2, n_ip + 3 * n_p + k) =
-				kernel->basis_planar_tangent(Parameter_Types::DZ);
+				lane_kernel->basis_planar_tangent(Parameter_Types::DZ);
 		}
-	}
+	});
 	// Tangent Constraints
-	for (int j = 0; j < n_t; j++) {
+	_assemble_rows(n_t, [&](const int &j, Kernel *lane_kernel) {
 		// Row:tangent/Column:interface increment pair block
-		for (int k = 0; k < (int)_increment_pairs.size(); k++) {
-			kernel->set_points(constraints.tangent[j], _increment_pairs[k][0]);
-			double v1 = kernel->basis_tangent_pt();
-			kernel->set_points(constraints.tangent[j], _increment_pairs[k][1]);
-			double v2 = kernel->basis_tangent_pt();
+		for (int k = 0; k < n_ip; k++) {
+			lane_kernel->set_points(constraints.tangent[j], _increment_pairs[k][0]);
+			double v1 = lane_kernel->basis_tangent_pt();
+			lane_kernel->set_points(constraints.tangent[j], _increment_pairs[k][1]);
+			double v2 = lane_kernel->basis_tangent_pt();
 			interpolation_matrix(j + n_ip + 3 * n_p, k) = v1 - v2;
 		}
 		// Row:tangent/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.planar[k]);
+			lane_kernel->set_points(constraints.tangent[j], constraints.planar[k]);
 			interpolation_matrix(j + n_ip + 3 * n_p, 3 * k + n_ip) =
-				kernel->basis_tangent_planar(Parameter_Types::DX);
+				lane_kernel->basis_tangent_planar(Parameter_Types::DX);
 			interpolation_matrix(j + n_ip + 3 * n_p, 3 * k + n_ip + 1) =
-				kernel->basis_tangent_planar(Parameter_Types::DY);
+				lane_kernel->basis_tangent_planar(Parameter_Types::DY);
 			interpolation_matrix(j + n_ip + 3 * n_p, 3 * k + n_ip + 2) =
-				kernel->basis_tangent_planar(Parameter_Types::DZ);
+				lane_kernel->basis_tangent_planar(Parameter_Types::DZ);
 		}
 		// Row:tangent/Column:tangent block
 		for (int k = 0; k < n_t; k++) {
-			kernel->set_points(constraints.tangent[j], constraints.tangent[k]);
+			lane_kernel->set_points(constraints.tangent[j], constraints.tangent[k]);
 			interpolation_matrix(j + n_ip + 3 * n_p, n_ip + 3 * n_p + k) =
-				kernel->basis_tangent_tangent();
+				lane_kernel->basis_tangent_tangent();
 		}
-	}
+	});
 
 	// build polynomial blocks if required
 	// | A PT |
@@ -665,6 +667,7 @@ void Stratigraphic_Surfaces::setup_system_solver() {
 
 		Quadratic_Predictor_Corrector_LOQO *qpc =
 			new Quadratic_Predictor_Corrector_LOQO(interpolation_matrix, inequality_matrix, b, r);
+		qpc->iteration_callback = _solver_iteration_callback();
 		if (!qpc->solve())
 			throw GRBF_Exceptions::loqo_quadratic_solver_failure;
 		solver = qpc;
@@ -691,6 +694,7 @@ void Stratigraphic_Surfaces::setup_system_solver() {
 		Quadratic_Predictor_Corrector *qpc = new Quadratic_Predictor_Corrector(
 			interpolation_matrix, equality_matrix, inequality_matrix,
 			equality_values, inequality_values);
+		qpc->iteration_callback = _solver_iteration_callback();
 		if (!qpc->solve())
 			throw GRBF_Exceptions::pc_quadratic_solver_failure;
 		solver = qpc;
@@ -774,7 +778,7 @@ void Stratigraphic_Surfaces::eval_scalar_interpolant_at_point(Point &p) {
 	double elemsum_2 = 0.0;
 	double elemsum_3 = 0.0;
 	double poly = 0.0;
-	for (int k = 0; k < (int)_increment_pairs.size(); k++) {
+	for (int k = 0; k < n_ip; k++) {
 		kernel_j->set_points(p, _increment_pairs[k][0]);
 		double v1 = kernel_j->basis_pt_pt();
 		kernel_j->set_points(p, _increment_pairs[k][1]);
@@ -827,49 +831,49 @@ void Stratigraphic_Surfaces::eval_vector_interpolant_at_point(Point &p) {
 	double poly_z = 0.0;
 	// interface constraints
 	for (int k = 0; k < n_ip; k++) {
-		kernel->set_points(p, _increment_pairs[k][0]);
-		double v1x = kernel->basis_planar_x_pt();
-		double v1y = kernel->basis_planar_y_pt();
-		double v1z = kernel->basis_planar_z_pt();
-		kernel->set_points(p, _increment_pairs[k][1]);
-		double v2x = kernel->basis_planar_x_pt();
-		double v2y = kernel->basis_planar_y_pt();
-		double v2z = kernel->basis_planar_z_pt();
+		kernel_j->set_points(p, _increment_pairs[k][0]);
+		double v1x = kernel_j->basis_planar_x_pt();
+		double v1y = kernel_j->basis_planar_y_pt();
+		double v1z = kernel_j->basis_planar_z_pt();
+		kernel_j->set_points(p, _increment_pairs[k][1]);
+		double v2x = kernel_j->basis_planar_x_pt();
+		double v2y = kernel_j->basis_planar_y_pt();
+		double v2z = kernel_j->basis_planar_z_pt();
 		elemsum_1_x += solver->weights[k] * (v1x - v2x);
 		elemsum_1_y += solver->weights[k] * (v1y - v2y);
 		elemsum_1_z += solver->weights[k] * (v1z - v2z);
 	}
 	// planar constraints
 	for (int k = 0; k < n_p; k++) {
-		kernel->set_points(p, constraints.planar[k]);
+		kernel_j->set_points(p, constraints.planar[k]);
 		elemsum_2_x += solver->weights[n_ip + 0 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DXDX);
+			kernel_j->basis_planar_planar(Parameter_Types::DXDX);
 		elemsum_2_x += solver->weights[n_ip + 1 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DXDY);
+			kernel_j->basis_planar_planar(Parameter_Types::DXDY);
 		elemsum_2_x += solver->weights[n_ip + 2 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DXDZ);
+			kernel_j->basis_planar_planar(Parameter_Types::DXDZ);
 		elemsum_2_y += solver->weights[n_ip + 0 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DYDX);
+			kernel_j->basis_planar_planar(Parameter_Types::DYDX);
 		elemsum_2_y += solver->weights[n_ip + 1 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DYDY);
+			kernel_j->basis_planar_planar(Parameter_Types::DYDY);
 		elemsum_2_y += solver->weights[n_ip + 2 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DYDZ);
+			kernel_j->basis_planar_planar(Parameter_Types::DYDZ);
 		elemsum_2_z += solver->weights[n_ip + 0 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DZDX);
+			kernel_j->basis_planar_planar(Parameter_Types::DZDX);
 		elemsum_2_z += solver->weights[n_ip + 1 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DZDY);
+			kernel_j->basis_planar_planar(Parameter_Types::DZDY);
 		elemsum_2_z += solver->weights[n_ip + 2 + 3 * k] *
-			kernel->basis_planar_planar(Parameter_Types::DZDZ);
+			kernel_j->basis_planar_planar(Parameter_Types::DZDZ);
 	}
 	// Tangent constraints
 	for (int k = 0; k < n_t; k++) {
-		kernel->set_points(p, constraints.tangent[k]);
+		kernel_j->set_points(p, constraints.tangent[k]);
 		elemsum_3_x += solver->weights[n_ip + 3 * n_p + k] *
-			kernel->basis_planar_tangent(Parameter_Types::DX);
+			kernel_j->basis_planar_tangent(Parameter_Types::DX);
 		elemsum_3_y += solver->weights[n_ip + 3 * n_p + k] *
-			kernel->basis_planar_tangent(Parameter_Types::DY);
+			kernel_j->basis_planar_tangent(Parameter_Types::DY);
 		elemsum_3_z += solver->weights[n_ip + 3 * n_p + k] *
-			kernel->basis_planar_tangent(Parameter_Types::DZ);
+			kernel_j->basis_planar_tangent(Parameter_Types::DZ);
 	}
 	if (intern_params.poly_term) {
 		Polynomial_Basis *p_basis_j = p_basis->clone();
@@ -889,4 +893,26 @@ void Stratigraphic_Surfaces::eval_vector_interpolant_at_point(Point &p) {
 	double nz = elemsum_1_z + elemsum_2_z + elemsum_3_z + poly_z;
 	p.set_vector_field(nx, ny, nz);
 	delete kernel_j;
+}
+
+void Stratigraphic_Surfaces::get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) {
+	int n_ip = _n_increment_pairs;
+	int n_p = intern_params.n_planar;
+	int n_t = intern_params.n_tangent;
+
+	for (int k = 0; k < n_ip; k++)
+		terms.push_back(Evaluation_Term(Evaluation_Term::Increment, solver->weights[k], _increment_pairs[k][0], _increment_pairs[k][1]));
+	for (int k = 0; k < n_p; k++) {
+		Point weights(solver->weights[n_ip + 3 * k], solver->weights[n_ip + 3 * k + 1], solver->weights[n_ip + 3 * k + 2]);
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, 1.0, constraints.planar[k], weights));
+	}
+	for (int k = 0; k < n_t; k++) {
+		Point direction(constraints.tangent[k].tx(), constraints.tangent[k].ty(), constraints.tangent[k].tz());
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, solver->weights[n_ip + 3 * n_p + k], constraints.tangent[k], direction));
+	}
+	monomial_coefficients = VectorXd::Zero(10);
+	if (intern_params.poly_term) {
+		prepare_polynomial_basis();
+		p_basis->get_monomial_coefficients(solver->weights.segment(n_ip + 3 * n_p + n_t, intern_params.n_poly_terms), monomial_coefficients);
+	}
 }
\ No newline at end of file
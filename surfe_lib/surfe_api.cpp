@@ -1,6 +1,15 @@
 #include <surfe_api.h>
+#include <interpolant_snapshot.h>
+#include <fused_evaluator.h>
+#include <grid_writer.h>
+#include <csv_reader.h>
+#include <constraint_file.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <memory>
 #include <time.h>
 #include <vector>
 GRBF_Modelling_Methods* Surfe_API::get_method_from_parameters(const Parameters& params)
@@ -16,20 +25,22 @@ GRBF_Modelling_Methods* Surfe_API::get_method_from_parameters(const Parameters&
 	else if (params.model_type == Parameter_Types::Continuous_property)
 		return new Continuous_Property(params);
 	else
-		std::throw_with_nested(GRBF_Exceptions::unknown_modelling_mode);
+		throw GRBF_Exceptions::unknown_modelling_mode;
 }
 
 SpatialParameters Surfe_API::GetDataBoundsAndResolution()
 {
+	check_not_computing();
+
 	// collect all constraints
 	std::vector<Point> points;
-	for (const auto &constraint : method_->constraints.inequality)
+	for (const auto &constraint : constraints_.inequality)
 		points.emplace_back(Point(constraint.x(),constraint.y(),constraint.z()));
-	for (const auto &constraint : method_->constraints.itrface)
+	for (const auto &constraint : constraints_.itrface)
 		points.emplace_back(Point(constraint.x(), constraint.y(), constraint.z()));
-	for (const auto &constraint : method_->constraints.planar)
+	for (const auto &constraint : constraints_.planar)
 		points.emplace_back(Point(constraint.x(), constraint.y(), constraint.z()));
-	for (const auto &constraint : method_->constraints.tangent)
+	for (const auto &constraint : constraints_.tangent)
 		points.emplace_back(Point(constraint.x(), constraint.y(), constraint.z()));
 
 	// compute bounds and resolutions
@@ -49,6 +60,8 @@ SpatialParameters Surfe_API::GetDataBoundsAndResolution()
 
 MatrixXd Surfe_API::GetInterfaceReferencePoints()
 {
+	check_not_computing();
+
 	std::vector<Interface> ref_pts = method_->interface_test_points;
 	int n = ref_pts.size();
 	MatrixXd ptarray(n, 3);
@@ -62,8 +75,10 @@ MatrixXd Surfe_API::GetInterfaceReferencePoints()
 
 MatrixXd Surfe_API::GetInterfaceConstraints()
 {
-	std::vector<Interface> interface = method_->constraints.itrface;
-	int n = interface.size();
+	check_not_computing();
+
+	const std::vector<Interface> &interface = constraints_.itrface;
+	int n = (int)interface.size();
 	MatrixXd interface_constraints(n, 4);
 	for (int j = 0; j < n; j++) {
 		interface_constraints(j, 0) = interface[j].x();
@@ -76,31 +91,36 @@ MatrixXd Surfe_API::GetInterfaceConstraints()
 }
 
 
-void Surfe_API::SetInterfaceConstraints(const MatrixXd &interface_constraints)
+void Surfe_API::SetInterfaceConstraints(const ConstMatrixView &interface_constraints)
 {
+	check_not_computing();
+
+	int n = (int)interface_constraints.rows();
+	if (n == 0 || interface_constraints.cols() != 4)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
 	// does the interpolant already have interface constraints ?
 	// if so, erase
-	if (!method_->constraints.itrface.empty())
-		method_->constraints.itrface.clear();
+	std::vector<Interface> &interface = constraints_.itrface;
+	interface.clear();
+	interface.reserve(n);
+	for (int j = 0; j < n; j++)
+		interface.emplace_back(
+			interface_constraints(j, 0), // x
+			interface_constraints(j, 1), // y
+			interface_constraints(j, 2), // z
+			interface_constraints(j, 3)); // level
 
-	int n = interface_constraints.rows();
-	if (n != 0 && interface_constraints.cols() == 4)
-	{
-		for (int j = 0; j < n; j++)
-			AddInterfaceConstraint(
-				interface_constraints(j, 0), // x
-				interface_constraints(j, 1), // y
-				interface_constraints(j, 2), // z
-				interface_constraints(j, 3)); // level
-	}
-	else
-		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	method_->parameters.use_interface = true;
+	constraints_changed_ = true;
 }
 
 MatrixXd Surfe_API::GetPlanarConstraints()
 {
-	std::vector<Planar> planar = method_->constraints.planar;
-	int n = planar.size();
+	check_not_computing();
+
+	const std::vector<Planar> &planar = constraints_.planar;
+	int n = (int)planar.size();
 	MatrixXd planar_constraints(n, 6);
 	for (int j = 0; j < n; j++) {
 		planar_constraints(j, 0) = planar[j].x();
@@ -113,33 +133,98 @@ MatrixXd Surfe_API::GetPlanarConstraints()
 	return planar_constraints;
 }
 
-void Surfe_API::SetPlanarConstraints(const MatrixXd &planar_constraints)
+void Surfe_API::SetPlanarConstraints(const ConstMatrixView &planar_constraints)
 {
+	check_not_computing();
+
+	int n = (int)planar_constraints.rows();
+	if (n == 0 || planar_constraints.cols() != 6)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
 	// does the interpolant already have planar constraints ?
 	// if so, erase
-	if (!method_->constraints.planar.empty())
-		method_->constraints.planar.clear();
+	std::vector<Planar> &planar = constraints_.planar;
+	planar.clear();
+	planar.reserve(n);
+	for (int j = 0; j < n; j++)
+		planar.emplace_back(
+			planar_constraints(j, 0), // x
+			planar_constraints(j, 1), // y
+			planar_constraints(j, 2), // z
+			planar_constraints(j, 3), // nx
+			planar_constraints(j, 4), // ny
+			planar_constraints(j, 5)); // nz
 
-	int n = planar_constraints.rows();
-	if (n != 0 && planar_constraints.cols() == 6)
-	{
-		for (int j = 0; j < n; j++)
-			AddPlanarConstraintwNormal(
-				planar_constraints(j, 0), // x
-				planar_constraints(j, 1), // y
-				planar_constraints(j, 2), // z
-				planar_constraints(j, 3), // nx
-				planar_constraints(j, 4), // ny
-				planar_constraints(j, 5)); // nz
-	}
-	else
+	method_->parameters.use_planar = true;
+	constraints_changed_ = true;
+}
+
+// Array form of Planar::_compute_normal_from_strike_dip_polarity(). The normal of the
+// down dip x strike vectors simplifies to sign(cos(dip)) * (sin(dip)cos(strike), -sin(dip)sin(strike), cos(dip))
+// which is then flipped to match the polarity (1 overturned: points down)
+static void get_normals_from_strike_dip_polarity(const ArrayXd &strike, const ArrayXd &dip, const ArrayXd &polarity, MatrixXd &normals)
+{
+	ArrayXd strike_rad = strike * D2R;
+	ArrayXd dip_rad = dip * D2R;
+	ArrayXd cos_dip = dip_rad.cos();
+	ArrayXd sign = (cos_dip < 0).select(ArrayXd::Constant(cos_dip.rows(), -1.0), ArrayXd::Ones(cos_dip.rows()));
+	sign = (polarity == 1 && cos_dip != 0).select(-sign, sign);
+
+	ArrayXd sin_dip = dip_rad.sin();
+	normals.resize(strike.rows(), 3);
+	normals.col(0) = sign * sin_dip * strike_rad.cos();
+	normals.col(1) = -sign * sin_dip * strike_rad.sin();
+	normals.col(2) = sign * cos_dip;
+}
+
+void Surfe_API::SetPlanarConstraintsStrikeDipPolarity(const ConstMatrixView &planar_constraints)
+{
+	check_not_computing();
+
+	int n = (int)planar_constraints.rows();
+	if (n == 0 || planar_constraints.cols() != 6)
 		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
+	ArrayXd strike = planar_constraints.col(3).array();
+	ArrayXd dip = planar_constraints.col(4).array();
+	ArrayXd polarity = planar_constraints.col(5).array();
+	MatrixXd normals;
+	get_normals_from_strike_dip_polarity(strike, dip, polarity, normals);
+
+	std::vector<Planar> &planar = constraints_.planar;
+	planar.clear();
+	planar.reserve(n);
+	for (int j = 0; j < n; j++)
+		planar.emplace_back(
+			planar_constraints(j, 0), // x
+			planar_constraints(j, 1), // y
+			planar_constraints(j, 2), // z
+			normals(j, 0), normals(j, 1), normals(j, 2),
+			dip(j), strike(j), (int)polarity(j));
+
+	method_->parameters.use_planar = true;
+	constraints_changed_ = true;
+}
+
+void Surfe_API::SetPlanarConstraintsAzimuthDipPolarity(const ConstMatrixView &planar_constraints)
+{
+	check_not_computing();
+	if (planar_constraints.rows() == 0 || planar_constraints.cols() != 6)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
+	// convert azimuth to strike
+	MatrixXd strike_constraints = planar_constraints;
+	ArrayXd azimuth = planar_constraints.col(3).array();
+	strike_constraints.col(3) = (azimuth >= 90.0).select(azimuth - 90.0, azimuth + 270.0).matrix();
+	SetPlanarConstraintsStrikeDipPolarity(strike_constraints);
 }
 
 MatrixXd Surfe_API::GetTangentConstraints()
 {
-	std::vector<Tangent> tangent = method_->constraints.tangent;
-	int n = tangent.size();
+	check_not_computing();
+
+	const std::vector<Tangent> &tangent = constraints_.tangent;
+	int n = (int)tangent.size();
 	MatrixXd tangent_constraints(n, 6);
 	for (int j = 0; j < n; j++) {
 		tangent_constraints(j, 0) = tangent[j].x();
@@ -152,33 +237,38 @@ MatrixXd Surfe_API::GetTangentConstraints()
 	return tangent_constraints;
 }
 
-void Surfe_API::SetTangentConstraints(const MatrixXd &tangent_constraints)
+void Surfe_API::SetTangentConstraints(const ConstMatrixView &tangent_constraints)
 {
+	check_not_computing();
+
+	int n = (int)tangent_constraints.rows();
+	if (n == 0 || tangent_constraints.cols() != 6)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
 	// does the interpolant already have tangent constraints ?
 	// if so, erase
-	if (!method_->constraints.tangent.empty())
-		method_->constraints.tangent.clear();
+	std::vector<Tangent> &tangent = constraints_.tangent;
+	tangent.clear();
+	tangent.reserve(n);
+	for (int j = 0; j < n; j++)
+		tangent.emplace_back(
+			tangent_constraints(j, 0), // x
+			tangent_constraints(j, 1), // y
+			tangent_constraints(j, 2), // z
+			tangent_constraints(j, 3), // vx
+			tangent_constraints(j, 4), // vy
+			tangent_constraints(j, 5)); // vz
 
-	int n = tangent_constraints.rows();
-	if (n != 0 && tangent_constraints.cols() == 6)
-	{
-		for (int j = 0; j < n; j++)
-			AddPlanarConstraintwNormal(
-				tangent_constraints(j, 0), // x
-				tangent_constraints(j, 1), // y
-				tangent_constraints(j, 2), // z
-				tangent_constraints(j, 3), // vx
-				tangent_constraints(j, 4), // vy
-				tangent_constraints(j, 5)); // vz
-	}
-	else
-		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	method_->parameters.use_tangent = true;
+	constraints_changed_ = true;
 }
 
 MatrixXd Surfe_API::GetInequalityConstraints()
 {
-	std::vector<Inequality> ie = method_->constraints.inequality;
-	int n = ie.size();
+	check_not_computing();
+
+	const std::vector<Inequality> &ie = constraints_.inequality;
+	int n = (int)ie.size();
 	MatrixXd inequality_constraints(n, 4);
 	for (int j = 0; j < n; j++) {
 		inequality_constraints(j, 0) = ie[j].x();
@@ -189,38 +279,280 @@ MatrixXd Surfe_API::GetInequalityConstraints()
 	return inequality_constraints;
 }
 
-void Surfe_API::SetInequalityConstraints(const MatrixXd &inequality_constraints)
+void Surfe_API::SetInequalityConstraints(const ConstMatrixView &inequality_constraints)
 {
+	check_not_computing();
+
+	int n = (int)inequality_constraints.rows();
+	if (n == 0 || inequality_constraints.cols() != 4)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
 	// does the interpolant already have inequality constraints ?
 	// if so, erase
-	if (!method_->constraints.inequality.empty())
-		method_->constraints.inequality.clear();
+	std::vector<Inequality> &ie = constraints_.inequality;
+	ie.clear();
+	ie.reserve(n);
+	for (int j = 0; j < n; j++)
+		ie.emplace_back(
+			inequality_constraints(j, 0), // x
+			inequality_constraints(j, 1), // y
+			inequality_constraints(j, 2), // z
+			inequality_constraints(j, 3)); // level
 
-	int n = inequality_constraints.rows();
-	if (n != 0 && inequality_constraints.cols() == 4)
-	{
-		for (int j = 0; j < n; j++)
-			AddInequalityConstraint(
-				inequality_constraints(j, 0), // x
-				inequality_constraints(j, 1), // y
-				inequality_constraints(j, 2), // z
-				inequality_constraints(j, 3)); // level
+	method_->parameters.use_inequality = true;
+	constraints_changed_ = true;
+}
+
+// header field whose lowercase name passes matches, empty if there is none.
+// Constraint files are matched by name as the geo_builder readers do
+static std::string find_csv_field(const std::vector<std::string> &header, const std::function<bool(const std::string &)> &matches)
+{
+	for (const auto &name : header) {
+		std::string lowercase_name = name;
+		std::transform(lowercase_name.begin(), lowercase_name.end(), lowercase_name.begin(), ::tolower);
+		if (matches(lowercase_name))
+			return name;
 	}
-	else
-		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	return std::string();
+}
+
+// header fields named exactly (case insensitive) as names, in that order.
+// Empty if one of them is missing
+static std::vector<std::string> find_csv_fields(const std::vector<std::string> &header, const std::vector<std::string> &names)
+{
+	std::vector<std::string> fields;
+	for (const auto &name : names) {
+		std::string field = find_csv_field(header, [&name](const std::string &lowercase_name) { return lowercase_name == name; });
+		if (field.empty())
+			return std::vector<std::string>();
+		fields.push_back(field);
+	}
+	return fields;
+}
+
+static bool has_filename(const char *filename)
+{
+	return filename != nullptr && filename[0] != '\0';
+}
+
+void Surfe_API::LoadConstraintFiles(const char *interface_file, const char *planar_file /*= ""*/,
+	const char *tangent_file /*= ""*/, const char *inequality_file /*= ""*/)
+{
+	check_not_computing();
+
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+
+	MatrixXd interface;
+	MatrixXd planar;
+	MatrixXd tangent;
+	MatrixXd inequality;
+	enum { normal_columns, strike_dip_polarity_columns, azimuth_dip_polarity_columns } planar_columns = normal_columns;
+
+	// one task per file, each one parsed in parallel
+	std::vector<std::function<void()> > tasks;
+	if (has_filename(interface_file))
+		tasks.push_back([&]() {
+			std::vector<std::string> header = read_csv_header(interface_file);
+			std::vector<std::string> columns = find_csv_fields(header, { "x", "y", "z" });
+			if (columns.empty())
+				throw GRBF_Exceptions::missing_csv_column;
+			std::string level = find_csv_field(header, [](const std::string &name) { return name.find("level") != std::string::npos; });
+			if (!level.empty()) {
+				columns.push_back(level);
+				interface = read_csv_columns(interface_file, columns);
+			}
+			else {
+				// a single interface
+				interface = read_csv_columns(interface_file, columns);
+				interface.conservativeResize(NoChange, 4);
+				interface.col(3).setZero();
+			}
+		});
+	if (has_filename(planar_file))
+		tasks.push_back([&]() {
+			std::vector<std::string> header = read_csv_header(planar_file);
+			std::vector<std::string> columns = find_csv_fields(header, { "x", "y", "z" });
+			if (columns.empty())
+				throw GRBF_Exceptions::missing_csv_column;
+			std::vector<std::string> normal = find_csv_fields(header, { "nx", "ny", "nz" });
+			if (!normal.empty()) {
+				columns.insert(columns.end(), normal.begin(), normal.end());
+				planar_columns = normal_columns;
+			}
+			else {
+				std::string dip = find_csv_field(header, [](const std::string &name) {
+					return name.find("dip") != std::string::npos && name.find("direction") == std::string::npos;
+				});
+				std::string strike = find_csv_field(header, [](const std::string &name) { return name.find("strike") != std::string::npos; });
+				std::string azimuth = find_csv_field(header, [](const std::string &name) {
+					return name.find("azimuth") != std::string::npos ||
+						(name.find("dip") != std::string::npos && name.find("direction") != std::string::npos);
+				});
+				std::string polarity = find_csv_field(header, [](const std::string &name) { return name.find("polarity") != std::string::npos; });
+				if (dip.empty() || polarity.empty() || (strike.empty() && azimuth.empty()))
+					throw GRBF_Exceptions::missing_csv_column;
+				planar_columns = strike.empty() ? azimuth_dip_polarity_columns : strike_dip_polarity_columns;
+				columns.push_back(strike.empty() ? azimuth : strike);
+				columns.push_back(dip);
+				columns.push_back(polarity);
+			}
+			planar = read_csv_columns(planar_file, columns);
+		});
+	if (has_filename(tangent_file))
+		tasks.push_back([&]() {
+			std::vector<std::string> header = read_csv_header(tangent_file);
+			std::vector<std::string> columns = find_csv_fields(header, { "x", "y", "z" });
+			std::vector<std::string> components = find_csv_fields(header, { "vx", "vy", "vz" });
+			if (components.empty())
+				components = find_csv_fields(header, { "tx", "ty", "tz" });
+			if (columns.empty() || components.empty())
+				throw GRBF_Exceptions::missing_csv_column;
+			columns.insert(columns.end(), components.begin(), components.end());
+			tangent = read_csv_columns(tangent_file, columns);
+		});
+	if (has_filename(inequality_file))
+		tasks.push_back([&]() {
+			std::vector<std::string> columns = find_csv_fields(read_csv_header(inequality_file), { "x", "y", "z", "level" });
+			if (columns.empty())
+				throw GRBF_Exceptions::missing_csv_column;
+			inequality = read_csv_columns(inequality_file, columns);
+		});
+	parallel_invoke(tasks);
+
+	// files without rows leave the constraints of their type as they are
+	if (interface.rows() != 0)
+		SetInterfaceConstraints(interface);
+	if (planar.rows() != 0) {
+		if (planar_columns == normal_columns)
+			SetPlanarConstraints(planar);
+		else if (planar_columns == strike_dip_polarity_columns)
+			SetPlanarConstraintsStrikeDipPolarity(planar);
+		else
+			SetPlanarConstraintsAzimuthDipPolarity(planar);
+	}
+	if (tangent.rows() != 0)
+		SetTangentConstraints(tangent);
+	if (inequality.rows() != 0)
+		SetInequalityConstraints(inequality);
+}
+
+void Surfe_API::SaveConstraints(const char *filename, const bool &single_precision /*= false*/, const bool &compress /*= false*/)
+{
+	check_not_computing();
+
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+
+	write_constraint_file(filename, GetInterfaceConstraints(), GetPlanarConstraints(), GetTangentConstraints(),
+		GetInequalityConstraints(), single_precision, compress);
+}
+
+void Surfe_API::LoadConstraints(const char *filename)
+{
+	check_not_computing();
+
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+
+	Constraint_File_Reader reader;
+	reader.open(filename);
+	// views of the mapped file unless the columns have to be decoded. The file
+	// holds all of the constraints, types without rows are cleared
+	MatrixXd storage;
+	if (reader.GetNumberOfConstraints(Constraint_File_Format::Interface_Constraints) != 0)
+		SetInterfaceConstraints(reader.GetConstraints(Constraint_File_Format::Interface_Constraints, storage));
+	else {
+		constraints_.itrface.clear();
+		method_->parameters.use_interface = false;
+	}
+	if (reader.GetNumberOfConstraints(Constraint_File_Format::Planar_Constraints) != 0)
+		SetPlanarConstraints(reader.GetConstraints(Constraint_File_Format::Planar_Constraints, storage));
+	else {
+		constraints_.planar.clear();
+		method_->parameters.use_planar = false;
+	}
+	if (reader.GetNumberOfConstraints(Constraint_File_Format::Tangent_Constraints) != 0)
+		SetTangentConstraints(reader.GetConstraints(Constraint_File_Format::Tangent_Constraints, storage));
+	else {
+		constraints_.tangent.clear();
+		method_->parameters.use_tangent = false;
+	}
+	if (reader.GetNumberOfConstraints(Constraint_File_Format::Inequality_Constraints) != 0)
+		SetInequalityConstraints(reader.GetConstraints(Constraint_File_Format::Inequality_Constraints, storage));
+	else {
+		constraints_.inequality.clear();
+		method_->parameters.use_inequality = false;
+	}
+	constraints_changed_ = true;
 }
 
 int Surfe_API::GetNumberOfInterfaces()
 {
+	check_not_computing();
+
 	return (int)method_->interface_test_points.size();
 }
 
+MatrixXd Surfe_API::ComputeConstraintResiduals()
+{
+	check_interpolant_current();
+
+	// measure on a copy - residuals are stored on the constraint objects
+	Constraints measured = constraints_;
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+	if (!method_->measure_residuals(measured))
+		throw GRBF_Exceptions::error_measuring_residuals;
+
+	int n_ie = (int)measured.inequality.size();
+	int n_i = (int)measured.itrface.size();
+	int n_p = (int)measured.planar.size();
+	int n_t = (int)measured.tangent.size();
+	MatrixXd residuals(n_ie + n_i + n_p + n_t, 5);
+	int row = 0;
+	for (const auto &inequality_pt : measured.inequality) {
+		residuals(row, 0) = inequality_pt.x();
+		residuals(row, 1) = inequality_pt.y();
+		residuals(row, 2) = inequality_pt.z();
+		residuals(row, 3) = Parameter_Types::InequalityConstraint;
+		residuals(row, 4) = inequality_pt.residual() ? 0.0 : 1.0;
+		row++;
+	}
+	for (const auto &interface_pt : measured.itrface) {
+		residuals(row, 0) = interface_pt.x();
+		residuals(row, 1) = interface_pt.y();
+		residuals(row, 2) = interface_pt.z();
+		residuals(row, 3) = Parameter_Types::InterfaceConstraint;
+		residuals(row, 4) = interface_pt.residual();
+		row++;
+	}
+	for (const auto &planar_pt : measured.planar) {
+		residuals(row, 0) = planar_pt.x();
+		residuals(row, 1) = planar_pt.y();
+		residuals(row, 2) = planar_pt.z();
+		residuals(row, 3) = Parameter_Types::PlanarConstraint;
+		residuals(row, 4) = planar_pt.residual() * R2D;
+		row++;
+	}
+	for (const auto &tangent_pt : measured.tangent) {
+		residuals(row, 0) = tangent_pt.x();
+		residuals(row, 1) = tangent_pt.y();
+		residuals(row, 2) = tangent_pt.z();
+		residuals(row, 3) = Parameter_Types::TangentConstraint;
+		// a tangent fits when it is perpendicular to the gradient
+		residuals(row, 4) = std::abs(90.0 - tangent_pt.residual() * R2D);
+		row++;
+	}
+
+	return residuals;
+}
+
 Surfe_API::Surfe_API(const Parameters& params)
 {
 	method_ = nullptr;
 	have_interpolant_ = false;
 	parameters_changed_ = true;
 	constraints_changed_ = false;
+	progress_chunk_size_ = 65536;
+	task_scheduler_ = nullptr;
+	max_concurrency_ = 0;
 
 	method_ = get_method_from_parameters(params);
 }
@@ -240,13 +572,30 @@ Surfe_API::Surfe_API(const int &modelling_method)
 	else
 		throw GRBF_Exceptions::unknown_modelling_mode;
 
+	have_interpolant_ = false;
 	parameters_changed_ = true;
+	constraints_changed_ = false;
+	progress_chunk_size_ = 65536;
+	task_scheduler_ = nullptr;
+	max_concurrency_ = 0;
+}
+
+Surfe_API::~Surfe_API()
+{
+	// the background thread works on method_
+	std::shared_ptr<Compute_Handle> job = active_job();
+	if (job) {
+		job->Cancel();
+		job->Wait();
+	}
 }
 
 void Surfe_API::AddInterfaceConstraint(const double &x, const double &y, const double &z, const double &level)
 {
+	check_not_computing();
+
 	Interface interface_constraint(x, y, z, level);
-	method_->constraints.itrface.push_back(interface_constraint);
+	constraints_.itrface.push_back(interface_constraint);
 
 	method_->parameters.use_interface = true;
 	constraints_changed_ = true;
@@ -254,8 +603,10 @@ void Surfe_API::AddInterfaceConstraint(const double &x, const double &y, const d
 
 void Surfe_API::AddPlanarConstraintwNormal(const double &x, const double &y, const double &z, const double &nx, const double &ny, const double &nz)
 {
+	check_not_computing();
+
 	Planar planar_constraint(x, y, z, nx, ny, nz);
-	method_->constraints.planar.push_back(planar_constraint);
+	constraints_.planar.push_back(planar_constraint);
 
 	method_->parameters.use_planar = true;
 	constraints_changed_ = true;
@@ -263,8 +614,10 @@ void Surfe_API::AddPlanarConstraintwNormal(const double &x, const double &y, con
 
 void Surfe_API::AddPlanarConstraintwStrikeDipPolarity(const double &x, const double &y, const double &z, const double &strike, const double &dip, const int &polarity)
 {
+	check_not_computing();
+
 	Planar planar_constraint(x, y, z, dip, strike, polarity);
-	method_->constraints.planar.push_back(planar_constraint);
+	constraints_.planar.push_back(planar_constraint);
 
 	method_->parameters.use_planar = true;
 	constraints_changed_ = true;
@@ -272,6 +625,8 @@ void Surfe_API::AddPlanarConstraintwStrikeDipPolarity(const double &x, const dou
 
 void Surfe_API::AddPlanarConstraintwAzimuthDipPolarity(const double &x, const double &y, const double &z, const double &azimuth, const double &dip, const int &polarity)
 {
+	check_not_computing();
+
 	double strike = 0.0;
 	// convert azimuth to strike
 	if (azimuth >= 90.0)
@@ -279,7 +634,7 @@ void Surfe_API::AddPlanarConstraintwAzimuthDipPolarity(const double &x, const do
 	else
 		strike = azimuth + 270.0;
 	Planar planar_constraint(x, y, z, dip, strike, polarity);
-	method_->constraints.planar.push_back(planar_constraint);
+	constraints_.planar.push_back(planar_constraint);
 
 	method_->parameters.use_planar = true;
 	constraints_changed_ = true;
@@ -287,8 +642,10 @@ void Surfe_API::AddPlanarConstraintwAzimuthDipPolarity(const double &x, const do
 
 void Surfe_API::AddTangentConstraint(const double &x, const double &y, const double &z, const double &tx, const double &ty, const double &tz)
 {
+	check_not_computing();
+
 	Tangent tangent_constraint(x, y, z, tx, ty, tz);
-	method_->constraints.tangent.push_back(tangent_constraint);
+	constraints_.tangent.push_back(tangent_constraint);
 
 	method_->parameters.use_tangent = true;
 	constraints_changed_ = true;
@@ -296,32 +653,96 @@ void Surfe_API::AddTangentConstraint(const double &x, const double &y, const dou
 
 void Surfe_API::AddInequalityConstraint(const double &x, const double &y, const double &z, const double &level)
 {
+	check_not_computing();
+
 	Inequality inequality_constraint(x, y, z, level);
-	method_->constraints.inequality.push_back(inequality_constraint);
+	constraints_.inequality.push_back(inequality_constraint);
 
 	method_->parameters.use_inequality = true;
 	constraints_changed_ = true;
 }
 
+void Surfe_API::report_progress(const std::string &stage, const double &fraction)
+{
+	if (progress_callback_)
+		progress_callback_(stage, fraction);
+}
+
+void Surfe_API::SetProgressCallback(const ProgressCallback &callback)
+{
+	check_not_computing();
+
+	progress_callback_ = callback;
+}
+
+void Surfe_API::SetTaskScheduler(Task_Scheduler *scheduler)
+{
+	check_not_computing();
+
+	task_scheduler_ = scheduler;
+}
+
+void Surfe_API::SetMaxConcurrency(const int &max_threads)
+{
+	check_not_computing();
+
+	max_concurrency_ = max_threads < 0 ? 0 : max_threads;
+}
+
+void Surfe_API::check_not_computing() const
+{
+	std::shared_ptr<Compute_Handle> job = active_job();
+	if (!job)
+		return;
+	const Parameter_Types::ComputePhase phase = job->GetPhase();
+	if (phase != Parameter_Types::Complete && phase != Parameter_Types::Cancelled && phase != Parameter_Types::Failed)
+		throw GRBF_Exceptions::computation_in_progress;
+}
+
+void Surfe_API::check_interpolant_current() const
+{
+	check_not_computing();
+	if (!have_interpolant_)
+		throw GRBF_Exceptions::missing_interpolant;
+	if (constraints_changed_ || parameters_changed_)
+		throw GRBF_Exceptions::interpolant_needs_update;
+}
+
 void Surfe_API::ComputeInterpolant()
 {
-	method_->remove_collocated_constraints();
+	std::shared_ptr<Compute_Handle> job = active_job();
+	if (job && !job->IsDone())
+		throw GRBF_Exceptions::computation_in_progress;
+
+	compute_interpolant(nullptr);
+}
+
+void Surfe_API::SaveInterpolant(const char *filename)
+{
+	check_interpolant_current();
 
 	try
 	{
-		method_->process_input_data();
+		Interpolant_Snapshot::save(filename, Interpolant_Snapshot::get_modelling_method_code(method_), method_);
 	}
 	catch (const std::exception& e)
 	{
 		SurfeExceptions exceptions(e);
 		throw exceptions;
 	}
+}
 
-	method_->get_method_parameters();
+void Surfe_API::LoadInterpolant(const char *filename)
+{
+	std::shared_ptr<Compute_Handle> job = active_job();
+	if (job && !job->IsDone())
+		throw GRBF_Exceptions::computation_in_progress;
 
+	GRBF_Modelling_Methods *method = nullptr;
 	try
 	{
-		method_->setup_basis_functions();
+		int modelling_method = 0;
+		method = Interpolant_Snapshot::load(filename, modelling_method);
 	}
 	catch (const std::exception& e)
 	{
@@ -329,25 +750,174 @@ void Surfe_API::ComputeInterpolant()
 		throw exceptions;
 	}
 
+	delete method_;
+	method_ = method;
+	constraints_ = method_->constraints;
+	have_interpolant_ = true;
+	constraints_changed_ = false;
+	parameters_changed_ = false;
+}
+
+void Surfe_API::compute_interpolant(Compute_Status *status)
+{
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+	// the dense solve uses the threads of the scope unless this computation is a task itself (Surfe_Batch)
+	Eigen_Threads_Scope eigen_threads;
+	// computed on a copy of the method that replaces method_ once solved, so a
+	// cancelled or failed computation leaves the previous interpolant intact
+	std::unique_ptr<GRBF_Modelling_Methods> method(method_->clone());
+	// status is only set for background computations
+	method->status = status;
+	if (status)
+		status->set_phase(Parameter_Types::Preprocessing);
+
 	try
 	{
-		method_->setup_system_solver();
+		if (status) status->check_cancelled();  // cancelled while queued
+		report_progress("preprocessing", 0.0);
+		// the method merges, declusters and selects on its own copy, the
+		// constraints of this instance are kept as set
+		method->constraints = constraints_;
+		method->remove_collocated_constraints();
+		method->decluster_constraints();
+		method->select_centers();
+		method->process_input_data();
+		method->get_method_parameters();
+		if (status) status->check_cancelled();
+
+		report_progress("setting up basis functions", 0.25);
+		method->setup_basis_functions();
+		if (status) status->check_cancelled();
+
+		report_progress("solving", 0.5);
+		method->setup_system_solver();
 	}
 	catch (const std::exception& e)
 	{
 		SurfeExceptions exceptions(e);
 		throw exceptions;
 	}
+	method->status = nullptr;
 
 	std::cout << "Interpolant has been computed" << std::endl;
 
+	delete method_;
+	method_ = method.release();
 	have_interpolant_ = true;
 	constraints_changed_ = false;
 	parameters_changed_ = false;
+	report_progress("complete", 1.0);
+}
+
+std::shared_ptr<Compute_Handle> Surfe_API::ComputeInterpolantAsync(const CompletionCallback &on_complete /*= CompletionCallback()*/)
+{
+	std::shared_ptr<Compute_Handle> job = active_job();
+	if (job && !job->IsDone())
+		throw GRBF_Exceptions::computation_in_progress;
+
+	std::shared_ptr<Compute_Handle> handle = std::make_shared<Compute_Handle>();
+	handle->status_.set_phase(Parameter_Types::Preprocessing);
+	set_active_job(handle);
+	// the thread keeps its own reference so the handle outlives the computation
+	handle->thread_ = std::thread([this, handle, on_complete]() {
+		run_compute_job(handle, on_complete);
+	});
+
+	return handle;
+}
+
+void Surfe_API::ComputeInterpolant(const std::shared_ptr<Compute_Handle> &handle, const CompletionCallback &on_complete /*= CompletionCallback()*/)
+{
+	std::shared_ptr<Compute_Handle> job = active_job();
+	if (job && !job->IsDone())
+		throw GRBF_Exceptions::computation_in_progress;
+
+	// a handle cancelled before it got here ends as Cancelled right away
+	handle->status_.set_phase(Parameter_Types::Preprocessing);
+	set_active_job(handle);
+	run_compute_job(handle, on_complete);
+}
+
+void Surfe_API::run_compute_job(const std::shared_ptr<Compute_Handle> &handle, const CompletionCallback &on_complete)
+{
+	Parameter_Types::ComputePhase phase = Parameter_Types::Complete;
+	std::string error_message;
+	try
+	{
+		compute_interpolant(&handle->status_);
+	}
+	catch (const std::exception& e)
+	{
+		phase = handle->status_.cancel_requested() ? Parameter_Types::Cancelled : Parameter_Types::Failed;
+		error_message = e.what();
+	}
+	handle->status_.set_phase(phase);
+
+	if (on_complete) {
+		try
+		{
+			on_complete(phase);
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << e.what() << std::endl;
+		}
+	}
+	handle->finish(error_message);
+}
+
+Compute_Handle::~Compute_Handle()
+{
+	if (thread_.joinable()) {
+		// the last reference can be released by the worker thread itself
+		if (thread_.get_id() == std::this_thread::get_id())
+			thread_.detach();
+		else
+			thread_.join();
+	}
+}
+
+void Compute_Handle::finish(const std::string &error_message)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	error_message_ = error_message;
+	done_ = true;
+	done_condition_.notify_all();
+}
+
+void Compute_Handle::Wait()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_condition_.wait(lock, [this]() { return done_; });
+}
+
+bool Compute_Handle::WaitFor(const double &seconds)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	return done_condition_.wait_for(lock, std::chrono::duration<double>(seconds), [this]() { return done_; });
+}
+
+void Compute_Handle::Cancel()
+{
+	status_.request_cancel();
+}
+
+bool Compute_Handle::IsDone()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return done_;
+}
+
+std::string Compute_Handle::GetErrorMessage()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return error_message_;
 }
 
 void Surfe_API::SetRegressionSmoothing(const bool &use_regression_smoothing, const double &amount /*= 0*/)
 {
+	check_not_computing();
+
 	method_->parameters.use_regression_smoothing = true;
 	method_->parameters.smoothing_amount = amount;
 
@@ -356,6 +926,8 @@ void Surfe_API::SetRegressionSmoothing(const bool &use_regression_smoothing, con
 
 void Surfe_API::SetGreedyAlgorithm(const bool &use_greedy, const double &interface_uncertainty /*= 0*/, const double &angular_uncertainty /*= 0*/)
 {
+	check_not_computing();
+
 	method_->parameters.use_greedy = true;
 	method_->parameters.interface_uncertainty = interface_uncertainty;
 	method_->parameters.angular_uncertainty = angular_uncertainty;
@@ -365,6 +937,8 @@ void Surfe_API::SetGreedyAlgorithm(const bool &use_greedy, const double &interfa
 
 void Surfe_API::SetRBFKernel(const Parameter_Types::RBF &rbf)
 {
+	check_not_computing();
+
 	method_->parameters.basis_type = rbf;
 
 	parameters_changed_ = true;
@@ -372,6 +946,7 @@ void Surfe_API::SetRBFKernel(const Parameter_Types::RBF &rbf)
 
 void Surfe_API::SetRBFKernel(const char *rbf_name)
 {
+	check_not_computing();
 	if (strcmp(rbf_name, "r3") == 0)
 		method_->parameters.basis_type = Parameter_Types::RBF::Cubic;
 	else if (strcmp(rbf_name, "WendlandC2") == 0)
@@ -396,6 +971,8 @@ void Surfe_API::SetRBFKernel(const char *rbf_name)
 
 void Surfe_API::SetRBFShapeParameter(const double &shape_param)
 {
+	check_not_computing();
+
 	method_->parameters.shape_parameter = shape_param;
 
 	parameters_changed_ = true;
@@ -403,6 +980,8 @@ void Surfe_API::SetRBFShapeParameter(const double &shape_param)
 
 void Surfe_API::SetPolynomialOrder(const int &poly_order)
 {
+	check_not_computing();
+
 	method_->parameters.polynomial_order = poly_order;
 
 	parameters_changed_ = true;
@@ -410,14 +989,63 @@ void Surfe_API::SetPolynomialOrder(const int &poly_order)
 
 void Surfe_API::SetGlobalAnisotropy(const bool &g_anisotropy)
 {
+	check_not_computing();
+
 	method_->parameters.model_global_anisotropy = g_anisotropy;
 
 	parameters_changed_ = true;
 }
 
+void Surfe_API::SetDeclustering(const bool &use_declustering, const double &spacing, const Parameter_Types::DeclusterMethod &method /*= Parameter_Types::VoxelGrid*/)
+{
+	check_not_computing();
+
+	method_->parameters.use_declustering = use_declustering;
+	method_->parameters.decluster_spacing = spacing;
+	method_->parameters.decluster_method = method;
+
+	parameters_changed_ = true;
+}
+
+void Surfe_API::SetDeclustering(const bool &use_declustering, const double &spacing, const char *method_name)
+{
+	check_not_computing();
+	if (strcmp(method_name, "voxel") == 0)
+		SetDeclustering(use_declustering, spacing, Parameter_Types::VoxelGrid);
+	else if (strcmp(method_name, "poisson") == 0)
+		SetDeclustering(use_declustering, spacing, Parameter_Types::PoissonDisk);
+	else
+		throw GRBF_Exceptions::unknown_decluster_method;
+}
+
+void Surfe_API::SetCenterSelection(const bool &use_center_selection, const int &max_centers, const double &tolerance /*= 0*/,
+	const Parameter_Types::CenterSelectionMethod &method /*= Parameter_Types::PGreedy*/)
+{
+	check_not_computing();
+
+	method_->parameters.use_center_selection = use_center_selection;
+	method_->parameters.max_centers = max_centers;
+	method_->parameters.center_selection_tolerance = tolerance;
+	method_->parameters.center_selection_method = method;
+
+	parameters_changed_ = true;
+}
+
+void Surfe_API::SetCenterSelection(const bool &use_center_selection, const int &max_centers, const double &tolerance, const char *method_name)
+{
+	check_not_computing();
+	if (strcmp(method_name, "p-greedy") == 0)
+		SetCenterSelection(use_center_selection, max_centers, tolerance, Parameter_Types::PGreedy);
+	else if (strcmp(method_name, "f-greedy") == 0)
+		SetCenterSelection(use_center_selection, max_centers, tolerance, Parameter_Types::FGreedy);
+	else
+		throw GRBF_Exceptions::unknown_center_selection_method;
+}
 
 void Surfe_API::SetRestrictedRange(const bool &use_restricted_range, const double &interface_uncertainty /*= 0*/, const double &angular_uncertainty /*= 0*/)
 {
+	check_not_computing();
+
 	method_->parameters.use_restricted_range = use_restricted_range;
 	method_->parameters.interface_uncertainty = interface_uncertainty;
 	method_->parameters.angular_uncertainty = angular_uncertainty;
@@ -427,6 +1055,7 @@ void Surfe_API::SetRestrictedRange(const bool &use_restricted_range, const doubl
 
 double Surfe_API::EvaluateInterpolantAtPoint(const double &x, const double &y, const double &z)
 {
+	check_not_computing();
 	if (have_interpolant_)
 	{
 		if (constraints_changed_ || parameters_changed_)
@@ -441,26 +1070,39 @@ double Surfe_API::EvaluateInterpolantAtPoint(const double &x, const double &y, c
 	else
 		throw GRBF_Exceptions::missing_interpolant;
 }
-VectorXd Surfe_API::EvaluateInterpolantAtPoints(const MatrixXd &locations)
+VectorXd Surfe_API::EvaluateInterpolantAtPoints(const ConstMatrixView &locations)
 {
+	check_not_computing();
+
 	// if so, erase
 	if (have_interpolant_)
 	{
+		if (constraints_changed_ || parameters_changed_)
+			throw GRBF_Exceptions::interpolant_needs_update;
+
 		int n = locations.rows();
 		VectorXd interpolant(n);
 		if (n != 0 && locations.cols() == 3)
 		{
-#pragma omp parallel for
-			for (int j = 0; j < n; j++)
+			Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+			// evaluated in chunks so progress can be reported from this thread
+			for (int begin = 0; begin < n; begin += progress_chunk_size_)
 			{
-				// convert x,y,z to Point
-				Point pt(locations(j,0),locations(j,1),locations(j,2));
-
-				// evaluate scalar field at this point
-				method_->eval_scalar_interpolant_at_point(pt);
-
-				// set scalar field value for this point in vector
-				interpolant(j) = pt.scalar_field();
+				int end = std::min(begin + progress_chunk_size_, n);
+				parallel_for(end - begin, 256, [&](const int &first, const int &last) {
+					for (int j = begin + first; j < begin + last; j++)
+					{
+						// convert x,y,z to Point
+						Point pt(locations(j,0),locations(j,1),locations(j,2));
+
+						// evaluate scalar field at this point
+						method_->eval_scalar_interpolant_at_point(pt);
+
+						// set scalar field value for this point in vector
+						interpolant(j) = pt.scalar_field();
+					}
+				});
+				report_progress("evaluating", (double)end / n);
 			}
 		
 			return interpolant;
@@ -477,6 +1119,7 @@ VectorXd Surfe_API::EvaluateInterpolantAtPoints(const MatrixXd &locations)
 }
 Vector3d Surfe_API::EvaluateVectorInterpolantAtPoint(const double &x, const double &y, const double &z)
 {
+	check_not_computing();
 	if (have_interpolant_)
 	{
 		if (constraints_changed_ || parameters_changed_)
@@ -497,29 +1140,40 @@ Vector3d Surfe_API::EvaluateVectorInterpolantAtPoint(const double &x, const doub
 		throw GRBF_Exceptions::missing_interpolant;
 }
 
-MatrixXd Surfe_API::EvaluateVectorInterpolantAtPoints(const MatrixXd &locations)
+MatrixXd Surfe_API::EvaluateVectorInterpolantAtPoints(const ConstMatrixView &locations)
 {
+	check_not_computing();
+
 	// if so, erase
 	if (have_interpolant_)
 	{
+		if (constraints_changed_ || parameters_changed_)
+			throw GRBF_Exceptions::interpolant_needs_update;
+
 		int n = locations.rows();
 		MatrixXd interpolant(n,3);
 		if (n != 0 && locations.cols() == 3)
 		{
-#pragma omp parallel for
-			for (int j = 0; j < n; j++)
+			Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+			for (int begin = 0; begin < n; begin += progress_chunk_size_)
 			{
-				double gradient[3];
-				// convert x,y,z to Point
-				Point pt(locations(j,0),locations(j,1),locations(j,2));
-
-				// evaluate scalar field at this point
-				method_->eval_vector_interpolant_at_point(pt);
-
-				// set vector components field value for this point in vector
-				interpolant(j,0) = pt.nx_interp();
-				interpolant(j,1) = pt.ny_interp();
-				interpolant(j,2) = pt.nz_interp();
+				int end = std::min(begin + progress_chunk_size_, n);
+				parallel_for(end - begin, 256, [&](const int &first, const int &last) {
+					for (int j = begin + first; j < begin + last; j++)
+					{
+						// convert x,y,z to Point
+						Point pt(locations(j,0),locations(j,1),locations(j,2));
+
+						// evaluate scalar field at this point
+						method_->eval_vector_interpolant_at_point(pt);
+
+						// set vector components field value for this point in vector
+						interpolant(j,0) = pt.nx_interp();
+						interpolant(j,1) = pt.ny_interp();
+						interpolant(j,2) = pt.nz_interp();
+					}
+				});
+				report_progress("evaluating", (double)end / n);
 			}
 		
 			return interpolant;
@@ -533,4 +1187,275 @@ MatrixXd Surfe_API::EvaluateVectorInterpolantAtPoints(const MatrixXd &locations)
 		throw GRBF_Exceptions::missing_interpolant;
 
 	
+}
+
+MatrixXd Surfe_API::EvaluateInterpolantAndDerivativesAtPoints(const ConstMatrixView &locations, const bool &with_hessian)
+{
+	check_interpolant_current();
+	int n = locations.rows();
+	if (n == 0 || locations.cols() != 3)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
+	// one pass over the flattened rbf terms gives every derivative of a center
+	Fused_Evaluator evaluator(std::vector<Surfe_API *>(1, this));
+	evaluator.SetTaskScheduler(task_scheduler_);
+	evaluator.SetMaxConcurrency(max_concurrency_);
+	MatrixXd derivatives(n, with_hessian ? 10 : 4);
+	MatrixXd values, gradients, hessians;
+	for (int begin = 0; begin < n; begin += progress_chunk_size_)
+	{
+		int end = std::min(begin + progress_chunk_size_, n);
+		if (with_hessian)
+			evaluator.EvaluateInterpolantsAndDerivativesAtPoints(locations.middleRows(begin, end - begin), values, gradients, hessians);
+		else
+			evaluator.EvaluateInterpolantsAndGradientsAtPoints(locations.middleRows(begin, end - begin), values, gradients);
+		derivatives.block(begin, 0, end - begin, 1) = values;
+		derivatives.block(begin, 1, end - begin, 3) = gradients;
+		if (with_hessian)
+			derivatives.block(begin, 4, end - begin, 6) = hessians;
+		report_progress("evaluating", (double)end / n);
+	}
+	return derivatives;
+}
+
+VectorXd Surfe_API::EvaluateOnRegularGrid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims)
+{
+	check_interpolant_current();
+	if (dims.minCoeff() <= 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
+	Fused_Evaluator evaluator(std::vector<Surfe_API *>(1, this));
+	evaluator.SetTaskScheduler(task_scheduler_);
+	evaluator.SetMaxConcurrency(max_concurrency_);
+	MatrixXd values((long long)dims(0) * dims(1) * dims(2), 1);
+	// slabs of z slices of about progress_chunk_size_ points
+	const int slab = std::max(1, progress_chunk_size_ / (dims(0) * dims(1)));
+	for (int first = 0; first < dims(2); first += slab)
+	{
+		int last = std::min(first + slab, dims(2));
+		evaluator.evaluate_grid(origin, spacing, dims, first, last, values);
+		report_progress("evaluating", (double)last / dims(2));
+	}
+	return values.col(0);
+}
+
+void Surfe_API::WriteRegularGrid(const char *filename, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const bool &single_precision, const bool &compress)
+{
+	check_interpolant_current();
+	if (dims.minCoeff() <= 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
+	Fused_Evaluator evaluator(std::vector<Surfe_API *>(1, this));
+	evaluator.SetTaskScheduler(task_scheduler_);
+	evaluator.SetMaxConcurrency(max_concurrency_);
+	Grid_File_Writer writer(filename, origin, spacing, dims, "Scalar Field", single_precision, compress);
+	// slabs of z slices of about progress_chunk_size_ points. A slab is written
+	// by a second thread while the next one is evaluated, so memory holds two
+	// slabs whatever the size of the grid
+	const long long slice_points = (long long)dims(0) * dims(1);
+	const int slab = (int)std::max(1LL, progress_chunk_size_ / slice_points);
+	MatrixXd slabs[2] = { MatrixXd(slice_points * slab, 1), MatrixXd(slice_points * slab, 1) };
+	std::thread write_thread;
+	std::exception_ptr write_error;
+	auto wait_for_write = [&]() {
+		if (write_thread.joinable())
+			write_thread.join();
+		if (write_error)
+			std::rethrow_exception(write_error);
+	};
+	try
+	{
+		for (int first = 0, n = 0; first < dims(2); first += slab, n++)
+		{
+			const int n_slices = std::min(slab, dims(2) - first);
+			MatrixXd &values = slabs[n % 2];
+			const Vector3d slab_origin(origin(0), origin(1), origin(2) + first * spacing(2));
+			evaluator.evaluate_grid(slab_origin, spacing, Vector3i(dims(0), dims(1), n_slices), 0, n_slices, values);
+			wait_for_write();
+			write_thread = std::thread([this, &writer, &values, &write_error, n_slices]() {
+				try
+				{
+					// the blocks of a compressed file are compressed in parallel
+					Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+					writer.WriteSlices(values.data(), n_slices);
+				}
+				catch (...)
+				{
+					write_error = std::current_exception();
+				}
+			});
+			report_progress("evaluating", (double)(first + n_slices) / dims(2));
+		}
+		wait_for_write();
+	}
+	catch (...)
+	{
+		if (write_thread.joinable())
+			write_thread.join();
+		throw;
+	}
+	writer.Close();
+}
+
+void Surfe_API::evaluate_grid_pyramid(const Fused_Evaluator &evaluator, const Vector3d &origin, const Vector3d &spacing,
+	const Vector3i &dims, const int &n_levels, const int &slab_points,
+	const std::function<void(const Grid_Level *level, const double &fraction)> &report)
+{
+	// points of all the levels for the progress, the finest level has 8/7 of
+	// those of the whole pyramid
+	double n_points = 0;
+	for (int l = 0; l < n_levels; l++) {
+		const Vector3i level_dims = (dims.array() - 1) / (1 << (n_levels - 1 - l)) + 1;
+		n_points += (double)level_dims(0) * level_dims(1) * level_dims(2);
+	}
+
+	MatrixXd coarse_values;
+	double n_done = 0;
+	for (int l = 0; l < n_levels; l++)
+	{
+		Grid_Level level;
+		level.level = l;
+		level.stride = 1 << (n_levels - 1 - l);
+		level.origin = origin;
+		level.spacing = spacing * level.stride;
+		level.dims = (dims.array() - 1) / level.stride + 1;
+		const int slice_points = level.dims(0) * level.dims(1);
+		MatrixXd values((long long)slice_points * level.dims(2), 1);
+		// the points shared with the previous level are copied, not evaluated
+		if (l > 0)
+			Fused_Evaluator::copy_coarse_points(coarse_values, level.dims, values);
+		const int slab = std::max(1, slab_points / slice_points);
+		for (int first = 0; first < level.dims(2); first += slab)
+		{
+			int last = std::min(first + slab, level.dims(2));
+			evaluator.evaluate_grid(level.origin, level.spacing, level.dims, first, last, values, l > 0);
+			report(nullptr, (n_done + (double)slice_points * last) / n_points);
+		}
+		n_done += (double)values.rows();
+		level.values = values.col(0);
+		coarse_values.swap(values);
+		report(&level, n_done / n_points);
+	}
+}
+
+// n_levels 0: automatic
+static int pyramid_levels(const Vector3i &dims, const int &n_levels)
+{
+	if (dims.minCoeff() <= 0 || n_levels < 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	return n_levels == 0 ? automatic_pyramid_levels(dims) : std::min(n_levels, 31);
+}
+
+std::vector<Grid_Level> Surfe_API::EvaluateGridPyramid(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const int &n_levels, const LevelCallback &on_level)
+{
+	check_interpolant_current();
+	const int levels = pyramid_levels(dims, n_levels);
+
+	Fused_Evaluator evaluator(std::vector<Surfe_API *>(1, this));
+	evaluator.SetTaskScheduler(task_scheduler_);
+	evaluator.SetMaxConcurrency(max_concurrency_);
+	std::vector<Grid_Level> pyramid;
+	evaluate_grid_pyramid(evaluator, origin, spacing, dims, levels, progress_chunk_size_,
+		[&](const Grid_Level *level, const double &fraction) {
+		if (level) {
+			pyramid.push_back(*level);
+			if (on_level)
+				on_level(*level);
+		}
+		else
+			report_progress("evaluating", fraction);
+	});
+	return pyramid;
+}
+
+std::shared_ptr<Grid_Pyramid_Handle> Surfe_API::EvaluateGridPyramidAsync(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const int &n_levels, const LevelCallback &on_level)
+{
+	check_interpolant_current();
+	const int levels = pyramid_levels(dims, n_levels);
+
+	// the evaluator holds its own copy of the rbf terms
+	std::shared_ptr<Fused_Evaluator> evaluator = std::make_shared<Fused_Evaluator>(std::vector<Surfe_API *>(1, this));
+	evaluator->SetTaskScheduler(task_scheduler_);
+	evaluator->SetMaxConcurrency(max_concurrency_);
+	std::shared_ptr<Grid_Pyramid_Handle> handle = std::make_shared<Grid_Pyramid_Handle>(levels);
+	const int slab_points = progress_chunk_size_;
+	// the thread keeps its own reference so the handle outlives the evaluation
+	handle->thread_ = std::thread([handle, evaluator, origin, spacing, dims, levels, slab_points, on_level]() {
+		std::string error_message;
+		try
+		{
+			evaluate_grid_pyramid(*evaluator, origin, spacing, dims, levels, slab_points,
+				[&handle, &on_level](const Grid_Level *level, const double &fraction) {
+				if (level) {
+					handle->publish(*level);
+					if (on_level)
+						on_level(*level);
+				}
+				handle->set_fraction(fraction);
+				if (handle->cancel_requested_)
+					throw GRBF_Exceptions::evaluation_cancelled;
+			});
+		}
+		catch (const std::exception& e)
+		{
+			error_message = e.what();
+		}
+		handle->finish(error_message);
+	});
+
+	return handle;
+}
+
+std::vector<Iso_Surface> Surfe_API::GetIsoSurfaces(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims)
+{
+	check_interpolant_current();
+	return GetIsoSurfaces(origin, spacing, dims, method_->get_interface_iso_values());
+}
+
+std::vector<Iso_Surface> Surfe_API::GetIsoSurfaces(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const std::vector<double> &iso_values)
+{
+	check_interpolant_current();
+
+	VectorXd volume = EvaluateOnRegularGrid(origin, spacing, dims);
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+	std::vector<Iso_Surface> surfaces = extract_iso_surfaces(volume.data(), origin, spacing, dims, iso_values);
+	report_progress("contouring", 1.0);
+	return surfaces;
+}
+
+std::vector<Iso_Surface> Surfe_API::GetIsoSurfacesAdaptive(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const int &coarse_stride)
+{
+	check_interpolant_current();
+	return GetIsoSurfacesAdaptive(origin, spacing, dims, method_->get_interface_iso_values(), coarse_stride);
+}
+
+std::vector<Iso_Surface> Surfe_API::GetIsoSurfacesAdaptive(const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const std::vector<double> &iso_values, const int &coarse_stride)
+{
+	check_interpolant_current();
+	if (dims.minCoeff() <= 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+
+	Fused_Evaluator evaluator(std::vector<Surfe_API *>(1, this));
+	evaluator.SetTaskScheduler(task_scheduler_);
+	evaluator.SetMaxConcurrency(max_concurrency_);
+	Field_Sampler sample = [&evaluator](const MatrixXd &points, VectorXd &values, VectorXd *gradient_norms) {
+		if (gradient_norms) {
+			MatrixXd all_values, gradients;
+			evaluator.EvaluateInterpolantsAndGradientsAtPoints(points, all_values, gradients);
+			values = all_values.col(0);
+			*gradient_norms = gradients.rowwise().norm();
+		}
+		else
+			values = evaluator.EvaluateInterpolantsAtPoints(points).col(0);
+	};
+	Scheduler_Scope scope(task_scheduler_, max_concurrency_);
+	std::vector<Iso_Surface> surfaces = extract_iso_surfaces_adaptive(sample, origin, spacing, dims, iso_values, coarse_stride);
+	report_progress("contouring", 1.0);
+	return surfaces;
 }
\ No newline at end of file
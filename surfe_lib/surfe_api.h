@@ -9,22 +9,121 @@
 #include <single_surface.h>
 #include <stratigraphic_surfaces.h>
 #include <vector_field.h>
+#include <compute_status.h>
+#include <iso_surface.h>
+#include <grid_pyramid.h>
+#include <task_scheduler.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
+
+// called with the current stage name and the fraction [0,1] of the work done.
+// Invoked from the thread doing the work: the thread that called into
+// Surfe_API, the background thread of ComputeInterpolantAsync and
+// EvaluateGridPyramidAsync, or a task scheduler thread for the models computed
+// by Surfe_Batch
+typedef std::function<void(const std::string &stage, const double &fraction)> ProgressCallback;
+
+// called once a background computation ends with Complete, Cancelled or Failed
+typedef std::function<void(const Parameter_Types::ComputePhase &phase)> CompletionCallback;
+
+// read-only strided view of a constraint or location array. Binds row major
+// (numpy default) and column major arrays without copying them
+typedef Eigen::Ref<const MatrixXd, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> > ConstMatrixView;
+
+// Handle on an interpolant computed in the background by
+// Surfe_API::ComputeInterpolantAsync(). Until the computation has ended the
+// other methods of the Surfe_API instance throw computation_in_progress. A
+// cancelled or failed computation leaves the previous interpolant in place.
+class SURFE_LIB_EXPORT Compute_Handle {
+private:
+	friend class Surfe_API;
+	friend class Surfe_Batch;
+	Compute_Status status_;
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable done_condition_;
+	bool done_;
+	std::string error_message_;
+
+	void finish(const std::string &error_message);
+
+public:
+	Compute_Handle() : done_(false) {}
+	~Compute_Handle();
+
+	// block until the computation ended and the completion callback has run
+	void Wait();
+	// returns false if the computation is still running after seconds
+	bool WaitFor(const double &seconds);
+	// request cancellation. Honoured at the next assembled matrix row, solver
+	// iteration or greedy iteration, the phase then ends as Cancelled
+	void Cancel();
+	bool IsDone();
+	Parameter_Types::ComputePhase GetPhase() const { return status_.phase(); }
+	Compute_Progress GetProgress() const { return status_.progress(); }
+	// what() of the exception that ended a Failed or Cancelled computation
+	std::string GetErrorMessage();
+};
+
+class Fused_Evaluator;
+
 class SURFE_LIB_EXPORT Surfe_API {
 private:
+	friend class Surfe_Batch;
+	friend class Fused_Evaluator;
 	// members
 	GRBF_Modelling_Methods *method_;
+	// constraints as set. Copied to method_ by every computation, the method
+	// solves with the merged, declustered or selected subset of them
+	Constraints constraints_;
 
 	bool have_interpolant_;
 	bool parameters_changed_;
 	bool constraints_changed_;
 
+	ProgressCallback progress_callback_;
+	int progress_chunk_size_;  // # of points evaluated between progress reports
+
+	// last computation started by ComputeInterpolantAsync() or Surfe_Batch. Other
+	// threads check it while it runs, so it is only read and replaced atomically
+	std::shared_ptr<Compute_Handle> active_job_;
+
+	Task_Scheduler *task_scheduler_;  // nullptr: process wide default
+	int max_concurrency_;  // max # of threads per parallel loop, 0 = no limit
+
 	// methods
+	std::shared_ptr<Compute_Handle> active_job() const { return std::atomic_load(&active_job_); }
+	void set_active_job(const std::shared_ptr<Compute_Handle> &job) { std::atomic_store(&active_job_, job); }
+	// throws computation_in_progress until the last computation has ended. Its
+	// completion callback may already use the instance
+	void check_not_computing() const;
+	// throws missing_interpolant or interpolant_needs_update unless the
+	// interpolant was computed with the current constraints and parameters
+	void check_interpolant_current() const;
 	GRBF_Modelling_Methods* get_method_from_parameters(const Parameters& params);
+	void report_progress(const std::string &stage, const double &fraction);
+	void compute_interpolant(Compute_Status *status);
+	// runs compute_interpolant() for a job started by ComputeInterpolantAsync()
+	// or Surfe_Batch, sets its final phase and marks it done
+	void run_compute_job(const std::shared_ptr<Compute_Handle> &handle, const CompletionCallback &on_complete);
+	// levels of a grid pyramid coarse to fine, each evaluated by slabs of
+	// about slab_points points. report is called after every slab with the
+	// fraction of the points done, and with each complete level (nullptr
+	// otherwise); it may throw to stop the evaluation
+	static void evaluate_grid_pyramid(const Fused_Evaluator &evaluator, const Vector3d &origin, const Vector3d &spacing,
+		const Vector3i &dims, const int &n_levels, const int &slab_points,
+		const std::function<void(const Grid_Level *level, const double &fraction)> &report);
 
 public:
 	Surfe_API(const int &modelling_method);
 	Surfe_API(const Parameters& params);
+	// cancels and waits for a running ComputeInterpolantAsync()
+	~Surfe_API();
 	
 	// Manually (no input files) adding constraints to interpolant methods
 	void AddInterfaceConstraint(
@@ -52,6 +151,29 @@ public:
 		const double &level
 	);
 	void ComputeInterpolant();
+	// compute the interpolant on a background thread. Throws
+	// computation_in_progress if a previous computation is still running.
+	// Until it has ended, the other methods of this instance throw
+	// computation_in_progress as well
+	std::shared_ptr<Compute_Handle> ComputeInterpolantAsync(const CompletionCallback &on_complete = CompletionCallback());
+	// same computation on the calling thread, reporting to and cancellable
+	// through a new handle created by the caller, e.g. to queue the computation
+	// on a thread of its own and poll or cancel it meanwhile
+	void ComputeInterpolant(const std::shared_ptr<Compute_Handle> &handle, const CompletionCallback &on_complete = CompletionCallback());
+	// binary snapshot of the computed interpolant (see interpolant_snapshot.h)
+	void SaveInterpolant(const char *filename);
+	// replaces the modelling method, parameters and constraints of this instance
+	// with a saved interpolant. Ready to evaluate, nothing is solved again
+	void LoadInterpolant(const char *filename);
+	// empty callback disables progress reporting
+	void SetProgressCallback(const ProgressCallback &callback);
+	const ProgressCallback &GetProgressCallback() const { return progress_callback_; }
+	// thread pool running the parallel loops of this instance, e.g. a pool owned
+	// by the host application. nullptr selects the process wide default. Not owned
+	void SetTaskScheduler(Task_Scheduler *scheduler);
+	// caps the # of threads working on any parallel loop of this instance
+	// (0 = as many as the scheduler has)
+	void SetMaxConcurrency(const int &max_threads);
 	void SetRegressionSmoothing(const bool &use_regression_smoothing, const double &amount);
 	void SetGreedyAlgorithm(const bool &use_greedy, const double &interface_uncertainty, const double &angular_uncertainty);
 	void SetRestrictedRange(const bool &use_restricted_range, const double &interface_uncertainty = 0, const double &angular_uncertainty = 0);
@@ -60,17 +182,83 @@ public:
 	void SetRBFShapeParameter(const double &shape_param);
 	void SetPolynomialOrder(const int &poly_order);
 	void SetGlobalAnisotropy(const bool &g_anisotropy);
+	// thin dense interface/planar/tangent constraints to spacing before solving
+	// method name: "voxel" or "poisson"
+	void SetDeclustering(const bool &use_declustering, const double &spacing, const Parameter_Types::DeclusterMethod &method = Parameter_Types::VoxelGrid);
+	void SetDeclustering(const bool &use_declustering, const double &spacing, const char *method_name);
+	// select a compact subset of at most max_centers constraints before solving.
+	// The polynomial unisolvent set and two points per interface are always
+	// kept, so few centers and many interfaces can exceed max_centers
+	// method name: "p-greedy" (power function) or "f-greedy" (residual)
+	void SetCenterSelection(const bool &use_center_selection, const int &max_centers, const double &tolerance = 0,
+		const Parameter_Types::CenterSelectionMethod &method = Parameter_Types::PGreedy);
+	void SetCenterSelection(const bool &use_center_selection, const int &max_centers, const double &tolerance, const char *method_name);
 	double EvaluateInterpolantAtPoint(
 		const double &x, const double &y, const double &z
 	);
 	VectorXd EvaluateInterpolantAtPoints(
-		const MatrixXd &locations
+		const ConstMatrixView &locations
 	);
 	Vector3d EvaluateVectorInterpolantAtPoint(
 		const double &x, const double &y, const double &z
 	);
 	MatrixXd EvaluateVectorInterpolantAtPoints(
-		const MatrixXd &locations
+		const ConstMatrixView &locations
+	);
+	// scalar field, gradient and optionally hessian in one pass over the
+	// centers. n x 4: value, gx, gy, gz, with_hessian n x 10 adds
+	// hxx, hyy, hzz, hxy, hxz, hyz
+	MatrixXd EvaluateInterpolantAndDerivativesAtPoints(
+		const ConstMatrixView &locations, const bool &with_hessian = false
+	);
+	// scalar field on the grid origin + (i, j, k) * spacing, 0 <= i < dims(0) ...
+	// without forming the grid points. nx * ny * nz values, x varies fastest,
+	// then y, then z (the point order of vtkImageData)
+	VectorXd EvaluateOnRegularGrid(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims
+	);
+	// the same grid evaluated by slabs of z slices, each written to filename as
+	// soon as it is done: memory use does not depend on the size of the grid.
+	// .vti (VTK image data) or .mhd (MetaImage, values in a .raw file), see
+	// Grid_File_Writer. single_precision writes 4 byte floats, compress zlib
+	// blocks (.vti only)
+	void WriteRegularGrid(const char *filename,
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const bool &single_precision = false,
+		const bool &compress = false
+	);
+	// the same grid evaluated coarse to fine: n_levels levels, each with twice
+	// the points of the previous one along every axis and reusing its values
+	// (see Grid_Level). on_level is called with each level as soon as it is
+	// complete. n_levels 0 picks a coarsest level of at most 32^3 points
+	std::vector<Grid_Level> EvaluateGridPyramid(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const int &n_levels = 0,
+		const LevelCallback &on_level = LevelCallback()
+	);
+	// same on a background thread, the levels can be polled from the handle.
+	// The interpolant is copied first, this instance can be used meanwhile.
+	// on_level runs on the background thread
+	std::shared_ptr<Grid_Pyramid_Handle> EvaluateGridPyramidAsync(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const int &n_levels = 0,
+		const LevelCallback &on_level = LevelCallback()
+	);
+	// interface surfaces contoured on that grid, one mesh per interface
+	// scalar field value of the modelling method
+	std::vector<Iso_Surface> GetIsoSurfaces(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims
+	);
+	// same at the given scalar field values, e.g. property levels
+	std::vector<Iso_Surface> GetIsoSurfaces(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const std::vector<double> &iso_values
+	);
+	// same surfaces evaluating the field only near them: sampled every
+	// coarse_stride grid points first, then refined in the cells the
+	// gradients say may hold a surface (see extract_iso_surfaces_adaptive)
+	std::vector<Iso_Surface> GetIsoSurfacesAdaptive(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const int &coarse_stride = 16
+	);
+	std::vector<Iso_Surface> GetIsoSurfacesAdaptive(
+		const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const std::vector<double> &iso_values,
+		const int &coarse_stride = 16
 	);
 	SpatialParameters GetDataBoundsAndResolution();
 
@@ -83,31 +271,71 @@ public:
 	// columns: x, y, z, level
 	// level: structural levels (interface codes)
 	MatrixXd GetInterfaceConstraints();
-	void SetInterfaceConstraints(const MatrixXd &interface_constraints);
+	void SetInterfaceConstraints(const ConstMatrixView &interface_constraints);
 
 	// Array of planar constraints
 	// n x 6 matrix, n = number of planar points
 	// columns: x, y, z, nx, ny, nz
 	// nx, ny, nz : components of the normal vector
 	MatrixXd GetPlanarConstraints();
-	void SetPlanarConstraints(const MatrixXd &planar_constraints);
+	void SetPlanarConstraints(const ConstMatrixView &planar_constraints);
+	// n x 6 matrices, columns: x, y, z, strike (or azimuth), dip, polarity
+	// polarity: 0 upright, 1 overturned
+	void SetPlanarConstraintsStrikeDipPolarity(const ConstMatrixView &planar_constraints);
+	void SetPlanarConstraintsAzimuthDipPolarity(const ConstMatrixView &planar_constraints);
 
 	// Array of tangent constraints
 	// n x 6 matrix, n = number of tangent points
 	// columns: x, y, z, vx, vy, vz
 	// vx, vy, vz : components of the tangent vector
 	MatrixXd GetTangentConstraints();
-	void SetTangentConstraints(const MatrixXd &tangent_constraints);
+	void SetTangentConstraints(const ConstMatrixView &tangent_constraints);
 
 	// Array of inequality constraints
 	// n x 4 matrix, n = number of inequality points
 	// columns: x, y, z, level
 	// level: structural level (compatible with interface level codes)
 	MatrixXd GetInequalityConstraints();
-	void SetInequalityConstraints(const MatrixXd &inequality_constraints);
+	void SetInequalityConstraints(const ConstMatrixView &inequality_constraints);
+
+	// Reads constraint .csv files concurrently, each one memory mapped and
+	// parsed in parallel (see csv_reader.h), and replaces the constraints of
+	// the types read. Empty file names are skipped. Columns are found by name,
+	// case insensitive:
+	//   all         x, y, z
+	//   interface   a name containing "level" (optional, level 0 without)
+	//   planar      nx, ny, nz or dip, strike (or azimuth / dip direction), polarity
+	//   tangent     vx, vy, vz or tx, ty, tz
+	//   inequality  level
+	// Throws missing_csv_column or error_reading_csv
+	void LoadConstraintFiles(const char *interface_file, const char *planar_file = "",
+		const char *tangent_file = "", const char *inequality_file = "");
+	// Binary columnar file of all the constraints (see constraint_file.h).
+	// single_precision stores 4 byte floats, compress zlib compressed columns
+	void SaveConstraints(const char *filename, const bool &single_precision = false, const bool &compress = false);
+	// replaces all of the constraints with those of a file written by
+	// SaveConstraints, straight from the memory mapped file. Types without
+	// rows in the file are cleared
+	void LoadConstraints(const char *filename);
 
 	int GetNumberOfInterfaces();
 
+	// Misfit of the computed interpolant at every constraint
+	// n x 5 matrix, n = total number of constraints
+	// columns: x, y, z, type, residual
+	// type: Parameter_Types::ConstraintType (0 inequality, 1 interface, 2 planar, 3 tangent)
+	// residual: interface - |scalar field - reference|, the reference being
+	//             single surface: 0
+	//             Lajaunie, stratigraphic: the scalar field at the interface
+	//               test point of the same level (interfaces are increments,
+	//               their values are not known before the solve)
+	//             continuous property, vector field: level
+	//           planar - angle (degrees) between constraint vector and gradient
+	//           tangent - |90 - angle (degrees) between constraint vector and
+	//             gradient|, 0 when the tangent lies in the surface
+	//           inequality - 0 if satisfied, 1 if violated
+	MatrixXd ComputeConstraintResiduals();
+
 	bool InterpolantComputed() const { return have_interpolant_; }
 
 };
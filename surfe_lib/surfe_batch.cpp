@@ -0,0 +1,186 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <surfe_batch.h>
+#include <fused_evaluator.h>
+
+#include <algorithm>
+
+// # of rows of the interpolation matrix, used to order and classify models
+static int interpolation_rows(const Constraints &constraints)
+{
+	return (int)(constraints.itrface.size() + constraints.inequality.size() +
+		3 * constraints.planar.size() + constraints.tangent.size());
+}
+
+Surfe_Batch::Surfe_Batch()
+	: task_scheduler_(nullptr), small_model_size_(2000), running_(false)
+{
+}
+
+Surfe_Batch::~Surfe_Batch()
+{
+	Cancel();
+	Wait();
+}
+
+void Surfe_Batch::check_not_running() const
+{
+	if (running_)
+		throw GRBF_Exceptions::computation_in_progress;
+}
+
+int Surfe_Batch::AddModel(const int &modelling_method)
+{
+	check_not_running();
+	models_.push_back(std::unique_ptr<Surfe_API>(new Surfe_API(modelling_method)));
+	return (int)models_.size() - 1;
+}
+
+int Surfe_Batch::AddModel(const Parameters &params)
+{
+	check_not_running();
+	models_.push_back(std::unique_ptr<Surfe_API>(new Surfe_API(params)));
+	return (int)models_.size() - 1;
+}
+
+Surfe_API &Surfe_Batch::GetModel(const int &index)
+{
+	return *models_.at(index);
+}
+
+void Surfe_Batch::SetTaskScheduler(Task_Scheduler *scheduler)
+{
+	check_not_running();
+	task_scheduler_ = scheduler;
+}
+
+void Surfe_Batch::SetSmallModelSize(const int &n_rows)
+{
+	check_not_running();
+	small_model_size_ = n_rows;
+}
+
+std::vector<int> Surfe_Batch::start_jobs()
+{
+	check_not_running();
+	if (thread_.joinable())
+		thread_.join();
+	for (const auto &model : models_)
+		if (model->active_job() && !model->active_job()->IsDone())
+			throw GRBF_Exceptions::computation_in_progress;
+
+	handles_.clear();
+	std::vector<int> rows;
+	for (const auto &model : models_) {
+		std::shared_ptr<Compute_Handle> handle = std::make_shared<Compute_Handle>();
+		handle->status_.set_phase(Parameter_Types::Preprocessing);
+		model->set_active_job(handle);
+		handles_.push_back(handle);
+		rows.push_back(interpolation_rows(model->constraints_));
+	}
+	// largest first, the small models fill the threads at the end
+	std::vector<int> order(models_.size());
+	for (int j = 0; j < (int)order.size(); j++)
+		order[j] = j;
+	std::stable_sort(order.begin(), order.end(), [&rows](const int &a, const int &b) { return rows[a] > rows[b]; });
+	running_ = true;
+	return order;
+}
+
+void Surfe_Batch::compute_models(const std::vector<int> &order)
+{
+	Scheduler_Scope scope(task_scheduler_, 0);
+	parallel_for((int)order.size(), 1, [this, &order](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			compute_model(order[j]);
+	});
+	running_ = false;
+}
+
+void Surfe_Batch::compute_model(const int &index)
+{
+	Surfe_API &model = *models_[index];
+	Task_Scheduler *scheduler = model.task_scheduler_;
+	const int max_concurrency = model.max_concurrency_;
+	if (task_scheduler_)
+		model.task_scheduler_ = task_scheduler_;
+	if (interpolation_rows(model.constraints_) <= small_model_size_)
+		model.max_concurrency_ = 1;
+	model.run_compute_job(handles_[index], CompletionCallback());
+	model.task_scheduler_ = scheduler;
+	model.max_concurrency_ = max_concurrency;
+}
+
+std::vector<std::shared_ptr<Compute_Handle> > Surfe_Batch::ComputeAll()
+{
+	std::vector<int> order = start_jobs();
+	compute_models(order);
+	return handles_;
+}
+
+std::vector<std::shared_ptr<Compute_Handle> > Surfe_Batch::ComputeAllAsync()
+{
+	std::vector<int> order = start_jobs();
+	thread_ = std::thread([this, order]() {
+		compute_models(order);
+	});
+	return handles_;
+}
+
+void Surfe_Batch::Wait()
+{
+	if (thread_.joinable())
+		thread_.join();
+}
+
+void Surfe_Batch::Cancel()
+{
+	for (const auto &handle : handles_)
+		handle->Cancel();
+}
+
+MatrixXd Surfe_Batch::EvaluateInterpolantsAtPoints(const ConstMatrixView &locations)
+{
+	check_not_running();
+	std::vector<Surfe_API *> models;
+	for (auto &model : models_)
+		models.push_back(model.get());
+	Fused_Evaluator evaluator(models);
+	evaluator.SetTaskScheduler(task_scheduler_);
+	return evaluator.EvaluateInterpolantsAtPoints(locations);
+}
@@ -0,0 +1,111 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef surfe_batch_h
+#define surfe_batch_h
+
+#include <surfe_lib_module.h>
+#include <surfe_api.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Computes many independent interpolants (fault blocks, series, properties)
+// together. Every model is a task on one task scheduler: models are started
+// largest first, small models run single threaded and are packed side by side
+// on the pool threads, large models split their assembly loops over the
+// threads left idle. A Compute_Handle per model reports its phase, progress
+// and errors; a failed model does not stop the others.
+// Progress callbacks of the models are invoked from the scheduler threads.
+class SURFE_LIB_EXPORT Surfe_Batch {
+private:
+	std::vector<std::unique_ptr<Surfe_API> > models_;
+	std::vector<std::shared_ptr<Compute_Handle> > handles_;  // of the last ComputeAll
+	Task_Scheduler *task_scheduler_;  // nullptr: process wide default
+	int small_model_size_;  // # of interpolation matrix rows
+	std::thread thread_;    // ComputeAllAsync()
+	std::atomic<bool> running_;
+
+	void check_not_running() const;
+	std::vector<int> start_jobs();
+	void compute_models(const std::vector<int> &order);
+	void compute_model(const int &index);
+
+	// not copyable, owns the models
+	Surfe_Batch(const Surfe_Batch &);
+	Surfe_Batch &operator=(const Surfe_Batch &);
+
+public:
+	Surfe_Batch();
+	// cancels and waits for a running ComputeAllAsync()
+	~Surfe_Batch();
+
+	// adds an empty model and returns its index. Constraints and parameters
+	// are set through GetModel(index)
+	int AddModel(const int &modelling_method);
+	int AddModel(const Parameters &params);
+	Surfe_API &GetModel(const int &index);
+	int GetNumberOfModels() const { return (int)models_.size(); }
+	// thread pool shared by all the models of the batch while they are
+	// computed, nullptr selects the process wide default. Not owned
+	void SetTaskScheduler(Task_Scheduler *scheduler);
+	// models with at most this # of interpolation matrix rows run on a
+	// single thread (default 2000)
+	void SetSmallModelSize(const int &n_rows);
+
+	// computes every model and returns their handles (model index order).
+	// Errors are reported by the handles, not thrown
+	std::vector<std::shared_ptr<Compute_Handle> > ComputeAll();
+	// same on a background thread, returns immediately. Throws
+	// computation_in_progress if the previous batch is still running
+	std::vector<std::shared_ptr<Compute_Handle> > ComputeAllAsync();
+	// block until ComputeAllAsync() is done
+	void Wait();
+	// request cancellation of every model not computed yet
+	void Cancel();
+	bool IsRunning() const { return running_; }
+
+	// scalar fields of every model at the same points in one pass (see
+	// Fused_Evaluator), n x GetNumberOfModels(). Throws missing_interpolant
+	// if a model has not been computed, interpolant_needs_update if it was
+	// changed since
+	MatrixXd EvaluateInterpolantsAtPoints(const ConstMatrixView &locations);
+};
+
+#endif
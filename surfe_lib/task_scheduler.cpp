@@ -0,0 +1,286 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#include <task_scheduler.h>
+
+#include <algorithm>
+#include <exception>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+struct Scheduling_Context {
+	Task_Scheduler *scheduler;
+	int max_concurrency;
+};
+thread_local Scheduling_Context current_context = { nullptr, 0 };
+thread_local int current_loop_depth = 0;  // > 0 inside a loop body
+
+// lets workers push the tasks they submit on their own deque
+thread_local Work_Stealing_Scheduler *current_pool = nullptr;
+thread_local int current_worker = -1;
+
+std::atomic<Task_Scheduler *> injected_default_scheduler(nullptr);
+
+struct Loop_State {
+	std::atomic<long long> next;
+	int active;  // threads inside the loop, guarded by mutex
+	std::mutex mutex;
+	std::condition_variable finished;
+	std::exception_ptr error;
+};
+}
+
+Work_Stealing_Scheduler::Work_Stealing_Scheduler(const int &n_threads /*= 0*/)
+{
+	int n = n_threads;
+	if (n <= 0)
+		n = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+	_n_queued = 0;
+	_next_queue = 0;
+	_stop = false;
+	for (int j = 0; j < n; j++)
+		_queues.emplace_back(new Task_Queue);
+	for (int j = 0; j < n; j++)
+		_workers.emplace_back(&Work_Stealing_Scheduler::_worker_loop, this, j);
+}
+
+Work_Stealing_Scheduler::~Work_Stealing_Scheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleep_mutex);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (auto &worker : _workers)
+		worker.join();
+}
+
+void Work_Stealing_Scheduler::submit(const std::function<void()> &task)
+{
+	int n = (int)_queues.size();
+	int queue = current_pool == this ? current_worker : (int)(_next_queue++ % n);
+	{
+		std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+		_queues[queue]->tasks.push_back(task);
+		_n_queued++;
+	}
+	// a worker checks _n_queued holding _sleep_mutex, taking it here means the
+	// worker either saw the task or is already waiting for the notification
+	{
+		std::lock_guard<std::mutex> lock(_sleep_mutex);
+	}
+	_wake.notify_one();
+}
+
+bool Work_Stealing_Scheduler::_pop_task(const int &worker, std::function<void()> &task)
+{
+	int n = (int)_queues.size();
+	for (int j = 0; j < n; j++) {
+		Task_Queue &queue = *_queues[(worker + j) % n];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+		if (j == 0) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		_n_queued--;
+		return true;
+	}
+	return false;
+}
+
+void Work_Stealing_Scheduler::_worker_loop(const int &worker)
+{
+	current_pool = this;
+	current_worker = worker;
+	std::function<void()> task;
+	for (;;) {
+		if (_pop_task(worker, task)) {
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				// parallel_for reports its own errors, a host task must not end the worker
+			}
+			task = nullptr;
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(_sleep_mutex);
+		_wake.wait(lock, [this]() { return _stop || _n_queued > 0; });
+		if (_stop && _n_queued == 0)
+			return;
+	}
+}
+
+Task_Scheduler *get_default_task_scheduler()
+{
+	Task_Scheduler *scheduler = injected_default_scheduler;
+	if (scheduler)
+		return scheduler;
+	// never destroyed, workers may still be parked when the process exits
+	static Work_Stealing_Scheduler *builtin_scheduler = new Work_Stealing_Scheduler();
+	return builtin_scheduler;
+}
+
+void set_default_task_scheduler(Task_Scheduler *scheduler)
+{
+	injected_default_scheduler = scheduler;
+}
+
+Scheduler_Scope::Scheduler_Scope(Task_Scheduler *scheduler, const int &max_concurrency)
+{
+	_previous_scheduler = current_context.scheduler;
+	_previous_max_concurrency = current_context.max_concurrency;
+	current_context.scheduler = scheduler;
+	current_context.max_concurrency = max_concurrency;
+}
+
+Scheduler_Scope::~Scheduler_Scope()
+{
+	current_context.scheduler = _previous_scheduler;
+	current_context.max_concurrency = _previous_max_concurrency;
+}
+
+// # of threads a loop started by this thread can use, the caller included
+static int scope_concurrency()
+{
+	Task_Scheduler *scheduler = current_context.scheduler ? current_context.scheduler : get_default_task_scheduler();
+	int n_threads = scheduler->concurrency() + 1;
+	if (current_context.max_concurrency > 0)
+		n_threads = std::min(n_threads, current_context.max_concurrency);
+	return n_threads;
+}
+
+Eigen_Threads_Scope::Eigen_Threads_Scope()
+{
+#ifdef _OPENMP
+	_previous_threads = omp_get_max_threads();
+	omp_set_num_threads(current_loop_depth > 0 ? 1 : std::min(_previous_threads, scope_concurrency()));
+#else
+	_previous_threads = 1;
+#endif
+}
+
+Eigen_Threads_Scope::~Eigen_Threads_Scope()
+{
+#ifdef _OPENMP
+	omp_set_num_threads(_previous_threads);
+#endif
+}
+
+void parallel_for(const int &n, const int &grain, const Range_Body &body)
+{
+	if (n <= 0)
+		return;
+	int chunk = std::max(1, grain);
+	int n_chunks = (n - 1) / chunk + 1;
+
+	Task_Scheduler *scheduler = current_context.scheduler ? current_context.scheduler : get_default_task_scheduler();
+	int n_lanes = std::min(scope_concurrency(), n_chunks);
+	if (n_lanes <= 1) {
+		body(0, n);
+		return;
+	}
+
+	// lanes pull chunks until the range is exhausted. A lane that starts after
+	// that never touches body, so the caller does not have to wait for it
+	std::shared_ptr<Loop_State> state = std::make_shared<Loop_State>();
+	state->next = 0;
+	state->active = 0;
+	Scheduling_Context context = current_context;
+	const Range_Body *loop_body = &body;
+	std::function<void()> lane = [state, context, loop_body, n, chunk]() {
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->active++;
+		}
+		Scheduling_Context previous_context = current_context;
+		current_context = context;
+		current_loop_depth++;
+		try
+		{
+			Eigen_Threads_Scope eigen_threads;
+			for (;;) {
+				long long begin = state->next.fetch_add(chunk);
+				if (begin >= n)
+					break;
+				(*loop_body)((int)begin, (int)std::min((long long)n, begin + chunk));
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (!state->error)
+				state->error = std::current_exception();
+			state->next = n;
+		}
+		current_loop_depth--;
+		current_context = previous_context;
+
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (--state->active == 0)
+			state->finished.notify_all();
+	};
+
+	for (int j = 1; j < n_lanes; j++)
+		scheduler->submit(lane);
+	lane();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&state]() { return state->active == 0; });
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+void parallel_invoke(const std::vector<std::function<void()> > &tasks)
+{
+	parallel_for((int)tasks.size(), 1, [&tasks](const int &begin, const int &end) {
+		for (int j = begin; j < end; j++)
+			tasks[j]();
+	});
+}
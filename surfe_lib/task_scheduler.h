@@ -0,0 +1,138 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+
+#ifndef task_scheduler_h
+#define task_scheduler_h
+
+#include <surfe_lib_module.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// body(begin, end) processes the indices [begin, end) of a parallel loop
+typedef std::function<void(const int &begin, const int &end)> Range_Body;
+
+// Pool of threads running the parallel loops of surfe. A host application
+// injects its own thread pool by implementing concurrency() and submit()
+class SURFE_LIB_EXPORT Task_Scheduler {
+public:
+	virtual ~Task_Scheduler() {}
+	// # of pool threads executing submitted tasks
+	virtual int concurrency() const = 0;
+	// run task asynchronously on a pool thread
+	virtual void submit(const std::function<void()> &task) = 0;
+};
+
+// Built in scheduler: a fixed set of workers, each with its own task deque.
+// Workers run the newest task of their own deque first and steal the oldest
+// task of the other deques when theirs is empty.
+class SURFE_LIB_EXPORT Work_Stealing_Scheduler : public Task_Scheduler {
+private:
+	struct Task_Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()> > tasks;
+	};
+	std::vector<std::unique_ptr<Task_Queue> > _queues;
+	std::vector<std::thread> _workers;
+	std::mutex _sleep_mutex;
+	std::condition_variable _wake;
+	std::atomic<int> _n_queued;
+	std::atomic<unsigned int> _next_queue;
+	bool _stop;
+
+	bool _pop_task(const int &worker, std::function<void()> &task);
+	void _worker_loop(const int &worker);
+
+public:
+	// n_threads = 0: one less than the # of hardware threads, the thread
+	// starting a loop takes part in it
+	explicit Work_Stealing_Scheduler(const int &n_threads = 0);
+	~Work_Stealing_Scheduler();
+
+	int concurrency() const override { return (int)_workers.size(); }
+	void submit(const std::function<void()> &task) override;
+};
+
+// Scheduler used when none is set on a Surfe_API, shared by every model in the
+// process so concurrent models do not oversubscribe the machine
+SURFE_LIB_EXPORT Task_Scheduler *get_default_task_scheduler();
+// nullptr restores the built in Work_Stealing_Scheduler. Not owned
+SURFE_LIB_EXPORT void set_default_task_scheduler(Task_Scheduler *scheduler);
+
+// Scheduler and maximum # of threads (0 = no limit) of the parallel loops
+// started by this thread while the scope is alive. Loop bodies inherit the
+// scope of the thread that started the loop, so nested loops obey it too.
+class SURFE_LIB_EXPORT Scheduler_Scope {
+private:
+	Task_Scheduler *_previous_scheduler;
+	int _previous_max_concurrency;
+
+public:
+	Scheduler_Scope(Task_Scheduler *scheduler, const int &max_concurrency);
+	~Scheduler_Scope();
+};
+
+// Eigen parallelizes its dense products and LU factorizations with OpenMP when
+// surfe is built with it. While the scope is alive those of this thread use as
+// many threads as the loops of the current Scheduler_Scope (at most
+// OMP_NUM_THREADS), or a single one inside a loop body, where the other lanes
+// already keep the threads busy.
+class SURFE_LIB_EXPORT Eigen_Threads_Scope {
+private:
+	int _previous_threads;
+
+public:
+	Eigen_Threads_Scope();
+	~Eigen_Threads_Scope();
+};
+
+// Calls body on consecutive ranges covering [0, n), handed out dynamically in
+// chunks of grain indices. The calling thread works on the loop as well and
+// only waits for chunks already started, so loops nest without deadlocking.
+// The first exception thrown by body stops the loop and is rethrown.
+SURFE_LIB_EXPORT void parallel_for(const int &n, const int &grain, const Range_Body &body);
+// runs independent tasks concurrently
+SURFE_LIB_EXPORT void parallel_invoke(const std::vector<std::function<void()> > &tasks);
+
+#endif
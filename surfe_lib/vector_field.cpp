@@ -105,36 +105,38 @@ Vector_Field::Vector_Field(const Parameters &m_params)
 bool Vector_Field::get_interpolation_matrix(MatrixXd &interpolation_matrix) {
 	int n_p = intern_params.n_planar;
 
+	_begin_assembly(n_p);
+
 	// Base Matrix Structure
 	// | p_x/p_x p_x/p_y p_x/p_z |
 	// | p_y/p_x p_y/p_y p_y/p_z |
 	// | p_z/p_x p_z/p_y p_z/p_z |
 
 	// Planar Constraints
-	for (int j = 0; j < n_p; j++) {
+	_assemble_rows(n_p, [&](const int &j, Kernel *lane_kernel) {
 		// Row:planar/Column:planar block
 		for (int k = 0; k < n_p; k++) {
-			kernel->set_points(constraints.planar[j], constraints.planar[k]);
+			lane_kernel->set_points(constraints.planar[j], constraints.planar[k]);
 			interpolation_matrix(3 * j, 3 * k) =
-				kernel->basis_planar_planar(Parameter_Types::DXDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDX);
 			interpolation_matrix(3 * j, 3 * k + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DXDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDY);
 			interpolation_matrix(3 * j, 3 * k + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DXDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DXDZ);
 			interpolation_matrix(3 * j + 1, 3 * k) =
-				kernel->basis_planar_planar(Parameter_Types::DYDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDX);
 			interpolation_matrix(3 * j + 1, 3 * k + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DYDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDY);
 			interpolation_matrix(3 * j + 1, 3 * k + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DYDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DYDZ);
 			interpolation_matrix(3 * j + 2, 3 * k) =
-				kernel->basis_planar_planar(Parameter_Types::DZDX);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDX);
 			interpolation_matrix(3 * j + 2, 3 * k + 1) =
-				kernel->basis_planar_planar(Parameter_Types::DZDY);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDY);
 			interpolation_matrix(3 * j + 2, 3 * k + 2) =
-				kernel->basis_planar_planar(Parameter_Types::DZDZ);
+				lane_kernel->basis_planar_planar(Parameter_Types::DZDZ);
 		}
-	}
+	});
 
 	return true;
 }
@@ -211,4 +213,14 @@ void Vector_Field::eval_vector_interpolant_at_point(Point &p) {
 	}
 	p.set_vector_field(elemsum_x, elemsum_y, elemsum_z);
 	delete kernel_j;
+}
+
+void Vector_Field::get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) {
+	int n_p = intern_params.n_planar;
+
+	for (int k = 0; k < n_p; k++) {
+		Point weights(solver->weights[3 * k], solver->weights[3 * k + 1], solver->weights[3 * k + 2]);
+		terms.push_back(Evaluation_Term(Evaluation_Term::Derivative, 1.0, constraints.planar[k], weights));
+	}
+	monomial_coefficients = VectorXd::Zero(10);
 }
\ No newline at end of file
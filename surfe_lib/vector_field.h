@@ -53,11 +53,11 @@ public:
 	bool get_equality_values(VectorXd &equality_values) override;
 	void eval_scalar_interpolant_at_point(Point &p) override;
 	void eval_vector_interpolant_at_point(Point &p) override;
+	void get_evaluation_terms(std::vector<Evaluation_Term> &terms, VectorXd &monomial_coefficients) override;
 	void get_method_parameters() override;
 	void process_input_data() override {};
 	void setup_system_solver() override;
 	bool get_minimial_and_excluded_input(Constraints &greedy_input, Constraints &excluded_input) override { return true; }  // TO implement
-	bool measure_residuals(Constraints &input) override { return true; }  // TO implement
 	bool append_greedy_input(Constraints &input) override { return true; }  // TO implement
 	bool convert_modified_kernel_to_rbf_kernel() override { return true; }  // TO IMPLEMENT
 	GRBF_Modelling_Methods *clone() override { return new Vector_Field(*this); }
@@ -0,0 +1,315 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <virtual_volume.h>
+
+#include <algorithm>
+
+Virtual_Volume::Virtual_Volume(Surfe_API *model, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+	const int &brick_size /*= 32*/, const double &max_memory_mb /*= 512*/)
+	: evaluator_(std::vector<Surfe_API *>(1, model)), origin_(origin), spacing_(spacing), dims_(dims),
+	brick_size_(brick_size), prefetch_(true), stopping_(false)
+{
+	if (dims.minCoeff() <= 0 || brick_size <= 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	n_bricks_ = (dims.array() + brick_size - 1) / brick_size;
+	const double brick_mb = (double)brick_size * brick_size * brick_size * sizeof(double) / (1024.0 * 1024.0);
+	max_bricks_ = (int)std::max(1.0, std::min(max_memory_mb / brick_mb, 1e9));
+	statistics_ = Virtual_Volume_Statistics();
+	prefetch_thread_ = std::thread(&Virtual_Volume::prefetch_loop, this);
+}
+
+Virtual_Volume::~Virtual_Volume()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+		prefetch_queue_.clear();
+	}
+	prefetch_condition_.notify_all();
+	prefetch_thread_.join();
+}
+
+Vector3i Virtual_Volume::brick_index(const long long &key) const
+{
+	const long long slice = (long long)n_bricks_(0) * n_bricks_(1);
+	return Vector3i((int)(key % n_bricks_(0)), (int)((key % slice) / n_bricks_(0)), (int)(key / slice));
+}
+
+Vector3i Virtual_Volume::brick_dims(const Vector3i &brick) const
+{
+	return (dims_ - brick_first(brick)).cwiseMin(Vector3i::Constant(brick_size_));
+}
+
+std::shared_ptr<const VectorXd> Virtual_Volume::evaluate_brick(const long long &key) const
+{
+	const Vector3i brick = brick_index(key);
+	const Vector3d brick_origin = origin_ + brick_first(brick).cast<double>().cwiseProduct(spacing_);
+	return std::make_shared<const VectorXd>(evaluator_.EvaluateOnRegularGrid(brick_origin, spacing_, brick_dims(brick)).col(0));
+}
+
+void Virtual_Volume::store_brick(const long long &key, const std::shared_ptr<const VectorXd> &values)
+{
+	Cached_Brick &cached = cache_[key];
+	cached.values = values;
+	lru_.push_front(key);
+	cached.lru_position = lru_.begin();
+	while ((int)lru_.size() > max_bricks_) {
+		cache_.erase(lru_.back());
+		lru_.pop_back();
+		statistics_.evicted++;
+	}
+}
+
+std::vector<std::shared_ptr<const VectorXd> > Virtual_Volume::get_bricks(const std::vector<long long> &keys)
+{
+	std::vector<std::shared_ptr<const VectorXd> > bricks(keys.size());
+	std::vector<int> claimed;
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (prefetch_error_) {
+		std::exception_ptr error = prefetch_error_;
+		prefetch_error_ = nullptr;
+		std::rethrow_exception(error);
+	}
+	for (;;)
+	{
+		claimed.clear();
+		bool in_flight = false;
+		for (int b = 0; b < (int)keys.size(); b++) {
+			if (bricks[b])
+				continue;
+			auto found = cache_.find(keys[b]);
+			if (found == cache_.end()) {
+				// nullptr entry: being evaluated by this thread
+				cache_[keys[b]] = Cached_Brick();
+				claimed.push_back(b);
+				statistics_.misses++;
+			}
+			else if (found->second.values) {
+				bricks[b] = found->second.values;
+				lru_.splice(lru_.begin(), lru_, found->second.lru_position);
+				statistics_.hits++;
+			}
+			else
+				in_flight = true;
+		}
+		if (claimed.empty()) {
+			if (!in_flight)
+				break;
+			// evaluated by another request or the prefetching, and possibly
+			// evicted again before this thread wakes up
+			brick_condition_.wait(lock);
+			continue;
+		}
+
+		lock.unlock();
+		size_t n_evaluated = 0;
+		try
+		{
+			for (; n_evaluated < claimed.size(); n_evaluated++)
+				bricks[claimed[n_evaluated]] = evaluate_brick(keys[claimed[n_evaluated]]);
+		}
+		catch (...)
+		{
+			lock.lock();
+			for (int b : claimed)
+				cache_.erase(keys[b]);
+			lock.unlock();
+			brick_condition_.notify_all();
+			throw;
+		}
+		lock.lock();
+		for (int b : claimed)
+			store_brick(keys[b], bricks[b]);
+		brick_condition_.notify_all();
+	}
+	return bricks;
+}
+
+void Virtual_Volume::queue_neighbours(const Vector3i &first_brick, const Vector3i &last_brick)
+{
+	const Vector3i first = (first_brick.array() - 1).max(0);
+	const Vector3i last = (last_brick.array() + 1).min(n_bricks_.array() - 1);
+	std::lock_guard<std::mutex> lock(mutex_);
+	// the viewer has moved on, the bricks queued for the last request are
+	// dropped. At most half the cache is prefetched so the requested bricks
+	// stay cached
+	prefetch_queue_.clear();
+	for (int k = first(2); k <= last(2); k++)
+		for (int j = first(1); j <= last(1); j++)
+			for (int i = first(0); i <= last(0); i++) {
+				if (i >= first_brick(0) && i <= last_brick(0) && j >= first_brick(1) && j <= last_brick(1) &&
+					k >= first_brick(2) && k <= last_brick(2))
+					continue;
+				const long long key = brick_key(Vector3i(i, j, k));
+				if (cache_.count(key) == 0 && (int)prefetch_queue_.size() < max_bricks_ / 2)
+					prefetch_queue_.push_back(key);
+			}
+	if (!prefetch_queue_.empty())
+		prefetch_condition_.notify_one();
+}
+
+void Virtual_Volume::prefetch_loop()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (;;)
+	{
+		prefetch_condition_.wait(lock, [this]() { return stopping_ || !prefetch_queue_.empty(); });
+		if (stopping_)
+			return;
+		const long long key = prefetch_queue_.front();
+		prefetch_queue_.pop_front();
+		if (cache_.count(key) != 0)
+			continue;
+		cache_[key] = Cached_Brick();
+		lock.unlock();
+		std::shared_ptr<const VectorXd> values;
+		std::exception_ptr error;
+		try
+		{
+			values = evaluate_brick(key);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		lock.lock();
+		if (values) {
+			store_brick(key, values);
+			statistics_.prefetched++;
+		}
+		else {
+			cache_.erase(key);
+			if (!prefetch_error_)
+				prefetch_error_ = error;
+		}
+		brick_condition_.notify_all();
+	}
+}
+
+void Virtual_Volume::SetPrefetch(const bool &prefetch_neighbours)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	prefetch_ = prefetch_neighbours;
+	if (!prefetch_)
+		prefetch_queue_.clear();
+}
+
+VectorXd Virtual_Volume::GetRegion(const Vector3i &first, const Vector3i &size)
+{
+	if (first.minCoeff() < 0 || size.minCoeff() <= 0 || (first + size - dims_).maxCoeff() > 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	const Vector3i last = first + size - Vector3i::Ones();
+	const Vector3i first_brick = first / brick_size_;
+	const Vector3i last_brick = last / brick_size_;
+	std::vector<long long> keys;
+	for (int k = first_brick(2); k <= last_brick(2); k++)
+		for (int j = first_brick(1); j <= last_brick(1); j++)
+			for (int i = first_brick(0); i <= last_brick(0); i++)
+				keys.push_back(brick_key(Vector3i(i, j, k)));
+	std::vector<std::shared_ptr<const VectorXd> > bricks = get_bricks(keys);
+
+	VectorXd region((long long)size(0) * size(1) * size(2));
+	for (size_t b = 0; b < keys.size(); b++) {
+		const Vector3i brick = brick_index(keys[b]);
+		const Vector3i origin = brick_first(brick);
+		const Vector3i dims = brick_dims(brick);
+		// part of the brick inside the region, in grid indices
+		const Vector3i lower = origin.cwiseMax(first);
+		const Vector3i upper = (origin + dims).cwiseMin(first + size);
+		const VectorXd &values = *bricks[b];
+		for (int k = lower(2); k < upper(2); k++)
+			for (int j = lower(1); j < upper(1); j++) {
+				const long long from = ((long long)(k - origin(2)) * dims(1) + (j - origin(1))) * dims(0) + (lower(0) - origin(0));
+				const long long to = ((long long)(k - first(2)) * size(1) + (j - first(1))) * size(0) + (lower(0) - first(0));
+				std::copy(values.data() + from, values.data() + from + (upper(0) - lower(0)), region.data() + to);
+			}
+	}
+
+	bool prefetch;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		prefetch = prefetch_;
+	}
+	if (prefetch)
+		queue_neighbours(first_brick, last_brick);
+	return region;
+}
+
+VectorXd Virtual_Volume::GetSlice(const int &axis, const int &index)
+{
+	if (axis < 0 || axis > 2)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	Vector3i first = Vector3i::Zero();
+	Vector3i size = dims_;
+	first(axis) = index;
+	size(axis) = 1;
+	return GetRegion(first, size);
+}
+
+double Virtual_Volume::GetValue(const int &i, const int &j, const int &k)
+{
+	return GetRegion(Vector3i(i, j, k), Vector3i::Ones())(0);
+}
+
+VectorXd Virtual_Volume::GetBrick(const Vector3i &brick)
+{
+	if (brick.minCoeff() < 0 || (brick - n_bricks_).maxCoeff() >= 0)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	return GetRegion(brick_first(brick), brick_dims(brick));
+}
+
+Virtual_Volume_Statistics Virtual_Volume::GetStatistics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Virtual_Volume_Statistics statistics = statistics_;
+	statistics.cached_bricks = (int)lru_.size();
+	statistics.cached_mb = 0;
+	for (long long key : lru_)
+		statistics.cached_mb += cache_[key].values->size() * sizeof(double) / (1024.0 * 1024.0);
+	return statistics;
+}
+
+void Virtual_Volume::ClearCache()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	prefetch_queue_.clear();
+	// bricks being evaluated keep their entries
+	for (long long key : lru_)
+		cache_.erase(key);
+	lru_.clear();
+}
@@ -0,0 +1,149 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef virtual_volume_h
+#define virtual_volume_h
+
+#include <surfe_lib_module.h>
+#include <fused_evaluator.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct Virtual_Volume_Statistics {
+	long long hits;        // bricks found in the cache
+	long long misses;      // bricks evaluated for a request
+	long long prefetched;  // bricks evaluated ahead of a request
+	long long evicted;
+	int cached_bricks;
+	double cached_mb;
+};
+
+// Scalar field of a solved interpolant on a regular grid too large to be
+// evaluated up front (e.g. 1000^3 points), for slice and volume viewers.
+// The grid is divided into bricks of brick_size^3 points evaluated on first
+// access and kept in a least recently used cache of at most max_memory_mb.
+// The bricks missing for a request are evaluated in parallel on the task
+// scheduler, then the neighbours of the requested bricks are evaluated by a
+// background thread ahead of the next request. A prefetch that fails is
+// rethrown by the next access.
+// The interpolant is copied at construction (see Fused_Evaluator), later
+// changes to the model are not seen. The access methods can be called from
+// several threads at once.
+class SURFE_LIB_EXPORT Virtual_Volume {
+private:
+	struct Cached_Brick {
+		std::shared_ptr<const VectorXd> values;  // nullptr while evaluated
+		std::list<long long>::iterator lru_position;
+	};
+	Fused_Evaluator evaluator_;
+	Vector3d origin_;
+	Vector3d spacing_;
+	Vector3i dims_;
+	int brick_size_;
+	Vector3i n_bricks_;
+	int max_bricks_;
+	bool prefetch_;
+
+	std::mutex mutex_;
+	std::unordered_map<long long, Cached_Brick> cache_;
+	std::list<long long> lru_;  // evaluated bricks, most recently used first
+	std::condition_variable brick_condition_;  // a brick was evaluated
+	std::deque<long long> prefetch_queue_;
+	std::condition_variable prefetch_condition_;
+	std::thread prefetch_thread_;
+	std::exception_ptr prefetch_error_;  // first prefetch failure, rethrown by the next access
+	bool stopping_;
+	Virtual_Volume_Statistics statistics_;
+
+	long long brick_key(const Vector3i &brick) const { return brick(0) + (long long)n_bricks_(0) * (brick(1) + (long long)n_bricks_(1) * brick(2)); }
+	Vector3i brick_index(const long long &key) const;
+	// first grid point and # of points of a brick, smaller at the far faces
+	Vector3i brick_first(const Vector3i &brick) const { return brick * brick_size_; }
+	Vector3i brick_dims(const Vector3i &brick) const;
+	std::shared_ptr<const VectorXd> evaluate_brick(const long long &key) const;
+	// caller holds mutex_
+	void store_brick(const long long &key, const std::shared_ptr<const VectorXd> &values);
+	// evaluated bricks, missing ones evaluated here or waited for
+	std::vector<std::shared_ptr<const VectorXd> > get_bricks(const std::vector<long long> &keys);
+	// queue the bricks around [first_brick, last_brick] for prefetching
+	void queue_neighbours(const Vector3i &first_brick, const Vector3i &last_brick);
+	void prefetch_loop();
+
+public:
+	// throws missing_interpolant if model has no interpolant, and
+	// interpolant_needs_update if it changed since it was computed
+	Virtual_Volume(Surfe_API *model, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims,
+		const int &brick_size = 32, const double &max_memory_mb = 512);
+	// stops the prefetching, waits for the brick being prefetched
+	~Virtual_Volume();
+
+	Vector3d GetOrigin() const { return origin_; }
+	Vector3d GetSpacing() const { return spacing_; }
+	Vector3i GetDimensions() const { return dims_; }
+	int GetBrickSize() const { return brick_size_; }
+	Vector3i GetNumberOfBricks() const { return n_bricks_; }
+	// thread pool of the brick evaluations, set before the first access.
+	// nullptr selects the process wide default. Not owned
+	void SetTaskScheduler(Task_Scheduler *scheduler) { evaluator_.SetTaskScheduler(scheduler); }
+	void SetMaxConcurrency(const int &max_threads) { evaluator_.SetMaxConcurrency(max_threads); }
+	// evaluate the neighbours of the requested bricks in the background
+	// (default on)
+	void SetPrefetch(const bool &prefetch_neighbours);
+
+	// values of the points [first, first + size) along each axis, x varies
+	// fastest. Throws array_has_incorrect_dimensions outside the grid
+	VectorXd GetRegion(const Vector3i &first, const Vector3i &size);
+	// the slice index across axis (0 x, 1 y, 2 z), the lower axis varies fastest
+	VectorXd GetSlice(const int &axis, const int &index);
+	double GetValue(const int &i, const int &j, const int &k);
+	// values of a brick, brick_size^3 points (fewer at the far faces)
+	VectorXd GetBrick(const Vector3i &brick);
+
+	Virtual_Volume_Statistics GetStatistics();
+	// drops the cached bricks, e.g. to release the memory
+	void ClearCache();
+};
+
+#endif
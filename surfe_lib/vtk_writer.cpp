@@ -0,0 +1,302 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <vtk_writer.h>
+#include <grbf_exceptions.h>
+#include <task_scheduler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#ifdef SURFE_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+bool vtk_compression_available()
+{
+#ifdef SURFE_WITH_ZLIB
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool little_endian_machine()
+{
+	const std::uint16_t probe = 1;
+	return *reinterpret_cast<const unsigned char *>(&probe) == 1;
+}
+
+std::vector<std::string> compress_vtk_blocks(const char *bytes, const size_t &n_bytes)
+{
+#ifdef SURFE_WITH_ZLIB
+	const int n_blocks = (int)((n_bytes + vtk_block_bytes - 1) / vtk_block_bytes);
+	std::vector<std::string> blocks(n_blocks);
+	parallel_for(n_blocks, 1, [&](const int &first, const int &last) {
+		std::vector<Bytef> buffer(compressBound((uLong)vtk_block_bytes));
+		for (int b = first; b < last; b++) {
+			const size_t begin = (size_t)b * vtk_block_bytes;
+			const uLong size = (uLong)std::min(vtk_block_bytes, n_bytes - begin);
+			uLongf compressed_size = (uLongf)buffer.size();
+			// fastest level: the files are written while the model is evaluated
+			if (compress2(buffer.data(), &compressed_size, reinterpret_cast<const Bytef *>(bytes + begin), size, Z_BEST_SPEED) != Z_OK)
+				throw GRBF_Exceptions::error_writing_vtk_file;
+			blocks[b].assign(reinterpret_cast<const char *>(buffer.data()), compressed_size);
+		}
+	});
+	return blocks;
+#else
+	(void)bytes;
+	(void)n_bytes;
+	throw GRBF_Exceptions::compression_not_available;
+#endif
+}
+
+bool uncompress_vtk_blocks(const char *compressed, const std::vector<std::uint64_t> &compressed_sizes,
+	char *bytes, const size_t &n_bytes)
+{
+#ifdef SURFE_WITH_ZLIB
+	const int n_blocks = (int)compressed_sizes.size();
+	if ((size_t)n_blocks != (n_bytes + vtk_block_bytes - 1) / vtk_block_bytes)
+		return false;
+	std::vector<size_t> block_offsets(n_blocks + 1, 0);
+	for (int b = 0; b < n_blocks; b++)
+		block_offsets[b + 1] = block_offsets[b] + compressed_sizes[b];
+	std::atomic<bool> valid(true);
+	parallel_for(n_blocks, 1, [&](const int &first, const int &last) {
+		for (int b = first; b < last; b++) {
+			const size_t begin = (size_t)b * vtk_block_bytes;
+			const uLongf size = (uLongf)std::min(vtk_block_bytes, n_bytes - begin);
+			uLongf uncompressed_size = size;
+			if (uncompress(reinterpret_cast<Bytef *>(bytes + begin), &uncompressed_size,
+				reinterpret_cast<const Bytef *>(compressed + block_offsets[b]), (uLong)compressed_sizes[b]) != Z_OK ||
+				uncompressed_size != size)
+				valid = false;
+		}
+	});
+	return valid.load();
+#else
+	(void)compressed;
+	(void)compressed_sizes;
+	(void)bytes;
+	(void)n_bytes;
+	throw GRBF_Exceptions::compression_not_available;
+#endif
+}
+
+namespace {
+
+// array of the appended data section, encoded with its header
+struct Appended_Array {
+	std::string type;  // Float64 or Int64
+	std::string name;
+	int n_components;
+	std::string data;
+};
+
+Appended_Array encode_array(const std::string &type, const std::string &name, const int &n_components,
+	const char *bytes, const size_t &n_bytes, const bool &compress)
+{
+	Appended_Array array = { type, name, n_components, std::string() };
+	if (!compress) {
+		const std::uint64_t size = n_bytes;
+		array.data.reserve(sizeof(size) + n_bytes);
+		array.data.append(reinterpret_cast<const char *>(&size), sizeof(size));
+		array.data.append(bytes, n_bytes);
+		return array;
+	}
+	// # of blocks, block size, size of a partial last block (0: full), then
+	// the compressed size of every block
+	std::vector<std::string> blocks = compress_vtk_blocks(bytes, n_bytes);
+	std::vector<std::uint64_t> header;
+	header.push_back(blocks.size());
+	header.push_back(vtk_block_bytes);
+	header.push_back(n_bytes % vtk_block_bytes);
+	size_t total = 0;
+	for (const auto &block : blocks) {
+		header.push_back(block.size());
+		total += block.size();
+	}
+	array.data.reserve(header.size() * sizeof(std::uint64_t) + total);
+	array.data.append(reinterpret_cast<const char *>(header.data()), header.size() * sizeof(std::uint64_t));
+	for (const auto &block : blocks)
+		array.data.append(block);
+	return array;
+}
+
+Appended_Array encode_matrix(const std::string &name, const MatrixXd &values, const bool &compress)
+{
+	// tuples are stored row after row
+	const Matrix<double, Dynamic, Dynamic, RowMajor> rows = values;
+	return encode_array("Float64", name, (int)values.cols(), reinterpret_cast<const char *>(rows.data()),
+		rows.size() * sizeof(double), compress);
+}
+
+Appended_Array encode_indices(const std::string &name, const std::vector<std::int64_t> &indices, const bool &compress)
+{
+	return encode_array("Int64", name, 1, reinterpret_cast<const char *>(indices.data()),
+		indices.size() * sizeof(std::int64_t), compress);
+}
+
+// cells of one kind: connectivity and offsets arrays, empty if there are none
+struct Cell_Arrays {
+	long long n_cells;
+	std::vector<Appended_Array> arrays;
+};
+
+Cell_Arrays encode_cells(const std::vector<std::int64_t> &connectivity, const int &cell_size, const bool &compress)
+{
+	Cell_Arrays cells = { (long long)connectivity.size() / cell_size, std::vector<Appended_Array>() };
+	if (cells.n_cells == 0)
+		return cells;
+	std::vector<std::int64_t> offsets(cells.n_cells);
+	for (long long c = 0; c < cells.n_cells; c++)
+		offsets[c] = (c + 1) * cell_size;
+	cells.arrays.push_back(encode_indices("connectivity", connectivity, compress));
+	cells.arrays.push_back(encode_indices("offsets", offsets, compress));
+	return cells;
+}
+
+void write_data_array_elements(std::ostream &xml, const std::vector<Appended_Array> &arrays, std::uint64_t &offset,
+	const std::string &indent)
+{
+	for (const auto &array : arrays) {
+		xml << indent << "<DataArray type=\"" << array.type << "\" Name=\"" << array.name << "\"";
+		if (array.n_components > 1)
+			xml << " NumberOfComponents=\"" << array.n_components << "\"";
+		xml << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+		offset += array.data.size();
+	}
+}
+
+void write_vtp(const char *filename, const long long &n_points, const std::vector<Appended_Array> &point_data,
+	const Appended_Array &points, const Cell_Arrays &verts, const Cell_Arrays &polys, const bool &compress)
+{
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw GRBF_Exceptions::error_writing_vtk_file;
+
+	std::ostringstream xml;
+	std::uint64_t offset = 0;
+	xml << "<?xml version=\"1.0\"?>\n"
+		<< "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"" << (little_endian_machine() ? "LittleEndian" : "BigEndian")
+		<< "\" header_type=\"UInt64\"" << (compress ? " compressor=\"vtkZLibDataCompressor\"" : "") << ">\n"
+		<< "  <PolyData>\n"
+		<< "    <Piece NumberOfPoints=\"" << n_points << "\" NumberOfVerts=\"" << verts.n_cells
+		<< "\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"" << polys.n_cells << "\">\n";
+	xml << "      <PointData";
+	if (!point_data.empty())
+		xml << " Scalars=\"" << point_data[0].name << "\"";
+	xml << ">\n";
+	write_data_array_elements(xml, point_data, offset, "        ");
+	xml << "      </PointData>\n"
+		<< "      <Points>\n";
+	write_data_array_elements(xml, std::vector<Appended_Array>(1, points), offset, "        ");
+	xml << "      </Points>\n"
+		<< "      <Verts>\n";
+	write_data_array_elements(xml, verts.arrays, offset, "        ");
+	xml << "      </Verts>\n"
+		<< "      <Polys>\n";
+	write_data_array_elements(xml, polys.arrays, offset, "        ");
+	xml << "      </Polys>\n"
+		<< "    </Piece>\n"
+		<< "  </PolyData>\n"
+		<< "  <AppendedData encoding=\"raw\">\n"
+		<< "   _";
+	const std::string header = xml.str();
+	file.write(header.data(), header.size());
+	for (const auto &array : point_data)
+		file.write(array.data.data(), array.data.size());
+	file.write(points.data.data(), points.data.size());
+	for (const auto &array : verts.arrays)
+		file.write(array.data.data(), array.data.size());
+	for (const auto &array : polys.arrays)
+		file.write(array.data.data(), array.data.size());
+	const std::string footer = "\n  </AppendedData>\n</VTKFile>\n";
+	file.write(footer.data(), footer.size());
+	if (!file)
+		throw GRBF_Exceptions::error_writing_vtk_file;
+}
+
+}  // namespace
+
+void write_vtp_points(const char *filename, const MatrixXd &points, const std::vector<Vtk_Array> &point_arrays,
+	const bool &compress /*= false*/)
+{
+	if (points.cols() != 3)
+		throw GRBF_Exceptions::array_has_incorrect_dimensions;
+	std::vector<Appended_Array> point_data;
+	for (const auto &array : point_arrays) {
+		if (array.values.rows() != points.rows())
+			throw GRBF_Exceptions::array_has_incorrect_dimensions;
+		point_data.push_back(encode_matrix(array.name, array.values, compress));
+	}
+	// a vertex per point so they are drawn
+	std::vector<std::int64_t> vertices(points.rows());
+	for (long long p = 0; p < points.rows(); p++)
+		vertices[p] = p;
+	write_vtp(filename, points.rows(), point_data, encode_matrix("Points", points, compress),
+		encode_cells(vertices, 1, compress), encode_cells(std::vector<std::int64_t>(), 3, compress), compress);
+}
+
+void write_vtp_surfaces(const char *filename, const std::vector<Iso_Surface> &surfaces, const bool &compress /*= false*/)
+{
+	long long n_points = 0;
+	long long n_triangles = 0;
+	for (const auto &surface : surfaces) {
+		n_points += surface.vertices.rows();
+		n_triangles += surface.triangles.rows();
+	}
+	MatrixXd points(n_points, 3);
+	MatrixXd iso_values(n_points, 1);
+	std::vector<std::int64_t> triangles;
+	triangles.reserve(3 * n_triangles);
+	long long first = 0;
+	for (const auto &surface : surfaces) {
+		points.middleRows(first, surface.vertices.rows()) = surface.vertices;
+		iso_values.middleRows(first, surface.vertices.rows()).setConstant(surface.iso_value);
+		for (int t = 0; t < surface.triangles.rows(); t++)
+			for (int c = 0; c < 3; c++)
+				triangles.push_back(first + surface.triangles(t, c));
+		first += surface.vertices.rows();
+	}
+	write_vtp(filename, n_points, std::vector<Appended_Array>(1, encode_matrix("Scalar Field", iso_values, compress)),
+		encode_matrix("Points", points, compress), encode_cells(std::vector<std::int64_t>(), 1, compress),
+		encode_cells(triangles, 3, compress), compress);
+}
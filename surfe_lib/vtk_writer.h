@@ -0,0 +1,87 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef vtk_writer_h
+#define vtk_writer_h
+
+#include <surfe_lib_module.h>
+#include <iso_surface.h>
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Eigen;
+
+// VTK XML files written without VTK. Arrays go to a raw binary appended data
+// section (header_type UInt64, the byte order of this machine), optionally
+// split in blocks compressed with zlib in parallel on the current task
+// scheduler (compressor vtkZLibDataCompressor). ParaView reads both.
+
+// true if surfe_lib was built with zlib (SURFE_WITH_ZLIB)
+SURFE_LIB_EXPORT bool vtk_compression_available();
+SURFE_LIB_EXPORT bool little_endian_machine();
+
+// uncompressed size of the compressed blocks
+const size_t vtk_block_bytes = 1 << 20;
+
+// n_bytes split in blocks of vtk_block_bytes (the last one shorter) each
+// compressed with zlib. Throws compression_not_available without zlib
+SURFE_LIB_EXPORT std::vector<std::string> compress_vtk_blocks(const char *bytes, const size_t &n_bytes);
+// inverse of compress_vtk_blocks: the blocks stored one after the other from
+// compressed, of compressed_sizes bytes, back into the n_bytes of bytes. False
+// if they do not decompress to that. Throws compression_not_available without zlib
+SURFE_LIB_EXPORT bool uncompress_vtk_blocks(const char *compressed, const std::vector<std::uint64_t> &compressed_sizes,
+	char *bytes, const size_t &n_bytes);
+
+// named point data array, n_points x n_components
+struct Vtk_Array {
+	std::string name;
+	MatrixXd values;
+};
+
+// points (n x 3) as a .vtp poly data of vertices with their point data, e.g.
+// constraints and their levels or normals
+SURFE_LIB_EXPORT void write_vtp_points(const char *filename, const MatrixXd &points,
+	const std::vector<Vtk_Array> &point_arrays, const bool &compress = false);
+// the triangle meshes in one .vtp poly data, with the iso value of every
+// vertex in the "Scalar Field" point array
+SURFE_LIB_EXPORT void write_vtp_surfaces(const char *filename, const std::vector<Iso_Surface> &surfaces,
+	const bool &compress = false);
+
+#endif
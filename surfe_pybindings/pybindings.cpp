@@ -1,5 +1,6 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/eigen.h>
+#include <pybind11/functional.h>
 #include <pybind11/stl.h>       //auto conversion b/w stl and python types
 #include <pybind11/iostream.h>  //auto conversion b/w stl and python types
 
@@ -7,6 +8,12 @@
 #include <modeling_methods.h>
 #include <modelling_input.h>
 #include <surfe_api.h>
+#include <surfe_batch.h>
+#include <fused_evaluator.h>
+#include <virtual_volume.h>
+#include <vtk_writer.h>
+#include <csv_reader.h>
+#include <constraint_file.h>
 
 #include <Eigen/LU>
 
@@ -15,9 +22,206 @@
 // ----------------
 
 namespace py = pybind11;
+
+// Python deletes objects with the GIL held. Surfe_API and Surfe_Batch wait for
+// their background computations when deleted, and the callbacks of those
+// computations need the GIL
+template <class T>
+struct Delete_Without_GIL {
+	void operator()(T *object) const
+	{
+		py::gil_scoped_release release;
+		delete object;
+	}
+};
+
+// worker thread of a Surfe_API object. It has a single worker so queued calls
+// run in submission order, e.g. an evaluation submitted after
+// ComputeInterpolantAsync sees the new interpolant, while other objects run
+// concurrently
+static py::object async_executor(py::object self)
+{
+	if (!py::hasattr(self, "_async_executor")) {
+		py::module futures = py::module::import("concurrent.futures");
+		self.attr("_async_executor") = futures.attr("ThreadPoolExecutor")(py::arg("max_workers") = 1);
+	}
+	return self.attr("_async_executor");
+}
+
+// Runs self.<method_name>(*args) on the worker thread of the object and returns
+// a concurrent.futures.Future (asyncio.wrap_future() makes it awaitable).
+// progress_callback replaces the callback of the object for this call only.
+static py::object submit_async(py::object self, const std::string &method_name, py::object progress_callback, py::tuple args)
+{
+	py::cpp_function task([self, method_name, progress_callback, args]() -> py::object {
+		Surfe_API &api = self.cast<Surfe_API &>();
+		if (progress_callback.is_none())
+			return self.attr(method_name.c_str())(*args);
+
+		ProgressCallback previous = api.GetProgressCallback();
+		api.SetProgressCallback(progress_callback.cast<ProgressCallback>());
+		try
+		{
+			py::object result = self.attr(method_name.c_str())(*args);
+			api.SetProgressCallback(previous);
+			return result;
+		}
+		catch (...)
+		{
+			api.SetProgressCallback(previous);
+			throw;
+		}
+	});
+	return async_executor(self).attr("submit")(task);
+}
+
+// Queues the computation of the interpolant on the worker of the object and
+// returns a Future completed when it ends, so calls submitted before it are
+// done first and calls submitted after it see the new interpolant.
+// future.handle is the Compute_Handle to poll the progress or cancel, also
+// while the computation is queued. Cancelled raises CancelledError and Failed
+// RuntimeError from future.result()
+static py::object compute_async(py::object self, py::object progress_callback, py::object on_complete)
+{
+	std::shared_ptr<Compute_Handle> handle = std::make_shared<Compute_Handle>();
+	CompletionCallback completion = on_complete.is_none() ? CompletionCallback() : on_complete.cast<CompletionCallback>();
+	py::cpp_function task([self, handle, progress_callback, completion]() {
+		Surfe_API &api = self.cast<Surfe_API &>();
+		ProgressCallback previous = api.GetProgressCallback();
+		if (!progress_callback.is_none())
+			api.SetProgressCallback(progress_callback.cast<ProgressCallback>());
+		try
+		{
+			py::gil_scoped_release release;
+			api.ComputeInterpolant(handle, completion);
+		}
+		catch (...)
+		{
+			api.SetProgressCallback(previous);
+			throw;
+		}
+		api.SetProgressCallback(previous);
+		if (handle->GetPhase() == Parameter_Types::Cancelled) {
+			py::object cancelled_error = py::module::import("concurrent.futures").attr("CancelledError");
+			PyErr_SetString(cancelled_error.ptr(), handle->GetErrorMessage().c_str());
+			throw py::error_already_set();
+		}
+		if (handle->GetPhase() == Parameter_Types::Failed)
+			throw std::runtime_error(handle->GetErrorMessage());
+	});
+	py::object future = async_executor(self).attr("submit")(task);
+	future.attr("handle") = py::cast(handle);
+	return future;
+}
+
 PYBIND11_MODULE(surfepy, m) {
+	py::enum_<Parameter_Types::ComputePhase>(m, "ComputePhase")
+		.value("Idle", Parameter_Types::Idle)
+		.value("Preprocessing", Parameter_Types::Preprocessing)
+		.value("Assembly", Parameter_Types::Assembly)
+		.value("Solving", Parameter_Types::Solving)
+		.value("Greedy", Parameter_Types::Greedy)
+		.value("Complete", Parameter_Types::Complete)
+		.value("Cancelled", Parameter_Types::Cancelled)
+		.value("Failed", Parameter_Types::Failed);
+
+	py::class_<Compute_Progress>(m, "ComputeProgress")
+		.def_readonly("phase", &Compute_Progress::phase)
+		.def_readonly("assembly_fraction", &Compute_Progress::assembly_fraction)
+		.def_readonly("solver_iteration", &Compute_Progress::solver_iteration)
+		.def_readonly("greedy_iteration", &Compute_Progress::greedy_iteration)
+		.def_readonly("n_greedy_residuals", &Compute_Progress::n_greedy_residuals);
+
+	py::class_<Iso_Surface>(m, "IsoSurface")
+		.def_readonly("iso_value", &Iso_Surface::iso_value)
+		.def_readonly("vertices", &Iso_Surface::vertices)
+		.def_readonly("triangles", &Iso_Surface::triangles);
+
+	m.def("ExtractIsoSurfaces",
+		[](const VectorXd &volume, const Vector3d &origin, const Vector3d &spacing, const Vector3i &dims, const std::vector<double> &iso_values) {
+			if (volume.size() != (long long)dims(0) * dims(1) * dims(2))
+				throw GRBF_Exceptions::array_has_incorrect_dimensions;
+			return extract_iso_surfaces(volume.data(), origin, spacing, dims, iso_values);
+		}, py::call_guard<py::gil_scoped_release>(),
+		"Contour a flattened volume (x fastest) at each iso value, returns an IsoSurface per value",
+		py::arg("volume"), py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("iso_values"));
+
+	m.def("ReadCSVColumns", &read_csv_columns, py::call_guard<py::gil_scoped_release>(),
+		"The named columns of a .csv file as an n x len(columns) array, parsed in parallel from a memory mapping",
+		py::arg("filename"), py::arg("columns"));
+	m.def("ReadCSVHeader", &read_csv_header, "Names of the header fields of a .csv file", py::arg("filename"));
+	m.def("WriteConstraintFile", &write_constraint_file, py::call_guard<py::gil_scoped_release>(),
+		"Write constraint arrays (columns as in Get*Constraints, empty ones left out) to a binary columnar file",
+		py::arg("filename"), py::arg("interface") = MatrixXd(), py::arg("planar") = MatrixXd(), py::arg("tangent") = MatrixXd(),
+		py::arg("inequality") = MatrixXd(), py::arg("single_precision") = false, py::arg("compress") = false);
+	m.def("ReadConstraintFile",
+		[](const char *filename) {
+			Constraint_File_Reader reader;
+			reader.open(filename);
+			std::map<std::string, MatrixXd> constraints;
+			const char *names[] = { "interface", "planar", "tangent", "inequality" };
+			for (int t = 0; t < 4; t++) {
+				const Constraint_File_Format::Constraint_Type type = (Constraint_File_Format::Constraint_Type)(t + 1);
+				MatrixXd storage;
+				if (reader.GetNumberOfConstraints(type) != 0)
+					constraints[names[t]] = reader.GetConstraints(type, storage);
+			}
+			return constraints;
+		}, py::call_guard<py::gil_scoped_release>(),
+		"The constraint arrays of a binary constraint file, a dict keyed by interface, planar, tangent and inequality",
+		py::arg("filename"));
+	m.def("VtkCompressionAvailable", &vtk_compression_available, "True if surfe was built with zlib to compress .vti and .vtp files");
+	m.def("WriteVTPPoints",
+		[](const char *filename, const MatrixXd &points, const std::map<std::string, MatrixXd> &point_arrays, const bool &compress) {
+			std::vector<Vtk_Array> arrays;
+			for (const auto &array : point_arrays)
+				arrays.push_back(Vtk_Array{ array.first, array.second });
+			write_vtp_points(filename, points, arrays, compress);
+		}, py::call_guard<py::gil_scoped_release>(),
+		"Write points (n x 3) as a .vtp file with a point data array per name",
+		py::arg("filename"), py::arg("points"), py::arg("point_arrays") = std::map<std::string, MatrixXd>(), py::arg("compress") = false);
+	m.def("WriteVTPSurfaces", &write_vtp_surfaces, py::call_guard<py::gil_scoped_release>(),
+		"Write IsoSurfaces as one .vtp file with their iso values as point data",
+		py::arg("filename"), py::arg("surfaces"), py::arg("compress") = false);
+
+	py::class_<Grid_Level>(m, "GridLevel")
+		.def_readonly("level", &Grid_Level::level)
+		.def_readonly("stride", &Grid_Level::stride)
+		.def_readonly("origin", &Grid_Level::origin)
+		.def_readonly("spacing", &Grid_Level::spacing)
+		.def_readonly("dims", &Grid_Level::dims)
+		.def_readonly("values", &Grid_Level::values);
+
+	py::class_<Grid_Pyramid_Handle, std::shared_ptr<Grid_Pyramid_Handle> >(m, "GridPyramidHandle")
+		.def("GetNumberOfLevels", &Grid_Pyramid_Handle::GetNumberOfLevels)
+		.def("GetNumberOfCompletedLevels", &Grid_Pyramid_Handle::GetNumberOfCompletedLevels)
+		.def("GetProgress", &Grid_Pyramid_Handle::GetProgress)
+		.def("WaitForLevel", &Grid_Pyramid_Handle::WaitForLevel, py::call_guard<py::gil_scoped_release>(),
+			"False if the level is still not complete after seconds", py::arg("level"), py::arg("seconds"))
+		.def("GetLevel", &Grid_Pyramid_Handle::GetLevel)
+		.def("Wait", &Grid_Pyramid_Handle::Wait, py::call_guard<py::gil_scoped_release>())
+		.def("IsDone", &Grid_Pyramid_Handle::IsDone)
+		.def("Cancel", &Grid_Pyramid_Handle::Cancel)
+		.def("GetErrorMessage", &Grid_Pyramid_Handle::GetErrorMessage);
+
+	py::class_<Compute_Handle, std::shared_ptr<Compute_Handle> >(m, "ComputeHandle")
+		.def("Wait", &Compute_Handle::Wait, py::call_guard<py::gil_scoped_release>())
+		.def("WaitFor", &Compute_Handle::WaitFor, py::call_guard<py::gil_scoped_release>(),
+			"False if still running after seconds")
+		.def("Cancel", &Compute_Handle::Cancel)
+		.def("IsDone", &Compute_Handle::IsDone)
+		.def("GetPhase", &Compute_Handle::GetPhase)
+		.def("GetProgress", &Compute_Handle::GetProgress)
+		.def("GetErrorMessage", &Compute_Handle::GetErrorMessage);
+
+	py::class_<Task_Scheduler>(m, "TaskScheduler")
+		.def("concurrency", &Task_Scheduler::concurrency);
+	py::class_<Work_Stealing_Scheduler, Task_Scheduler>(m, "WorkStealingScheduler")
+		.def(py::init<const int &>(), py::arg("n_threads") = 0);
+
 	// setup bindings for Surfe_API
-	py::class_<Surfe_API>(m, "Surfe_API")
+	// dynamic attributes hold the worker of the asynchronous calls
+	py::class_<Surfe_API, std::unique_ptr<Surfe_API, Delete_Without_GIL<Surfe_API> > >(m, "Surfe_API", py::dynamic_attr())
 		.def(py::init<const int>())
 		.def(py::init<const Parameters &>())
 		.def("AddInterfaceConstraint",
@@ -32,7 +236,18 @@ PYBIND11_MODULE(surfepy, m) {
 		.def("AddInequalityConstraint",
 		(void (Surfe_API::*)(const double&, const double&, const double&, const double&))
 			&Surfe_API::AddInequalityConstraint, "Add an inequality constraint")
-		.def("ComputeInterpolant", &Surfe_API::ComputeInterpolant)
+		.def("ComputeInterpolant", (void (Surfe_API::*)()) &Surfe_API::ComputeInterpolant, py::call_guard<py::gil_scoped_release>())
+		.def("ComputeInterpolantAsync", &compute_async,
+			"Compute the interpolant on a background thread. Returns a concurrent.futures.Future, its handle attribute is a cancellable ComputeHandle",
+			py::arg("progress_callback") = py::none(), py::arg("on_complete") = py::none())
+		.def("SaveInterpolant", &Surfe_API::SaveInterpolant, py::call_guard<py::gil_scoped_release>(),
+			"Write the computed interpolant to a binary snapshot file")
+		.def("LoadInterpolant", &Surfe_API::LoadInterpolant, py::call_guard<py::gil_scoped_release>(),
+			"Replace this model with an interpolant read from a snapshot file")
+		.def("SetTaskScheduler", &Surfe_API::SetTaskScheduler, py::keep_alive<1, 2>(),
+			"Run the parallel loops on this scheduler, None for the shared default")
+		.def("SetMaxConcurrency", &Surfe_API::SetMaxConcurrency, "Max # of threads per parallel loop, 0 = no limit")
+		.def("SetProgressCallback", &Surfe_API::SetProgressCallback, "callback(stage, fraction), None to disable")
 		.def("SetRegressionSmoothing", &Surfe_API::SetRegressionSmoothing)
 		.def("SetGreedyAlgorithm", &Surfe_API::SetGreedyAlgorithm)
 		.def("SetRestrictedRange", &Surfe_API::SetRestrictedRange)
@@ -42,20 +257,160 @@ PYBIND11_MODULE(surfepy, m) {
 		.def("SetRBFShapeParameter", &Surfe_API::SetRBFShapeParameter)
 		.def("SetPolynomialOrder", &Surfe_API::SetPolynomialOrder)
 		.def("SetGlobalAnisotropy", &Surfe_API::SetGlobalAnisotropy)
+		.def("SetDeclustering",
+		(void (Surfe_API::*)(const bool&, const double&, const char *))
+			&Surfe_API::SetDeclustering, "Thin dense constraints to a target spacing: 'voxel' or 'poisson'")
+		.def("SetCenterSelection",
+		(void (Surfe_API::*)(const bool&, const int&, const double&, const char *))
+			&Surfe_API::SetCenterSelection, "Greedy selection of at most max_centers constraints: 'p-greedy' or 'f-greedy'")
 		.def("EvaluateInterpolantAtPoint", &Surfe_API::EvaluateInterpolantAtPoint)
-		.def("EvaluateInterpolantAtPoints", &Surfe_API::EvaluateInterpolantAtPoints)
+		.def("EvaluateInterpolantAtPoints", &Surfe_API::EvaluateInterpolantAtPoints, py::call_guard<py::gil_scoped_release>())
+		.def("EvaluateInterpolantAtPointsAsync",
+			[](py::object self, py::object locations, py::object progress_callback) {
+				return submit_async(self, "EvaluateInterpolantAtPoints", progress_callback, py::make_tuple(locations));
+			}, "Evaluate the scalar field on a worker thread. Returns a concurrent.futures.Future",
+			py::arg("locations"), py::arg("progress_callback") = py::none())
 		.def("EvaluateVectorInterpolantAtPoint", &Surfe_API::EvaluateVectorInterpolantAtPoint)
-		.def("EvaluateVectorInterpolantAtPoints", &Surfe_API::EvaluateVectorInterpolantAtPoints)
+		.def("EvaluateVectorInterpolantAtPoints", &Surfe_API::EvaluateVectorInterpolantAtPoints, py::call_guard<py::gil_scoped_release>())
+		.def("EvaluateVectorInterpolantAtPointsAsync",
+			[](py::object self, py::object locations, py::object progress_callback) {
+				return submit_async(self, "EvaluateVectorInterpolantAtPoints", progress_callback, py::make_tuple(locations));
+			}, "Evaluate the gradient on a worker thread. Returns a concurrent.futures.Future",
+			py::arg("locations"), py::arg("progress_callback") = py::none())
+		.def("EvaluateInterpolantAndDerivativesAtPoints", &Surfe_API::EvaluateInterpolantAndDerivativesAtPoints,
+			py::arg("locations"), py::arg("with_hessian") = false, py::call_guard<py::gil_scoped_release>(),
+			"n x 4 value, gx, gy, gz (n x 10 with hessian xx, yy, zz, xy, xz, yz) in one pass")
+		.def("EvaluateOnRegularGrid", &Surfe_API::EvaluateOnRegularGrid, py::call_guard<py::gil_scoped_release>(),
+			"Scalar field on the grid origin + (i, j, k) * spacing, x varies fastest. Reshape to (nz, ny, nx)",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"))
+		.def("WriteRegularGrid", &Surfe_API::WriteRegularGrid, py::call_guard<py::gil_scoped_release>(),
+			"Evaluate the grid by slabs written to a .vti or .mhd file as they are done, for grids larger than memory",
+			py::arg("filename"), py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("single_precision") = false, py::arg("compress") = false)
+		.def("EvaluateGridPyramid", &Surfe_API::EvaluateGridPyramid, py::call_guard<py::gil_scoped_release>(),
+			"The same grid evaluated coarse to fine, a GridLevel per level. on_level is called with each level",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("n_levels") = 0, py::arg("on_level") = py::none())
+		.def("EvaluateGridPyramidAsync", &Surfe_API::EvaluateGridPyramidAsync,
+			"Evaluate the grid pyramid on a background thread. Returns a GridPyramidHandle to poll the levels",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("n_levels") = 0, py::arg("on_level") = py::none())
+		.def("GetIsoSurfaces", (std::vector<Iso_Surface> (Surfe_API::*)(const Vector3d &, const Vector3d &, const Vector3i &)) &Surfe_API::GetIsoSurfaces,
+			py::call_guard<py::gil_scoped_release>(), "Interface surfaces contoured on the grid, an IsoSurface per interface",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"))
+		.def("GetIsoSurfaces", (std::vector<Iso_Surface> (Surfe_API::*)(const Vector3d &, const Vector3d &, const Vector3i &, const std::vector<double> &)) &Surfe_API::GetIsoSurfaces,
+			py::call_guard<py::gil_scoped_release>(), "Surfaces at the given scalar field values contoured on the grid",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("iso_values"))
+		.def("GetIsoSurfacesAdaptive", (std::vector<Iso_Surface> (Surfe_API::*)(const Vector3d &, const Vector3d &, const Vector3i &, const int &)) &Surfe_API::GetIsoSurfacesAdaptive,
+			py::call_guard<py::gil_scoped_release>(), "Interface surfaces evaluating the field only in the cells near them",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("coarse_stride") = 16)
+		.def("GetIsoSurfacesAdaptive", (std::vector<Iso_Surface> (Surfe_API::*)(const Vector3d &, const Vector3d &, const Vector3i &, const std::vector<double> &, const int &)) &Surfe_API::GetIsoSurfacesAdaptive,
+			py::call_guard<py::gil_scoped_release>(), "Surfaces at the given values evaluating the field only in the cells near them",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("iso_values"), py::arg("coarse_stride") = 16)
 
-		.def("GetDataBoundsAndResolution", &Surfe_API::GetDataBoundsAndResolution)
+		.def("GetDataBoundsAndResolution", &Surfe_API::GetDataBoundsAndResolution, py::call_guard<py::gil_scoped_release>())
 		.def("GetInterfaceReferencePoints", &Surfe_API::GetInterfaceReferencePoints)
-		.def("GetInterfaceConstraints", &Surfe_API::GetInterfaceConstraints)
-		.def("SetInterfaceConstraints", &Surfe_API::SetInterfaceConstraints)
-		.def("GetPlanarConstraints", &Surfe_API::GetPlanarConstraints)
-		.def("SetPlanarConstraints", &Surfe_API::SetPlanarConstraints)
-		.def("GetTangentConstraints", &Surfe_API::GetTangentConstraints)
-		.def("SetTangentConstraints", &Surfe_API::SetTangentConstraints)
-		.def("GetInequalityConstraints", &Surfe_API::GetInequalityConstraints)
-		.def("SetInequalityConstraints", &Surfe_API::SetInequalityConstraints);
+		.def("GetInterfaceConstraints", &Surfe_API::GetInterfaceConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("SetInterfaceConstraints", &Surfe_API::SetInterfaceConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("GetPlanarConstraints", &Surfe_API::GetPlanarConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("SetPlanarConstraints", &Surfe_API::SetPlanarConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("SetPlanarConstraintsStrikeDipPolarity", &Surfe_API::SetPlanarConstraintsStrikeDipPolarity, py::call_guard<py::gil_scoped_release>())
+		.def("SetPlanarConstraintsAzimuthDipPolarity", &Surfe_API::SetPlanarConstraintsAzimuthDipPolarity, py::call_guard<py::gil_scoped_release>())
+		.def("GetTangentConstraints", &Surfe_API::GetTangentConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("SetTangentConstraints", &Surfe_API::SetTangentConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("GetInequalityConstraints", &Surfe_API::GetInequalityConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("SetInequalityConstraints", &Surfe_API::SetInequalityConstraints, py::call_guard<py::gil_scoped_release>())
+		.def("LoadConstraintFiles", &Surfe_API::LoadConstraintFiles, py::call_guard<py::gil_scoped_release>(),
+			"Read the constraint .csv files concurrently and in parallel. Empty file names are skipped",
+			py::arg("interface_file"), py::arg("planar_file") = "", py::arg("tangent_file") = "", py::arg("inequality_file") = "")
+		.def("SaveConstraints", &Surfe_API::SaveConstraints, py::call_guard<py::gil_scoped_release>(),
+			"Write all the constraints to a binary columnar constraint file",
+			py::arg("filename"), py::arg("single_precision") = false, py::arg("compress") = false)
+		.def("LoadConstraints", &Surfe_API::LoadConstraints, py::call_guard<py::gil_scoped_release>(),
+			"Replace all the constraints with those of a binary constraint file, read from a memory mapping")
+		.def("ComputeConstraintResiduals", &Surfe_API::ComputeConstraintResiduals, py::call_guard<py::gil_scoped_release>());
+
+	// models are owned by the batch, GetModel() returns a reference kept valid
+	// by the batch object
+	py::class_<Surfe_Batch, std::unique_ptr<Surfe_Batch, Delete_Without_GIL<Surfe_Batch> > >(m, "Surfe_Batch")
+		.def(py::init<>())
+		.def("AddModel", (int (Surfe_Batch::*)(const int &)) &Surfe_Batch::AddModel, "Add an empty model, returns its index")
+		.def("AddModel", (int (Surfe_Batch::*)(const Parameters &)) &Surfe_Batch::AddModel, "Add an empty model, returns its index")
+		.def("GetModel", &Surfe_Batch::GetModel, py::return_value_policy::reference_internal)
+		.def("GetNumberOfModels", &Surfe_Batch::GetNumberOfModels)
+		.def("SetTaskScheduler", &Surfe_Batch::SetTaskScheduler, py::keep_alive<1, 2>())
+		.def("SetSmallModelSize", &Surfe_Batch::SetSmallModelSize, "Models with at most n_rows matrix rows run single threaded")
+		.def("ComputeAll", &Surfe_Batch::ComputeAll, py::call_guard<py::gil_scoped_release>(),
+			"Compute every model, returns a ComputeHandle per model")
+		.def("ComputeAllAsync", &Surfe_Batch::ComputeAllAsync,
+			"Compute every model in the background, returns a ComputeHandle per model")
+		.def("Wait", &Surfe_Batch::Wait, py::call_guard<py::gil_scoped_release>())
+		.def("Cancel", &Surfe_Batch::Cancel)
+		.def("IsRunning", &Surfe_Batch::IsRunning)
+		.def("EvaluateInterpolantsAtPoints", &Surfe_Batch::EvaluateInterpolantsAtPoints, py::call_guard<py::gil_scoped_release>(),
+			"Scalar fields of every model at the same points, n x n_models");
+
+	py::class_<Virtual_Volume_Statistics>(m, "VirtualVolumeStatistics")
+		.def_readonly("hits", &Virtual_Volume_Statistics::hits)
+		.def_readonly("misses", &Virtual_Volume_Statistics::misses)
+		.def_readonly("prefetched", &Virtual_Volume_Statistics::prefetched)
+		.def_readonly("evicted", &Virtual_Volume_Statistics::evicted)
+		.def_readonly("cached_bricks", &Virtual_Volume_Statistics::cached_bricks)
+		.def_readonly("cached_mb", &Virtual_Volume_Statistics::cached_mb);
+
+	py::class_<Virtual_Volume>(m, "VirtualVolume")
+		.def(py::init<Surfe_API *, const Vector3d &, const Vector3d &, const Vector3i &, const int &, const double &>(),
+			"Grid of a computed model evaluated by bricks on demand, cached up to max_memory_mb",
+			py::arg("model"), py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("brick_size") = 32,
+			py::arg("max_memory_mb") = 512)
+		.def("GetOrigin", &Virtual_Volume::GetOrigin)
+		.def("GetSpacing", &Virtual_Volume::GetSpacing)
+		.def("GetDimensions", &Virtual_Volume::GetDimensions)
+		.def("GetBrickSize", &Virtual_Volume::GetBrickSize)
+		.def("GetNumberOfBricks", &Virtual_Volume::GetNumberOfBricks)
+		.def("SetTaskScheduler", &Virtual_Volume::SetTaskScheduler, py::keep_alive<1, 2>())
+		.def("SetMaxConcurrency", &Virtual_Volume::SetMaxConcurrency)
+		.def("SetPrefetch", &Virtual_Volume::SetPrefetch)
+		.def("GetRegion", &Virtual_Volume::GetRegion, py::call_guard<py::gil_scoped_release>(),
+			"Values of the points [first, first + size), x varies fastest. Reshape to (sz, sy, sx)",
+			py::arg("first"), py::arg("size"))
+		.def("GetSlice", &Virtual_Volume::GetSlice, py::call_guard<py::gil_scoped_release>(),
+			"Slice index across axis (0 x, 1 y, 2 z)", py::arg("axis"), py::arg("index"))
+		.def("GetValue", &Virtual_Volume::GetValue, py::call_guard<py::gil_scoped_release>())
+		.def("GetBrick", &Virtual_Volume::GetBrick, py::call_guard<py::gil_scoped_release>())
+		.def("GetStatistics", &Virtual_Volume::GetStatistics)
+		.def("ClearCache", &Virtual_Volume::ClearCache);
+
+	py::class_<Fused_Evaluator>(m, "FusedEvaluator")
+		.def(py::init<const std::vector<Surfe_API *> &>(), "Snapshot of the interpolants of a list of computed models")
+		.def("GetNumberOfModels", &Fused_Evaluator::GetNumberOfModels)
+		.def("GetNumberOfCenters", &Fused_Evaluator::GetNumberOfCenters)
+		.def("SetTaskScheduler", &Fused_Evaluator::SetTaskScheduler, py::keep_alive<1, 2>())
+		.def("SetMaxConcurrency", &Fused_Evaluator::SetMaxConcurrency)
+		.def("EvaluateInterpolantsAtPoints", &Fused_Evaluator::EvaluateInterpolantsAtPoints, py::call_guard<py::gil_scoped_release>(),
+			"n x n_models scalar field values")
+		.def("EvaluateOnRegularGrid", &Fused_Evaluator::EvaluateOnRegularGrid, py::call_guard<py::gil_scoped_release>(),
+			"nx ny nz x n_models values on the grid origin + (i, j, k) * spacing, x varies fastest",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"))
+		.def("EvaluateOnRefinedGrid", &Fused_Evaluator::EvaluateOnRefinedGrid, py::call_guard<py::gil_scoped_release>(),
+			"Same given the values on the grid of twice the spacing, which are reused",
+			py::arg("origin"), py::arg("spacing"), py::arg("dims"), py::arg("coarse_values"))
+		.def("EvaluateVectorInterpolantsAtPoints", &Fused_Evaluator::EvaluateVectorInterpolantsAtPoints, py::call_guard<py::gil_scoped_release>(),
+			"n x 3 * n_models gradients")
+		.def("EvaluateInterpolantsAndGradientsAtPoints",
+			[](const Fused_Evaluator &self, const ConstMatrixView &locations) {
+				MatrixXd values, gradients;
+				{
+					py::gil_scoped_release release;
+					self.EvaluateInterpolantsAndGradientsAtPoints(locations, values, gradients);
+				}
+				return py::make_tuple(values, gradients);
+			}, "(values, gradients)")
+		.def("EvaluateInterpolantsAndDerivativesAtPoints",
+			[](const Fused_Evaluator &self, const ConstMatrixView &locations) {
+				MatrixXd values, gradients, hessians;
+				{
+					py::gil_scoped_release release;
+					self.EvaluateInterpolantsAndDerivativesAtPoints(locations, values, gradients, hessians);
+				}
+				return py::make_tuple(values, gradients, hessians);
+			}, "(values, gradients, hessians)");
 		
 }
\ No newline at end of file
@@ -0,0 +1,421 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// surfe_run: computes a model and writes its outputs without VTK, Qt or a
+// display, e.g. on a batch scheduler
+//   surfe_run model.cfg [report.json]
+// The config file (see run_config.h) names the parameters, the constraint
+// files and the outputs. Wall time of every phase, the process peak memory
+// at its end and how much the phase raised it, the # of threads and the model
+// size are reported as JSON on stdout, or in the report file. Exit code 0 on
+// success, 1 if a phase failed, 2 for a bad command line.
+#include <run_config.h>
+#include <surfe_api.h>
+#include <csv_reader.h>
+#include <grbf_exceptions.h>
+#include <vtk_writer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const std::vector<std::string> known_keys = {
+	// model
+	"modelling_mode", "rbf", "shape_parameter", "polynomial_order", "global_anisotropy",
+	"restricted_range", "greedy", "interface_uncertainty", "angular_uncertainty", "regression_smoothing",
+	"declustering", "decluster_spacing", "center_selection", "max_centers", "center_tolerance", "threads",
+	// inputs
+	"interface_file", "planar_file", "tangent_file", "inequality_file", "constraint_file", "load_interpolant",
+	// grid
+	"grid_origin", "grid_spacing", "grid_dims",
+	// outputs
+	"save_interpolant", "save_constraints", "grid_output", "points_file", "points_output", "points_gradient",
+	"iso_surfaces_output", "iso_values", "iso_coarse_stride", "single_precision", "compress", "report"
+};
+
+// peak resident memory of the process in MB
+static double peak_memory_mb()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	// bytes on macOS, kB elsewhere
+	return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+	return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+static std::string json_string(const std::string &text)
+{
+	std::string quoted = "\"";
+	for (const char &c : text) {
+		if (c == '"' || c == '\\') {
+			quoted += '\\';
+			quoted += c;
+		}
+		else if ((unsigned char)c < 0x20) {
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+			quoted += escaped;
+		}
+		else
+			quoted += c;
+	}
+	return quoted + "\"";
+}
+
+class Run_Report {
+private:
+	struct Phase {
+		std::string name;
+		double seconds;
+		double peak_memory_so_far_mb;  // process high-water mark at the end of the phase
+		double peak_memory_growth_mb;  // increase of the high-water mark during the phase
+	};
+	std::chrono::steady_clock::time_point start_;
+	std::vector<Phase> phases_;
+	std::vector<std::pair<std::string, long long> > counts_;
+
+public:
+	std::string config;
+	std::string error;
+	std::string failed_phase;
+	int threads;
+
+	Run_Report() : start_(std::chrono::steady_clock::now()), threads(1) {}
+
+	// runs body as the named phase. An exception is passed on, the phase is
+	// reported as failed_phase
+	template <typename Body>
+	void Time(const std::string &name, const Body &body)
+	{
+		std::chrono::steady_clock::time_point phase_start = std::chrono::steady_clock::now();
+		double peak_at_start = peak_memory_mb();
+		try {
+			body();
+		}
+		catch (...) {
+			failed_phase = name;
+			throw;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - phase_start;
+		double peak_at_end = peak_memory_mb();
+		phases_.push_back({ name, elapsed.count(), peak_at_end, peak_at_end - peak_at_start });
+	}
+	void Count(const std::string &name, const long long &count) { counts_.emplace_back(name, count); }
+
+	void Write(std::ostream &out) const
+	{
+		std::chrono::duration<double> total = std::chrono::steady_clock::now() - start_;
+		out << "{\n";
+		out << "  \"config\": " << json_string(config) << ",\n";
+		out << "  \"status\": " << (error.empty() ? "\"ok\"" : "\"failed\"") << ",\n";
+		if (!error.empty())
+			out << "  \"error\": " << json_string(error) << ",\n";
+		if (!failed_phase.empty())
+			out << "  \"failed_phase\": " << json_string(failed_phase) << ",\n";
+		out << "  \"threads\": " << threads << ",\n";
+		out << "  \"phases\": [";
+		for (size_t k = 0; k < phases_.size(); k++)
+			out << (k ? ",\n" : "\n") << "    { \"name\": " << json_string(phases_[k].name) << ", \"seconds\": "
+				<< phases_[k].seconds << ", \"peak_memory_so_far_mb\": " << phases_[k].peak_memory_so_far_mb
+				<< ", \"peak_memory_growth_mb\": " << phases_[k].peak_memory_growth_mb << " }";
+		out << (phases_.empty() ? "],\n" : "\n  ],\n");
+		out << "  \"counts\": {";
+		for (size_t k = 0; k < counts_.size(); k++)
+			out << (k ? ", " : " ") << json_string(counts_[k].first) << ": " << counts_[k].second;
+		out << (counts_.empty() ? "},\n" : " },\n");
+		out << "  \"total_seconds\": " << total.count() << ",\n";
+		out << "  \"peak_memory_mb\": " << peak_memory_mb() << "\n";
+		out << "}\n";
+	}
+};
+
+static void set_parameters(const Run_Config &config, Surfe_API &surfe)
+{
+	if (config.Has("rbf"))
+		surfe.SetRBFKernel(config.GetString("rbf").c_str());
+	if (config.Has("shape_parameter"))
+		surfe.SetRBFShapeParameter(config.GetDouble("shape_parameter"));
+	if (config.Has("polynomial_order"))
+		surfe.SetPolynomialOrder(config.GetInt("polynomial_order"));
+	if (config.Has("global_anisotropy"))
+		surfe.SetGlobalAnisotropy(config.GetBool("global_anisotropy"));
+	double interface_uncertainty = config.GetDouble("interface_uncertainty");
+	double angular_uncertainty = config.GetDouble("angular_uncertainty");
+	if (config.GetBool("restricted_range"))
+		surfe.SetRestrictedRange(true, interface_uncertainty, angular_uncertainty);
+	if (config.GetBool("greedy"))
+		surfe.SetGreedyAlgorithm(true, interface_uncertainty, angular_uncertainty);
+	if (config.Has("regression_smoothing"))
+		surfe.SetRegressionSmoothing(true, config.GetDouble("regression_smoothing"));
+	if (config.Has("declustering"))
+		surfe.SetDeclustering(true, config.GetDouble("decluster_spacing"), config.GetString("declustering").c_str());
+	if (config.Has("center_selection"))
+		surfe.SetCenterSelection(true, config.GetInt("max_centers"), config.GetDouble("center_tolerance"),
+			config.GetString("center_selection").c_str());
+}
+
+static std::string lower_case(std::string text)
+{
+	for (auto &c : text)
+		c = (char)std::tolower((unsigned char)c);
+	return text;
+}
+
+// x, y, z columns of a .csv file, names are case insensitive
+static MatrixXd read_csv_points(const std::string &filename)
+{
+	std::vector<std::string> header = read_csv_header(filename.c_str());
+	std::vector<std::string> columns;
+	for (const char *name : { "x", "y", "z" }) {
+		for (const auto &field : header)
+			if (lower_case(field) == name) {
+				columns.push_back(field);
+				break;
+			}
+		if (columns.size() == 0 || lower_case(columns.back()) != name)
+			throw GRBF_Exceptions::missing_csv_column;
+	}
+	return read_csv_columns(filename.c_str(), columns);
+}
+
+// values (n x 1 or n x 4 with the gradient) after the point coordinates
+static void write_csv_points(const std::string &filename, const MatrixXd &points, const VectorXd &values,
+	const MatrixXd &gradients)
+{
+	FILE *file = fopen(filename.c_str(), "wb");
+	if (!file)
+		throw std::runtime_error("cannot write " + filename);
+	fputs(gradients.size() ? "x,y,z,value,gx,gy,gz\n" : "x,y,z,value\n", file);
+	for (Index j = 0; j < points.rows(); j++) {
+		fprintf(file, "%.17g,%.17g,%.17g,%.17g", points(j, 0), points(j, 1), points(j, 2), values(j));
+		if (gradients.size())
+			fprintf(file, ",%.17g,%.17g,%.17g", gradients(j, 0), gradients(j, 1), gradients(j, 2));
+		fputc('\n', file);
+	}
+	bool failed = ferror(file) != 0;
+	if (fclose(file) != 0 || failed)
+		throw std::runtime_error("cannot write " + filename);
+}
+
+static void run(const Run_Config &config, Run_Report &report)
+{
+	std::vector<std::string> unknown = config.UnknownKeys(known_keys);
+	if (!unknown.empty())
+		throw Run_Config_Error("unknown key " + unknown[0]);
+
+	// threads = n caps every parallel loop at n threads (the calling thread and
+	// n - 1 workers of the scheduler). Default: every hardware thread
+	int threads = config.GetInt("threads");
+	if (threads < 0)
+		throw Run_Config_Error("threads must be >= 0");
+	int available = get_default_task_scheduler()->concurrency() + 1;
+	report.threads = threads > 0 ? std::min(threads, available) : available;
+	Scheduler_Scope scope(nullptr, threads);
+
+	Surfe_API surfe(config.GetInt("modelling_mode", 1));
+	surfe.SetMaxConcurrency(threads);
+
+	std::string interpolant = config.GetPath("load_interpolant");
+	if (!interpolant.empty()) {
+		report.Time("load_interpolant", [&]() { surfe.LoadInterpolant(interpolant.c_str()); });
+	}
+	else {
+		set_parameters(config, surfe);
+		std::string constraint_file = config.GetPath("constraint_file");
+		if (!constraint_file.empty())
+			report.Time("load_constraints", [&]() { surfe.LoadConstraints(constraint_file.c_str()); });
+		std::string interface_file = config.GetPath("interface_file");
+		std::string planar_file = config.GetPath("planar_file");
+		std::string tangent_file = config.GetPath("tangent_file");
+		std::string inequality_file = config.GetPath("inequality_file");
+		if (!interface_file.empty() || !planar_file.empty() || !tangent_file.empty() || !inequality_file.empty())
+			report.Time("read_constraint_files", [&]() {
+				surfe.LoadConstraintFiles(interface_file.c_str(), planar_file.c_str(), tangent_file.c_str(),
+					inequality_file.c_str());
+			});
+	}
+	report.Count("interface_constraints", surfe.GetInterfaceConstraints().rows());
+	report.Count("planar_constraints", surfe.GetPlanarConstraints().rows());
+	report.Count("tangent_constraints", surfe.GetTangentConstraints().rows());
+	report.Count("inequality_constraints", surfe.GetInequalityConstraints().rows());
+
+	bool single_precision = config.GetBool("single_precision");
+	bool compress = config.GetBool("compress");
+	std::string save_constraints = config.GetPath("save_constraints");
+	if (!save_constraints.empty())
+		report.Time("save_constraints", [&]() { surfe.SaveConstraints(save_constraints.c_str(), single_precision, compress); });
+
+	if (interpolant.empty())
+		report.Time("compute_interpolant", [&]() { surfe.ComputeInterpolant(); });
+	std::string save_interpolant = config.GetPath("save_interpolant");
+	if (!save_interpolant.empty())
+		report.Time("save_interpolant", [&]() { surfe.SaveInterpolant(save_interpolant.c_str()); });
+
+	std::string points_file = config.GetPath("points_file");
+	std::string points_output = config.GetPath("points_output");
+	if (points_file.empty() != points_output.empty())
+		throw Run_Config_Error("points_file and points_output go together");
+	if (!points_file.empty()) {
+		MatrixXd points;
+		VectorXd values;
+		MatrixXd gradients;
+		report.Time("read_points", [&]() { points = read_csv_points(points_file); });
+		report.Time("evaluate_points", [&]() {
+			values = surfe.EvaluateInterpolantAtPoints(points);
+			if (config.GetBool("points_gradient"))
+				gradients = surfe.EvaluateVectorInterpolantAtPoints(points);
+		});
+		report.Time("write_points", [&]() { write_csv_points(points_output, points, values, gradients); });
+		report.Count("points", points.rows());
+	}
+
+	std::string grid_output = config.GetPath("grid_output");
+	std::string iso_surfaces_output = config.GetPath("iso_surfaces_output");
+	if (grid_output.empty() && iso_surfaces_output.empty())
+		return;
+	// grid_origin and grid_dims, or the bounds of the constraints sampled
+	// every grid_spacing
+	if (!config.Has("grid_spacing"))
+		throw Run_Config_Error("grid_spacing is needed for grid_output and iso_surfaces_output");
+	Vector3d spacing = config.GetVector3d("grid_spacing");
+	if (spacing.minCoeff() <= 0)
+		throw Run_Config_Error("grid_spacing must be > 0");
+	Vector3d origin;
+	Vector3i dims;
+	if (config.Has("grid_origin") != config.Has("grid_dims"))
+		throw Run_Config_Error("grid_origin and grid_dims go together");
+	if (config.Has("grid_origin")) {
+		origin = config.GetVector3d("grid_origin");
+		dims = config.GetVector3i("grid_dims");
+	}
+	else {
+		SpatialParameters bounds = surfe.GetDataBoundsAndResolution();
+		origin = Vector3d(bounds.xmin, bounds.ymin, bounds.zmin);
+		Vector3d extent(bounds.xmax - bounds.xmin, bounds.ymax - bounds.ymin, bounds.zmax - bounds.zmin);
+		for (int d = 0; d < 3; d++)
+			dims(d) = (int)std::ceil(extent(d) / spacing(d)) + 1;
+	}
+	report.Count("grid_points", (long long)dims(0) * dims(1) * dims(2));
+
+	if (!grid_output.empty())
+		report.Time("evaluate_grid", [&]() {
+			surfe.WriteRegularGrid(grid_output.c_str(), origin, spacing, dims, single_precision, compress);
+		});
+	if (!iso_surfaces_output.empty()) {
+		std::vector<Iso_Surface> surfaces;
+		std::vector<double> iso_values = config.GetDoubles("iso_values");
+		int coarse_stride = config.GetInt("iso_coarse_stride");
+		report.Time("iso_surfaces", [&]() {
+			if (coarse_stride > 1)
+				surfaces = iso_values.empty() ? surfe.GetIsoSurfacesAdaptive(origin, spacing, dims, coarse_stride)
+					: surfe.GetIsoSurfacesAdaptive(origin, spacing, dims, iso_values, coarse_stride);
+			else
+				surfaces = iso_values.empty() ? surfe.GetIsoSurfaces(origin, spacing, dims)
+					: surfe.GetIsoSurfaces(origin, spacing, dims, iso_values);
+		});
+		report.Time("write_iso_surfaces", [&]() { write_vtp_surfaces(iso_surfaces_output.c_str(), surfaces, compress); });
+		long long triangles = 0;
+		for (const auto &surface : surfaces)
+			triangles += surface.triangles.rows();
+		report.Count("iso_surface_triangles", triangles);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2 || argc > 3) {
+		std::cerr << "usage: surfe_run <config file> [report.json]" << std::endl;
+		return 2;
+	}
+	Run_Report report;
+	report.config = argv[1];
+	report.threads = get_default_task_scheduler()->concurrency() + 1;
+	std::string report_file = argc > 2 ? argv[2] : "";
+	// the library's messages go to stderr, stdout only has the report
+	std::streambuf *stdout_buffer = std::cout.rdbuf(std::cerr.rdbuf());
+	try {
+		Run_Config config(argv[1]);
+		if (report_file.empty())
+			report_file = config.GetPath("report");
+		run(config, report);
+	}
+	catch (const std::exception &e) {
+		report.error = e.what();
+	}
+	std::cout.rdbuf(stdout_buffer);
+
+	if (report_file.empty())
+		report.Write(std::cout);
+	else {
+		std::ofstream out(report_file.c_str());
+		report.Write(out);
+		if (!out) {
+			std::cerr << "surfe_run: cannot write " << report_file << std::endl;
+			return 1;
+		}
+	}
+	if (!report.error.empty()) {
+		std::cerr << "surfe_run: " << report.error << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,216 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <run_config.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static std::string trim(const std::string &text)
+{
+	size_t first = 0, last = text.size();
+	while (first < last && std::isspace((unsigned char)text[first]))
+		first++;
+	while (last > first && std::isspace((unsigned char)text[last - 1]))
+		last--;
+	return text.substr(first, last - first);
+}
+
+static std::string lower_case(std::string text)
+{
+	for (auto &c : text)
+		c = (char)std::tolower((unsigned char)c);
+	return text;
+}
+
+static bool is_absolute_path(const std::string &path)
+{
+	if (!path.empty() && (path[0] == '/' || path[0] == '\\'))
+		return true;
+	// drive letter
+	return path.size() > 1 && path[1] == ':';
+}
+
+Run_Config::Run_Config(const std::string &filename)
+{
+	std::ifstream file(filename.c_str());
+	if (!file)
+		throw Run_Config_Error("cannot read config file " + filename);
+	size_t separator = filename.find_last_of("/\\");
+	if (separator != std::string::npos)
+		directory_ = filename.substr(0, separator + 1);
+
+	std::string line;
+	int line_number = 0;
+	while (std::getline(file, line)) {
+		line_number++;
+		// UTF-8 byte order mark of files saved by some editors
+		if (line_number == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+			line.erase(0, 3);
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+		line = trim(line);
+		if (line.empty())
+			continue;
+		size_t equal = line.find('=');
+		if (equal == std::string::npos)
+			throw Run_Config_Error(filename + ":" + std::to_string(line_number) + ": expected key = value");
+		std::string key = lower_case(trim(line.substr(0, equal)));
+		if (key.empty())
+			throw Run_Config_Error(filename + ":" + std::to_string(line_number) + ": missing key");
+		if (values_.count(key))
+			throw Run_Config_Error(filename + ":" + std::to_string(line_number) + ": " + key + " is set twice");
+		values_[key] = trim(line.substr(equal + 1));
+		lines_[key] = line_number;
+	}
+}
+
+std::string Run_Config::value(const std::string &key) const
+{
+	auto it = values_.find(key);
+	return it == values_.end() ? std::string() : it->second;
+}
+
+void Run_Config::bad_value(const std::string &key, const std::string &expected) const
+{
+	auto it = lines_.find(key);
+	std::string where = it == lines_.end() ? "" : "line " + std::to_string(it->second) + ": ";
+	throw Run_Config_Error(where + key + " = " + value(key) + ", expected " + expected);
+}
+
+std::string Run_Config::GetString(const std::string &key, const std::string &default_value) const
+{
+	return Has(key) ? value(key) : default_value;
+}
+
+std::string Run_Config::GetPath(const std::string &key) const
+{
+	std::string path = value(key);
+	if (path.empty() || is_absolute_path(path))
+		return path;
+	return directory_ + path;
+}
+
+double Run_Config::GetDouble(const std::string &key, const double &default_value) const
+{
+	if (!Has(key))
+		return default_value;
+	std::string text = value(key);
+	char *end = nullptr;
+	errno = 0;
+	double number = std::strtod(text.c_str(), &end);
+	if (text.empty() || *end != '\0' || errno == ERANGE)
+		bad_value(key, "a number");
+	return number;
+}
+
+int Run_Config::GetInt(const std::string &key, const int &default_value) const
+{
+	if (!Has(key))
+		return default_value;
+	std::string text = value(key);
+	char *end = nullptr;
+	errno = 0;
+	long number = std::strtol(text.c_str(), &end, 10);
+	if (text.empty() || *end != '\0' || errno == ERANGE || number < INT_MIN || number > INT_MAX)
+		bad_value(key, "an integer");
+	return (int)number;
+}
+
+bool Run_Config::GetBool(const std::string &key, const bool &default_value) const
+{
+	if (!Has(key))
+		return default_value;
+	std::string text = lower_case(value(key));
+	if (text == "true" || text == "yes" || text == "on" || text == "1")
+		return true;
+	if (text == "false" || text == "no" || text == "off" || text == "0")
+		return false;
+	bad_value(key, "true or false");
+}
+
+std::vector<double> Run_Config::GetDoubles(const std::string &key) const
+{
+	std::string text = value(key);
+	std::replace(text.begin(), text.end(), ',', ' ');
+	std::istringstream stream(text);
+	std::vector<double> numbers;
+	std::string item;
+	while (stream >> item) {
+		char *end = nullptr;
+		double number = std::strtod(item.c_str(), &end);
+		if (*end != '\0')
+			bad_value(key, "a list of numbers");
+		numbers.push_back(number);
+	}
+	return numbers;
+}
+
+Vector3d Run_Config::GetVector3d(const std::string &key) const
+{
+	std::vector<double> numbers = GetDoubles(key);
+	if (numbers.size() == 1)
+		return Vector3d::Constant(numbers[0]);
+	if (numbers.size() != 3)
+		bad_value(key, "x, y, z");
+	return Vector3d(numbers[0], numbers[1], numbers[2]);
+}
+
+Vector3i Run_Config::GetVector3i(const std::string &key) const
+{
+	Vector3d numbers = GetVector3d(key);
+	for (int d = 0; d < 3; d++)
+		if (numbers(d) < 1 || numbers(d) > INT_MAX || numbers(d) != std::floor(numbers(d)))
+			bad_value(key, "positive integers");
+	return numbers.cast<int>();
+}
+
+std::vector<std::string> Run_Config::UnknownKeys(const std::vector<std::string> &known) const
+{
+	std::vector<std::string> unknown;
+	for (const auto &entry : values_)
+		if (std::find(known.begin(), known.end(), entry.first) == known.end())
+			unknown.push_back(entry.first);
+	return unknown;
+}
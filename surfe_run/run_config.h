@@ -0,0 +1,88 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef run_config_h
+#define run_config_h
+
+#include <Eigen/Core>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Eigen;
+
+// Thrown for unreadable config files, unknown keys and bad values
+class Run_Config_Error : public std::runtime_error {
+public:
+	explicit Run_Config_Error(const std::string &message) : std::runtime_error(message) {}
+};
+
+// Settings of a surfe_run pipeline: one "key = value" per line, # starts a
+// comment. Lists are comma or space separated. Relative file names are
+// resolved against the directory of the config file, see docs/InputsAndOutputs.md
+// for the keys.
+class Run_Config {
+private:
+	std::string directory_;
+	std::map<std::string, std::string> values_;
+	std::map<std::string, int> lines_;
+
+	std::string value(const std::string &key) const;
+	[[noreturn]] void bad_value(const std::string &key, const std::string &expected) const;
+
+public:
+	// throws Run_Config_Error
+	explicit Run_Config(const std::string &filename);
+
+	bool Has(const std::string &key) const { return values_.count(key) != 0; }
+	std::string GetString(const std::string &key, const std::string &default_value = "") const;
+	// absolute or relative to the config file, empty if not set
+	std::string GetPath(const std::string &key) const;
+	double GetDouble(const std::string &key, const double &default_value = 0) const;
+	int GetInt(const std::string &key, const int &default_value = 0) const;
+	// true / false, yes / no, on / off or 1 / 0
+	bool GetBool(const std::string &key, const bool &default_value = false) const;
+	std::vector<double> GetDoubles(const std::string &key) const;
+	// three values, or one used for x, y and z
+	Vector3d GetVector3d(const std::string &key) const;
+	Vector3i GetVector3i(const std::string &key) const;
+	// keys of the file that are not in known, e.g. misspelled ones
+	std::vector<std::string> UnknownKeys(const std::vector<std::string> &known) const;
+};
+
+#endif
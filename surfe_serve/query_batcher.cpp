@@ -0,0 +1,197 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <query_batcher.h>
+#include <task_scheduler.h>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+// points per parallel_for chunk: enough to amortize the scheduling, few
+// enough that a batch of small queries still spreads over the threads
+static const long long chunk_points = 256;
+
+// points [first, first + n) of query
+static void evaluate_range(Query_Batcher::Query &query, const long long &first, const int &n)
+{
+	switch (query.kind) {
+	case Query_Batcher::Scalar_Query:
+		query.model->EvaluateScalar(query.points + 3 * first, n, query.values + first);
+		break;
+	case Query_Batcher::Scalar_Gradient_Query:
+		query.model->EvaluateScalarAndGradient(query.points + 3 * first, n, query.values + first,
+			query.gradients + 3 * first);
+		break;
+	case Query_Batcher::Classify_Query:
+		query.model->Classify(query.points + 3 * first, n, query.units + first);
+		break;
+	case Query_Batcher::Grid_Slab_Query: {
+		double points[3 * chunk_points];
+		const long long slice_points = (long long)query.nx * query.ny;
+		for (int j = 0; j < n; j++) {
+			const long long p = first + j;
+			const long long k = p / slice_points;
+			const long long r = p - k * slice_points;
+			points[3 * j] = query.origin[0] + (double)(r % query.nx) * query.spacing[0];
+			points[3 * j + 1] = query.origin[1] + (double)(r / query.nx) * query.spacing[1];
+			points[3 * j + 2] = query.origin[2] + (double)(query.first_slice + k) * query.spacing[2];
+		}
+		query.model->EvaluateScalar(points, n, query.values + first);
+		break;
+	}
+	}
+}
+
+Query_Batcher::Query_Batcher(const int &max_threads, const long long &max_batch_points, const int &batch_window_us)
+	: max_threads_(max_threads), max_batch_points_(std::max(max_batch_points, chunk_points)),
+	batch_window_(std::max(batch_window_us, 0)), queued_points_(0), stop_(false),
+	n_requests_(0), n_points_(0), n_batches_(0)
+{
+	dispatcher_ = std::thread(&Query_Batcher::dispatch, this);
+}
+
+Query_Batcher::~Query_Batcher()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	queued_.notify_all();
+	dispatcher_.join();
+}
+
+void Query_Batcher::Evaluate(Query &query)
+{
+	query.next = 0;
+	query.done = 0;
+	query.error.clear();
+	if (query.n_points <= 0)
+		return;
+	std::unique_lock<std::mutex> lock(mutex_);
+	queue_.push_back(&query);
+	queued_points_ += query.n_points;
+	queued_.notify_one();
+	finished_.wait(lock, [&]() { return query.done == query.n_points; });
+	if (!query.error.empty())
+		throw std::runtime_error(query.error);
+}
+
+void Query_Batcher::GetStats(uint64_t &n_requests, uint64_t &n_points, uint64_t &n_batches)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	n_requests = n_requests_;
+	n_points = n_points_;
+	n_batches = n_batches_;
+}
+
+void Query_Batcher::dispatch()
+{
+	struct Part {
+		Query *query;
+		long long first;
+		long long n;
+	};
+	struct Chunk {
+		size_t part;
+		long long first;
+		int n;
+	};
+	// loop bodies of this thread obey max_threads
+	Scheduler_Scope scope(nullptr, max_threads_);
+	std::vector<Part> parts;
+	std::vector<Chunk> chunks;
+	std::vector<std::string> errors;
+	for (;;) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		queued_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+		if (queue_.empty())
+			return;
+		if (batch_window_.count() > 0 && queued_points_ < max_batch_points_)
+			queued_.wait_for(lock, batch_window_, [&]() { return stop_ || queued_points_ >= max_batch_points_; });
+
+		// up to max_batch_points from the front of the queue. The last query
+		// taken may be split, its rest goes to the back of the queue so the
+		// queries behind it are in the next batch (round robin)
+		parts.clear();
+		long long n_taken = 0;
+		while (!queue_.empty() && n_taken < max_batch_points_) {
+			Query *query = queue_.front();
+			long long n = std::min(query->n_points - query->next, max_batch_points_ - n_taken);
+			parts.push_back({ query, query->next, n });
+			if (query->next == 0)
+				n_requests_++;
+			query->next += n;
+			n_taken += n;
+			queue_.pop_front();
+			if (query->next < query->n_points)
+				queue_.push_back(query);
+		}
+		queued_points_ -= n_taken;
+		lock.unlock();
+
+		chunks.clear();
+		for (size_t p = 0; p < parts.size(); p++)
+			for (long long first = parts[p].first; first < parts[p].first + parts[p].n; first += chunk_points)
+				chunks.push_back({ p, first, (int)std::min(chunk_points, parts[p].first + parts[p].n - first) });
+		errors.assign(parts.size(), std::string());
+		parallel_for((int)chunks.size(), 1, [&](const int &first, const int &last) {
+			for (int c = first; c < last; c++) {
+				const Chunk &chunk = chunks[c];
+				try {
+					evaluate_range(*parts[chunk.part].query, chunk.first, chunk.n);
+				}
+				catch (const std::exception &e) {
+					std::lock_guard<std::mutex> error_lock(mutex_);
+					errors[chunk.part] = e.what();
+				}
+			}
+		});
+
+		lock.lock();
+		for (size_t p = 0; p < parts.size(); p++) {
+			if (!errors[p].empty())
+				parts[p].query->error = errors[p];
+			parts[p].query->done += parts[p].n;
+		}
+		n_points_ += (uint64_t)n_taken;
+		n_batches_++;
+		lock.unlock();
+		finished_.notify_all();
+	}
+}
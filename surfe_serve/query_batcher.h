@@ -0,0 +1,114 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef query_batcher_h
+#define query_batcher_h
+
+#include <surfe_eval.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Coalesces the queries of concurrent connections into evaluation batches.
+// A dispatcher thread takes the queued queries, at most max_batch_points
+// points at a time, cuts them in chunks and evaluates the chunks with
+// parallel_for on the task scheduler. A query larger than a batch is split
+// over several batches and its rest goes to the back of the queue, so small
+// queries wait at most one batch behind a large grid slab. Queries arriving
+// while a batch is evaluated form the next one; batch_window additionally
+// holds an incomplete batch back for more queries (0: batches go as soon as
+// the dispatcher is free).
+class Query_Batcher {
+public:
+	enum Query_Kind {
+		Scalar_Query,
+		Scalar_Gradient_Query,
+		Classify_Query,
+		Grid_Slab_Query
+	};
+	// results are written straight to values, gradients or units
+	struct Query {
+		Query_Kind kind;
+		const Surfe_Evaluator *model;
+		long long n_points;
+		const double *points;  // n_points x 3 row major, not for grid slabs
+		// grid slab: origin + (i, j, first_slice + k) * spacing, x fastest
+		double origin[3];
+		double spacing[3];
+		int nx, ny, first_slice;
+		double *values;
+		double *gradients;     // n_points x 3 row major
+		int32_t *units;
+
+		// progress, guarded by the batcher
+		long long next;  // first point not handed to a batch yet
+		long long done;
+		std::string error;
+	};
+
+private:
+	int max_threads_;
+	long long max_batch_points_;
+	std::chrono::microseconds batch_window_;
+	std::mutex mutex_;
+	std::condition_variable queued_;
+	std::condition_variable finished_;
+	std::deque<Query *> queue_;
+	long long queued_points_;
+	bool stop_;
+	uint64_t n_requests_, n_points_, n_batches_;
+	std::thread dispatcher_;
+
+	void dispatch();
+
+public:
+	// max_threads: threads per batch (0 = all of the task scheduler)
+	Query_Batcher(const int &max_threads, const long long &max_batch_points, const int &batch_window_us);
+	// evaluates the queries already queued, then stops the dispatcher
+	~Query_Batcher();
+
+	// queues query and blocks until it is evaluated. Throws std::runtime_error
+	void Evaluate(Query &query);
+	void GetStats(uint64_t &n_requests, uint64_t &n_points, uint64_t &n_batches);
+};
+
+#endif
@@ -0,0 +1,220 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <serve_client.h>
+
+#include <cstring>
+#include <unistd.h>
+
+using namespace Serve_Protocol;
+
+static Request_Header new_request(const Request_Type &type, const int &model)
+{
+	Request_Header header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic = request_magic;
+	header.type = type;
+	header.model = model;
+	return header;
+}
+
+static void set_grid_slab(Request_Header &header, const double origin[3], const double spacing[3], const int dims[3],
+	const int &first_slice, const int &n_slices)
+{
+	for (int d = 0; d < 3; d++) {
+		header.origin[d] = origin[d];
+		header.spacing[d] = spacing[d];
+		header.dims[d] = dims[d];
+	}
+	header.first_slice = first_slice;
+	header.n_slices = n_slices;
+}
+
+Surfe_Serve_Client::Surfe_Serve_Client(const std::string &socket_path)
+{
+	std::string error;
+	socket_ = connect_unix_socket(socket_path, error);
+	if (socket_ < 0)
+		throw Serve_Error(error);
+}
+
+Surfe_Serve_Client::~Surfe_Serve_Client()
+{
+	close(socket_);
+}
+
+Response_Header Surfe_Serve_Client::request(Request_Header &header, const void *payload, const size_t &payload_bytes,
+	const int &fd /*= -1*/)
+{
+	header.payload_bytes = payload_bytes;
+	Response_Header response;
+	if (!write_fully_with_fd(socket_, &header, sizeof(header), fd) || !write_fully(socket_, payload, payload_bytes) ||
+		!read_fully(socket_, &response, sizeof(response)) || response.magic != response_magic)
+		throw Serve_Error("connection to surfe_serve lost");
+	reply_.resize((size_t)response.payload_bytes);
+	if (!read_fully(socket_, reply_.data(), reply_.size()))
+		throw Serve_Error("connection to surfe_serve lost");
+	if (response.status != Ok)
+		throw Serve_Error(std::string(reply_.begin(), reply_.end()));
+	return response;
+}
+
+void Surfe_Serve_Client::copy_reply(void *results, const size_t &bytes)
+{
+	if (reply_.size() != bytes)
+		throw Serve_Error("unexpected response size");
+	std::memcpy(results, reply_.data(), bytes);
+}
+
+int Surfe_Serve_Client::LoadModel(const std::string &filename)
+{
+	Request_Header header = new_request(Load_Model, -1);
+	return (int)request(header, filename.data(), filename.size()).value;
+}
+
+int Surfe_Serve_Client::GetNumberOfCenters(const int &model)
+{
+	Request_Header header = new_request(Get_Model_Info, model);
+	request(header, nullptr, 0);
+	Model_Info info;
+	if (reply_.size() < sizeof(info))
+		throw Serve_Error("unexpected response size");
+	std::memcpy(&info, reply_.data(), sizeof(info));
+	return info.n_centers;
+}
+
+std::vector<double> Surfe_Serve_Client::GetInterfaceIsoValues(const int &model)
+{
+	Request_Header header = new_request(Get_Model_Info, model);
+	request(header, nullptr, 0);
+	Model_Info info;
+	if (reply_.size() < sizeof(info))
+		throw Serve_Error("unexpected response size");
+	std::memcpy(&info, reply_.data(), sizeof(info));
+	if (reply_.size() != sizeof(info) + info.n_interfaces * sizeof(double))
+		throw Serve_Error("unexpected response size");
+	std::vector<double> iso_values(info.n_interfaces);
+	if (info.n_interfaces > 0)
+		std::memcpy(iso_values.data(), reply_.data() + sizeof(info), iso_values.size() * sizeof(double));
+	return iso_values;
+}
+
+Server_Stats Surfe_Serve_Client::GetServerStats()
+{
+	Request_Header header = new_request(Get_Server_Stats, -1);
+	request(header, nullptr, 0);
+	Server_Stats stats;
+	copy_reply(&stats, sizeof(stats));
+	return stats;
+}
+
+void Surfe_Serve_Client::EvaluateScalar(const int &model, const double *points, const int &n_points, double *values)
+{
+	Request_Header header = new_request(Scalar, model);
+	header.n_points = n_points;
+	request(header, points, 3 * (size_t)n_points * sizeof(double));
+	copy_reply(values, (size_t)n_points * sizeof(double));
+}
+
+void Surfe_Serve_Client::EvaluateScalarAndGradient(const int &model, const double *points, const int &n_points,
+	double *values, double *gradients)
+{
+	Request_Header header = new_request(Scalar_Gradient, model);
+	header.n_points = n_points;
+	request(header, points, 3 * (size_t)n_points * sizeof(double));
+	if (reply_.size() != 4 * (size_t)n_points * sizeof(double))
+		throw Serve_Error("unexpected response size");
+	std::memcpy(values, reply_.data(), (size_t)n_points * sizeof(double));
+	std::memcpy(gradients, reply_.data() + (size_t)n_points * sizeof(double), 3 * (size_t)n_points * sizeof(double));
+}
+
+void Surfe_Serve_Client::Classify(const int &model, const double *points, const int &n_points, int32_t *units)
+{
+	Request_Header header = new_request(Serve_Protocol::Classify, model);
+	header.n_points = n_points;
+	request(header, points, 3 * (size_t)n_points * sizeof(double));
+	copy_reply(units, (size_t)n_points * sizeof(int32_t));
+}
+
+void Surfe_Serve_Client::EvaluateGridSlab(const int &model, const double origin[3], const double spacing[3],
+	const int dims[3], const int &first_slice, const int &n_slices, double *values)
+{
+	Request_Header header = new_request(Grid_Slab, model);
+	set_grid_slab(header, origin, spacing, dims, first_slice, n_slices);
+	Response_Header response = request(header, nullptr, 0);
+	copy_reply(values, (size_t)response.value * sizeof(double));
+}
+
+char *Surfe_Serve_Client::AttachSharedMemory(const size_t &bytes)
+{
+	std::string error;
+	int fd = shared_.Create(bytes, error);
+	if (fd < 0)
+		throw Serve_Error(error);
+	Request_Header header = new_request(Attach_Shared_Memory, -1);
+	try {
+		request(header, nullptr, 0, fd);
+	}
+	catch (...) {
+		close(fd);
+		shared_.Unmap();
+		throw;
+	}
+	close(fd);
+	return shared_.Data();
+}
+
+void Surfe_Serve_Client::EvaluateShared(const Request_Type &type, const int &model, const int &n_points,
+	const size_t &input_offset, const size_t &output_offset)
+{
+	Request_Header header = new_request(type, model);
+	header.flags = Use_Shared_Memory;
+	header.n_points = n_points;
+	header.input_offset = input_offset;
+	header.output_offset = output_offset;
+	request(header, nullptr, 0);
+}
+
+void Surfe_Serve_Client::EvaluateGridSlabShared(const int &model, const double origin[3], const double spacing[3],
+	const int dims[3], const int &first_slice, const int &n_slices, const size_t &output_offset)
+{
+	Request_Header header = new_request(Grid_Slab, model);
+	header.flags = Use_Shared_Memory;
+	set_grid_slab(header, origin, spacing, dims, first_slice, n_slices);
+	header.output_offset = output_offset;
+	request(header, nullptr, 0);
+}
@@ -0,0 +1,108 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef serve_client_h
+#define serve_client_h
+
+#include <serve_protocol.h>
+#include <serve_socket.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Connection failures and requests refused by the server
+class Serve_Error : public std::runtime_error {
+public:
+	explicit Serve_Error(const std::string &message) : std::runtime_error(message) {}
+};
+
+// Client of surfe_serve. One connection, one request at a time: use a client
+// per thread for concurrent queries, the server coalesces them. Points are
+// n x 3 row major x, y, z. Methods throw Serve_Error.
+class Surfe_Serve_Client {
+private:
+	int socket_;
+	Shared_Memory shared_;
+	std::vector<char> reply_;
+	// sends header and payload, waits for the response, its payload lands in reply_
+	Serve_Protocol::Response_Header request(Serve_Protocol::Request_Header &header, const void *payload,
+		const size_t &payload_bytes, const int &fd = -1);
+	// result payload of exactly bytes copied to results
+	void copy_reply(void *results, const size_t &bytes);
+	// not copyable, owns the connection
+	Surfe_Serve_Client(const Surfe_Serve_Client &);
+	Surfe_Serve_Client &operator=(const Surfe_Serve_Client &);
+
+public:
+	explicit Surfe_Serve_Client(const std::string &socket_path);
+	~Surfe_Serve_Client();
+
+	// id of a saved interpolant, loaded by the server unless it already is.
+	// A relative file name is relative to the server's working directory
+	int LoadModel(const std::string &filename);
+	int GetNumberOfCenters(const int &model);
+	std::vector<double> GetInterfaceIsoValues(const int &model);
+	Serve_Protocol::Server_Stats GetServerStats();
+
+	// points and results go through the socket
+	void EvaluateScalar(const int &model, const double *points, const int &n_points, double *values);
+	// gradients: n_points x 3 row major
+	void EvaluateScalarAndGradient(const int &model, const double *points, const int &n_points, double *values,
+		double *gradients);
+	void Classify(const int &model, const double *points, const int &n_points, int32_t *units);
+	// origin + (i, j, k) * spacing, first_slice <= k < first_slice + n_slices.
+	// values: dims[0] * dims[1] * n_slices, x fastest
+	void EvaluateGridSlab(const int &model, const double origin[3], const double spacing[3], const int dims[3],
+		const int &first_slice, const int &n_slices, double *values);
+
+	// Zero copy queries: bytes of shared memory mapped by the client and the
+	// server, replacing a previous one. The points are placed in it and the
+	// server writes the results to it, only the request headers go through
+	// the socket. Offsets are in bytes, multiples of 8
+	char *AttachSharedMemory(const size_t &bytes);
+	char *SharedMemory() const { return shared_.Data(); }
+	// type: Scalar, Scalar_Gradient or Classify, results laid out as in
+	// serve_protocol.h
+	void EvaluateShared(const Serve_Protocol::Request_Type &type, const int &model, const int &n_points,
+		const size_t &input_offset, const size_t &output_offset);
+	void EvaluateGridSlabShared(const int &model, const double origin[3], const double spacing[3], const int dims[3],
+		const int &first_slice, const int &n_slices, const size_t &output_offset);
+};
+
+#endif
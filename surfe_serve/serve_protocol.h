@@ -0,0 +1,131 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef serve_protocol_h
+#define serve_protocol_h
+
+#include <cstdint>
+
+// Binary protocol of surfe_serve over a Unix domain socket. A client sends a
+// Request_Header, followed by payload_bytes of payload, and waits for a
+// Response_Header and its payload; one request at a time per connection,
+// concurrent clients use a connection each. Integers and doubles are in the
+// byte order of the machine, both ends run on it.
+//
+// Point queries carry their points (n_points x 3 row major x, y, z) in the
+// payload and get their results in the response payload, or, with the
+// Use_Shared_Memory flag, read the points at input_offset of the connection's
+// shared memory and write the results at output_offset: nothing but the
+// headers goes through the socket. Results:
+//   Scalar           n_points doubles
+//   Scalar_Gradient  n_points values, then n_points x 3 row major gradients
+//   Classify         n_points int32 units (see Surfe_Evaluator::Classify)
+//   Grid_Slab        dims[0] * dims[1] * n_slices doubles, x fastest
+namespace Serve_Protocol {
+	const uint32_t request_magic = 0x51465253;   // "SRFQ"
+	const uint32_t response_magic = 0x52465253;  // "SRFR"
+
+	enum Request_Type {
+		// payload: file name of a saved interpolant (Surfe_API::SaveInterpolant).
+		// value: model id. A file already loaded gets the same id
+		Load_Model = 1,
+		// payload: Model_Info followed by n_interfaces iso values
+		Get_Model_Info = 2,
+		Scalar = 3,
+		Scalar_Gradient = 4,
+		Classify = 5,
+		// origin + (i, j, k) * spacing, 0 <= i < dims[0], 0 <= j < dims[1],
+		// first_slice <= k < first_slice + n_slices
+		Grid_Slab = 6,
+		// the shared memory file descriptor is passed with the header
+		// (SCM_RIGHTS) and mapped by the server, replacing a previous one
+		Attach_Shared_Memory = 7,
+		// payload: Server_Stats
+		Get_Server_Stats = 8
+	};
+
+	enum Request_Flags {
+		Use_Shared_Memory = 1
+	};
+
+	enum Status {
+		Ok = 0,
+		Failed = 1  // payload: error message
+	};
+
+	struct Request_Header {
+		uint32_t magic;
+		uint32_t type;           // Request_Type
+		int32_t model;
+		uint32_t flags;          // Request_Flags
+		int64_t n_points;        // Scalar, Scalar_Gradient, Classify
+		uint64_t input_offset;   // bytes into the shared memory
+		uint64_t output_offset;
+		double origin[3];        // Grid_Slab
+		double spacing[3];
+		int32_t dims[3];
+		int32_t first_slice;
+		int32_t n_slices;
+		uint32_t reserved;
+		uint64_t payload_bytes;
+	};
+
+	struct Response_Header {
+		uint32_t magic;
+		uint32_t status;         // Status
+		int64_t value;           // model id for Load_Model, else # of results
+		uint64_t payload_bytes;
+	};
+
+	struct Model_Info {
+		int32_t n_centers;
+		int32_t n_interfaces;
+	};
+
+	struct Server_Stats {
+		uint64_t models;
+		uint64_t connections;
+		uint64_t requests;       // queries evaluated
+		uint64_t points;         // results evaluated
+		uint64_t batches;        // evaluation passes the queries were coalesced into
+	};
+
+	static_assert(sizeof(Request_Header) == 120, "Request_Header layout");
+	static_assert(sizeof(Response_Header) == 24, "Response_Header layout");
+}
+
+#endif
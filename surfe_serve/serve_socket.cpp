@@ -0,0 +1,268 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#include <serve_socket.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+// macOS: SIGPIPE is ignored by the server, clients set SO_NOSIGPIPE
+#define MSG_NOSIGNAL 0
+#endif
+
+bool read_fully(const int &socket, void *data, const size_t &bytes)
+{
+	int received_fd = -1;
+	if (!read_fully_with_fd(socket, data, bytes, received_fd))
+		return false;
+	if (received_fd >= 0)
+		close(received_fd);
+	return true;
+}
+
+bool write_fully(const int &socket, const void *data, const size_t &bytes)
+{
+	return write_fully_with_fd(socket, data, bytes, -1);
+}
+
+bool read_fully_with_fd(const int &socket, void *data, const size_t &bytes, int &received_fd)
+{
+	received_fd = -1;
+	char *next = static_cast<char *>(data);
+	size_t left = bytes;
+	while (left > 0) {
+		struct iovec io = { next, left };
+		union {
+			char buffer[CMSG_SPACE(sizeof(int))];
+			struct cmsghdr align;
+		} control;
+		struct msghdr message;
+		std::memset(&message, 0, sizeof(message));
+		message.msg_iov = &io;
+		message.msg_iovlen = 1;
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+		ssize_t n = recvmsg(socket, &message, 0);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		for (struct cmsghdr *c = CMSG_FIRSTHDR(&message); c; c = CMSG_NXTHDR(&message, c))
+			if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+				int fd;
+				std::memcpy(&fd, CMSG_DATA(c), sizeof(int));
+				if (received_fd >= 0)
+					close(received_fd);
+				received_fd = fd;
+			}
+		next += n;
+		left -= (size_t)n;
+	}
+	if (left > 0 && received_fd >= 0) {
+		close(received_fd);
+		received_fd = -1;
+	}
+	return left == 0;
+}
+
+bool write_fully_with_fd(const int &socket, const void *data, const size_t &bytes, const int &fd)
+{
+	const char *next = static_cast<const char *>(data);
+	size_t left = bytes;
+	bool send_fd = fd >= 0;
+	while (left > 0) {
+		struct iovec io = { const_cast<char *>(next), left };
+		union {
+			char buffer[CMSG_SPACE(sizeof(int))];
+			struct cmsghdr align;
+		} control;
+		struct msghdr message;
+		std::memset(&message, 0, sizeof(message));
+		message.msg_iov = &io;
+		message.msg_iovlen = 1;
+		if (send_fd) {
+			std::memset(control.buffer, 0, sizeof(control.buffer));
+			message.msg_control = control.buffer;
+			message.msg_controllen = sizeof(control.buffer);
+			struct cmsghdr *c = CMSG_FIRSTHDR(&message);
+			c->cmsg_level = SOL_SOCKET;
+			c->cmsg_type = SCM_RIGHTS;
+			c->cmsg_len = CMSG_LEN(sizeof(int));
+			std::memcpy(CMSG_DATA(c), &fd, sizeof(int));
+		}
+		ssize_t n = sendmsg(socket, &message, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		send_fd = false;
+		next += n;
+		left -= (size_t)n;
+	}
+	return true;
+}
+
+static bool unix_address(const std::string &path, struct sockaddr_un &address, std::string &error)
+{
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		error = "invalid socket path " + path;
+		return false;
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size());
+	return true;
+}
+
+int listen_unix_socket(const std::string &path, std::string &error)
+{
+	struct sockaddr_un address;
+	if (!unix_address(path, address, error))
+		return -1;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		error = std::string("socket: ") + std::strerror(errno);
+		return -1;
+	}
+	// a socket file left by a daemon that did not exit cleanly, unless a
+	// daemon still listens on it
+	struct stat status;
+	if (stat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+		int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		bool in_use = probe >= 0 && connect(probe, (struct sockaddr *)&address, sizeof(address)) == 0;
+		if (probe >= 0)
+			close(probe);
+		if (in_use) {
+			close(fd);
+			error = "a server is already listening on " + path;
+			return -1;
+		}
+		unlink(path.c_str());
+	}
+	if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+		error = "cannot listen on " + path + ": " + std::strerror(errno);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int connect_unix_socket(const std::string &path, std::string &error)
+{
+	struct sockaddr_un address;
+	if (!unix_address(path, address, error))
+		return -1;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		error = std::string("socket: ") + std::strerror(errno);
+		return -1;
+	}
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+	if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+		error = "cannot connect to " + path + ": " + std::strerror(errno);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int Shared_Memory::Create(const size_t &bytes, std::string &error)
+{
+	Unmap();
+	// unique name, unlinked at once: only the descriptors keep it alive
+	static std::atomic<unsigned int> counter(0);
+	std::string name = "/surfe_serve_" + std::to_string((long long)getpid()) + "_" + std::to_string(counter++);
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0) {
+		error = std::string("shm_open: ") + std::strerror(errno);
+		return -1;
+	}
+	shm_unlink(name.c_str());
+	if (ftruncate(fd, (off_t)bytes) != 0) {
+		error = std::string("ftruncate: ") + std::strerror(errno);
+		close(fd);
+		return -1;
+	}
+	void *data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED) {
+		error = std::string("mmap: ") + std::strerror(errno);
+		close(fd);
+		return -1;
+	}
+	data_ = static_cast<char *>(data);
+	size_ = bytes;
+	return fd;
+}
+
+bool Shared_Memory::Map(const int &fd, std::string &error)
+{
+	Unmap();
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+		error = "invalid shared memory";
+		close(fd);
+		return false;
+	}
+	void *data = mmap(nullptr, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		error = std::string("mmap: ") + std::strerror(errno);
+		return false;
+	}
+	data_ = static_cast<char *>(data);
+	size_ = (size_t)status.st_size;
+	return true;
+}
+
+void Shared_Memory::Unmap()
+{
+	if (data_)
+		munmap(data_, size_);
+	data_ = nullptr;
+	size_ = 0;
+}
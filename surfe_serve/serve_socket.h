@@ -0,0 +1,90 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#ifndef serve_socket_h
+#define serve_socket_h
+
+#include <cstddef>
+#include <string>
+
+// Unix domain socket and shared memory helpers of surfe_serve and its client.
+// The read / write functions retry partial transfers and interrupted calls
+// and return false when the peer closed the connection or on error.
+
+bool read_fully(const int &socket, void *data, const size_t &bytes);
+bool write_fully(const int &socket, const void *data, const size_t &bytes);
+// same, also receiving / sending one file descriptor (SCM_RIGHTS) with the
+// first bytes. received_fd is -1 if none came
+bool read_fully_with_fd(const int &socket, void *data, const size_t &bytes, int &received_fd);
+bool write_fully_with_fd(const int &socket, const void *data, const size_t &bytes, const int &fd);
+
+// listening socket at path, a stale socket file is replaced. -1 on error
+int listen_unix_socket(const std::string &path, std::string &error);
+// -1 on error
+int connect_unix_socket(const std::string &path, std::string &error);
+
+// Read / write mapping of a shared memory file descriptor. The descriptor is
+// closed once mapped, the mapping is released by the destructor or Unmap
+class Shared_Memory {
+private:
+	char *data_;
+	size_t size_;
+	// not copyable, owns the mapping
+	Shared_Memory(const Shared_Memory &);
+	Shared_Memory &operator=(const Shared_Memory &);
+
+public:
+	Shared_Memory() : data_(nullptr), size_(0) {}
+	~Shared_Memory() { Unmap(); }
+
+	// new anonymous shared memory of bytes, mapped. Returns a descriptor to
+	// pass to another process (closed by the caller), -1 on error
+	int Create(const size_t &bytes, std::string &error);
+	// maps the whole of fd and closes it
+	bool Map(const int &fd, std::string &error);
+	void Unmap();
+
+	char *Data() const { return data_; }
+	size_t Size() const { return size_; }
+	// [offset, offset + bytes) lies in the mapping
+	bool Contains(const size_t &offset, const size_t &bytes) const
+	{
+		return data_ && offset <= size_ && bytes <= size_ - offset;
+	}
+};
+
+#endif
@@ -0,0 +1,393 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// surfe_serve: local evaluation service. Keeps saved interpolants resident
+// and answers the point, grid slab and classification queries of local
+// clients over a Unix domain socket (see serve_protocol.h and serve_client.h)
+//   surfe_serve <socket path> [model.surfe ...] [--threads n]
+//       [--max-batch-points n] [--batch-window-us n]
+// Models given on the command line get the ids 0, 1, ... in that order.
+// SIGINT / SIGTERM stop the server and remove the socket file.
+#include <serve_protocol.h>
+#include <serve_socket.h>
+#include <query_batcher.h>
+#include <surfe_eval.h>
+
+#include <atomic>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Serve_Protocol;
+
+// larger point sets go through shared memory
+static const uint64_t max_payload_bytes = 256ull << 20;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void request_stop(int)
+{
+	stop_requested = 1;
+}
+
+// Saved interpolants loaded so far, resident until the server exits. Ids are
+// indices, so a model pointer stays valid once handed out
+class Model_Registry {
+private:
+	std::mutex mutex_;
+	std::vector<std::unique_ptr<Surfe_Evaluator> > models_;
+	std::vector<std::string> paths_;
+
+public:
+	// id of the model, loaded unless it already is. Throws
+	int Load(const std::string &filename)
+	{
+		char resolved[PATH_MAX];
+		std::string path = realpath(filename.c_str(), resolved) ? resolved : filename;
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t id = 0; id < paths_.size(); id++)
+			if (paths_[id] == path)
+				return (int)id;
+		std::unique_ptr<Surfe_Evaluator> model(new Surfe_Evaluator(path.c_str()));
+		models_.push_back(std::move(model));
+		paths_.push_back(path);
+		return (int)models_.size() - 1;
+	}
+	// nullptr for an unknown id
+	const Surfe_Evaluator *Get(const int &id)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return id >= 0 && id < (int)models_.size() ? models_[id].get() : nullptr;
+	}
+	size_t Size()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return models_.size();
+	}
+};
+
+struct Server {
+	Model_Registry models;
+	std::unique_ptr<Query_Batcher> batcher;
+	std::atomic<uint64_t> n_connections;
+	Server() : n_connections(0) {}
+};
+
+// pointer to bytes at offset of the shared memory, checked and 8 byte aligned
+static char *shared_range(const Shared_Memory &shared, const uint64_t &offset, const uint64_t &bytes)
+{
+	if (!shared.Data())
+		throw std::runtime_error("no shared memory attached");
+	if (offset % 8 != 0 || !shared.Contains((size_t)offset, (size_t)bytes))
+		throw std::runtime_error("shared memory range out of bounds or misaligned");
+	return shared.Data() + offset;
+}
+
+// evaluates a point or grid slab query. Results go to the shared memory, or
+// to results for the response payload
+static int64_t evaluate_query(Server &server, const Request_Header &request, const std::vector<char> &payload,
+	const Shared_Memory &shared, std::vector<char> &results)
+{
+	Query_Batcher::Query query = Query_Batcher::Query();
+	query.model = server.models.Get(request.model);
+	if (!query.model)
+		throw std::runtime_error("unknown model id " + std::to_string(request.model));
+
+	size_t result_bytes = sizeof(double);
+	if (request.type == Grid_Slab) {
+		query.kind = Query_Batcher::Grid_Slab_Query;
+		if (request.dims[0] <= 0 || request.dims[1] <= 0 || request.n_slices <= 0 || request.first_slice < 0 ||
+			request.dims[2] < request.first_slice + (int64_t)request.n_slices)
+			throw std::runtime_error("invalid grid slab");
+		for (int d = 0; d < 3; d++) {
+			query.origin[d] = request.origin[d];
+			query.spacing[d] = request.spacing[d];
+		}
+		query.nx = request.dims[0];
+		query.ny = request.dims[1];
+		query.first_slice = request.first_slice;
+		query.n_points = (long long)request.dims[0] * request.dims[1] * request.n_slices;
+	}
+	else {
+		if (request.type == Scalar)
+			query.kind = Query_Batcher::Scalar_Query;
+		else if (request.type == Scalar_Gradient) {
+			query.kind = Query_Batcher::Scalar_Gradient_Query;
+			result_bytes = 4 * sizeof(double);
+		}
+		else {
+			query.kind = Query_Batcher::Classify_Query;
+			result_bytes = sizeof(int32_t);
+		}
+		if (request.n_points < 0 || request.n_points > INT_MAX)
+			throw std::runtime_error("invalid # of points");
+		query.n_points = request.n_points;
+	}
+	if (query.n_points > INT_MAX)
+		throw std::runtime_error("too many points in one query");
+	const uint64_t n = (uint64_t)query.n_points;
+	const uint64_t output_bytes = n * result_bytes;
+
+	char *output;
+	if (request.flags & Use_Shared_Memory) {
+		if (query.kind != Query_Batcher::Grid_Slab_Query)
+			query.points = (const double *)shared_range(shared, request.input_offset, 3 * n * sizeof(double));
+		output = shared_range(shared, request.output_offset, output_bytes);
+	}
+	else {
+		if (query.kind != Query_Batcher::Grid_Slab_Query) {
+			if (payload.size() != 3 * n * sizeof(double))
+				throw std::runtime_error("payload does not hold n_points x 3 doubles");
+			query.points = (const double *)payload.data();
+		}
+		if (output_bytes > max_payload_bytes)
+			throw std::runtime_error("results too large for the socket, use shared memory");
+		results.resize((size_t)output_bytes);
+		output = results.data();
+	}
+	if (query.kind == Query_Batcher::Classify_Query)
+		query.units = (int32_t *)output;
+	else {
+		query.values = (double *)output;
+		if (query.kind == Query_Batcher::Scalar_Gradient_Query)
+			query.gradients = query.values + n;
+	}
+	server.batcher->Evaluate(query);
+	return query.n_points;
+}
+
+static void serve_connection(Server &server, const int &socket)
+{
+	Shared_Memory shared;
+	std::vector<char> payload;
+	std::vector<char> reply;
+	for (;;) {
+		Request_Header request;
+		int fd = -1;
+		if (!read_fully_with_fd(socket, &request, sizeof(request), fd))
+			break;
+		// not a client, or a payload to refuse: the stream cannot be resynchronized
+		if (request.magic != request_magic || request.payload_bytes > max_payload_bytes) {
+			if (fd >= 0)
+				close(fd);
+			break;
+		}
+		payload.resize((size_t)request.payload_bytes);
+		if (!read_fully(socket, payload.data(), payload.size())) {
+			if (fd >= 0)
+				close(fd);
+			break;
+		}
+
+		Response_Header response = { response_magic, Ok, 0, 0 };
+		reply.clear();
+		try {
+			switch (request.type) {
+			case Load_Model:
+				response.value = server.models.Load(std::string(payload.begin(), payload.end()));
+				break;
+			case Get_Model_Info: {
+				const Surfe_Evaluator *model = server.models.Get(request.model);
+				if (!model)
+					throw std::runtime_error("unknown model id " + std::to_string(request.model));
+				const std::vector<double> &iso_values = model->GetInterfaceIsoValues();
+				Model_Info info = { model->GetNumberOfCenters(), model->GetNumberOfInterfaces() };
+				reply.resize(sizeof(info) + iso_values.size() * sizeof(double));
+				std::memcpy(reply.data(), &info, sizeof(info));
+				if (!iso_values.empty())
+					std::memcpy(reply.data() + sizeof(info), iso_values.data(), iso_values.size() * sizeof(double));
+				break;
+			}
+			case Scalar:
+			case Scalar_Gradient:
+			case Classify:
+			case Grid_Slab:
+				response.value = evaluate_query(server, request, payload, shared, reply);
+				break;
+			case Attach_Shared_Memory: {
+				if (fd < 0)
+					throw std::runtime_error("no shared memory descriptor received");
+				std::string error;
+				int mapped_fd = fd;
+				fd = -1;
+				if (!shared.Map(mapped_fd, error))
+					throw std::runtime_error(error);
+				response.value = (int64_t)shared.Size();
+				break;
+			}
+			case Get_Server_Stats: {
+				Server_Stats stats;
+				stats.models = server.models.Size();
+				stats.connections = server.n_connections;
+				server.batcher->GetStats(stats.requests, stats.points, stats.batches);
+				reply.resize(sizeof(stats));
+				std::memcpy(reply.data(), &stats, sizeof(stats));
+				break;
+			}
+			default:
+				throw std::runtime_error("unknown request type " + std::to_string(request.type));
+			}
+		}
+		catch (const std::exception &e) {
+			response.status = Failed;
+			std::string message = e.what();
+			reply.assign(message.begin(), message.end());
+		}
+		if (fd >= 0)
+			close(fd);
+		response.payload_bytes = reply.size();
+		if (!write_fully(socket, &response, sizeof(response)) || !write_fully(socket, reply.data(), reply.size()))
+			break;
+	}
+}
+
+static bool parse_int_option(const char *value, long long &number)
+{
+	char *end = nullptr;
+	number = value ? std::strtoll(value, &end, 10) : 0;
+	return value && *value && *end == '\0' && number >= 0;
+}
+
+int main(int argc, char *argv[])
+{
+	std::string socket_path;
+	std::vector<std::string> model_files;
+	long long threads = 0, max_batch_points = 65536, batch_window_us = 0;
+	for (int a = 1; a < argc; a++) {
+		std::string arg = argv[a];
+		long long *option = arg == "--threads" ? &threads : arg == "--max-batch-points" ? &max_batch_points :
+			arg == "--batch-window-us" ? &batch_window_us : nullptr;
+		if (option) {
+			if (!parse_int_option(a + 1 < argc ? argv[++a] : nullptr, *option) || *option > INT_MAX) {
+				std::cerr << "surfe_serve: " << arg << " needs a number >= 0" << std::endl;
+				return 2;
+			}
+		}
+		else if (socket_path.empty())
+			socket_path = arg;
+		else
+			model_files.push_back(arg);
+	}
+	if (socket_path.empty()) {
+		std::cerr << "usage: surfe_serve <socket path> [model.surfe ...] [--threads n] "
+			"[--max-batch-points n] [--batch-window-us n]" << std::endl;
+		return 2;
+	}
+
+	Server server;
+	for (const auto &filename : model_files) {
+		try {
+			int id = server.models.Load(filename);
+			std::cerr << "surfe_serve: model " << id << " " << filename << std::endl;
+		}
+		catch (const std::exception &e) {
+			std::cerr << "surfe_serve: cannot load " << filename << ": " << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	std::string error;
+	int listener = listen_unix_socket(socket_path, error);
+	if (listener < 0) {
+		std::cerr << "surfe_serve: " << error << std::endl;
+		return 1;
+	}
+	std::signal(SIGPIPE, SIG_IGN);
+	std::signal(SIGINT, request_stop);
+	std::signal(SIGTERM, request_stop);
+	server.batcher.reset(new Query_Batcher((int)threads, max_batch_points, (int)batch_window_us));
+	std::cerr << "surfe_serve: listening on " << socket_path << std::endl;
+
+	struct Connection {
+		int socket;
+		std::atomic<bool> finished;
+		std::thread thread;
+	};
+	std::list<std::unique_ptr<Connection> > connections;
+	while (!stop_requested) {
+		// the timeout lets a stop request through
+		struct pollfd listening = { listener, POLLIN, 0 };
+		if (poll(&listening, 1, 200) > 0 && (listening.revents & POLLIN)) {
+			int socket = accept(listener, nullptr, nullptr);
+			if (socket >= 0) {
+				std::unique_ptr<Connection> connection(new Connection());
+				connection->socket = socket;
+				connection->finished = false;
+				Connection *c = connection.get();
+				server.n_connections++;
+				connection->thread = std::thread([&server, c]() {
+					serve_connection(server, c->socket);
+					c->finished = true;
+				});
+				connections.push_back(std::move(connection));
+			}
+		}
+		for (auto it = connections.begin(); it != connections.end();) {
+			if ((*it)->finished) {
+				(*it)->thread.join();
+				close((*it)->socket);
+				it = connections.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	// unblock the connections waiting for a request, then let them finish
+	close(listener);
+	unlink(socket_path.c_str());
+	for (auto &connection : connections) {
+		shutdown(connection->socket, SHUT_RDWR);
+		connection->thread.join();
+		close(connection->socket);
+	}
+	server.batcher.reset();
+	std::cerr << "surfe_serve: stopped" << std::endl;
+	return 0;
+}
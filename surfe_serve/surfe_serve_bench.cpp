@@ -0,0 +1,285 @@
+﻿// SURFace Estimator(SURFE) - Terms and Conditions of Use
+
+// Unless otherwise noted, computer program source code of the SURFace
+// Estimator(SURFE) is covered under Crown Copyright, Government of Canada, and
+// is distributed under the MIT License.
+
+// The Canada wordmark and related graphics associated with this distribution
+// are protected under trademark law and copyright law.No permission is granted
+// to use them outside the parameters of the Government of Canada's corporate
+// identity program. For more information, see
+// http://www.tbs-sct.gc.ca/fip-pcim/index-eng.asp
+
+// Copyright title to all 3rd party software distributed with the SURFace
+// Estimator(SURFE) is held by the respective copyright holders as noted in
+// those files.Users are asked to read the 3rd Party Licenses referenced with
+// those assets.
+
+// MIT License
+
+// Copyright(c) 2017 Government of Canada
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// surfe_serve_bench: throughput and latency of a running surfe_serve
+//   surfe_serve_bench <socket path> <model.surfe> [--clients n] [--seconds s]
+//       [--batch-sizes 1,16,256,4096] [--query scalar|gradient|classify|slab]
+//       [--shared-memory] [--box xmin,ymin,zmin,xmax,ymax,zmax]
+// For every batch size, n client threads with a connection each send queries
+// of that many random points in the box back to back for s seconds. One line
+// per batch size: requests and points per second, latency percentiles and
+// the mean # of requests the server coalesced into an evaluation batch.
+#include <serve_client.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Serve_Protocol;
+
+struct Bench_Options {
+	std::string socket_path;
+	std::string model_file;
+	int clients;
+	double seconds;
+	std::vector<int> batch_sizes;
+	Request_Type query;
+	bool shared_memory;
+	double box[6];
+};
+
+struct Client_Result {
+	std::vector<double> latencies;  // seconds per request
+	long long points;
+	std::string error;
+};
+
+static std::vector<double> parse_numbers(const std::string &text)
+{
+	std::vector<double> numbers;
+	std::stringstream stream(text);
+	std::string item;
+	while (std::getline(stream, item, ','))
+		numbers.push_back(std::atof(item.c_str()));
+	return numbers;
+}
+
+// slab of about n_points points: up to 256 along x, 1 slice
+static void slab_dims(const int &n_points, int dims[3])
+{
+	dims[0] = std::min(n_points, 256);
+	dims[1] = (n_points + dims[0] - 1) / dims[0];
+	dims[2] = 1;
+}
+
+static void run_client(const Bench_Options &options, const int &model, const int &batch_size, const int &seed,
+	const std::chrono::steady_clock::time_point &end, Client_Result &result)
+{
+	try {
+		Surfe_Serve_Client client(options.socket_path);
+		std::mt19937 random(seed);
+		// a few point sets, generated up front
+		const int n_sets = 4;
+		std::vector<double> points(3 * (size_t)batch_size * n_sets);
+		for (size_t j = 0; j < points.size(); j++) {
+			int d = (int)(j % 3);
+			std::uniform_real_distribution<double> coordinate(options.box[d], options.box[d + 3]);
+			points[j] = coordinate(random);
+		}
+		std::vector<double> values(4 * (size_t)batch_size);
+		std::vector<int32_t> units(batch_size);
+		const double spacing[3] = { (options.box[3] - options.box[0]) / 256, (options.box[4] - options.box[1]) / 256, 1 };
+		int dims[3];
+		slab_dims(batch_size, dims);
+
+		// points then results in the shared memory, written once
+		const size_t points_bytes = points.size() * sizeof(double);
+		if (options.shared_memory) {
+			char *shared = client.AttachSharedMemory(points_bytes + 4 * (size_t)batch_size * sizeof(double));
+			std::memcpy(shared, points.data(), points_bytes);
+		}
+
+		result.points = 0;
+		for (long long r = 0; std::chrono::steady_clock::now() < end; r++) {
+			const size_t set = (size_t)(r % n_sets);
+			const double *batch = points.data() + 3 * (size_t)batch_size * set;
+			const double origin[3] = { options.box[0], options.box[1], options.box[2] + (double)set };
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			if (options.shared_memory) {
+				if (options.query == Grid_Slab)
+					client.EvaluateGridSlabShared(model, origin, spacing, dims, 0, 1, points_bytes);
+				else
+					client.EvaluateShared(options.query, model, batch_size, 3 * (size_t)batch_size * set * sizeof(double),
+						points_bytes);
+			}
+			else if (options.query == Scalar)
+				client.EvaluateScalar(model, batch, batch_size, values.data());
+			else if (options.query == Scalar_Gradient)
+				client.EvaluateScalarAndGradient(model, batch, batch_size, values.data(), values.data() + batch_size);
+			else if (options.query == Classify)
+				client.Classify(model, batch, batch_size, units.data());
+			else {
+				values.resize((size_t)dims[0] * dims[1]);
+				client.EvaluateGridSlab(model, origin, spacing, dims, 0, 1, values.data());
+			}
+			std::chrono::duration<double> latency = std::chrono::steady_clock::now() - start;
+			result.latencies.push_back(latency.count());
+			result.points += options.query == Grid_Slab ? (long long)dims[0] * dims[1] : batch_size;
+		}
+	}
+	catch (const std::exception &e) {
+		result.error = e.what();
+	}
+}
+
+static double percentile(const std::vector<double> &sorted, const double &p)
+{
+	if (sorted.empty())
+		return 0;
+	size_t k = (size_t)std::ceil(p * sorted.size());
+	return sorted[std::min(std::max(k, (size_t)1), sorted.size()) - 1];
+}
+
+int main(int argc, char *argv[])
+{
+	Bench_Options options;
+	options.clients = 4;
+	options.seconds = 3;
+	options.batch_sizes = { 1, 16, 256, 4096 };
+	options.query = Scalar;
+	options.shared_memory = false;
+	const double default_box[6] = { 0, 0, 0, 100, 100, 100 };
+	std::copy(default_box, default_box + 6, options.box);
+
+	std::vector<std::string> positional;
+	for (int a = 1; a < argc; a++) {
+		std::string arg = argv[a];
+		std::string value = a + 1 < argc ? argv[a + 1] : "";
+		if (arg == "--clients" && a + 1 < argc) {
+			options.clients = std::max(std::atoi(value.c_str()), 1);
+			a++;
+		}
+		else if (arg == "--seconds" && a + 1 < argc) {
+			options.seconds = std::max(std::atof(value.c_str()), 0.1);
+			a++;
+		}
+		else if (arg == "--batch-sizes" && a + 1 < argc) {
+			options.batch_sizes.clear();
+			for (double n : parse_numbers(value))
+				if (n >= 1 && n <= INT_MAX / 32)
+					options.batch_sizes.push_back((int)n);
+			a++;
+		}
+		else if (arg == "--query" && a + 1 < argc) {
+			if (value == "scalar")
+				options.query = Scalar;
+			else if (value == "gradient")
+				options.query = Scalar_Gradient;
+			else if (value == "classify")
+				options.query = Classify;
+			else if (value == "slab")
+				options.query = Grid_Slab;
+			else {
+				std::cerr << "surfe_serve_bench: unknown query " << value << std::endl;
+				return 2;
+			}
+			a++;
+		}
+		else if (arg == "--shared-memory")
+			options.shared_memory = true;
+		else if (arg == "--box" && a + 1 < argc) {
+			std::vector<double> box = parse_numbers(value);
+			if (box.size() != 6) {
+				std::cerr << "surfe_serve_bench: --box needs xmin,ymin,zmin,xmax,ymax,zmax" << std::endl;
+				return 2;
+			}
+			std::copy(box.begin(), box.end(), options.box);
+			a++;
+		}
+		else
+			positional.push_back(arg);
+	}
+	if (positional.size() != 2 || options.batch_sizes.empty()) {
+		std::cerr << "usage: surfe_serve_bench <socket path> <model.surfe> [--clients n] [--seconds s] "
+			"[--batch-sizes 1,16,256,4096] [--query scalar|gradient|classify|slab] [--shared-memory] "
+			"[--box xmin,ymin,zmin,xmax,ymax,zmax]" << std::endl;
+		return 2;
+	}
+	options.socket_path = positional[0];
+	// the server resolves relative names against its own directory
+	char resolved[PATH_MAX];
+	options.model_file = realpath(positional[1].c_str(), resolved) ? resolved : positional[1];
+
+	try {
+		Surfe_Serve_Client control(options.socket_path);
+		const int model = control.LoadModel(options.model_file);
+		std::printf("model %d: %d centers, %d clients, %s, %s\n", model, control.GetNumberOfCenters(model),
+			options.clients, options.shared_memory ? "shared memory" : "socket payloads",
+			options.query == Scalar ? "scalar" : options.query == Scalar_Gradient ? "gradient" :
+			options.query == Classify ? "classify" : "slab");
+		std::printf("%10s %12s %14s %10s %10s %10s %10s %12s\n", "batch", "requests/s", "points/s",
+			"p50 ms", "p90 ms", "p99 ms", "max ms", "req/batch");
+		for (int batch_size : options.batch_sizes) {
+			Server_Stats before = control.GetServerStats();
+			std::vector<Client_Result> results(options.clients);
+			std::vector<std::thread> clients;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			std::chrono::steady_clock::time_point end = start +
+				std::chrono::microseconds((long long)(options.seconds * 1e6));
+			for (int c = 0; c < options.clients; c++)
+				clients.emplace_back(run_client, std::cref(options), model, batch_size, c + 1, end, std::ref(results[c]));
+			for (auto &client : clients)
+				client.join();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			Server_Stats after = control.GetServerStats();
+
+			std::vector<double> latencies;
+			long long points = 0;
+			for (const auto &result : results) {
+				if (!result.error.empty()) {
+					std::cerr << "surfe_serve_bench: " << result.error << std::endl;
+					return 1;
+				}
+				latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+				points += result.points;
+			}
+			std::sort(latencies.begin(), latencies.end());
+			uint64_t batches = after.batches - before.batches;
+			std::printf("%10d %12.0f %14.0f %10.3f %10.3f %10.3f %10.3f %12.2f\n", batch_size,
+				latencies.size() / elapsed.count(), points / elapsed.count(), 1e3 * percentile(latencies, 0.5),
+				1e3 * percentile(latencies, 0.9), 1e3 * percentile(latencies, 0.99), 1e3 * percentile(latencies, 1.0),
+				batches ? (double)(after.requests - before.requests) / batches : 0.0);
+			std::fflush(stdout);
+		}
+	}
+	catch (const std::exception &e) {
+		std::cerr << "surfe_serve_bench: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
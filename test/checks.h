@@ -0,0 +1,49 @@
+#ifndef surfe_checks_h
+#define surfe_checks_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+// Minimal checks of the test executables registered with ctest. A failed
+// CHECK is reported with its location, the executable then returns
+// EXIT_FAILURE from CHECKS_RESULT()
+
+static int n_failed_checks = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::cout << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+			n_failed_checks++; \
+		} \
+	} while (0)
+
+#define CHECKS_RESULT() (n_failed_checks == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+// true if f throws an Exception (one of the classes of grbf_exceptions.h)
+template <class Exception, class Function>
+bool throws(const Function &f)
+{
+	try {
+		f();
+	}
+	catch (const Exception &) {
+		return true;
+	}
+	catch (const std::exception &e) {
+		std::cout << "unexpected exception: " << e.what() << std::endl;
+	}
+	return false;
+}
+
+// largest absolute difference relative to the largest magnitude of b
+template <class A, class B>
+double relative_difference(const A &a, const B &b)
+{
+	return (a - b).cwiseAbs().maxCoeff() / std::max(1.0, b.cwiseAbs().maxCoeff());
+}
+
+#endif
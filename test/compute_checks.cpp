@@ -0,0 +1,132 @@
+// Checks of the interpolant life cycle: cancelled computations, evaluation of
+// stale interpolants and the use of a Surfe_API while it computes
+#include <checks.h>
+#include <surfe_api.h>
+#include <virtual_volume.h>
+
+#include <future>
+#include <memory>
+#include <string>
+
+static void add_constraints(Surfe_API &api, const double &depth)
+{
+	// jittered so the interface points are never collinear
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j < 8; j++) {
+			double x = i * 10 + 3.1 * std::sin(7.3 * (i * 8 + j));
+			double y = j * 10 + 2.7 * std::cos(5.1 * (i * 8 + j));
+			api.AddInterfaceConstraint(x, y, depth + 5 * std::sin(x / 30.0), 0);
+		}
+	api.AddPlanarConstraintwNormal(50, 50, depth, 0, 0.05, 1);
+}
+
+// a cancelled recompute keeps the previous interpolant, which stays stale
+static void check_cancelled_compute()
+{
+	Surfe_API api(1);
+	add_constraints(api, 50);
+	api.ComputeInterpolant();
+	const double before = api.EvaluateInterpolantAtPoint(30, 30, 50);
+
+	add_constraints(api, 20);
+	std::promise<std::shared_ptr<Compute_Handle> > started;
+	std::shared_future<std::shared_ptr<Compute_Handle> > handle = started.get_future().share();
+	api.SetProgressCallback([&](const std::string &stage, const double &) {
+		if (stage == "setting up basis functions")
+			handle.get()->Cancel();
+	});
+	started.set_value(api.ComputeInterpolantAsync());
+	handle.get()->Wait();
+	CHECK(handle.get()->GetPhase() == Parameter_Types::Cancelled);
+	CHECK(api.InterpolantComputed());
+
+	MatrixXd point(1, 3);
+	point << 30, 30, 50;
+	CHECK(throws<interpolantneedsupdate>([&]() { api.EvaluateInterpolantAtPoints(point); }));
+	CHECK(throws<interpolantneedsupdate>([&]() {
+		api.EvaluateOnRegularGrid(Vector3d(30, 30, 50), Vector3d(1, 1, 1), Vector3i(1, 1, 1));
+	}));
+
+	api.SetProgressCallback(ProgressCallback());
+	api.ComputeInterpolant();
+	CHECK(api.EvaluateInterpolantAtPoint(30, 30, 50) != before);
+
+	// cancelled before it started
+	std::shared_ptr<Compute_Handle> queued = std::make_shared<Compute_Handle>();
+	queued->Cancel();
+	api.AddInterfaceConstraint(5, 5, 40, 0);
+	api.ComputeInterpolant(queued);
+	CHECK(queued->IsDone());
+	CHECK(queued->GetPhase() == Parameter_Types::Cancelled);
+}
+
+// every evaluation path refuses an interpolant older than its constraints or
+// parameters
+static void check_stale_interpolant()
+{
+	Surfe_API api(1);
+	add_constraints(api, 50);
+	CHECK(throws<missinginterpolant>([&]() { api.EvaluateInterpolantAtPoint(1, 2, 3); }));
+	api.ComputeInterpolant();
+
+	const Vector3d origin(0, 0, 0), spacing(10, 10, 10);
+	const Vector3i dims(4, 4, 4);
+	MatrixXd points(2, 3);
+	points << 1, 2, 3, 4, 5, 6;
+	for (int change = 0; change < 2; change++) {
+		if (change == 0)
+			api.SetRBFShapeParameter(2);
+		else {
+			api.ComputeInterpolant();
+			api.AddInterfaceConstraint(45, 45, 50, 0);
+		}
+		CHECK(throws<interpolantneedsupdate>([&]() { api.EvaluateOnRegularGrid(origin, spacing, dims); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { api.EvaluateInterpolantAtPoints(points); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { api.EvaluateVectorInterpolantAtPoints(points); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { api.EvaluateInterpolantAndDerivativesAtPoints(points); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { api.EvaluateGridPyramid(origin, spacing, dims); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { api.GetIsoSurfaces(origin, spacing, dims); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { api.ComputeConstraintResiduals(); }));
+		CHECK(throws<interpolantneedsupdate>([&]() { Virtual_Volume volume(&api, origin, spacing, dims); }));
+	}
+	api.ComputeInterpolant();
+	CHECK(api.EvaluateOnRegularGrid(origin, spacing, dims).rows() == 64);
+}
+
+// while a computation runs the other methods throw, on_complete may use the
+// object
+static void check_compute_in_progress()
+{
+	Surfe_API api(1);
+	add_constraints(api, 50);
+	int n_thrown = 0;
+	api.SetProgressCallback([&](const std::string &stage, const double &) {
+		if (stage != "solving")
+			return;
+		n_thrown += throws<computationinprogress>([&]() { api.GetInterfaceConstraints(); });
+		n_thrown += throws<computationinprogress>([&]() { api.SetRBFShapeParameter(1); });
+		n_thrown += throws<computationinprogress>([&]() { api.AddInterfaceConstraint(0, 0, 0, 0); });
+	});
+	double on_complete_value = 0;
+	std::shared_ptr<Compute_Handle> handle = api.ComputeInterpolantAsync([&](const Parameter_Types::ComputePhase &) {
+		on_complete_value = api.EvaluateInterpolantAtPoint(30, 30, 50);
+	});
+	handle->Wait();
+	CHECK(handle->GetPhase() == Parameter_Types::Complete);
+	CHECK(n_thrown == 3);
+	CHECK(on_complete_value == api.EvaluateInterpolantAtPoint(30, 30, 50));
+
+	// same interpolant as the synchronous computation
+	Surfe_API sync(1);
+	add_constraints(sync, 50);
+	sync.ComputeInterpolant();
+	CHECK(std::fabs(sync.EvaluateInterpolantAtPoint(30, 30, 50) - on_complete_value) < 1e-9);
+}
+
+int main()
+{
+	check_cancelled_compute();
+	check_stale_interpolant();
+	check_compute_in_progress();
+	return CHECKS_RESULT();
+}
@@ -0,0 +1,213 @@
+// Checks that the batched evaluation paths (fused evaluator, regular grids,
+// grid pyramids, virtual volumes, model batches) reproduce the per-point
+// evaluation of the modelling methods, and of the task scheduler they run on
+#include <checks.h>
+#include <surfe_api.h>
+#include <fused_evaluator.h>
+#include <surfe_batch.h>
+#include <virtual_volume.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+struct Model_Case {
+	int mode;
+	Parameter_Types::RBF rbf;
+	double shape_parameter;
+	bool anisotropic;
+	bool restricted_range;
+};
+
+static void add_constraints(Surfe_API &api, const int &mode)
+{
+	for (int i = 0; i < 6; i++)
+		for (int j = 0; j < 6; j++) {
+			double x = i * 17 + std::sin(3.0 * i + j), y = j * 13 + std::cos(5.0 * j + i);
+			api.AddInterfaceConstraint(x, y, 50 + 5 * std::sin(x / 30.0), 0);
+			if (mode != 1)
+				api.AddInterfaceConstraint(x, y, 20 + 5 * std::sin(x / 30.0), 1);
+		}
+	if (mode != 5) {
+		api.AddPlanarConstraintwNormal(50, 50, 50, 0, 0.05, 1);
+		api.AddPlanarConstraintwNormal(20, 50, 50, 0.1, 0, 1);
+		api.AddPlanarConstraintwStrikeDipPolarity(70, 30, 40, 30, 10, 0);
+		api.AddTangentConstraint(40, 40, 45, 1, 0, 0.05);
+	}
+}
+
+static MatrixXd check_points(const int &n)
+{
+	MatrixXd points(n, 3);
+	for (int k = 0; k < n; k++)
+		points.row(k) << (k * 37) % 100 + 0.3, (k * 53) % 100 + 0.7, (k * 11) % 90 + 0.1;
+	points.row(0) << 0, 0, 50;  // on a center
+	return points;
+}
+
+// the fused evaluator of several models at once against the per-point
+// evaluation of each model
+static void check_fused_evaluation()
+{
+	using P = Parameter_Types;
+	const Model_Case cases[] = {
+		{ 1, P::Cubic, 0, false, false }, { 1, P::Gaussian, 0.01, false, false }, { 1, P::Cubic, 0, true, false },
+		{ 1, P::Cubic, 0, false, true }, { 2, P::Cubic, 0, false, false }, { 2, P::MQ, 60, true, false },
+		{ 5, P::MQ, 60, false, false } };
+	std::vector<std::unique_ptr<Surfe_API> > apis;
+	std::vector<Surfe_API *> models;
+	for (const auto &c : cases) {
+		apis.emplace_back(new Surfe_API(c.mode));
+		Surfe_API &api = *apis.back();
+		add_constraints(api, c.mode);
+		api.SetRBFKernel(c.rbf);
+		if (c.shape_parameter != 0)
+			api.SetRBFShapeParameter(c.shape_parameter);
+		if (c.anisotropic)
+			api.SetGlobalAnisotropy(true);
+		if (c.restricted_range)
+			api.SetRestrictedRange(true, 0.5, 5);
+		api.ComputeInterpolant();
+		models.push_back(&api);
+	}
+
+	const MatrixXd points = check_points(500);
+	Fused_Evaluator fused(models);
+	MatrixXd values, gradients;
+	fused.EvaluateInterpolantsAndGradientsAtPoints(points, values, gradients);
+	for (size_t m = 0; m < models.size(); m++) {
+		const VectorXd expected_values = models[m]->EvaluateInterpolantAtPoints(points);
+		const MatrixXd expected_gradients = models[m]->EvaluateVectorInterpolantAtPoints(points);
+		CHECK(relative_difference(values.col(m), expected_values) < 1e-9);
+		CHECK(relative_difference(gradients.middleCols(3 * m, 3), expected_gradients) < 1e-9);
+
+		const MatrixXd derivatives = models[m]->EvaluateInterpolantAndDerivativesAtPoints(points);
+		CHECK(relative_difference(derivatives.col(0), expected_values) < 1e-9);
+		CHECK(relative_difference(derivatives.rightCols(3), expected_gradients) < 1e-9);
+	}
+}
+
+// regular grids, pyramids and virtual volumes against the grid points
+static void check_grid_evaluation()
+{
+	Surfe_API api(1);
+	add_constraints(api, 1);
+	api.SetGlobalAnisotropy(true);
+	api.ComputeInterpolant();
+
+	const Vector3d origin(-3, 1, 2), spacing(7, 9, 11);
+	const Vector3i dims(15, 13, 9);
+	MatrixXd points((long long)dims.prod(), 3);
+	for (int k = 0, row = 0; k < dims(2); k++)
+		for (int j = 0; j < dims(1); j++)
+			for (int i = 0; i < dims(0); i++, row++)
+				points.row(row) = origin + Vector3d(i, j, k).cwiseProduct(spacing);
+	const VectorXd expected = api.EvaluateInterpolantAtPoints(points);
+
+	const VectorXd grid = api.EvaluateOnRegularGrid(origin, spacing, dims);
+	CHECK(relative_difference(grid, expected) < 1e-9);
+
+	const std::vector<Grid_Level> levels = api.EvaluateGridPyramid(origin, spacing, dims, 3);
+	CHECK(levels.size() == 3);
+	CHECK(levels.back().dims == dims);
+	CHECK(relative_difference(levels.back().values, expected) < 1e-9);
+
+	Virtual_Volume volume(&api, origin, spacing, dims, 4, 1);
+	const VectorXd region = volume.GetRegion(Vector3i::Zero(), dims);
+	CHECK(relative_difference(region, expected) < 1e-9);
+	const VectorXd slice = volume.GetSlice(2, 5);
+	CHECK(relative_difference(slice, expected.segment(5LL * dims(0) * dims(1), dims(0) * dims(1))) < 1e-9);
+	CHECK(throws<arrayhasincorrectdimensions>([&]() { volume.GetRegion(Vector3i(10, 0, 0), Vector3i(8, 1, 1)); }));
+	// concurrent readers of the cache, which holds a few bricks only
+	std::vector<std::thread> readers;
+	std::atomic<int> n_wrong(0);
+	for (int t = 0; t < 4; t++)
+		readers.emplace_back([&, t]() {
+			for (int k = 0; k < dims(2); k++) {
+				const VectorXd values = volume.GetSlice(2, (k + 2 * t) % dims(2));
+				const long long first = (long long)((k + 2 * t) % dims(2)) * dims(0) * dims(1);
+				if (relative_difference(values, expected.segment(first, dims(0) * dims(1))) > 1e-9)
+					n_wrong++;
+			}
+		});
+	for (auto &reader : readers)
+		reader.join();
+	CHECK(n_wrong == 0);
+}
+
+static void check_batch_evaluation()
+{
+	Surfe_Batch batch;
+	for (int m = 0; m < 3; m++) {
+		const int index = batch.AddModel(m == 2 ? 2 : 1);
+		add_constraints(batch.GetModel(index), m == 2 ? 2 : 1);
+		batch.GetModel(index).SetRBFShapeParameter(m == 1 ? 0.5 : 1.0);
+	}
+	std::vector<std::shared_ptr<Compute_Handle> > handles = batch.ComputeAll();
+	for (const auto &handle : handles)
+		CHECK(handle->GetPhase() == Parameter_Types::Complete);
+
+	const MatrixXd points = check_points(200);
+	const MatrixXd values = batch.EvaluateInterpolantsAtPoints(points);
+	for (int m = 0; m < batch.GetNumberOfModels(); m++)
+		CHECK(relative_difference(values.col(m), batch.GetModel(m).EvaluateInterpolantAtPoints(points)) < 1e-9);
+}
+
+static void check_task_scheduler()
+{
+	Work_Stealing_Scheduler pool(4);
+	{
+		Scheduler_Scope scope(&pool, 0);
+		// nested loops cover every index once
+		std::vector<long long> sums(1000, 0);
+		parallel_for(1000, 7, [&](const int &begin, const int &end) {
+			for (int j = begin; j < end; j++) {
+				std::atomic<long long> sum(0);
+				parallel_for(100, 3, [&](const int &inner_begin, const int &inner_end) {
+					for (int k = inner_begin; k < inner_end; k++)
+						sum += k;
+				});
+				sums[j] = sum + j;
+			}
+		});
+		long long total = 0;
+		for (long long sum : sums)
+			total += sum;
+		CHECK(total == 1000LL * 4950 + 499500);
+
+		// the exception of a body is rethrown by the loop
+		bool rethrown = false;
+		try {
+			parallel_for(10000, 10, [&](const int &begin, const int &end) {
+				if (begin <= 5000 && 5000 < end)
+					throw std::runtime_error("body failure");
+			});
+		}
+		catch (const std::runtime_error &) {
+			rethrown = true;
+		}
+		CHECK(rethrown);
+	}
+	{
+		Scheduler_Scope scope(&pool, 2);
+		std::mutex mutex;
+		std::set<std::thread::id> threads;
+		parallel_for(200, 1, [&](const int &, const int &) {
+			std::lock_guard<std::mutex> lock(mutex);
+			threads.insert(std::this_thread::get_id());
+		});
+		CHECK(threads.size() <= 2);
+	}
+}
+
+int main()
+{
+	check_fused_evaluation();
+	check_grid_evaluation();
+	check_batch_evaluation();
+	check_task_scheduler();
+	return CHECKS_RESULT();
+}
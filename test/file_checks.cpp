@@ -0,0 +1,143 @@
+// Round trip checks of the files written by Surfe_API: binary constraint
+// files, interpolant snapshots and the .vti / .mhd regular grids
+#include <checks.h>
+#include <surfe_api.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static void add_constraints(Surfe_API &api, const double &depth, const int &n)
+{
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++) {
+			double x = i * 10 + 3.1 * std::sin(7.3 * (i * n + j)), y = j * 10 + 2.7 * std::cos(5.1 * (i * n + j));
+			api.AddInterfaceConstraint(x, y, depth + 5 * std::sin(x / 30.0), 0);
+			api.AddInterfaceConstraint(x, y, depth - 30 + 5 * std::sin(x / 30.0), 1);
+		}
+	api.AddPlanarConstraintwNormal(50, 50, depth, 0, 0.05, 1);
+	api.AddPlanarConstraintwNormal(20, 40, depth - 30, 0.1, 0, 1);
+}
+
+static std::string read_file(const char *filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Save then Load restores the saved constraints, also into an instance that
+// has constraints of other types
+static void check_constraint_file()
+{
+	Surfe_API saved(2);
+	add_constraints(saved, 60, 6);
+	saved.AddTangentConstraint(40, 40, 55, 1, 0, 0.05);
+	saved.SaveConstraints("checks_constraints.scf");
+
+	Surfe_API loaded(2);
+	add_constraints(loaded, 80, 3);
+	loaded.AddInequalityConstraint(10, 30, 80, 0.5);
+	loaded.ComputeInterpolant();
+	loaded.LoadConstraints("checks_constraints.scf");
+	CHECK(loaded.GetInterfaceConstraints() == saved.GetInterfaceConstraints());
+	CHECK(loaded.GetPlanarConstraints() == saved.GetPlanarConstraints());
+	CHECK(loaded.GetTangentConstraints() == saved.GetTangentConstraints());
+	CHECK(loaded.GetInequalityConstraints().rows() == 0);
+	// the interpolant of the previous constraints is stale
+	CHECK(throws<interpolantneedsupdate>([&]() { loaded.EvaluateInterpolantAtPoint(1, 2, 3); }));
+
+	saved.ComputeInterpolant();
+	loaded.ComputeInterpolant();
+	CHECK(loaded.EvaluateInterpolantAtPoint(30, 30, 50) == saved.EvaluateInterpolantAtPoint(30, 30, 50));
+
+	// single precision columns
+	saved.SaveConstraints("checks_constraints_float.scf", true);
+	loaded.LoadConstraints("checks_constraints_float.scf");
+	CHECK(relative_difference(loaded.GetInterfaceConstraints(), saved.GetInterfaceConstraints()) < 1e-6);
+
+	CHECK(throws<errorreadingconstraintfile>([&]() { loaded.LoadConstraints("checks_missing.scf"); }));
+}
+
+// a loaded snapshot evaluates bit for bit as the model it was saved from
+static void check_snapshot()
+{
+	Surfe_API api(2);
+	add_constraints(api, 60, 5);
+	api.SetGlobalAnisotropy(true);
+	api.ComputeInterpolant();
+	api.SaveInterpolant("checks_interpolant.bin");
+
+	Surfe_API loaded(1);
+	loaded.LoadInterpolant("checks_interpolant.bin");
+	MatrixXd points(300, 3);
+	for (int k = 0; k < 300; k++)
+		points.row(k) << (k * 37) % 100, (k * 53) % 100, (k * 11) % 90;
+	CHECK((loaded.EvaluateInterpolantAtPoints(points).array() == api.EvaluateInterpolantAtPoints(points).array()).all());
+	CHECK((loaded.EvaluateVectorInterpolantAtPoints(points).array() == api.EvaluateVectorInterpolantAtPoints(points).array()).all());
+
+	Surfe_API empty(1);
+	CHECK(throws<missinginterpolant>([&]() { empty.SaveInterpolant("checks_empty.bin"); }));
+	// the reader's errors reach the caller wrapped in SurfeExceptions
+	bool read_error = false;
+	try {
+		empty.LoadInterpolant("checks_missing.bin");
+	}
+	catch (const SurfeExceptions &e) {
+		read_error = std::string(e.what()).find("Error reading interpolant snapshot file") != std::string::npos;
+	}
+	CHECK(read_error);
+}
+
+// the values of the written grids are those of EvaluateOnRegularGrid
+static void check_grid_files()
+{
+	Surfe_API api(1);
+	add_constraints(api, 50, 5);
+	api.ComputeInterpolant();
+	const Vector3d origin(-3, 1, 2), spacing(0.7, 0.9, 1.1);
+	const Vector3i dims(40, 30, 17);
+	const long long n = (long long)dims.prod();
+	const VectorXd expected = api.EvaluateOnRegularGrid(origin, spacing, dims);
+
+	// .vti: raw appended data, a UInt64 byte count then the values
+	api.WriteRegularGrid("checks_grid.vti", origin, spacing, dims);
+	const std::string vti = read_file("checks_grid.vti");
+	const size_t appended = vti.find("   _");
+	CHECK(appended != std::string::npos);
+	if (appended != std::string::npos) {
+		std::uint64_t n_bytes = 0;
+		std::memcpy(&n_bytes, &vti[appended + 4], sizeof(n_bytes));
+		CHECK(n_bytes == n * sizeof(double));
+		VectorXd values(n);
+		std::memcpy(values.data(), &vti[appended + 4 + sizeof(n_bytes)], n * sizeof(double));
+		CHECK((values.array() == expected.array()).all());
+	}
+
+	// .mhd: header and a .raw file of floats
+	api.WriteRegularGrid("checks_grid.mhd", origin, spacing, dims, true);
+	const std::string mhd = read_file("checks_grid.mhd");
+	CHECK(mhd.find("DimSize = 40 30 17") != std::string::npos);
+	const std::string raw = read_file("checks_grid.raw");
+	CHECK((long long)raw.size() == n * (long long)sizeof(float));
+	if ((long long)raw.size() == n * (long long)sizeof(float)) {
+		std::vector<float> values(n);
+		std::memcpy(values.data(), raw.data(), raw.size());
+		double difference = 0;
+		for (long long j = 0; j < n; j++)
+			difference = std::max(difference, std::fabs(values[j] - expected(j)) / std::max(1.0, std::fabs(expected(j))));
+		CHECK(difference < 1e-6);
+	}
+
+	CHECK(throws<unsupportedgridfileformat>([&]() { api.WriteRegularGrid("checks_grid.txt", origin, spacing, dims); }));
+}
+
+int main()
+{
+	check_constraint_file();
+	check_snapshot();
+	check_grid_files();
+	return CHECKS_RESULT();
+}
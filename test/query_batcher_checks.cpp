@@ -0,0 +1,113 @@
+// Checks of the query batcher of surfe_serve: concurrent queries of every
+// kind, coalesced into batches or split over several, give the results of
+// the evaluator they are queued for
+#include <checks.h>
+#include <query_batcher.h>
+#include <surfe_api.h>
+#include <surfe_eval.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static Query_Batcher::Query make_query(const Query_Batcher::Query_Kind &kind, const Surfe_Evaluator &model)
+{
+	Query_Batcher::Query query = Query_Batcher::Query();
+	query.kind = kind;
+	query.model = &model;
+	return query;
+}
+
+static void check_point_queries(Query_Batcher &batcher, const Surfe_Evaluator &model)
+{
+	// several threads, queries from a few points to several batches
+	std::atomic<int> n_wrong(0);
+	std::vector<std::thread> clients;
+	for (int t = 0; t < 4; t++)
+		clients.emplace_back([&, t]() {
+			const int n = t == 0 ? 20000 : 17 + 300 * t;
+			std::vector<double> points(3 * n);
+			for (int k = 0; k < 3 * n; k++)
+				points[k] = ((k + 7 * t) * 37 % 1000) / 10.0;
+			std::vector<double> expected(n), expected_gradients(3 * n);
+			std::vector<int> expected_units(n);
+			model.EvaluateScalarAndGradient(points.data(), n, expected.data(), expected_gradients.data());
+			model.Classify(points.data(), n, expected_units.data());
+
+			std::vector<double> values(n), gradients(3 * n);
+			std::vector<int32_t> units(n);
+			Query_Batcher::Query query = make_query(Query_Batcher::Scalar_Gradient_Query, model);
+			query.n_points = n;
+			query.points = points.data();
+			query.values = values.data();
+			query.gradients = gradients.data();
+			batcher.Evaluate(query);
+			Query_Batcher::Query classify = make_query(Query_Batcher::Classify_Query, model);
+			classify.n_points = n;
+			classify.points = points.data();
+			classify.units = units.data();
+			batcher.Evaluate(classify);
+			for (int k = 0; k < n; k++)
+				if (values[k] != expected[k] || gradients[3 * k + 2] != expected_gradients[3 * k + 2] || units[k] != expected_units[k])
+					n_wrong++;
+		});
+	for (auto &client : clients)
+		client.join();
+	CHECK(n_wrong == 0);
+}
+
+static void check_grid_slab_query(Query_Batcher &batcher, const Surfe_Evaluator &model)
+{
+	const int nx = 30, ny = 20, first_slice = 5, n_slices = 4;
+	std::vector<double> values(nx * ny * n_slices);
+	Query_Batcher::Query query = make_query(Query_Batcher::Grid_Slab_Query, model);
+	query.n_points = (long long)values.size();
+	const double origin[3] = { 1, 2, 3 }, spacing[3] = { 2, 3, 4 };
+	for (int j = 0; j < 3; j++) {
+		query.origin[j] = origin[j];
+		query.spacing[j] = spacing[j];
+	}
+	query.nx = nx;
+	query.ny = ny;
+	query.first_slice = first_slice;
+	query.values = values.data();
+	batcher.Evaluate(query);
+
+	double difference = 0;
+	for (int k = 0; k < n_slices; k++)
+		for (int j = 0; j < ny; j++)
+			for (int i = 0; i < nx; i++) {
+				const double point[3] = { origin[0] + i * spacing[0], origin[1] + j * spacing[1], origin[2] + (first_slice + k) * spacing[2] };
+				double value = 0;
+				model.EvaluateScalar(point, 1, &value);
+				difference = std::max(difference, std::fabs(value - values[(k * ny + j) * nx + i]));
+			}
+	CHECK(difference < 1e-9);
+}
+
+int main()
+{
+	Surfe_API api(2);
+	for (int i = 0; i < 6; i++)
+		for (int j = 0; j < 6; j++) {
+			double x = i * 17 + std::sin(3.0 * i + j), y = j * 13 + std::cos(5.0 * j + i);
+			api.AddInterfaceConstraint(x, y, 50 + 5 * std::sin(x / 30.0), 0);
+			api.AddInterfaceConstraint(x, y, 20 + 5 * std::sin(x / 30.0), 1);
+		}
+	api.AddPlanarConstraintwNormal(50, 50, 50, 0, 0.05, 1);
+	api.ComputeInterpolant();
+	api.SaveInterpolant("checks_batcher_model.bin");
+	Surfe_Evaluator model("checks_batcher_model.bin");
+
+	{
+		// small batches so the large queries are split
+		Query_Batcher batcher(0, 4096, 0);
+		check_point_queries(batcher, model);
+		check_grid_slab_query(batcher, model);
+		uint64_t n_requests, n_points, n_batches;
+		batcher.GetStats(n_requests, n_points, n_batches);
+		CHECK(n_requests == 9);
+		CHECK(n_batches >= n_points / 4096);
+	}
+	return CHECKS_RESULT();
+}